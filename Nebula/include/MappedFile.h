@@ -0,0 +1,75 @@
+#ifndef NEBULA_MAPPED_FILE_H
+#define NEBULA_MAPPED_FILE_H
+
+#include "Result.h"
+
+namespace Nebula // ---------------------------------------------------------------------------------------------------------------
+{
+
+/// <summary>
+/// Read-only memory mapping of a whole file. Pages are loaded by the operating system on first access, so opening a large file
+/// costs little more than opening a small one, and data which is laid out for it can be used in place without being read or
+/// parsed.
+/// </summary>
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile & operator=(MappedFile const&) = delete;
+
+	/// <summary> Map the file at the given location. </summary>
+	/// <returns>
+	/// <list type="bullet">
+	/// <item> <term> RESULT_CODE_SUCCESS </term> <description> The file was mapped. </description> </item>
+	/// <item> <term> RESULT_CODE_ALREADY_OPEN </term> <description> A file is already mapped. </description> </item>
+	/// <item> <term> RESULT_CODE_EMPTY </term> <description> The file is empty, and cannot be mapped. </description> </item>
+	/// <item> <term> RESULT_CODE_FAILURE </term> <description> The file could not be opened or mapped. </description> </item>
+	/// </list>
+	/// </returns>
+	Result Open(StringView filePath);
+
+	/// <summary> Unmap the file. </summary>
+	/// <returns>
+	/// <list type="bullet">
+	/// <item> <term> RESULT_CODE_SUCCESS </term> <description> The file was unmapped. </description> </item>
+	/// <item> <term> RESULT_CODE_NOT_OPEN </term> <description> No file was mapped. </description> </item>
+	/// </list>
+	/// </returns>
+	Result Close();
+
+	/// <returns> True if a file is mapped, false otherwise. </returns>
+	bool IsOpen() const;
+
+	/// <returns> The mapped contents of the file, which are page aligned. Empty if no file is mapped. </returns>
+	std::span<std::byte const> GetData() const;
+
+private:
+	std::byte const *	m_pData;
+	size_t				m_size;
+
+#ifdef _WIN32
+	void *				m_fileHandle;		// Windows file handle.
+	void *				m_mappingHandle;	// Windows file mapping handle.
+#endif
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline bool MappedFile::IsOpen() const
+{
+	return (nullptr != m_pData);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<std::byte const> MappedFile::GetData() const
+{
+	return std::span<std::byte const>(m_pData, m_size);
+}
+
+} // namespace Nebula -------------------------------------------------------------------------------------------------------------
+
+#endif//NEBULA_MAPPED_FILE_H
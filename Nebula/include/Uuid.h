@@ -12,6 +12,9 @@ public:
 	Uuid();
 	Uuid(Uuid const& other);
 
+	/// <summary> Restore an identifier from its value, such as one read back from a file. Not checked for uniqueness. </summary>
+	explicit Uuid(uint64_t value);
+
 	uint64_t Get() const;
 
 	bool operator==(Uuid const& rhs) const;
@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Nebula // ---------------------------------------------------------------------------------------------------------------
+{
+
+MappedFile::MappedFile() :
+	m_pData(nullptr),
+	m_size(0)
+#ifdef _WIN32
+	, m_fileHandle(INVALID_HANDLE_VALUE),
+	m_mappingHandle(nullptr)
+#endif
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Result MappedFile::Open(StringView filePath)
+{
+	if (IsOpen())
+		return RESULT_CODE_ALREADY_OPEN;
+
+	String const path(filePath);
+
+#ifdef _WIN32
+	HANDLE const fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (INVALID_HANDLE_VALUE == fileHandle)
+		return RESULT_CODE_FAILURE;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(fileHandle, &fileSize) || (0 == fileSize.QuadPart))
+	{
+		CloseHandle(fileHandle);
+		return (0 == fileSize.QuadPart) ? RESULT_CODE_EMPTY : RESULT_CODE_FAILURE;
+	}
+
+	HANDLE const mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void const*const pView = (nullptr == mappingHandle) ? nullptr : MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (nullptr == pView)
+	{
+		if (nullptr != mappingHandle)
+			CloseHandle(mappingHandle);
+
+		CloseHandle(fileHandle);
+		return RESULT_CODE_FAILURE;
+	}
+
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int const fileDescriptor = open(path.c_str(), O_RDONLY);
+
+	if (-1 == fileDescriptor)
+		return RESULT_CODE_FAILURE;
+
+	struct stat fileStatus;
+
+	if ((0 != fstat(fileDescriptor, &fileStatus)) || (0 == fileStatus.st_size))
+	{
+		close(fileDescriptor);
+		return (0 == fileStatus.st_size) ? RESULT_CODE_EMPTY : RESULT_CODE_FAILURE;
+	}
+
+	size_t const size = static_cast<size_t>(fileStatus.st_size);
+	void *const pView = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+	close(fileDescriptor); // The mapping holds its own reference to the file.
+
+	if (MAP_FAILED == pView)
+		return RESULT_CODE_FAILURE;
+
+	m_size = size;
+#endif
+
+	m_pData = static_cast<std::byte const*>(pView);
+
+	return RESULT_CODE_SUCCESS;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Result MappedFile::Close()
+{
+	if (!IsOpen())
+		return RESULT_CODE_NOT_OPEN;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+	CloseHandle(m_mappingHandle);
+	CloseHandle(m_fileHandle);
+
+	m_mappingHandle = nullptr;
+	m_fileHandle = INVALID_HANDLE_VALUE;
+#else
+	munmap(const_cast<std::byte *>(m_pData), m_size);
+#endif
+
+	m_pData = nullptr;
+	m_size = 0;
+
+	return RESULT_CODE_SUCCESS;
+}
+
+} // namespace Nebula -------------------------------------------------------------------------------------------------------------
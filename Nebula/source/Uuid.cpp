@@ -21,4 +21,11 @@ Uuid::Uuid(Uuid const& other) :
 {
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Uuid::Uuid(uint64_t value) :
+	m_value(value)
+{
+}
+
 } // namespace Nebula -------------------------------------------------------------------------------------------------------------
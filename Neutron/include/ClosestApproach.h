@@ -0,0 +1,87 @@
+#ifndef NEUTRON_CLOSEST_APPROACH_H
+#define NEUTRON_CLOSEST_APPROACH_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "NeutronTime.h"
+#include "Orbit.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+class ParticleBase;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Search for close approaches between orbiters on conics about the same primary, from their current anomalies over a time
+/// horizon. Pairs whose apsis shells are separated by more than the threshold are rejected from their elements alone. Otherwise
+/// the horizon is pruned by branch and bound: the relative distance changes no faster than the sum of the orbiters' periapsis
+/// speeds, which bounds the distance from below over an interval from its values at the ends. Intervals which cannot come within
+/// the threshold are discarded, the rest are bisected down to a fraction of the shorter period, and each minimum bracketed by a
+/// sign change of the range rate is refined by regula falsi. The ends of the horizon are reported when the distance is least
+/// there: the orbiters are receding at the start, or still closing at the horizon.
+/// </summary>
+namespace ClosestApproach // ------------------------------------------------------------------------------------------------------
+{
+
+constexpr int64_t	kSamplesPerPeriod			= 64;	// Finest interval, as a fraction of the shorter closed-orbit period.
+constexpr int64_t	kOpenOrbitSamples			= 256;	// Finest interval, as a fraction of the horizon, when neither orbit is closed.
+constexpr int64_t	kCoarseSamplesPerPeriod		= 8;	// Top-level interval, as a fraction of the shorter closed-orbit period.
+constexpr int		kMaxRefinementIterations	= 64;
+
+template<typename T>
+struct Approach
+{
+	Time::Microseconds	m_time;			// Time of closest approach, relative to the orbiters' current time.
+	T					m_distance;		// Distance at closest approach, in the orbits' units.
+};
+
+template<typename T>
+struct IndexedApproach
+{
+	size_t				m_index;		// Index of the other orbit in the batch.
+	Approach<T>			m_approach;
+};
+
+/// <summary> Find the close approaches between two orbiters within a horizon. </summary>
+/// <param name="orbit"> The first orbiter's orbit. </param>
+/// <param name="otherOrbit"> The second orbiter's orbit, about the same primary and in the same units. </param>
+/// <param name="horizon"> The search duration, from the orbiters' current time. </param>
+/// <param name="threshold"> Approaches closer than this distance are reported. </param>
+/// <param name="approaches"> Storage for the found approaches, in time order. Appended to. </param>
+template<typename T>
+void Find(TOrbit<T> const& orbit, TOrbit<T> const& otherOrbit, Time::Microseconds horizon, T threshold,
+	std::vector<Approach<T>> & approaches);
+
+/// <summary> Batched Find, screening one orbiter against many. The first orbiter's coarse samples are shared by the batch. </summary>
+/// <param name="approaches"> Storage for the found approaches, grouped by batch index and in time order within each group. Appended to. </param>
+template<typename T>
+void Find(TOrbit<T> const& orbit, std::span<TOrbit<T> const* const> otherOrbits, Time::Microseconds horizon, T threshold,
+	std::vector<IndexedApproach<T>> & approaches);
+
+/// <summary> Find the close approaches between two particles in the same scaled space. </summary>
+/// <exception cref="ApiException"> Invalid parameter - the particles are in different spaces, or one has no orbit. </exception>
+void Find(ParticleBase & particle, ParticleBase & otherParticle, Time::Microseconds horizon, float threshold,
+	std::vector<Approach<float>> & approaches);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class ClosestApproachTestScript : public ITestScript
+{
+public:
+	ClosestApproachTestScript();
+	virtual ~ClosestApproachTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace ClosestApproach ----------------------------------------------------------------------------------------------------
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_CLOSEST_APPROACH_H
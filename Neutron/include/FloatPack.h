@@ -0,0 +1,250 @@
+#ifndef NEUTRON_FLOAT_PACK_H
+#define NEUTRON_FLOAT_PACK_H
+
+#include "NebulaTypes.h"
+
+// MSVC accepts AVX intrinsics without /arch:AVX, so x64 builds always compile the AVX specialization and select it at runtime.
+// Other compilers only compile it when targeting AVX.
+#if defined(__AVX__) || defined(__AVX2__) || (defined(_MSC_VER) && defined(_M_X64))
+#define NEUTRON_FLOAT_PACK_AVX
+#endif
+
+#if defined(NEUTRON_FLOAT_PACK_AVX) || defined(_M_X64) || defined(__SSE2__)
+#define NEUTRON_FLOAT_PACK_SSE
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+/// <summary>
+/// A pack of NWidth single-precision lanes, operated on together. Specialized for scalar (1), SSE (4) and AVX (8) lanes.
+/// Every operation is a single IEEE-754 operation per lane (no fused multiply-add), so a kernel written against FloatPack gives
+/// bit-identical results for every width - the scalar specialization is the reference for the SIMD specializations.
+/// Comparisons produce masks (all bits set in true lanes) for use with Select.
+/// </summary>
+template<size_t NWidth>
+class FloatPack;
+
+// Widest pack compiled into this build. The widest pack usable on the executing processor is given by GetFloatPackWidth().
+#if defined(NEUTRON_FLOAT_PACK_AVX)
+constexpr size_t kFloatPackMaxWidth = 8;
+#elif defined(NEUTRON_FLOAT_PACK_SSE)
+constexpr size_t kFloatPackMaxWidth = 4;
+#else
+constexpr size_t kFloatPackMaxWidth = 1;
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<>
+class FloatPack<1>
+{
+public:
+	static constexpr size_t kWidth = 1;
+
+	FloatPack() = default;
+	FloatPack(float value) : m_value(value) {}
+
+	static FloatPack Load(float const* pValues) { return FloatPack(*pValues); }
+	void Store(float * pValues) const { *pValues = m_value; }
+
+	friend FloatPack operator+(FloatPack lhs, FloatPack rhs) { return lhs.m_value + rhs.m_value; }
+	friend FloatPack operator-(FloatPack lhs, FloatPack rhs) { return lhs.m_value - rhs.m_value; }
+	friend FloatPack operator*(FloatPack lhs, FloatPack rhs) { return lhs.m_value * rhs.m_value; }
+	friend FloatPack operator/(FloatPack lhs, FloatPack rhs) { return lhs.m_value / rhs.m_value; }
+
+	friend FloatPack Sqrt(FloatPack value) { return sqrtf(value.m_value); }
+	friend FloatPack Min(FloatPack lhs, FloatPack rhs) { return (lhs.m_value < rhs.m_value) ? lhs : rhs; }
+	friend FloatPack Max(FloatPack lhs, FloatPack rhs) { return (rhs.m_value < lhs.m_value) ? lhs : rhs; }
+
+	friend FloatPack operator<(FloatPack lhs, FloatPack rhs) { return FromMask(lhs.m_value < rhs.m_value); }
+	friend FloatPack operator<=(FloatPack lhs, FloatPack rhs) { return FromMask(lhs.m_value <= rhs.m_value); }
+	friend FloatPack operator==(FloatPack lhs, FloatPack rhs) { return FromMask(lhs.m_value == rhs.m_value); }
+
+	friend FloatPack operator&(FloatPack lhs, FloatPack rhs) { return FromBits(lhs.Bits() & rhs.Bits()); }
+	friend FloatPack operator|(FloatPack lhs, FloatPack rhs) { return FromBits(lhs.Bits() | rhs.Bits()); }
+	friend FloatPack AndNot(FloatPack mask, FloatPack value) { return FromBits(~mask.Bits() & value.Bits()); }
+
+	/// <returns> Lanes of trueValue where the mask is set, otherwise lanes of falseValue. </returns>
+	friend FloatPack Select(FloatPack mask, FloatPack trueValue, FloatPack falseValue)
+	{
+		return FromBits((mask.Bits() & trueValue.Bits()) | (~mask.Bits() & falseValue.Bits()));
+	}
+
+	float operator[](size_t) const { return m_value; }
+
+private:
+	static FloatPack FromMask(bool isSet) { return FromBits(isSet ? 0xFFFFFFFFu : 0u); }
+	static FloatPack FromBits(uint32_t bits) { return std::bit_cast<float>(bits); }
+	uint32_t Bits() const { return std::bit_cast<uint32_t>(m_value); }
+
+	float	m_value;
+};
+
+#if defined(NEUTRON_FLOAT_PACK_SSE)
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<>
+class FloatPack<4>
+{
+public:
+	static constexpr size_t kWidth = 4;
+
+	FloatPack() = default;
+	FloatPack(float value) : m_value(_mm_set1_ps(value)) {}
+	FloatPack(__m128 value) : m_value(value) {}
+
+	static FloatPack Load(float const* pValues) { return _mm_loadu_ps(pValues); }
+	void Store(float * pValues) const { _mm_storeu_ps(pValues, m_value); }
+
+	friend FloatPack operator+(FloatPack lhs, FloatPack rhs) { return _mm_add_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator-(FloatPack lhs, FloatPack rhs) { return _mm_sub_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator*(FloatPack lhs, FloatPack rhs) { return _mm_mul_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator/(FloatPack lhs, FloatPack rhs) { return _mm_div_ps(lhs.m_value, rhs.m_value); }
+
+	friend FloatPack Sqrt(FloatPack value) { return _mm_sqrt_ps(value.m_value); }
+	friend FloatPack Min(FloatPack lhs, FloatPack rhs) { return _mm_min_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack Max(FloatPack lhs, FloatPack rhs) { return _mm_max_ps(lhs.m_value, rhs.m_value); }
+
+	friend FloatPack operator<(FloatPack lhs, FloatPack rhs) { return _mm_cmplt_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator<=(FloatPack lhs, FloatPack rhs) { return _mm_cmple_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator==(FloatPack lhs, FloatPack rhs) { return _mm_cmpeq_ps(lhs.m_value, rhs.m_value); }
+
+	friend FloatPack operator&(FloatPack lhs, FloatPack rhs) { return _mm_and_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator|(FloatPack lhs, FloatPack rhs) { return _mm_or_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack AndNot(FloatPack mask, FloatPack value) { return _mm_andnot_ps(mask.m_value, value.m_value); }
+
+	friend FloatPack Select(FloatPack mask, FloatPack trueValue, FloatPack falseValue)
+	{
+		return _mm_or_ps(_mm_and_ps(mask.m_value, trueValue.m_value), _mm_andnot_ps(mask.m_value, falseValue.m_value));
+	}
+
+	float operator[](size_t index) const
+	{
+		alignas(16) float values[kWidth];
+		_mm_store_ps(values, m_value);
+
+		return values[index];
+	}
+
+private:
+	__m128	m_value;
+};
+
+#endif//NEUTRON_FLOAT_PACK_SSE
+
+#if defined(NEUTRON_FLOAT_PACK_AVX)
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<>
+class FloatPack<8>
+{
+public:
+	static constexpr size_t kWidth = 8;
+
+	FloatPack() = default;
+	FloatPack(float value) : m_value(_mm256_set1_ps(value)) {}
+	FloatPack(__m256 value) : m_value(value) {}
+
+	static FloatPack Load(float const* pValues) { return _mm256_loadu_ps(pValues); }
+	void Store(float * pValues) const { _mm256_storeu_ps(pValues, m_value); }
+
+	friend FloatPack operator+(FloatPack lhs, FloatPack rhs) { return _mm256_add_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator-(FloatPack lhs, FloatPack rhs) { return _mm256_sub_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator*(FloatPack lhs, FloatPack rhs) { return _mm256_mul_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator/(FloatPack lhs, FloatPack rhs) { return _mm256_div_ps(lhs.m_value, rhs.m_value); }
+
+	friend FloatPack Sqrt(FloatPack value) { return _mm256_sqrt_ps(value.m_value); }
+	friend FloatPack Min(FloatPack lhs, FloatPack rhs) { return _mm256_min_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack Max(FloatPack lhs, FloatPack rhs) { return _mm256_max_ps(lhs.m_value, rhs.m_value); }
+
+	friend FloatPack operator<(FloatPack lhs, FloatPack rhs) { return _mm256_cmp_ps(lhs.m_value, rhs.m_value, _CMP_LT_OQ); }
+	friend FloatPack operator<=(FloatPack lhs, FloatPack rhs) { return _mm256_cmp_ps(lhs.m_value, rhs.m_value, _CMP_LE_OQ); }
+	friend FloatPack operator==(FloatPack lhs, FloatPack rhs) { return _mm256_cmp_ps(lhs.m_value, rhs.m_value, _CMP_EQ_OQ); }
+
+	friend FloatPack operator&(FloatPack lhs, FloatPack rhs) { return _mm256_and_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack operator|(FloatPack lhs, FloatPack rhs) { return _mm256_or_ps(lhs.m_value, rhs.m_value); }
+	friend FloatPack AndNot(FloatPack mask, FloatPack value) { return _mm256_andnot_ps(mask.m_value, value.m_value); }
+
+	friend FloatPack Select(FloatPack mask, FloatPack trueValue, FloatPack falseValue)
+	{
+		return _mm256_blendv_ps(falseValue.m_value, trueValue.m_value, mask.m_value);
+	}
+
+	float operator[](size_t index) const
+	{
+		alignas(32) float values[kWidth];
+		_mm256_store_ps(values, m_value);
+
+		return values[index];
+	}
+
+private:
+	__m256	m_value;
+};
+
+#endif//NEUTRON_FLOAT_PACK_AVX
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> The widest FloatPack width compiled into this build and supported by the executing processor. </returns>
+inline size_t GetFloatPackWidth()
+{
+	static size_t const s_width = []() -> size_t
+	{
+#if defined(NEUTRON_FLOAT_PACK_AVX)
+#if defined(_MSC_VER)
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+
+		bool const hasAvx = (0 != (cpuInfo[2] & (1 << 28)));
+		bool const hasOsXSave = (0 != (cpuInfo[2] & (1 << 27)));
+
+		// The OS must also save the upper halves of the YMM registers on context switch.
+		if (hasAvx && hasOsXSave && (0x6 == (_xgetbv(0) & 0x6)))
+			return 8;
+#else
+		if (__builtin_cpu_supports("avx"))
+			return 8;
+#endif
+#endif//NEUTRON_FLOAT_PACK_AVX
+
+		return kFloatPackMaxWidth < 4 ? kFloatPackMaxWidth : 4;
+	}();
+
+	return s_width;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Invoke a kernel templated on pack width with the widest width usable on the executing processor.
+/// The kernel is a callable with a template call operator, e.g. [&]<size_t NWidth>() { ... }.
+/// </summary>
+template<typename TKernel>
+decltype(auto) DispatchFloatPack(TKernel && kernel)
+{
+#if defined(NEUTRON_FLOAT_PACK_AVX)
+	if (8 == GetFloatPackWidth())
+		return kernel.template operator()<8>();
+#endif
+#if defined(NEUTRON_FLOAT_PACK_SSE)
+	return kernel.template operator()<4>();
+#else
+	return kernel.template operator()<1>();
+#endif
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_FLOAT_PACK_H
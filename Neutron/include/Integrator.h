@@ -0,0 +1,126 @@
+#ifndef NEUTRON_INTEGRATOR_H
+#define NEUTRON_INTEGRATOR_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "NeutronTime.h"
+#include "Orbit.h"
+#include "Vector3.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Numerical integration of bodies under non-Keplerian accelerations, such as thrust or perturbations. Each body is integrated
+/// relative to the conic of its orbit elements (Encke's method): the conic is propagated analytically, and only the deviation
+/// from it is integrated. When the deviation grows beyond a fraction of the distance to the primary, the body is rectified - its
+/// elements are recomputed from its state and the deviation is reset to zero. A body with no acceleration coasts along its conic in
+/// one analytic step. All vectors are relative to the primary, in the units of the bodies' scaled space.
+/// </summary>
+namespace Integrator // -----------------------------------------------------------------------------------------------------------
+{
+
+enum class Method : uint8_t
+{
+	RungeKutta4,		// Classic fourth-order Runge-Kutta, with fixed steps.
+	DormandPrince54,	// Fifth-order Runge-Kutta with an embedded fourth-order error estimate, with adaptive steps.
+	VelocityVerlet,		// Second-order symplectic (kick-drift-kick leapfrog), with fixed steps.
+	Yoshida4,			// Fourth-order symplectic (Yoshida's composition of three leapfrog steps), with fixed steps.
+	Count
+};
+
+template<typename T>
+struct TSettings
+{
+	Method				m_method				= Method::DormandPrince54;
+	Time::Microseconds	m_maximumStep			= Time::Microsecond;	// One second. The step of fixed-step methods, and the largest step of adaptive methods.
+	Time::Microseconds	m_minimumStep			= 1;			// The smallest step of adaptive methods, which is accepted whatever its error.
+	T					m_tolerance				= T(1e-6);		// Largest error per adaptive step in any deviation component.
+	T					m_rectificationRatio	= T(1e-2);		// Largest deviation, relative to the distance to the primary, before rectification.
+};
+
+/// <summary> A body integrated relative to the conic of its orbit elements. </summary>
+template<typename T>
+struct TBody
+{
+	using Elements = typename TOrbit<T>::Elements;
+	using Vector3T = TVector3<T>;
+
+	Elements			m_elements;										// Reference conic. Replaced on rectification.
+	double				m_meanAnomaly			= 0.0;					// Mean anomaly on the reference conic. Advanced by integration.
+	Vector3T			m_positionDeviation		= Vector3T::Zero();		// Deviation from the reference conic. Advanced by integration.
+	Vector3T			m_velocityDeviation		= Vector3T::Zero();		// Deviation from the reference conic. Advanced by integration.
+	Vector3T			m_acceleration			= Vector3T::Zero();		// Constant non-gravitational acceleration, such as thrust.
+	Time::Microseconds	m_stepSize				= 0;					// Adaptive step to try first, or 0 for the maximum. Updated with the last step.
+
+	Vector3T			m_position;										// Output: the position at the end of the integration.
+	Vector3T			m_velocity;										// Output: the velocity at the end of the integration.
+	uint32_t			m_stepCount				= 0;					// Output: the number of steps taken, including rejected steps.
+	uint32_t			m_rectificationCount	= 0;					// Output: the number of rectifications.
+};
+
+/// <summary>
+/// Acceleration of a body in addition to the primary's gravity and the body's own constant acceleration, which depends only on the
+/// body's position, so that the symplectic methods remain symplectic.
+/// </summary>
+/// <param name="bodyIndex"> Index of the body in the batch. </param>
+/// <param name="time"> Time since the start of the integration (seconds). </param>
+/// <param name="position"> The body's position. </param>
+template<typename T>
+using TAccelerationFunction = std::function<TVector3<T>(size_t bodyIndex, double time, TVector3<T> const& position)>;
+
+/// <summary>
+/// Initialize a body on the conic through the given state, with no deviation.
+/// </summary>
+/// <param name="gravityParameter"> The gravity parameter of the primary. </param>
+/// <exception cref="ApiException"> Angular momentum evaluated to zero. </exception>
+template<typename T>
+void Initialize(TBody<T> & body, T gravityParameter, TVector3<T> const& position, TVector3<T> const& velocity);
+
+/// <summary>
+/// Integrate a batch of bodies about the same primary by the given time step. Each body takes its own steps: under adaptive
+/// methods a body under strong acceleration takes many small steps, and a body with no acceleration one analytic step.
+/// </summary>
+/// <param name="gravityParameter"> The gravity parameter of the primary. </param>
+/// <param name="bodies"> The bodies, whose states are advanced and outputs written. </param>
+/// <param name="dT"> The time step. </param>
+/// <param name="settings"> The integration method and its parameters. </param>
+/// <param name="accelerationFunction"> Additional acceleration of every body, or empty for none. </param>
+/// <exception cref="ApiException"> Invalid parameter - the settings are invalid. </exception>
+template<typename T>
+void Integrate(T gravityParameter, std::span<TBody<T>> bodies, Time::Microseconds dT, TSettings<T> const& settings,
+	TAccelerationFunction<T> const& accelerationFunction = {});
+
+using Settings = TSettings<float>;
+using Settingsd = TSettings<double>;
+using Body = TBody<float>;
+using Bodyd = TBody<double>;
+
+extern template void Initialize(TBody<float> &, float, TVector3<float> const&, TVector3<float> const&);
+extern template void Initialize(TBody<double> &, double, TVector3<double> const&, TVector3<double> const&);
+extern template void Integrate(float, std::span<TBody<float>>, Time::Microseconds, TSettings<float> const&,
+	TAccelerationFunction<float> const&);
+extern template void Integrate(double, std::span<TBody<double>>, Time::Microseconds, TSettings<double> const&,
+	TAccelerationFunction<double> const&);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class IntegratorTestScript : public ITestScript
+{
+public:
+	IntegratorTestScript();
+	virtual ~IntegratorTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Integrator ---------------------------------------------------------------------------------------------------------
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_INTEGRATOR_H
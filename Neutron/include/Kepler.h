@@ -0,0 +1,106 @@
+#ifndef NEUTRON_KEPLER_H
+#define NEUTRON_KEPLER_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Solvers for Kepler's equation: elliptic M = E - e * sin(E), hyperbolic M = e * sinh(F) - F, and parabolic (Barker's equation)
+/// M = D / 2 + D^3 / 6. Near e = 1 the elliptic and hyperbolic forms lose precision to cancellation, so they are also solved in
+/// series form. Each solver has a scalar and a batched form; the batched forms take structure-of-arrays spans and apply the
+/// scalar solver to each element in turn.
+/// </summary>
+namespace Kepler // ---------------------------------------------------------------------------------------------------------------
+{
+
+/// <summary> Solution method, trading accuracy for throughput. </summary>
+enum class Method
+{
+	FixedHalley,	// A fixed number of Halley iterations from Danby's starter. Fixed cost; converged to double precision for e < 0.99.
+	StarterTable,	// A starter looked up in a precomputed table, refined by a fixed number of Newton iterations. Fixed cost and the
+					// fastest; residual below 1e-8 for e < 0.95, degrading towards e = 1. Hyperbolic orbits are solved as FixedHalley.
+	Tolerance		// Halley iterations until the correction falls below kTolerance. Data-dependent iteration count.
+};
+
+constexpr double	kTolerance					= 1e-12;	// Convergence tolerance of the Tolerance method (radians).
+constexpr int		kMaxIterations				= 32;		// Iteration limit of the Tolerance method.
+constexpr int		kFixedHalleyIterations		= 4;		// Iteration count of the FixedHalley method.
+constexpr int		kStarterNewtonIterations	= 2;		// Newton iteration count of the StarterTable method.
+constexpr double	kNearParabolicBand			= 0.1;		// Orbits with |e - 1| below this are solved by SolveNearParabolic.
+
+/// <summary> Solve the elliptic Kepler equation, M = E - e * sin(E), for the eccentric anomaly (E). </summary>
+/// <param name="meanAnomaly"> The mean anomaly (M), radians. Need not be wrapped to [0, 2 Pi). </param>
+/// <param name="eccentricity"> The eccentricity (e), in [0, 1). </param>
+template<Method NMethod = Method::Tolerance>
+double SolveElliptic(double meanAnomaly, double eccentricity);
+
+/// <summary> Solve the hyperbolic Kepler equation, M = e * sinh(F) - F, for the hyperbolic anomaly (F). </summary>
+/// <param name="meanAnomaly"> The mean anomaly (M). </param>
+/// <param name="eccentricity"> The eccentricity (e), greater than 1. </param>
+template<Method NMethod = Method::Tolerance>
+double SolveHyperbolic(double meanAnomaly, double eccentricity);
+
+/// <summary> Solve Barker's equation, M = D / 2 + D^3 / 6, for the parabolic anomaly D = tan(v / 2). Closed form (Cardano). </summary>
+double SolveParabolic(double meanAnomaly);
+
+/// <summary>
+/// Solve Kepler's equation for an eccentricity near 1, in series form: M = (1 - e) * E + e * (E - sin(E)) for an ellipse, and
+/// M = (e - 1) * F + e * (sinh(F) - F) for a hyperbola, with E - sin(E) and sinh(F) - F summed as series for small anomalies.
+/// Halley iterations from the cubic starter: until the correction falls below kTolerance by the Tolerance method, else a fixed
+/// kFixedHalleyIterations (StarterTable has no table for this band, and is solved as FixedHalley).
+/// </summary>
+/// <param name="meanAnomaly"> The mean anomaly (M), radians. Need not be wrapped to [0, 2 Pi) for an ellipse. </param>
+/// <param name="eccentricity"> The eccentricity (e), other than 1. </param>
+/// <returns> The eccentric anomaly (E) if e is less than 1, else the hyperbolic anomaly (F). </returns>
+template<Method NMethod = Method::Tolerance>
+double SolveNearParabolic(double meanAnomaly, double eccentricity);
+
+/// <summary> Evaluate Kepler's equation in the series form of SolveNearParabolic, of which it is the inverse. </summary>
+/// <param name="anomaly"> The eccentric anomaly (E) if e is less than 1, else the hyperbolic anomaly (F). </param>
+/// <returns> The mean anomaly (M). </returns>
+double NearParabolicMeanAnomaly(double anomaly, double eccentricity);
+
+/// <summary> Batched SolveElliptic. All spans must have the same size. </summary>
+/// <exception cref="ApiException"> Mismatched batch sizes. </exception>
+template<Method NMethod = Method::Tolerance>
+void SolveElliptic(std::span<double const> meanAnomalies, std::span<double const> eccentricities, std::span<double> eccentricAnomalies);
+
+/// <summary> Batched SolveHyperbolic. All spans must have the same size. </summary>
+/// <exception cref="ApiException"> Mismatched batch sizes. </exception>
+template<Method NMethod = Method::Tolerance>
+void SolveHyperbolic(std::span<double const> meanAnomalies, std::span<double const> eccentricities, std::span<double> hyperbolicAnomalies);
+
+/// <summary> Batched SolveParabolic. Both spans must have the same size. </summary>
+/// <exception cref="ApiException"> Mismatched batch sizes. </exception>
+void SolveParabolic(std::span<double const> meanAnomalies, std::span<double> parabolicAnomalies);
+
+/// <summary> Batched SolveNearParabolic. All spans must have the same size. </summary>
+/// <exception cref="ApiException"> Mismatched batch sizes. </exception>
+template<Method NMethod = Method::Tolerance>
+void SolveNearParabolic(std::span<double const> meanAnomalies, std::span<double const> eccentricities, std::span<double> anomalies);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class KeplerTestScript : public ITestScript
+{
+public:
+	KeplerTestScript();
+	virtual ~KeplerTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Kepler -------------------------------------------------------------------------------------------------------------
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_KEPLER_H
@@ -234,6 +234,112 @@ typedef Period<Granularity::Nanosecond>		Nanoseconds;
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
+/// <summary>
+/// Fixed-step simulation clock. Elapsed real time is accumulated in integer microseconds and consumed in whole ticks of fixed
+/// length, so the simulation time is always an exact multiple of the tick length and does not drift however long the clock runs
+/// (an int64 microsecond count covers 2.9e5 years). The unconsumed remainder places the render time between the last tick and
+/// the next: on-rails state can be evaluated exactly at the render time, so rendering may run at a higher rate than the
+/// simulation ticks.
+/// </summary>
+class SimulationClock
+{
+public:
+	/// <param name="tickLength"> The simulation time step. Must be positive. </param>
+	/// <param name="maxTicksPerAdvance"> Whole ticks beyond this many per advance are dropped, so that a long frame cannot build an ever-growing backlog. </param>
+	SimulationClock(Microseconds tickLength, uint32_t maxTicksPerAdvance);
+
+	/// <summary> Accumulate elapsed real time, and consume it in whole ticks. </summary>
+	/// <param name="elapsed"> The real time elapsed since the last advance. Must not be negative. </param>
+	/// <returns> The number of ticks which have fallen due, which the caller should simulate in turn. </returns>
+	uint32_t Advance(Microseconds elapsed);
+
+	Microseconds GetTickLength() const;
+	uint64_t GetTickCount() const;
+
+	/// <returns> The simulation time of the last tick. </returns>
+	Microseconds GetTime() const;
+
+	/// <returns> The time at which to evaluate state for rendering: the time of the last tick plus the unconsumed remainder. </returns>
+	Microseconds GetRenderTime() const;
+
+	/// <returns> The unconsumed remainder as a fraction of a tick, in [0, 1). </returns>
+	double GetInterpolationFactor() const;
+
+private:
+	int64_t		m_tickLength;
+	uint64_t	m_tickCount;			// Number of ticks consumed.
+	int64_t		m_accumulator;			// Elapsed time not yet consumed by a tick, less than one tick.
+	uint32_t	m_maxTicksPerAdvance;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline SimulationClock::SimulationClock(Microseconds tickLength, uint32_t maxTicksPerAdvance) :
+	m_tickLength(tickLength.Get()),
+	m_tickCount(0),
+	m_accumulator(0),
+	m_maxTicksPerAdvance(maxTicksPerAdvance)
+{
+	assert(0 < m_tickLength);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t SimulationClock::Advance(Microseconds elapsed)
+{
+	assert(0 <= elapsed.Get());
+
+	m_accumulator += elapsed.Get();
+
+	int64_t dueTicks = m_accumulator / m_tickLength;
+
+	if (static_cast<int64_t>(m_maxTicksPerAdvance) < dueTicks)
+		dueTicks = m_maxTicksPerAdvance; // The dropped ticks' time is discarded below with the consumed ticks.
+
+	m_accumulator = std::min(m_accumulator - (dueTicks * m_tickLength), m_accumulator % m_tickLength);
+	m_tickCount += static_cast<uint64_t>(dueTicks);
+
+	return static_cast<uint32_t>(dueTicks);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Microseconds SimulationClock::GetTickLength() const
+{
+	return m_tickLength;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t SimulationClock::GetTickCount() const
+{
+	return m_tickCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Microseconds SimulationClock::GetTime() const
+{
+	return static_cast<int64_t>(m_tickCount) * m_tickLength;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Microseconds SimulationClock::GetRenderTime() const
+{
+	return (static_cast<int64_t>(m_tickCount) * m_tickLength) + m_accumulator;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline double SimulationClock::GetInterpolationFactor() const
+{
+	return static_cast<double>(m_accumulator) / static_cast<double>(m_tickLength);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
 class TimeTestScript : public ITestScript
 {
 public:
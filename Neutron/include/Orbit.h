@@ -3,24 +3,32 @@
 
 #include "NebulaTypes.h"
 #include "ITestScript.h"
+#include "Exception.h"
 #include "Vector3.h"
 #include "NeutronTime.h"
+#include "Kepler.h"
 
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
-/* Forward Declarations */
-class ScalingSpace;
-
 using namespace Nebula;
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-class Orbit
+/// <summary>
+/// Two-body orbit of an orbiter about a primary, with elements and kinetics of scalar type T. Anomalies are always held in double
+/// precision. Orbit (float) is the bulk type, and keeps the SIMD batch path; Orbitd (double) serves high-value orbiters whose
+/// spaces would otherwise need rescaling to stay within float precision.
+/// </summary>
+template<typename T>
+class TOrbit
 {
 	friend class ParticleBase;
 
 public:
+	using Scalar = T;
+	using Vector3T = TVector3<T>;
+
 	enum class Type
 	{
 		Circle,
@@ -42,68 +50,329 @@ public:
 		/// <param name="position"> Initial position of the orbiter relative to the primary. </param>
 		/// <param name="velocity"> Initial velocity of the orbiter relative to the primary. </param>
 		/// <exception cref="ApiException"> Angular momentum evaluted to zero. </exception>
-		void Compute(float gravityParameter, Vector3 const& position, Vector3 const& velocity);
+		void Compute(T gravityParameter, Vector3T const& position, Vector3T const& velocity);
+
+		/// <summary> Compute the orientation angles from the perifocal frame. </summary>
+		void ComputeOrientation();
+
+		/// <param name="position"> Position of the orbiter relative to the primary. </param>
+		/// <returns> The true anomaly (radians) of the given position, measured from the perifocal frame's x-axis. </returns>
+		double ComputeTrueAnomaly(Vector3T const& position) const;
 
-		float				m_angularMomentum			= 0.f;			/// Orbital specific angular momentum
-		float				m_eccentricity				= 0.f;			/// Eccentricity
+		/// <returns> The mean anomaly (radians) corresponding to the given true anomaly on this orbit. </returns>
+		double TrueToMeanAnomaly(double trueAnomaly) const;
+
+		/// <summary>
+		/// Solve Kepler's equation for the true anomaly (radians) corresponding to the given mean anomaly on this orbit. Orbits
+		/// within Kepler::kNearParabolicBand of e = 1 are solved by Kepler::SolveNearParabolic, by the same method.
+		/// </summary>
+		/// <typeparam name="NMethod"> The Kepler equation solution method. </typeparam>
+		template<Kepler::Method NMethod = Kepler::Method::Tolerance>
+		double MeanToTrueAnomaly(double meanAnomaly) const;
 
-		float				m_velocityK					= 0.f;			/// Constant factor of orbital velocity:             mu / h
-		float				m_massK						= 0.f;			/// Constant factor of mean anomaly for e >= 1:      mu^2 / h^3
+		/// <summary> Advance a mean anomaly by the given time. Mean anomalies of closed orbits are wrapped to [0, 2 Pi). </summary>
+		/// <returns> The mean anomaly after time dT. </returns>
+		double PropagateMeanAnomaly(double meanAnomaly, Time::Microseconds dT) const;
+
+		/// <summary> Compute the position and velocity of the orbiter, relative to the primary, at the given true anomaly. </summary>
+		/// <param name="position"> Storage for the computed position. </param>
+		/// <param name="velocity"> Storage for the computed velocity. </param>
+		void ComputeKinetics(double trueAnomaly, Vector3T & position, Vector3T & velocity) const;
+
+		T					m_angularMomentum			= 0;			/// Orbital specific angular momentum
+		T					m_eccentricity				= 0;			/// Eccentricity
+
+		T					m_velocityK					= 0;			/// Constant factor of orbital velocity:             mu / h
+		T					m_massK						= 0;			/// Constant factor of mean anomaly for e >= 1:      mu^2 / h^3
+		T					m_meanMotion				= 0;			/// Rate of change of mean anomaly (n):              mu^2 / h^3 * (e')^(3/2), or mu^2 / h^3 for a parabola
 
 		Type				m_type						= Type::Circle;	/// Type of orbit - defined by eccentricity, indicates the type of shape which describes the orbit path
 
 		/* Dimensions */
-		float				m_semiMajor					= 0.f;
-		float				m_semiMinor					= 0.f;
-		float				m_centreOffset				= 0.f;			/// Signed distance from occupied focus to centre, measured along perifocal frame's x-axis.
+		T					m_semiMajor					= 0;
+		T					m_semiMinor					= 0;
+		T					m_centreOffset				= 0;			/// Signed distance from occupied focus to centre, measured along perifocal frame's x-axis.
 		Time::Microseconds	m_period					= 0;			/// Orbit period, measured in microseconds.
-		float				m_parameter					= 0.f;			/// Orbit parameter, or semi-latus rectum:   h^2 / mu
+		T					m_parameter					= 0;			/// Orbit parameter, or semi-latus rectum:   h^2 / mu
 
 		/* Perifocal frame */
-		Vector3				m_perifocalX				= { 0.f };		/// The direction of the major axis.
-		Vector3				m_perifocalY				= { 0.f };		/// The direction of the minor axis.
-		Vector3				m_perifocalZ				= { 0.f };		/// The direction of the normal.
+		Vector3T			m_perifocalX				= { 0 };		/// The direction of the major axis.
+		Vector3T			m_perifocalY				= { 0 };		/// The direction of the minor axis.
+		Vector3T			m_perifocalZ				= { 0 };		/// The direction of the normal.
 
 		/* Orientation */
-		float				m_inclination				= 0.f;			/// Inclination.
-		Vector3				m_ascendingNodeDirection	= { 0.f };		/// Direction of ascending node.
-		float				m_rightAscension			= 0.f;			/// Right ascension of ascending node.
-		float				m_argumentPeriapsis			= 0.f;			/// Argument of periapsis.
+		T					m_inclination				= 0;			/// Inclination.
+		Vector3T			m_ascendingNodeDirection	= { 0 };		/// Direction of ascending node.
+		T					m_rightAscension			= 0;			/// Right ascension of ascending node.
+		T					m_argumentPeriapsis			= 0;			/// Argument of periapsis.
 
 		//Quaternion m_orientation;										/// Quaternion orientation of the perifocal frame relative to the reference frame.
 	};
 
+	/// <summary>
+	/// One conic section of a patched-conic trajectory: the part of the orbiter's path which lies in a single scaling space.
+	/// The exit is resolved lazily - until it is, m_exitTime and m_trueAnomalyExit are undefined.
+	/// </summary>
 	class Section
 	{
 	public:
 		Section() = default;
 
-		Elements	m_elements;
-		double		m_trueAnomalyEntry	= 0.0;
-		double		m_trueAnomalyExit	= 0.0;
+		/// <summary> Compute the position and velocity of the orbiter, relative to the primary, at the given system time. </summary>
+		/// <typeparam name="NMethod"> The Kepler equation solution method. </typeparam>
+		/// <param name="time"> The system time, which should lie within the section. </param>
+		template<Kepler::Method NMethod = Kepler::Method::Tolerance>
+		void ComputeKinetics(Time::Microseconds time, Vector3T & position, Vector3T & velocity) const;
+
+		Elements			m_elements;
+		Time::Microseconds	m_entryTime			= 0;		// System time at which the orbiter enters the section.
+		Time::Microseconds	m_exitTime			= 0;		// System time at which the orbiter exits the section.
+		double				m_meanAnomalyEntry	= 0.0;
+		double				m_trueAnomalyEntry	= 0.0;
+		double				m_trueAnomalyExit	= 0.0;
+		bool				m_isExitResolved	= false;	// Whether the exit has been computed.
 	};
 
-	Orbit();
+	/// <summary>
+	/// Compute the elements of a batch of orbits about the same primary. Float orbits are processed in SIMD lanes (AVX: 8, SSE: 4)
+	/// with the remainder processed one at a time; results are bit-identical to Elements::Compute regardless of batch position.
+	/// Double orbits are processed one at a time.
+	/// </summary>
+	/// <param name="gravityParameter"> The gravity parameter of the primary. </param>
+	/// <param name="positions"> Positions of the orbiters relative to the primary. </param>
+	/// <param name="velocities"> Velocities of the orbiters relative to the primary. </param>
+	/// <param name="elements"> Storage for the computed elements, one per position/velocity pair. </param>
+	/// <exception cref="ApiException"> Mismatched batch sizes, or angular momentum evaluated to zero. </exception>
+	static void ComputeElements(T gravityParameter, std::span<Vector3T const> positions, std::span<Vector3T const> velocities,
+		std::span<Elements> elements);
+
+	TOrbit();
+	TOrbit(TOrbit const&) = delete;
+	TOrbit(TOrbit &&) noexcept = default;
+
+	TOrbit & operator=(TOrbit const&) = delete;
+	TOrbit & operator=(TOrbit &&) noexcept = default;
+
+	/// <summary>
+	/// Compute the current section's elements and the orbiter's anomalies from the given position and velocity. Discards any
+	/// predicted sections, and the current section's resolved exit.
+	/// </summary>
+	/// <param name="gravityParameter"> The gravity parameter of the primary. </param>
+	/// <param name="position"> Position of the orbiter relative to the primary. </param>
+	/// <param name="velocity"> Velocity of the orbiter relative to the primary. </param>
+	/// <exception cref="ApiException"> Angular momentum evaluted to zero. </exception>
+	void Initialize(T gravityParameter, Vector3T const& position, Vector3T const& velocity);
+
+	/// <summary>
+	/// Initialize the current section from elements already computed, such as by a batched ComputeElements, and compute the
+	/// orbiter's anomalies from the given position. Discards any predicted sections, and the current section's resolved exit.
+	/// </summary>
+	/// <param name="elements"> The elements of the orbit. </param>
+	/// <param name="position"> Position of the orbiter relative to the primary, from which the elements were computed. </param>
+	void Initialize(Elements const& elements, Vector3T const& position);
+
+	/// <summary>
+	/// Initialize the current section from elements already computed, with the orbiter at the given mean anomaly. Discards any
+	/// predicted sections, and the current section's resolved exit.
+	/// </summary>
+	/// <param name="elements"> The elements of the orbit. </param>
+	/// <param name="meanAnomaly"> The mean anomaly of the orbiter. </param>
+	void Initialize(Elements const& elements, double meanAnomaly);
+
+	/// <summary>
+	/// Advance the orbiter along the current section by the given time. Closed-form (on-rails) propagation: the cost is
+	/// independent of dT.
+	/// </summary>
+	/// <typeparam name="NMethod"> The Kepler equation solution method. </typeparam>
+	/// <param name="dT"> The time by which to advance the orbiter. </param>
+	/// <param name="position"> Storage for the new position of the orbiter relative to the primary. </param>
+	/// <param name="velocity"> Storage for the new velocity of the orbiter relative to the primary. </param>
+	template<Kepler::Method NMethod = Kepler::Method::Tolerance>
+	void Propagate(Time::Microseconds dT, Vector3T & position, Vector3T & velocity);
 
 	Section & GetCurrentSection();
+	Section const& GetCurrentSection() const;
+	double GetTrueAnomaly() const;
+	double GetMeanAnomaly() const;
+
+	/// <returns> The number of sections from the current section onwards, including the predicted sections. </returns>
+	size_t GetSectionCount() const;
+
+	/// <param name="index"> The section index relative to the current section, less than GetSectionCount(). </param>
+	Section & GetSection(size_t index);
+	Section const& GetSection(size_t index) const;
+
+	/// <summary> Append a predicted section. Sections which the orbiter has already left are released first. </summary>
+	/// <returns> Reference to the new, default constructed, section. </returns>
+	Section & AppendSection();
+
+	/// <summary> Move the orbiter onto the next (predicted) section, at the section's entry anomaly. </summary>
+	void AdvanceSection();
+
+	/// <summary> Discard the predicted sections after the current section, and the current section's resolved exit. </summary>
+	void DiscardPrediction();
 
 private:
 	using SectionList = std::deque<UniquePtr<Section>>;
 
 	SectionList	m_sections;
-	size_t		m_currentSectionIndex;
+	size_t		m_currentSectionIndex;	// Sections before the current section are released lazily, by AppendSection().
 	double		m_trueAnomaly;
+	double		m_meanAnomaly;
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Orbit::Section & Orbit::GetCurrentSection()
+template<typename T>
+template<Kepler::Method NMethod>
+inline void TOrbit<T>::Propagate(Time::Microseconds dT, Vector3T & position, Vector3T & velocity)
+{
+	Elements const& elements = GetCurrentSection().m_elements;
+
+	m_meanAnomaly = elements.PropagateMeanAnomaly(m_meanAnomaly, dT);
+	m_trueAnomaly = elements.template MeanToTrueAnomaly<NMethod>(m_meanAnomaly);
+
+	elements.ComputeKinetics(m_trueAnomaly, position, velocity);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline TOrbit<T>::Section & TOrbit<T>::GetCurrentSection()
+{
+	assert(m_currentSectionIndex < m_sections.size());
+
+	return *m_sections[m_currentSectionIndex];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline TOrbit<T>::Section const& TOrbit<T>::GetCurrentSection() const
 {
 	assert(m_currentSectionIndex < m_sections.size());
 
 	return *m_sections[m_currentSectionIndex];
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline size_t TOrbit<T>::GetSectionCount() const
+{
+	return m_sections.size() - m_currentSectionIndex;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline TOrbit<T>::Section & TOrbit<T>::GetSection(size_t index)
+{
+	assert(index < GetSectionCount());
+
+	return *m_sections[m_currentSectionIndex + index];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline TOrbit<T>::Section const& TOrbit<T>::GetSection(size_t index) const
+{
+	assert(index < GetSectionCount());
+
+	return *m_sections[m_currentSectionIndex + index];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline void TOrbit<T>::AdvanceSection()
+{
+	assert(1 < GetSectionCount());
+
+	++m_currentSectionIndex;
+
+	Section const& section = GetCurrentSection();
+
+	m_meanAnomaly = section.m_meanAnomalyEntry;
+	m_trueAnomaly = section.m_trueAnomalyEntry;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline double TOrbit<T>::GetTrueAnomaly() const
+{
+	return m_trueAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline double TOrbit<T>::GetMeanAnomaly() const
+{
+	return m_meanAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+template<Kepler::Method NMethod>
+inline void TOrbit<T>::Section::ComputeKinetics(Time::Microseconds time, Vector3T & position, Vector3T & velocity) const
+{
+	double const meanAnomaly = m_elements.PropagateMeanAnomaly(m_meanAnomalyEntry, time - m_entryTime);
+
+	m_elements.ComputeKinetics(m_elements.template MeanToTrueAnomaly<NMethod>(meanAnomaly), position, velocity);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+template<Kepler::Method NMethod>
+inline double TOrbit<T>::Elements::MeanToTrueAnomaly(double meanAnomaly) const
+{
+	double const eccentricity = m_eccentricity;
+
+	switch (m_type)
+	{
+	case Type::Circle:
+		return meanAnomaly;
+
+	case Type::Ellipse:
+	{
+		double const eccentricAnomaly = ((1.0 - eccentricity) < Kepler::kNearParabolicBand) ?
+			Kepler::SolveNearParabolic<NMethod>(meanAnomaly, eccentricity) : Kepler::SolveElliptic<NMethod>(meanAnomaly, eccentricity);
+
+		// True anomaly (v) = 2 * atan(sqrt((1 + e) / (1 - e)) * tan(E / 2)).
+		return 2.0 * atan2(sqrt(1.0 + eccentricity) * sin(0.5 * eccentricAnomaly), sqrt(1.0 - eccentricity) * cos(0.5 * eccentricAnomaly));
+	}
+
+	case Type::Parabola:
+		return 2.0 * atan(Kepler::SolveParabolic(meanAnomaly)); // True anomaly (v) = 2 * atan(D).
+
+	case Type::Hyperbola:
+	{
+		double const hyperbolicAnomaly = ((eccentricity - 1.0) < Kepler::kNearParabolicBand) ?
+			Kepler::SolveNearParabolic<NMethod>(meanAnomaly, eccentricity) : Kepler::SolveHyperbolic<NMethod>(meanAnomaly, eccentricity);
+
+		// True anomaly (v) = 2 * atan(sqrt((e + 1) / (e - 1)) * tanh(F / 2)).
+		return 2.0 * atan(sqrt((eccentricity + 1.0) / (eccentricity - 1.0)) * tanh(0.5 * hyperbolicAnomaly));
+	}
+
+	default:
+		throw Exception(RESULT_CODE_UNRECOGNIZED, "Unrecognized orbit type");
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+using Orbit = TOrbit<float>;
+using Orbitd = TOrbit<double>;
+
+extern template class TOrbit<float>;
+extern template class TOrbit<double>;
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
@@ -8,6 +8,11 @@
 #include "Particle.h"
 #include "ITestScript.h"
 #include "NeutronTime.h"
+#include "PriorityQueue.h"
+#include "ReplayLog.h"
+#include "TaskPool.h"
+
+#include <unordered_map>
 
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
@@ -18,6 +23,8 @@ using namespace Nebula;
 
 class OrbitalSystem
 {
+	friend class OrbitalSystemTestScript;
+
 public:
 	OrbitalSystem(float hostMass, float hostSpaceTrueRadius);
 
@@ -30,8 +37,39 @@ public:
 
 	void Reset(float hostMass, float hostSpaceTrueRadius);
 
+	/// <summary>
+	/// Set the task pool used to update the system in parallel, or nullptr to update on the calling thread.
+	/// The result of an update does not depend on the pool or on its thread count.
+	/// </summary>
+	void SetTaskPool(TaskPool * pTaskPool);
+
+	/// <summary>
+	/// Set the recorder to which every change of a particle's orbit is recorded - creation, recomputation on rescaling, scaling
+	/// space transitions and impulses - or nullptr to stop recording. Recorded events are flushed at the end of each call which
+	/// records them.
+	/// </summary>
+	void SetReplayRecorder(ReplayRecorder * pReplayRecorder);
+
+	/// <summary>
+	/// Advance the system time by the given time step and wake the particles with scheduled events (scaling space boundary
+	/// crossings) which fall due. All other particles stay on their orbits without being touched - use Synchronize() to
+	/// evaluate their states at the current time. A particle crossing into a section of its predicted trajectory simply
+	/// advances onto that section.
+	/// Due events are processed in rounds: the woken particles are propagated independently (in parallel, given a task pool),
+	/// then their boundary crossings are applied. Particles which host scaling spaces are transferred one at a time, in queue
+	/// order, as moving them rescales their attached spaces; the crossings of all other particles are then applied together in
+	/// batches by source and destination space, so transfers between spaces are deterministic.
+	/// </summary>
+	/// <param name="dT"> The time step. </param>
 	void OnUpdate(Time::Microseconds dT);
 
+	/// <summary>
+	/// Propagate every particle in the system to the current system time. Given a task pool, sibling subtrees of the scaling
+	/// space tree are synchronized in parallel, with one task per scaling space and per chunk of its particles.
+	/// </summary>
+	void Synchronize();
+
+	Time::Microseconds GetTime() const;
 	ScalingSpace & GetHostSpace();
 	Particle::ScalingSpaceList const& GetScalingSpaces() const;
 
@@ -48,6 +86,13 @@ public:
 	/// <returns> A pointer to the created particle. </returns>
 	Particle & CreateParticle(float mass, Vector3 position, Vector3 velocity, ScalingSpace & hostSpace);
 
+	/// <summary>
+	/// Change a particle's velocity instantaneously at the current system time, such as by a thruster burn, and recompute its orbit.
+	/// </summary>
+	/// <param name="particle"> The particle. </param>
+	/// <param name="deltaVelocity"> The change in velocity, scaled to the particle's host space. </param>
+	void ApplyImpulse(Particle & particle, Vector3 const& deltaVelocity);
+
 	/// <summary> Create a scaling space attached to the given particle. </summary>
 	/// <param name="radius"> The true radius of the scaling space (in meters). </param>
 	/// <param name="pHostParticle"> Pointer to the host particle. </param>
@@ -56,13 +101,50 @@ public:
 	/// <exception cref="AssertionException"> Radius is too small. </exception>
 	ScalingSpace & CreateScalingSpace(float trueRadius, Particle & hostParticle);
 
+	/// <summary>
+	/// Extend the particle's predicted trajectory: the chain of conic sections (patched conics) which it follows across scaling
+	/// space boundaries, from its current section onwards. Predicted sections are kept until the particle leaves them, so
+	/// repeated queries only pay for sections not yet predicted. Prediction stops at a section entering a non-influencing
+	/// space, whose primary moves relative to the space so that its exit cannot be solved for in closed form.
+	/// Sections are read with particle.GetOrbit().GetSection(index).
+	/// </summary>
+	/// <param name="particle"> The particle. </param>
+	/// <param name="sectionCount"> The number of sections wanted, including the current section. </param>
+	/// <param name="horizon"> Sections entered later than this time from now are not predicted. </param>
+	/// <returns> The number of sections available, which is less than requested if prediction stopped early. </returns>
+	size_t PredictTrajectory(Particle & particle, size_t sectionCount, Time::Microseconds horizon);
+
 private:
+	struct ParticleEvent
+	{
+		Time::Microseconds	m_time = 0;				// System time at which the particle must be updated.
+		Particle *			m_pParticle = nullptr;	// The particle to update.
+		uint32_t			m_eventId = 0;			// The particle's event ID when the event was scheduled.
+	};
+
 	struct ParticleUpdateQueuePredicate
 	{
-		bool operator()(Particle *const& lhs, Particle *const& rhs);
+		bool operator()(ParticleEvent const& lhs, ParticleEvent const& rhs) const;
 	};
 
-	using ParticleUpdateQueue = SortedList<Particle *, ParticleUpdateQueuePredicate>;
+	struct ParticleUpdateQueueEquals
+	{
+		bool operator()(ParticleEvent const& lhs, ParticleEvent const& rhs) const;
+	};
+
+	using ParticleUpdateQueue = PriorityQueue<ParticleEvent, ParticleUpdateQueuePredicate, ParticleUpdateQueueEquals>;
+
+	/// <summary> A particle's scaling space boundary crossing, applied in a batch with the other crossings of an update round. </summary>
+	struct Transition
+	{
+		Particle *		m_pParticle			= nullptr;
+		ScalingSpace *	m_pSourceSpace		= nullptr;	// The space which the particle leaves.
+		ScalingSpace *	m_pSpace			= nullptr;	// The space which the particle enters.
+		Vector3			m_position;						// Position relative/scaled to the space entered, offset by its cached primary kinetics, unless predicted.
+		Vector3			m_velocity;						// Velocity relative/scaled to the space entered, offset by its cached primary kinetics, unless predicted.
+		bool			m_isPredicted		= false;	// Whether the particle enters its next predicted section, rather than having its orbit recomputed.
+		uint32_t		m_groupIndex		= 0;		// Index of the transition's (source space, space) group, in order of first appearance.
+	};
 
 	/// <summary>
 	/// Create a scaling space in the host particle's scaling space list and initialize it's outer/inner scaling space pointers.
@@ -74,23 +156,35 @@ private:
 	/// <summary>
 	/// Initialize an existing scaling space from its true radius and position in its host's scaling space list.
 	/// Computes new radius and whether it is influencing from the true radius and the host's existing space of influence.
+	/// The space's particles which host no scaling spaces are rescaled lazily (see ScalingSpace::Rescale()).
 	/// </summary>
 	/// <param name="scalingSpace"> The scaling space to initialize. </param>
-	static void InitializeScalingSpace(ScalingSpace & scalingSpace);
+	void InitializeScalingSpace(ScalingSpace & scalingSpace);
 
 	/// <summary>
 	/// Recompute the space's radius relative to the outer space, assuming constant true radius.
-	/// If not influencing, recomputes all particle orbits (as primary kinetics are affected by rescaling).
+	/// Recomputes all particle orbits, as their predicted exits lead to the former outer space and, if not influencing, primary
+	/// kinetics are affected by rescaling; lazily for particles which host no scaling spaces.
 	/// </summary>
 	/// <param name="scalingSpace"> The scaling space to rescale. </param>
-	static void RecomputeRadius(ScalingSpace & scalingSpace);
+	void RecomputeRadius(ScalingSpace & scalingSpace);
 
-	/// <summary> Initialize an existing particle in the given scaling space. </summary>
+	/// <summary>
+	/// Transfer the particles of a space's outer space which lie within the space into it, and reschedule the others, whose
+	/// predicted crossings no longer hold. Each particle is tested at its own epoch, relative to the space's host particle.
+	/// </summary>
+	/// <param name="scalingSpace"> The scaling space, initialized, which has an outer space. </param>
+	void CaptureOuterParticles(ScalingSpace & scalingSpace);
+
+	/// <summary>
+	/// Initialize an existing particle in the given scaling space, its own or its host space's outer space, from its rescaled
+	/// state. Reschedules the particle and its attached spaces, whose events depend on it.
+	/// </summary>
 	/// <param name="particle"> The particle to initialize. </param>
 	/// <param name="position"> The particle's new position, relative to the new scaling space. </param>
 	/// <param name="velocity"> The particle's new velocity, relative to the new scaling space. </param>
 	/// <param name="scalingSpace"> The particle's new scaling space. </param>
-	static void InitializeParticle(Particle & particle, Vector3 const& position, Vector3 const& velocity, ScalingSpace & scalingSpace);
+	void InitializeParticle(Particle & particle, Vector3 const& position, Vector3 const& velocity, ScalingSpace & scalingSpace);
 
 	/// <returns> Whether a particle at the given radial distance from the given scaling space should enter the scaling space. </returns>
 
@@ -101,9 +195,189 @@ private:
 	static bool ShouldDescend(float particleRadialDistance, ScalingSpace const& scalingSpace);
 	static bool ShouldAscend(float particleRadialDistance);
 
-	UniquePtr<Particle>		m_pHostParticle;			// The host particle, around which all other particles in the system orbit.
+	/// <summary>
+	/// Propagate the particles in a scaling space to the given time, then recurse into the spaces attached to each particle.
+	/// Host particles are always updated before their attached spaces so the primary kinetics of non-influencing spaces can
+	/// be refreshed first.
+	/// </summary>
+	/// <param name="scalingSpace"> The scaling space to update. </param>
+	/// <param name="time"> The system time to propagate to. </param>
+	static void SynchronizeScalingSpace(ScalingSpace & scalingSpace, Time::Microseconds time);
+
+	/// <summary> Submit a task to synchronize a scaling space, as SynchronizeScalingSpace, with the system's task pool. </summary>
+	/// <param name="taskGroup"> The task group which the scaling space's tasks, and the tasks of its attached spaces, join. </param>
+	/// <param name="scalingSpace"> The scaling space to update. </param>
+	void SubmitSynchronizeScalingSpace(TaskPool::TaskGroup & taskGroup, ScalingSpace & scalingSpace);
+
+	/// <summary> Call function(begin, end) for chunks of [0, count), in parallel if the system has a task pool. </summary>
+	template<typename TFunction>
+	void ForEachChunk(size_t count, TFunction const& function);
+
+	/// <summary>
+	/// Compute an upper bound on the time until a particle in a non-influencing space can reach a boundary, relative to the
+	/// particle's epoch. The primary moves relative to the space's centre, so the crossing cannot be solved for, and the
+	/// particle is re-checked when it wakes.
+	/// </summary>
+	/// <param name="particle"> The particle. </param>
+	/// <param name="delay"> Storage for the time (seconds) until the next event. </param>
+	/// <returns> Whether the particle has an event. </returns>
+	static bool ComputeEventDelay(Particle const& particle, double & delay);
+
+	/// <summary>
+	/// Compute an upper bound on the time until a particle can enter the outermost space attached to another particle in its
+	/// host space, relative to the particle's epoch.
+	/// </summary>
+	/// <param name="particle"> The particle. </param>
+	/// <param name="delay"> Storage for the time (seconds) until the next event. </param>
+	/// <returns> Whether there is another particle with attached spaces in the particle's host space. </returns>
+	static bool ComputeSiblingDelay(Particle const& particle, double & delay);
+
+	/// <summary>
+	/// Compute an upper bound on the time until a particle can enter the outermost space attached to another particle in its
+	/// host space, relative to the particle's epoch.
+	/// </summary>
+	/// <param name="particle"> The particle. </param>
+	/// <param name="localPosition"> The particle's position in its host space at its epoch. </param>
+	/// <param name="speedBound"> The particle's greatest speed on its orbit. </param>
+	/// <param name="hostParticle"> The other particle. </param>
+	/// <returns> The time (seconds) until the particle can enter the other particle's spaces. </returns>
+	static double ComputeHostParticleDelay(Particle const& particle, Vector3 const& localPosition, float speedBound,
+		Particle const& hostParticle);
+
+	/// <returns> The greatest speed on an orbit: the speed at periapsis. </returns>
+	static float ComputeSpeedBound(Orbit::Elements const& elements);
+
+	/// <summary>
+	/// Solve for the next boundary crossing of an orbit in an influencing space. The orbit is exactly a conic about the space's
+	/// centre, so the crossing times of the escape radius and of the inner space's radius are found from the mean anomaly.
+	/// </summary>
+	/// <param name="elements"> The orbit elements, relative to the space's primary. </param>
+	/// <param name="scalingSpace"> The influencing space. </param>
+	/// <param name="meanAnomaly"> The mean anomaly from which to search. </param>
+	/// <param name="delay"> Storage for the time (seconds) until the crossing. </param>
+	/// <param name="pNextSpace"> Storage for the space entered at the crossing. </param>
+	/// <returns> Whether the orbit crosses a boundary. </returns>
+	static bool ComputeCrossingDelay(Orbit::Elements const& elements, ScalingSpace const& scalingSpace, double meanAnomaly,
+		double & delay, ScalingSpace *& pNextSpace);
+
+	/// <returns> The event delay, rounded up to a whole (non-zero) number of microseconds. </returns>
+	static Time::Microseconds RoundEventDelay(double delay);
+
+	/// <summary> Resolve the exit of a section in an influencing space. Sections in non-influencing spaces have no resolvable exit. </summary>
+	/// <param name="index"> The particle's section index relative to its current section: that of the first unresolved exit. </param>
+	static void ResolveSectionExit(Particle & particle, size_t index);
+
+	/// <summary>
+	/// Predict the section following the particle's last predicted section: transform the state at the exit into the next
+	/// space and compute the new conic.
+	/// </summary>
+	/// <returns> Whether a section was appended. </returns>
+	static bool PredictNextSection(Particle & particle);
+
+	/// <summary> Compute a particle's predicted state at the given time, if its trajectory places it in the given space. </summary>
+	/// <param name="position"> Storage for the position, relative/scaled to the space. </param>
+	/// <param name="velocity"> Storage for the velocity, relative/scaled to the space. </param>
+	/// <returns> Whether the state could be predicted. </returns>
+	static bool PredictKinetics(Particle & particle, ScalingSpace const& scalingSpace, Time::Microseconds time, Vector3 & position,
+		Vector3 & velocity);
+
+	/// <summary> Move a particle to another scaling space's particle list, and re-attach its spaces to the new space. </summary>
+	static void MoveParticle(Particle & particle, ScalingSpace & scalingSpace);
+
+	/// <summary> Move a particle to another scaling space and recompute its orbit from the given state. </summary>
+	/// <param name="particle"> The particle to move. </param>
+	/// <param name="scalingSpace"> The particle's new scaling space. </param>
+	/// <param name="position"> The particle's position, relative/scaled to the new scaling space. </param>
+	/// <param name="velocity"> The particle's velocity, relative/scaled to the new scaling space. </param>
+	void TransferParticle(Particle & particle, ScalingSpace & scalingSpace, Vector3 const& position, Vector3 const& velocity);
+
+	/// <summary>
+	/// Whether a particle which has been propagated to the time of its event has crossed onto its next predicted section,
+	/// predicting the section if need be.
+	/// </summary>
+	static bool HasPredictedCrossing(Particle & particle);
+
+	/// <summary> Advance a particle onto its next predicted section, and compute its state there. </summary>
+	static void EnterPredictedSection(Particle & particle);
+
+	/// <summary>
+	/// Detect a particle's scaling space boundary crossing from its state: leaving its space, or entering the space's inner
+	/// space or the outermost space attached to another particle in the space. A resolved exit from an influencing space is
+	/// taken once due, whatever the state.
+	/// </summary>
+	/// <param name="pScalingSpace"> Storage for the space which the particle enters. </param>
+	/// <param name="position"> Storage for the particle's position, relative/scaled to the space entered. </param>
+	/// <param name="velocity"> Storage for the particle's velocity, relative/scaled to the space entered. </param>
+	/// <returns> Whether the particle has crossed a boundary. </returns>
+	static bool DetectCrossing(Particle const& particle, ScalingSpace *& pScalingSpace, Vector3 & position, Vector3 & velocity);
+
+	/// <summary>
+	/// Compute a particle's state at its epoch relative/scaled to its host space, with the primary of a non-influencing space
+	/// where it is at the epoch rather than at the space's cached primary kinetics.
+	/// </summary>
+	static void ComputeLocalKinetics(Particle const& particle, Vector3 & position, Vector3 & velocity);
+
+	/// <summary>
+	/// Handle the boundary crossings of the round's due particles which host no scaling spaces, then schedule their next events.
+	/// Crossings are grouped by source and destination space: the orbits recomputed on entering each space are computed in one
+	/// batch, and each source space's particle list is walked once, with the particles leaving it spliced into their destination
+	/// lists group by group. Every orbit is computed before any particle moves, so a degenerate orbit throws with the system unchanged.
+	/// </summary>
+	void ProcessTransitions();
+
+	/// <summary> Record the particle's orbit, from its state at its epoch, to the replay recorder, if there is one. </summary>
+	void RecordOrbit(ReplayEvent::Type type, Particle const& particle);
+
+	/// <summary> Write the recorded events to the replay log, if there is a recorder. </summary>
+	void FlushReplay();
 
-	ParticleUpdateQueue		m_particleUpdateQueue;		// The particle update queue.
+	/// <summary> Invalidate the particle's scheduled event and schedule its next event, if it has one. </summary>
+	void ScheduleParticle(Particle & particle);
+
+	/// <summary>
+	/// Discard the predicted trajectories of, and schedule, all particles in a scaling space and in the spaces attached to
+	/// those particles.
+	/// </summary>
+	void ScheduleScalingSpace(ScalingSpace & scalingSpace);
+
+	/// <summary>
+	/// Schedule the other particles in the host space of a particle with attached spaces, as when it enters the space or its
+	/// trajectory changes, since their events are bounded by the time until they can enter its spaces. Particles whose events
+	/// already fall within the new bound keep them.
+	/// </summary>
+	void ScheduleSiblings(Particle & hostParticle);
+
+	/// <summary>
+	/// Discard the predicted trajectories of, and schedule, the particles in a scaling space, but not those in the spaces
+	/// attached to them.
+	/// </summary>
+	void ScheduleSpaceParticles(ScalingSpace & scalingSpace);
+
+	/// <summary>
+	/// Handle any scaling space boundary crossing of a particle which has been propagated to the time of its event, then
+	/// schedule its next event. A predicted crossing advances the particle onto its next section; otherwise the crossing is
+	/// detected from the particle's state and its orbit recomputed.
+	/// </summary>
+	void ProcessParticleEvent(Particle & particle);
+
+	UniquePtr<Particle>			m_pHostParticle;			// The host particle, around which all other particles in the system orbit.
+
+	Time::Microseconds			m_time;						// The current system time.
+	ParticleUpdateQueue			m_particleUpdateQueue;		// The particle update queue, ordered by event time.
+	std::vector<ParticleEvent>	m_dueEvents;				// Events processed in the current round of an update.
+
+	// Scratch storage for the batched transitions of an update round.
+	std::vector<Particle *>								m_batchParticles;		// Due particles which host no scaling spaces, in queue order.
+	std::vector<Transition>								m_transitions;			// Their crossings, sorted by group.
+	std::vector<Vector3>								m_transitionPositions;	// Recomputed crossings' positions relative to the primary.
+	std::vector<Vector3>								m_transitionVelocities;	// Recomputed crossings' velocities relative to the primary.
+	std::vector<Orbit::Elements>						m_transitionElements;	// Recomputed crossings' orbit elements.
+	std::vector<std::list<UniquePtr<Particle>>>			m_groupParticles;		// Particles leaving their source space, by group.
+	std::unordered_map<ScalingSpace const*, uint32_t>	m_spaceOrder;			// Order of first appearance of each space in the round.
+	std::unordered_map<Particle const*, uint32_t>		m_particleGroups;		// Group of each particle leaving the source space being walked.
+
+	TaskPool *					m_pTaskPool;				// The pool used to update the system in parallel, or nullptr.
+	ReplayRecorder *			m_pReplayRecorder;			// The recorder of orbit changes, or nullptr.
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -115,9 +389,30 @@ inline float OrbitalSystem::ComputeRadiusOfInfluence(float orbitRadius, float pa
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+inline void OrbitalSystem::SetTaskPool(TaskPool * pTaskPool)
+{
+	m_pTaskPool = pTaskPool;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void OrbitalSystem::SetReplayRecorder(ReplayRecorder * pReplayRecorder)
+{
+	m_pReplayRecorder = pReplayRecorder;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Time::Microseconds OrbitalSystem::GetTime() const
+{
+	return m_time;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 inline ScalingSpace & OrbitalSystem::GetHostSpace()
 {
-	return *m_pHostParticle->GetHostSpace();
+	return **m_pHostParticle->m_attachedSpaces.begin(); // The system host particle has no host space of its own.
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -142,11 +437,37 @@ inline bool OrbitalSystem::ShouldAscend(float particleRadialDistance)
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
+
+inline float OrbitalSystem::ComputeSpeedBound(Orbit::Elements const& elements)
+{
+	// Speed at periapsis = mu / h * (1 + e).
+	return elements.m_velocityK * (1.f + elements.m_eccentricity);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TFunction>
+inline void OrbitalSystem::ForEachChunk(size_t count, TFunction const& function)
+{
+	if ((nullptr == m_pTaskPool) || (count <= kParallelChunkSize))
+		function(0, count);
+	else
+		m_pTaskPool->ParallelFor(count, kParallelChunkSize, function);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline bool OrbitalSystem::ParticleUpdateQueuePredicate::operator()(ParticleEvent const& lhs, ParticleEvent const& rhs) const
+{
+	return lhs.m_time.Get() < rhs.m_time.Get();
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline bool OrbitalSystem::ParticleUpdateQueuePredicate::operator()(Particle *const& lhs, Particle *const& rhs)
+inline bool OrbitalSystem::ParticleUpdateQueueEquals::operator()(ParticleEvent const& lhs, ParticleEvent const& rhs) const
 {
-	assert(false); // TODO !
+	return lhs.m_time == rhs.m_time;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
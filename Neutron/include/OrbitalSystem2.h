@@ -5,14 +5,20 @@
 #include "NebulaTypes.h"
 #include "ParticleBase.h"
 #include "ScaledSpaceBase.h"
+#include "ScaledSpaceTree.h"
+#include "SimulationSnapshot.h"
+#include "TaskPool.h"
 #include "Vector3.h"
 #include "Orbit.h"
+#include "Perturbation.h"
 
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
 using namespace Nebula;
 
+class SnapshotFile;
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
@@ -21,17 +27,27 @@ class OrbitalSystem2
 	friend class ParticleBase;
 	friend class OrbitalSystem2TestScript;
 
+public:
+	/// <summary> Scalar precision of the orbit along which a particle is propagated. </summary>
+	enum class Precision : uint8_t
+	{
+		Single,		// Float orbit: the default, and the only precision of particles held in a particle store.
+		Double,		// Double orbit: for high-value particles, whose float elements would drift from their true orbit.
+	};
+
+private:
 	class HostParticle : public ParticleBase
 	{
 	public:
 		HostParticle(OrbitalSystem2 & orbitalSystem, float hostMass);
 		virtual ~HostParticle() override = default;
 
-		virtual Vector3 const& GetPosition() const override;
-		virtual Vector3 const& GetVelocity() const override;
+		virtual Vector3 GetPosition() const override;
+		virtual Vector3 GetVelocity() const override;
 		virtual bool IsInfluencing() const override;
 		virtual ScaledSpaceBase * GetSpaceOfInfluence() const override;
-		virtual Orbit const* GetOrbit() const override;
+		virtual Orbit::Elements const* GetElements() const override;
+		virtual double GetMeanAnomaly() const override;
 	};
 
 	class InfluencingSpace : public ScaledSpaceBase
@@ -43,8 +59,17 @@ class OrbitalSystem2
 		virtual ParticleBase const* GetPrimary() const override;
 		virtual Vector3 const& GetPrimaryPosition() const override;
 		virtual Vector3 const& GetPrimaryVelocity() const override;
+		virtual uint64_t GetPrimaryKineticsVersion() const override;
+
+	protected:
+		virtual void RefreshPrimaryKinetics() override;
 	};
 
+	/// <summary>
+	/// A space whose primary is not its host particle, so the primary moves relative to the space. The primary kinetics are
+	/// cached, and recomputed from the level above whenever the host particle moves. Spaces are propagated from the host space
+	/// down, so the host particle's space is always refreshed first, and reading the primary kinetics never writes.
+	/// </summary>
 	class NonInfluencingSpace : public ScaledSpaceBase
 	{
 	public:
@@ -56,33 +81,70 @@ class OrbitalSystem2
 		virtual ParticleBase const* GetPrimary() const override;
 		virtual Vector3 const& GetPrimaryPosition() const override;
 		virtual Vector3 const& GetPrimaryVelocity() const override;
+		virtual uint64_t GetPrimaryKineticsVersion() const override;
 
-	private:
-		static ParticleBase * FindPrimary(ScaledSpaceBase const* pScaledSpace);
-		static void ComputePrimaryKinetics(ScaledSpaceBase const* pScaledSpace, Vector3 & position, Vector3 & velocity);
+	protected:
+		virtual void RefreshPrimaryKinetics() override;
 
-		ParticleBase *	m_pPrimary;			// Pointer to the local primary.
-		Vector3			m_primaryPosition;	// Locally scaled position of the primary relative to this space.
-		Vector3			m_primaryVelocity;	// Locally scaled velocity of the primary relative to this space.
+	private:
+		Vector3				m_primaryPosition;			// Locally scaled position of the primary relative to this space.
+		Vector3				m_primaryVelocity;			// Locally scaled velocity of the primary relative to this space.
+		uint64_t			m_primaryKineticsVersion;	// Incremented whenever the primary kinetics are recomputed.
 	};
 
 	class Particle : public ParticleBase
 	{
 	public:
-		Particle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity);
+		Particle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity,
+			Orbit::Elements const& elements);
 		virtual ~Particle() override = default;
 
-		virtual Vector3 const& GetPosition() const override;
-		virtual Vector3 const& GetVelocity() const override;
+		virtual Vector3 GetPosition() const override;
+		virtual Vector3 GetVelocity() const override;
 		virtual bool IsInfluencing() const override;
 		virtual ScaledSpaceBase * GetSpaceOfInfluence() const override;
-		virtual Orbit const* GetOrbit() const override;
+		virtual Orbit::Elements const* GetElements() const override;
+		virtual double GetMeanAnomaly() const override;
+
+		/// <summary>
+		/// Compute the particle's position and velocity at the system time, on its orbit from the host space's epoch: where the
+		/// particle is while its space lags in a lower update tier.
+		/// </summary>
+		void ComputeKinetics(Vector3 & position, Vector3 & velocity) const;
+
+		/// <summary>
+		/// Compute the particle's position and velocity relative to the primary at the host space's epoch, from its orbit: unlike
+		/// GetPosition less the primary position, this holds while the primary has already moved on with the host particle.
+		/// </summary>
+		void ComputeOrbitKinetics(Vector3d & position, Vector3d & velocity) const;
+
+		/// <summary> Set the particle's position and velocity, and recompute its orbit. </summary>
+		/// <param name="position"> The particle position, relative/scaled to the host space. </param>
+		/// <param name="velocity"> The particle velocity, relative/scaled to the host space. </param>
+		void SetKinetics(Vector3 const& position, Vector3 const& velocity);
+
+		/// <summary> Propagate the particle along its orbit, without recomputing the orbit. </summary>
+		/// <param name="dT"> The time step. </param>
+		void Propagate(Time::Microseconds dT);
+
+		bool IsPerturbed() const;
+		void SetPerturbed(bool isPerturbed);
+
+		Precision GetPrecision() const;
+
+		/// <summary> Set the precision of the orbit along which the particle is propagated, recomputing it from the current state. </summary>
+		void SetPrecision(Precision precision);
 
 	protected:
+		virtual void GetEpochState(Vector3 & position, Vector3 & velocity, double & meanAnomaly) const override;
+
 		Vector3				m_position;
 		Vector3				m_velocity;
 
-		UniquePtr<Orbit>	m_pOrbit;
+		UniquePtr<Orbit>	m_pOrbit;		// The particle's orbit. Only its elements are current for a double precision particle.
+		UniquePtr<Orbitd>	m_pOrbitd;		// The orbit along which a double precision particle is propagated, or nullptr.
+
+		bool				m_isPerturbed;	// Whether the particle is propagated by Encke's method rather than on rails.
 	};
 
 	class InfluencingParticle : public Particle
@@ -91,23 +153,88 @@ class OrbitalSystem2
 		using Particle::GetPosition;
 		using Particle::GetVelocity;
 
-		InfluencingParticle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity);
+		InfluencingParticle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity,
+			Orbit::Elements const& elements);
 		virtual ~InfluencingParticle() override = default;
 
 		virtual bool IsInfluencing() const override;
 		virtual ScaledSpaceBase * GetSpaceOfInfluence() const override;
-		virtual Orbit const* GetOrbit() const override;
 
 	private:
 		InfluencingSpace *	m_pSpaceOfInfluence;
 	};
 
+	/// <summary> View of a non-influencing particle whose state is held in its host space's particle store. </summary>
+	class StoredParticle : public ParticleBase
+	{
+	public:
+		StoredParticle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity,
+			Orbit::Elements const& elements);
+		virtual ~StoredParticle() override;
+
+		virtual Vector3 GetPosition() const override;
+		virtual Vector3 GetVelocity() const override;
+		virtual bool IsInfluencing() const override;
+		virtual ScaledSpaceBase * GetSpaceOfInfluence() const override;
+		virtual Orbit::Elements const* GetElements() const override;
+		virtual double GetMeanAnomaly() const override;
+		virtual uint64_t GetGeneration() const override;
+
+		ParticleStore::Handle GetHandle() const;
+
+		/// <summary> Compute the particle's position and velocity at the system time, as Particle::ComputeKinetics. </summary>
+		void ComputeKinetics(Vector3 & position, Vector3 & velocity) const;
+
+	protected:
+		virtual void GetEpochState(Vector3 & position, Vector3 & velocity, double & meanAnomaly) const override;
+
+	private:
+		ParticleStore &			m_particleStore;
+		ParticleStore::Handle	m_handle;
+	};
+
 public:
+	/// <summary> Description of a particle to be created by CreateParticles. </summary>
+	struct ParticleDesc
+	{
+		ScaledSpaceBase *	m_pHostSpace;		// The scaled space in which the particle will be placed.
+		float				m_mass;				// The particle mass (kg).
+		Vector3				m_position;			// The particle initial position, relative/scaled to the host space.
+		Vector3				m_velocity;			// The particle initial velocity, relative/scaled to the host space.
+		bool				m_isInfluencing;	// Whether the particle has a sphere of influence (an influencing scaled space).
+	};
+
+	/// <summary> Observer distances at which spaces drop to lower update tiers, and how often the middle tier is propagated. </summary>
+	struct LevelOfDetail
+	{
+		uint32_t			m_tickInterval	= 8;		// Ticks between propagations of EveryNthTick spaces.
+		float				m_nearDistance	= 4.f;		// Spaces nearer the observer than this are propagated every tick. In radii of the space.
+		float				m_farDistance	= 64.f;		// Spaces farther from the observer than this are propagated on demand. In radii of the space.
+	};
+
+	/// <summary> Choice of a space's update tier, called every tick for every space in place of the observer distance. </summary>
+	using UpdateTierFunction = std::function<ScaledSpaceBase::UpdateTier(ScaledSpaceBase const& space)>;
+
+	/// <summary>
+	/// Restore an orbital system from a snapshot file. Spaces and particles are recreated with their recorded identifiers, and
+	/// the recorded orbit elements are used as they are rather than recomputed.
+	/// </summary>
+	/// <param name="file"> The snapshot file. </param>
+	/// <returns> The restored system. Its snapshots continue from the file's tick. </returns>
+	/// <exception cref="ApiException"> Invalid parameter - the file's spaces cannot be rebuilt from its particles. </exception>
+	static UniquePtr<OrbitalSystem2> Restore(SnapshotFile const& file);
+
 	OrbitalSystem2(float hostMass, float hostSpaceTrueRadius);
 
 	ParticleBase * GetHostParticle();
 	ScaledSpaceBase * GetHostSpace();
 
+	/// <returns> The hierarchy of every scaled space in the system. </returns>
+	ScaledSpaceTree & GetScaledSpaceTree();
+
+	/// <returns> The system time: the sum of the time steps of every update. </returns>
+	Time::Microseconds GetTime() const;
+
 	/// <summary> Create a scaled space. </summary>
 	/// <param name="hostParticle"> The particle to which the new space will be attached. </param>
 	/// <param name="trueRadius"> The true radius (meters). </param>
@@ -123,6 +250,7 @@ public:
 	/// <param name="isInfluencing"> Whether the particle has a sphere of influence (an influencing scaled space). </param>
 	/// <returns> Reference to the created particle. </returns>
 	/// <exception cref="ApiException"> Invalid parameter. </exception>
+	/// <remarks> Non-influencing particles are held in the host space's particle store, if it is enabled. </remarks>
 	ParticleBase * CreateParticle(ScaledSpaceBase & hostSpace, float mass, Vector3 position, Vector3 velocity, bool isInfluencing);
 
 	/// <summary> Create a particle with circular orbit. </summary>
@@ -135,14 +263,176 @@ public:
 	/// <exception cref="ApiException"> Invalid parameter. </exception>
 	ParticleBase * CreateParticle(ScaledSpaceBase & hostSpace, float mass, Vector3 position, bool isInfluencing);
 
+	/// <summary>
+	/// Create a batch of particles. The descriptions are grouped by host space, so that each space's primary is evaluated once
+	/// and the orbits of its particles are computed in one batch. The whole batch is validated, including the radius of influence
+	/// of each influencing particle, and every orbit computed, before any particle store is reserved or particle created, so an
+	/// invalid description leaves the system unchanged.
+	/// </summary>
+	/// <param name="descs"> Descriptions of the particles to create. </param>
+	/// <param name="particles"> Storage for the created particles, in the order of the descriptions. Appended to. </param>
+	/// <exception cref="ApiException"> Invalid parameter. </exception>
+	/// <remarks> Particles with the same host space are added to it in the order of their descriptions. </remarks>
+	void CreateParticles(std::span<ParticleDesc const> descs, std::vector<ParticleBase *> & particles);
+
 	/// <summary> Destroy a particle in this orbital system. </summary>
 	/// <param name="pParticleBase"> Pointer to the particle to be destroyed. </param>
 	void DestroyParticle(ParticleBase * pParticleBase);
 
+	/// <summary>
+	/// Propagate the particles by the given time step, space by space from the host space down. Particles follow their orbits on
+	/// rails, except those set to be perturbed: these are propagated by Encke's method under the gravity of the influencing particles
+	/// which share their host space, in steps no longer than a fraction of the shortest period in the space, and have their orbits
+	/// recomputed from the perturbed state after each.
+	/// Each space's update tier is chosen first, and only the spaces due in their tier are propagated: the rest keep their particles
+	/// at their epoch until a later tick, or until synchronized, propagates them by the whole elapsed time in one step. Their
+	/// getters meanwhile evaluate them on their orbits at the system time. Spaces with perturbed particles are propagated every tick.
+	/// </summary>
+	/// <param name="dT"> The time step. </param>
+	void OnUpdate(Time::Microseconds dT);
+
+	/// <summary>
+	/// Set the observer distances and tick interval of the update tiers. Without an observer or an update tier function, every space
+	/// is propagated every tick.
+	/// </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the tick interval is zero, or the near distance exceeds the far distance. </exception>
+	void SetLevelOfDetail(LevelOfDetail const& levelOfDetail);
+
+	/// <summary> Set the observer, such as the camera, by whose distance from each space the update tiers are chosen. </summary>
+	/// <param name="pSpace"> The space in which the observer is placed, or nullptr for no observer. Must outlive its use as the observer's space. </param>
+	/// <param name="position"> The observer position, relative/scaled to the space. </param>
+	void SetObserver(ScaledSpaceBase const* pSpace, Vector3 const& position);
+
+	/// <summary> Set a function to choose each space's update tier in place of the observer distance, or an empty function for none. </summary>
+	void SetUpdateTierFunction(UpdateTierFunction updateTierFunction);
+
+	/// <summary>
+	/// Set the task pool used to update the system in parallel, or nullptr to update on the calling thread. Each space is
+	/// propagated once its outer space has been, sibling spaces concurrently, and the particles on rails of a large space in
+	/// chunks. The result of an update does not depend on the pool or on its thread count.
+	/// </summary>
+	void SetTaskPool(TaskPool * pTaskPool);
+
+	/// <summary>
+	/// Propagate a space's particles, and those of its outer spaces, to the system time if they lag behind it in a lower update
+	/// tier. Reading a lagging particle evaluates its orbit each time: synchronize a space before reading many of its particles.
+	/// </summary>
+	void Synchronize(ScaledSpaceBase & space);
+
+	/// <summary>
+	/// Set whether a particle is perturbed by the influencing particles which share its host space. The host space is synchronized,
+	/// and is propagated every tick while it has perturbed particles.
+	/// </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the particle is the host particle, or is held in a particle store. </exception>
+	void SetPerturbed(ParticleBase & particle, bool isPerturbed);
+
+	/// <returns> Whether a particle is perturbed by the influencing particles which share its host space. </returns>
+	bool IsPerturbed(ParticleBase const& particle) const;
+
+	/// <summary>
+	/// Set the precision of the orbit along which a particle is propagated. The particle's position and velocity remain single
+	/// precision, as do the elements read through ParticleBase::GetElements.
+	/// </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the particle is the host particle, or is held in a particle store. </exception>
+	void SetPrecision(ParticleBase & particle, Precision precision);
+
+	/// <returns> The precision of the orbit along which a particle is propagated. Single for particles held in a particle store. </returns>
+	Precision GetPrecision(ParticleBase const& particle) const;
+
+	/// <summary>
+	/// Copy the state of every space and particle into the snapshot back buffer, and publish it to readers. Call from the
+	/// simulation thread once a tick's updates are complete. The snapshot is taken at the system time, from which readers may
+	/// evaluate particle states at later times.
+	/// </summary>
+	void PublishSnapshot();
+
+	/// <returns> The most recently published snapshot, or nullptr if none has been published. Safe to call from any thread. </returns>
+	SnapshotBuffer::SnapshotPtr AcquireSnapshot() const;
+
 private:
+	/// <summary> Check that a position lies within its host space and outside the host space's inner space. </summary>
+	/// <param name="pInnerSpace"> The host space's inner space, or nullptr. </param>
+	/// <exception cref="ApiException"> Invalid parameter. </exception>
+	static void ValidateParticlePosition(Vector3 const& position, ScaledSpaceBase const* pInnerSpace);
+
+	/// <summary> Check that an influencing particle's radius of influence is a valid scaled space radius within its host space. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the orbit is unbound, or the radius is out of range. </exception>
+	static void ValidateRadiusOfInfluence(float mass, float primaryMass, Orbit::Elements const& elements);
+
+	/// <returns> The particle as an individually held particle, or nullptr if it is the host particle or held in a particle store. </returns>
+	static Particle * AsIndividualParticle(ParticleBase const& particle);
+
+	/// <summary> Scratch storage for propagating a space's perturbed particles, kept between ticks. </summary>
+	struct PropagationScratch
+	{
+		std::vector<Perturbation::Perturber>	m_perturbers;
+		std::vector<Integrator::Bodyd>			m_perturbedBodies;
+		std::vector<uint32_t>					m_excludedPerturbers;
+		std::vector<Particle *>					m_perturbedParticles;
+	};
+
 	ScaledSpaceBase * CreateScaledSpaceImpl(ParticleBase * pHostParticle, float trueRadius, bool isInfluencing);
 
-	UniquePtr<HostParticle>	m_pHostParticle;	// Pointer to the interface of the host particle around which all other particles in the system orbit.
+	/// <summary> Create a particle from elements already computed. The caller rebuilds the space hierarchy if the particle is influencing. </summary>
+	ParticleBase * CreateParticleImpl(ScaledSpaceBase & hostSpace, float mass, Vector3 const& position, Vector3 const& velocity,
+		bool isInfluencing, Orbit::Elements const& elements);
+
+	/// <summary>
+	/// Choose every space's update tier, from the update tier function or the observer distance, or every tick for a space with
+	/// perturbed particles. A space is then raised to the highest tier of its inner spaces, as their primary kinetics are read from
+	/// the particles of their outer spaces.
+	/// </summary>
+	void UpdateTiers();
+
+	/// <returns> Whether a space's particles lag behind the system time, in a lower update tier. </returns>
+	bool IsLagging(ScaledSpaceBase const& space) const;
+
+	/// <summary>
+	/// Compute the kinetics of a space's primary relative to the space at the system time. The cached primary kinetics are current
+	/// unless the space's host particle lags, in which case they are evaluated from the host particle's orbit.
+	/// </summary>
+	void ComputePrimaryKinetics(ScaledSpaceBase const& space, Vector3 & position, Vector3 & velocity) const;
+
+	/// <returns> Whether a space is propagated in the current tick, in its update tier. </returns>
+	static bool IsDue(ScaledSpaceBase const& space, bool isNthTick);
+
+	/// <summary> Propagate a space's particles from the space's epoch to the system time. Its outer spaces must be up to date. </summary>
+	/// <param name="scratch"> Scratch storage for the space's perturbed particles, used by one space at a time. </param>
+	void PropagateSpace(ScaledSpaceBase & space, PropagationScratch & scratch);
+
+	/// <summary> Submit a task to propagate a space if it is due, then to submit the tasks of its child spaces. </summary>
+	/// <param name="taskGroup"> The task group which the space's tasks, and the tasks of its child spaces, join. </param>
+	/// <param name="nodeIndex"> The index of the space's node in the space hierarchy. </param>
+	void SubmitPropagateSpace(TaskPool::TaskGroup & taskGroup, uint32_t nodeIndex, bool isNthTick);
+
+	/// <summary> Propagate a space and its lagging outer spaces, outermost first, without refreshing the space origins. </summary>
+	void PropagateLaggingSpaces(ScaledSpaceBase & space);
+
+	// Particles and spaces are allocated from per-type pools. The pools are declared first so that they outlive the host particle,
+	// which owns every other particle and space in the system.
+	ObjectPool<Particle>			m_particlePool;
+	ObjectPool<InfluencingParticle>	m_influencingParticlePool;
+	ObjectPool<StoredParticle>		m_storedParticlePool;
+	ObjectPool<InfluencingSpace>	m_influencingSpacePool;
+	ObjectPool<NonInfluencingSpace>	m_nonInfluencingSpacePool;
+
+	ScaledSpaceTree					m_scaledSpaceTree;	// Declared before the host particle, as every space invalidates it on destruction.
+
+	UniquePtr<HostParticle>			m_pHostParticle;	// Pointer to the interface of the host particle around which all other particles in the system orbit.
+
+	SnapshotBuffer					m_snapshotBuffer;	// Published state for concurrent readers.
+	uint64_t						m_snapshotTick;		// Number of snapshots published.
+
+	Time::Microseconds				m_time;				// System time: the sum of the time steps of every update.
+	uint64_t						m_tickCount;		// Number of updates.
+
+	LevelOfDetail					m_levelOfDetail;
+	UpdateTierFunction				m_updateTierFunction;
+	ScaledSpaceBase const*			m_pObserverSpace;	// Space of the observer, or nullptr for none.
+	Vector3							m_observerPosition;	// Relative/scaled to the observer's space.
+
+	TaskPool *						m_pTaskPool;		// The pool used to update the system in parallel, or nullptr.
+	PropagationScratch				m_propagationScratch;	// Scratch storage of the spaces propagated on the calling thread.
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -160,16 +450,51 @@ inline ScaledSpaceBase * OrbitalSystem2::GetHostSpace()
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
+
+inline ScaledSpaceTree & OrbitalSystem2::GetScaledSpaceTree()
+{
+	return m_scaledSpaceTree;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Time::Microseconds OrbitalSystem2::GetTime() const
+{
+	return m_time;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline SnapshotBuffer::SnapshotPtr OrbitalSystem2::AcquireSnapshot() const
+{
+	return m_snapshotBuffer.Acquire();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void OrbitalSystem2::SetTaskPool(TaskPool * pTaskPool)
+{
+	m_pTaskPool = pTaskPool;
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Vector3 const& OrbitalSystem2::HostParticle::GetPosition() const
+inline bool OrbitalSystem2::IsLagging(ScaledSpaceBase const& space) const
+{
+	return !(m_time == space.m_epoch);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Vector3 OrbitalSystem2::HostParticle::GetPosition() const
 {
 	return Vector3::Zero();
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Vector3 const& OrbitalSystem2::HostParticle::GetVelocity() const
+inline Vector3 OrbitalSystem2::HostParticle::GetVelocity() const
 {
 	return Vector3::Zero();
 }
@@ -190,11 +515,18 @@ inline ScaledSpaceBase * OrbitalSystem2::HostParticle::GetSpaceOfInfluence() con
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Orbit const* OrbitalSystem2::HostParticle::GetOrbit() const
+inline Orbit::Elements const* OrbitalSystem2::HostParticle::GetElements() const
 {
 	return nullptr;
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline double OrbitalSystem2::HostParticle::GetMeanAnomaly() const
+{
+	return 0.0;
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
@@ -224,12 +556,27 @@ inline Vector3 const& OrbitalSystem2::InfluencingSpace::GetPrimaryVelocity() con
 	return Vector3::Zero();
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t OrbitalSystem2::InfluencingSpace::GetPrimaryKineticsVersion() const
+{
+	return 0; // The primary is the host particle, at the centre of the space.
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void OrbitalSystem2::InfluencingSpace::RefreshPrimaryKinetics()
+{
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
 inline OrbitalSystem2::NonInfluencingSpace::NonInfluencingSpace(ParticleBase * pHostParticle, float trueRadius) :
 	ScaledSpaceBase(pHostParticle, trueRadius),
-	m_pPrimary(FindPrimary(this))
+	m_primaryPosition(Vector3::Zero()),
+	m_primaryVelocity(Vector3::Zero()),
+	m_primaryKineticsVersion(0)
 {
 }
 
@@ -239,7 +586,7 @@ inline void OrbitalSystem2::NonInfluencingSpace::Initialize(float radius)
 {
 	ScaledSpaceBase::Initialize(radius);
 
-	ComputePrimaryKinetics(this, m_primaryPosition, m_primaryVelocity);
+	RefreshPrimaryKinetics(); // The true radius, and so the scaling of the host chain, may have changed.
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -253,7 +600,7 @@ inline bool OrbitalSystem2::NonInfluencingSpace::IsInfluencing() const
 
 inline ParticleBase const* OrbitalSystem2::NonInfluencingSpace::GetPrimary() const
 {
-	return m_pPrimary;
+	return m_spaceTree.GetPrimary(*this);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -272,83 +619,109 @@ inline Vector3 const& OrbitalSystem2::NonInfluencingSpace::GetPrimaryVelocity()
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline ParticleBase * OrbitalSystem2::NonInfluencingSpace::FindPrimary(ScaledSpaceBase const* pScaledSpace)
+inline uint64_t OrbitalSystem2::NonInfluencingSpace::GetPrimaryKineticsVersion() const
 {
-	ParticleBase * pHostParticle = pScaledSpace->GetHostParticle();
+	return m_primaryKineticsVersion;
+}
 
-	while ((nullptr != pScaledSpace) && !pScaledSpace->IsInfluencing());
-	{
-		assert(nullptr != pHostParticle);
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void OrbitalSystem2::NonInfluencingSpace::RefreshPrimaryKinetics()
+{
+	ScaledSpaceBase const*const pHostSpace = m_pHostParticle->GetHostSpace();
+	assert(nullptr != pHostSpace); // The system host's spaces are all influencing.
 
-		pScaledSpace = pHostParticle->GetHostSpace();
+	// The primary's state relative to this space is its state relative to the host particle's space, less the host particle's
+	// state, rescaled to this space.
+	float const scaleFactor = m_spaceTree.GetScale(*pHostSpace, *this);
 
-		pHostParticle = pScaledSpace->GetHostParticle();
-	}
+	m_primaryPosition = (pHostSpace->GetPrimaryPosition() - m_pHostParticle->GetPosition()) * scaleFactor;
+	m_primaryVelocity = (pHostSpace->GetPrimaryVelocity() - m_pHostParticle->GetVelocity()) * scaleFactor;
 
-	return pHostParticle;
+	++m_primaryKineticsVersion;
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline void OrbitalSystem2::NonInfluencingSpace::ComputePrimaryKinetics(ScaledSpaceBase const* pScaledSpace, Vector3 & position,
-	Vector3 & velocity)
+inline Vector3 OrbitalSystem2::Particle::GetPosition() const
 {
-	assert(nullptr != pScaledSpace);
+	if (!m_orbitalSystem.IsLagging(*m_pHostSpace))
+		return m_position;
 
-	position = 0.f;
-	velocity = 0.f;
+	Vector3 position, velocity;
+	ComputeKinetics(position, velocity);
 
-	float scaleFactor = 1.f;
-	ParticleBase const* pHostParticle = pScaledSpace->GetHostParticle();
+	return position;
+}
 
-	while (!pScaledSpace->IsInfluencing())
-	{
-		ParticleBase const* pHostParticle = pScaledSpace->m_pHostParticle;
-		ScaledSpaceBase const* pHostSpace = pHostParticle->m_pHostSpace;
+// --------------------------------------------------------------------------------------------------------------------------------
 
-		scaleFactor *= (pHostSpace->m_trueRadius / pScaledSpace->m_trueRadius);
+inline Vector3 OrbitalSystem2::Particle::GetVelocity() const
+{
+	if (!m_orbitalSystem.IsLagging(*m_pHostSpace))
+		return m_velocity;
 
-		position -= pHostParticle->GetPosition() * scaleFactor;
-		velocity -= pHostParticle->GetVelocity() * scaleFactor;
+	Vector3 position, velocity;
+	ComputeKinetics(position, velocity);
 
-		pScaledSpace = pHostSpace;
-	}
+	return velocity;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
+
+inline bool OrbitalSystem2::Particle::IsInfluencing() const
+{
+	return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline ScaledSpaceBase * OrbitalSystem2::Particle::GetSpaceOfInfluence() const
+{
+	return nullptr;
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Vector3 const& OrbitalSystem2::Particle::GetPosition() const
+inline Orbit::Elements const* OrbitalSystem2::Particle::GetElements() const
 {
-	return m_position;
+	return &m_pOrbit->GetCurrentSection().m_elements;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Vector3 const& OrbitalSystem2::Particle::GetVelocity() const
+inline double OrbitalSystem2::Particle::GetMeanAnomaly() const
 {
-	return m_velocity;
+	if (!m_orbitalSystem.IsLagging(*m_pHostSpace))
+		return (nullptr == m_pOrbitd) ? m_pOrbit->GetMeanAnomaly() : m_pOrbitd->GetMeanAnomaly();
+
+	Time::Microseconds const dT = m_orbitalSystem.m_time - m_pHostSpace->m_epoch;
+
+	return (nullptr == m_pOrbitd) ?
+		m_pOrbit->GetCurrentSection().m_elements.PropagateMeanAnomaly(m_pOrbit->GetMeanAnomaly(), dT) :
+		m_pOrbitd->GetCurrentSection().m_elements.PropagateMeanAnomaly(m_pOrbitd->GetMeanAnomaly(), dT);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline bool OrbitalSystem2::Particle::IsInfluencing() const
+inline bool OrbitalSystem2::Particle::IsPerturbed() const
 {
-	return false;
+	return m_isPerturbed;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline ScaledSpaceBase * OrbitalSystem2::Particle::GetSpaceOfInfluence() const
+inline void OrbitalSystem2::Particle::SetPerturbed(bool isPerturbed)
 {
-	return nullptr;
+	m_isPerturbed = isPerturbed;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Orbit const* OrbitalSystem2::Particle::GetOrbit() const
+inline OrbitalSystem2::Precision OrbitalSystem2::Particle::GetPrecision() const
 {
-	return m_pOrbit.get();
+	return (nullptr == m_pOrbitd) ? Precision::Single : Precision::Double;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -366,11 +739,79 @@ inline ScaledSpaceBase * OrbitalSystem2::InfluencingParticle::GetSpaceOfInfluenc
 	return m_pSpaceOfInfluence;
 }
 
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Vector3 OrbitalSystem2::StoredParticle::GetPosition() const
+{
+	if (!m_orbitalSystem.IsLagging(*m_pHostSpace))
+		return m_particleStore.GetPosition(m_handle);
+
+	Vector3 position, velocity;
+	ComputeKinetics(position, velocity);
+
+	return position;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Vector3 OrbitalSystem2::StoredParticle::GetVelocity() const
+{
+	if (!m_orbitalSystem.IsLagging(*m_pHostSpace))
+		return m_particleStore.GetVelocity(m_handle);
+
+	Vector3 position, velocity;
+	ComputeKinetics(position, velocity);
+
+	return velocity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline bool OrbitalSystem2::StoredParticle::IsInfluencing() const
+{
+	return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline ScaledSpaceBase * OrbitalSystem2::StoredParticle::GetSpaceOfInfluence() const
+{
+	return nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Orbit::Elements const* OrbitalSystem2::StoredParticle::GetElements() const
+{
+	return &m_particleStore.GetElements(m_handle);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline double OrbitalSystem2::StoredParticle::GetMeanAnomaly() const
+{
+	double const meanAnomaly = m_particleStore.GetMeanAnomaly(m_handle);
+
+	if (!m_orbitalSystem.IsLagging(*m_pHostSpace))
+		return meanAnomaly;
+
+	return m_particleStore.GetElements(m_handle).PropagateMeanAnomaly(meanAnomaly, m_orbitalSystem.m_time - m_pHostSpace->m_epoch);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t OrbitalSystem2::StoredParticle::GetGeneration() const
+{
+	return m_particleStore.GetGeneration(); // Per store rather than per particle - conservative for spaces attached to stored particles.
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
-inline Orbit const* OrbitalSystem2::InfluencingParticle::GetOrbit() const
+inline ParticleStore::Handle OrbitalSystem2::StoredParticle::GetHandle() const
 {
-	return m_pOrbit.get();
+	return m_handle;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -23,6 +23,7 @@ class Particle
 {
 	friend class OrbitalSystem;
 	friend class ParticleTestScript;
+	friend class OrbitalSystemTestScript;
 
 	struct ScalingSpaceListPredicate
 	{
@@ -59,12 +60,77 @@ public:
 		Vector3		m_localVelocity;		// Velocity relative/scaled to the host space.
 	};
 
-	Particle(State const& state, ScalingSpace * pHostSpace);
+	Particle(State const& state, ScalingSpace * pHostSpace, Time::Microseconds epoch);
 	Particle(float mass, float hostSpaceTrueRadius);
 
+	/// <summary> Set the particle's state and host space, and restart its trajectory from the current section at its epoch. </summary>
 	void Set(Vector3 const& position, Vector3 const& velocity, ScalingSpace * pHostSpace);
 
+	/// <summary> Set the particle's state and host space, with orbit elements already computed from the state, such as in a batch. </summary>
+	/// <param name="elements"> The orbit elements, relative to the host space's primary. </param>
+	void Set(Vector3 const& position, Vector3 const& velocity, ScalingSpace * pHostSpace, Orbit::Elements const& elements);
+
+	/// <returns> Whether the host space has been rescaled since the particle's state was set. </returns>
+	bool IsRescalePending() const;
+
+	/// <returns> The factor by which the host space has been rescaled since the particle's state was set. </returns>
+	float ComputePendingRescale() const;
+
+	/// <summary>
+	/// Apply the host space's rescales recorded since the particle's state was set: rescale the state, and restart the
+	/// trajectory at the particle's epoch from the rescaled state.
+	/// </summary>
+	void ApplyRescale();
+
+	/// <summary> Record the resolved exit of the last section whose exit is unresolved. </summary>
+	/// <param name="pNextSpace"> The space entered on exit, or nullptr if the section never exits. </param>
+	void ResolveSectionExit(ScalingSpace * pNextSpace);
+
+	/// <summary> Discard the predicted sections after the current section, and the current section's resolved exit. </summary>
+	void DiscardPrediction();
+
+	/// <summary> Move the particle's trajectory onto its next (predicted) section. The state is not updated. </summary>
+	void AdvanceSection();
+
+	/// <summary>
+	/// Advance the particle along its orbit (conic section) by the given time, relative to the host space's primary, applying
+	/// any pending rescale of the host space first.
+	/// The cost is independent of the time step as the position is evaluated analytically from the orbit elements.
+	/// </summary>
+	/// <param name="dT"> The time step. </param>
+	void Propagate(Time::Microseconds dT);
+
+	/// <summary>
+	/// Evaluate the particle's state at the given system time, from its epoch, without advancing it. Used to render the particle
+	/// between simulation ticks. The state is evaluated on the current section: a boundary crossing falling due before the given
+	/// time is not applied until the system is updated. A pending rescale of the host space is accounted for, and the primary
+	/// of a non-influencing host space is placed where it is at the given time.
+	/// </summary>
+	/// <param name="time"> The system time. </param>
+	/// <param name="position"> Storage for the position, relative/scaled to the host space. </param>
+	/// <param name="velocity"> Storage for the velocity, relative/scaled to the host space. </param>
+	void ComputeKinetics(Time::Microseconds time, Vector3 & position, Vector3 & velocity) const;
+
+	/// <summary> Evaluate the particle's state relative to the host space's primary at the given system time, as ComputeKinetics(). </summary>
+	/// <param name="time"> The system time. </param>
+	/// <param name="positionFromPrimary"> Storage for the position, relative to the primary and scaled to the host space. </param>
+	/// <param name="velocityFromPrimary"> Storage for the velocity, relative to the primary and scaled to the host space. </param>
+	void ComputeOrbitKinetics(Time::Microseconds time, Vector3 & positionFromPrimary, Vector3 & velocityFromPrimary) const;
+
+	/// <returns> The system time at which the particle's state was last evaluated. </returns>
+	Time::Microseconds GetEpoch() const;
+
 	State const& GetState() const;
+	Orbit const& GetOrbit() const;
+
+	/// <param name="index"> The section index relative to the current section, less than GetOrbit().GetSectionCount(). </param>
+	/// <returns> The scaling space in which the section of the particle's trajectory lies. </returns>
+	ScalingSpace * GetSectionSpace(size_t index) const;
+
+	/// <param name="index"> The section index relative to the current section, less than GetOrbit().GetSectionCount(). </param>
+	/// <returns> The scaling space which the particle enters on exiting the section, or nullptr if the section's exit is unresolved or it never exits. </returns>
+	ScalingSpace * GetSectionNextSpace(size_t index) const;
+
 	ScalingSpace * GetHostSpace();
 	ScalingSpace * GetSpaceOfInfluence();
 	ScalingSpaceList const& GetScalingSpaceList() const;
@@ -73,7 +139,14 @@ public:
 
 private:
 	State								m_state;						// Physical state of the particle.
-	UniquePtr<Orbit::Elements>			m_pElements;					// Pointer to the orbit elements.
+	Orbit								m_orbit;						// The particle's trajectory: the current and predicted conic sections.
+	Time::Microseconds					m_epoch;						// System time at which the state and mean anomaly are valid.
+	std::deque<ScalingSpace *>			m_nextSpaces;					// The space entered on exiting each section from the current section, for the sections with resolved exits.
+	uint32_t							m_eventId;						// ID of the particle's latest scheduled event - queued events with any other ID are stale.
+	Time::Microseconds					m_eventTime;					// System time of the particle's latest scheduled event, or the greatest time if it has none.
+	float								m_scale;						// The host space's scale when the state was set.
+	uint32_t							m_scaleGeneration;				// The host space's scale generation when the state was set.
+	bool								m_isRescaled;					// Whether a rescale has been applied since the system last recorded the orbit.
 
 	ScalingSpace *						m_pHostSpace;					// Pointer to the scaling space in which this particle is moving, or the orbital system's host space if this particle is the system host particle.
 	ScalingSpaceList					m_attachedSpaces;				// List of pointers to scaling spaces attached to this particle.
@@ -88,6 +161,43 @@ inline Particle::State const& Particle::GetState() const
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+inline bool Particle::IsRescalePending() const
+{
+	return (nullptr != m_pHostSpace) && (m_pHostSpace->GetScaleGeneration() != m_scaleGeneration);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline float Particle::ComputePendingRescale() const
+{
+	return IsRescalePending() ? (m_pHostSpace->GetScale() / m_scale) : 1.f;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Orbit const& Particle::GetOrbit() const
+{
+	return m_orbit;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline ScalingSpace * Particle::GetSectionSpace(size_t index) const
+{
+	assert(index < m_orbit.GetSectionCount());
+
+	return (0 == index) ? m_pHostSpace : m_nextSpaces[index - 1];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline ScalingSpace * Particle::GetSectionNextSpace(size_t index) const
+{
+	return (index < m_nextSpaces.size()) ? m_nextSpaces[index] : nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 inline ScalingSpace * Particle::GetHostSpace()
 {
 	return m_pHostSpace;
@@ -95,6 +205,13 @@ inline ScalingSpace * Particle::GetHostSpace()
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+inline Time::Microseconds Particle::GetEpoch() const
+{
+	return m_epoch;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 inline ScalingSpace * Particle::GetSpaceOfInfluence()
 {
 	ScalingSpace * pSpaceOfInfluence = nullptr;
@@ -2,6 +2,7 @@
 #define NEUTRON_I_PARTICLE_H
 
 #include "NebulaTypes.h"
+#include "Orbit.h"
 #include "ScaledSpaceList.h"
 #include "Vector3.h"
 #include "Uuid.h"
@@ -12,6 +13,8 @@ namespace Neutron // -----------------------------------------------------------
 using namespace Nebula;
 using namespace Nova;
 
+class OrbitalSystem2;
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
@@ -30,17 +33,45 @@ public:
 	ScaledSpaceList & GetAttachedSpaces();
 	float GetMass() const;
 
-	virtual Vector3 const& GetPosition() const = 0;
-	virtual Vector3 const& GetVelocity() const = 0;
+	virtual Vector3 GetPosition() const = 0;
+	virtual Vector3 GetVelocity() const = 0;
 	virtual bool IsInfluencing() const = 0;
 	virtual ScaledSpaceBase * GetSpaceOfInfluence() const = 0;
-	virtual class Orbit const* GetOrbit() const = 0;
+
+	/// <returns> The elements of the particle's orbit about its space's primary, or nullptr if the particle has no orbit. </returns>
+	virtual Orbit::Elements const* GetElements() const = 0;
+
+	/// <returns> The particle's mean anomaly on its orbit. Undefined if the particle has no orbit. </returns>
+	virtual double GetMeanAnomaly() const = 0;
+
+	/// <returns> The particle's generation, which changes whenever its position or velocity changes. </returns>
+	virtual uint64_t GetGeneration() const;
 
 	Uuid									m_uuid;
 
 protected:
+	/// <summary>
+	/// Attach a new scaled space to the particle. The space hierarchy is invalidated, and must be rebuilt once the new space and
+	/// any others created with it are in place.
+	/// </summary>
 	template<typename TScaledSpace>
-	TScaledSpace * EmplaceScaledSpace(float trueRadius);
+	TScaledSpace * EmplaceScaledSpace(ObjectPool<TScaledSpace> & scaledSpacePool, float trueRadius);
+
+	/// <summary>
+	/// Read the particle's state as last propagated, at its host space's epoch, where the getters evaluate it at the system time
+	/// if the space lags behind it in a lower update tier.
+	/// </summary>
+	/// <param name="meanAnomaly"> Storage for the mean anomaly. Undefined if the particle has no orbit. </param>
+	virtual void GetEpochState(Vector3 & position, Vector3 & velocity, double & meanAnomaly) const;
+
+	/// <summary> List the particle among its host space's host particles once its first space is attached, and invalidate the space hierarchy. </summary>
+	void OnSpaceAttached();
+
+	/// <summary>
+	/// Advance the particle's generation, and refresh the primary kinetics of the spaces attached to it. Must be called whenever
+	/// the particle's position or velocity changes.
+	/// </summary>
+	void OnKineticsChanged();
 
 	OrbitalSystem2 &						m_orbitalSystem;				// Reference to the orbital system.
 
@@ -48,6 +79,7 @@ protected:
 	ScaledSpaceList							m_attachedSpaces;				// List of pointers to scaling spaces attached to this particle.
 
 	float									m_mass;							// The particle mass.
+	uint64_t								m_generation;					// Incremented whenever the position or velocity changes.
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -85,12 +117,24 @@ inline float ParticleBase::GetMass() const
 	return m_mass;
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t ParticleBase::GetGeneration() const
+{
+	return m_generation;
+}
+
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
 template<typename TScaledSpace>
-inline TScaledSpace * ParticleBase::EmplaceScaledSpace(float trueRadius)
+inline TScaledSpace * ParticleBase::EmplaceScaledSpace(ObjectPool<TScaledSpace> & scaledSpacePool, float trueRadius)
 {
-	return static_cast<TScaledSpace *>(m_attachedSpaces.Emplace<TScaledSpace>(this, trueRadius)->get());
+	TScaledSpace *const pScaledSpace = static_cast<TScaledSpace *>(m_attachedSpaces.Emplace(scaledSpacePool, this, trueRadius)->get());
+
+	OnSpaceAttached();
+
+	return pScaledSpace;
 }
 
 } // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,298 @@
+#ifndef NEUTRON_PARTICLE_STORE_H
+#define NEUTRON_PARTICLE_STORE_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "Vector3.h"
+#include "Orbit.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Structure-of-arrays storage for the state of the particles in a scaled space. Each component of the particles' positions and
+/// velocities, their masses, orbit elements and mean anomalies are stored in separate contiguous arrays, so that bulk updates stream
+/// through memory instead of chasing one heap allocation per particle.
+/// Particles are identified by stable handles: removing a particle moves the last particle into the vacated slot, so array
+/// indices are not stable and must be looked up from the handle.
+/// </summary>
+class ParticleStore
+{
+	friend class ParticleStoreTestScript;
+
+public:
+	using Handle = uint32_t;
+
+	static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+	ParticleStore() = default;
+
+	/// <summary> Add a particle to the store. The particle's orbit is left uninitialized until set by SetOrbit. </summary>
+	/// <param name="mass"> The particle mass. </param>
+	/// <param name="position"> The particle position, relative/scaled to the space. </param>
+	/// <param name="velocity"> The particle velocity, relative/scaled to the space. </param>
+	/// <returns> The handle of the new particle. </returns>
+	Handle Add(float mass, Vector3 const& position, Vector3 const& velocity);
+
+	/// <summary> Remove a particle from the store. Invalidates the array index of the last particle. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the handle does not refer to a particle in the store. </exception>
+	void Remove(Handle handle);
+
+	/// <summary> Reserve storage for the given total number of particles, so that adding a batch does not reallocate per particle. </summary>
+	void Reserve(size_t count);
+
+	/// <summary> Advance every particle in the store along its orbit. </summary>
+	/// <param name="dT"> The time step. </param>
+	/// <param name="primaryPosition"> The position of the space's primary, relative/scaled to the space. </param>
+	/// <param name="primaryVelocity"> The velocity of the space's primary, relative/scaled to the space. </param>
+	void Propagate(Time::Microseconds dT, Vector3 const& primaryPosition, Vector3 const& primaryVelocity);
+
+	/// <returns> The store's generation, which changes whenever the position or velocity of any particle in the store changes. </returns>
+	uint64_t GetGeneration() const;
+
+	size_t Size() const;
+	bool Empty() const;
+	bool Contains(Handle handle) const;
+
+	/// <returns> The current array index of the particle with the given handle. </returns>
+	size_t GetIndex(Handle handle) const;
+
+	float GetMass(Handle handle) const;
+	Vector3 GetPosition(Handle handle) const;
+	Vector3 GetVelocity(Handle handle) const;
+	Orbit::Elements const& GetElements(Handle handle) const;
+	double GetMeanAnomaly(Handle handle) const;
+
+	void SetPosition(Handle handle, Vector3 const& position);
+	void SetVelocity(Handle handle, Vector3 const& velocity);
+
+	/// <summary> Set the orbit along which the particle is propagated. </summary>
+	/// <param name="elements"> The elements of the orbit about the space's primary. </param>
+	/// <param name="meanAnomaly"> The particle's current mean anomaly on the orbit. </param>
+	void SetOrbit(Handle handle, Orbit::Elements const& elements, double meanAnomaly);
+
+	// Contiguous arrays, indexed by array index.
+	std::span<float const> GetPositionsX() const;
+	std::span<float const> GetPositionsY() const;
+	std::span<float const> GetPositionsZ() const;
+	std::span<float const> GetVelocitiesX() const;
+	std::span<float const> GetVelocitiesY() const;
+	std::span<float const> GetVelocitiesZ() const;
+	std::span<float const> GetMasses() const;
+	std::span<Orbit::Elements const> GetElements() const;
+	std::span<double const> GetMeanAnomalies() const;
+
+private:
+	std::vector<float>		m_positionX;
+	std::vector<float>		m_positionY;
+	std::vector<float>		m_positionZ;
+	std::vector<float>		m_velocityX;
+	std::vector<float>		m_velocityY;
+	std::vector<float>		m_velocityZ;
+	std::vector<float>		m_mass;
+
+	std::vector<Orbit::Elements>	m_elements;			// Elements of each particle's orbit about the space's primary.
+	std::vector<double>				m_meanAnomalies;	// Mean anomaly of each particle on its orbit.
+
+	std::vector<Handle>		m_indexToHandle;		// Handle of the particle stored at each array index.
+	std::vector<uint32_t>	m_handleToIndex;		// Array index of the particle with each handle, or kInvalidIndex if the handle is free.
+	std::vector<Handle>		m_freeHandles;			// Handles released by removed particles, available for reuse.
+
+	uint64_t				m_generation = 0;		// Incremented whenever a position or velocity changes.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t ParticleStore::GetGeneration() const
+{
+	return m_generation;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline size_t ParticleStore::Size() const
+{
+	return m_mass.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline bool ParticleStore::Empty() const
+{
+	return m_mass.empty();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline bool ParticleStore::Contains(Handle handle) const
+{
+	return (handle < m_handleToIndex.size()) && (kInvalidIndex != m_handleToIndex[handle]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline size_t ParticleStore::GetIndex(Handle handle) const
+{
+	assert(Contains(handle));
+
+	return m_handleToIndex[handle];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline float ParticleStore::GetMass(Handle handle) const
+{
+	return m_mass[GetIndex(handle)];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Vector3 ParticleStore::GetPosition(Handle handle) const
+{
+	size_t const index = GetIndex(handle);
+
+	return Vector3(m_positionX[index], m_positionY[index], m_positionZ[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Vector3 ParticleStore::GetVelocity(Handle handle) const
+{
+	size_t const index = GetIndex(handle);
+
+	return Vector3(m_velocityX[index], m_velocityY[index], m_velocityZ[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Orbit::Elements const& ParticleStore::GetElements(Handle handle) const
+{
+	return m_elements[GetIndex(handle)];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline double ParticleStore::GetMeanAnomaly(Handle handle) const
+{
+	return m_meanAnomalies[GetIndex(handle)];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void ParticleStore::SetPosition(Handle handle, Vector3 const& position)
+{
+	size_t const index = GetIndex(handle);
+
+	++m_generation;
+
+	m_positionX[index] = position.X();
+	m_positionY[index] = position.Y();
+	m_positionZ[index] = position.Z();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void ParticleStore::SetVelocity(Handle handle, Vector3 const& velocity)
+{
+	size_t const index = GetIndex(handle);
+
+	++m_generation;
+
+	m_velocityX[index] = velocity.X();
+	m_velocityY[index] = velocity.Y();
+	m_velocityZ[index] = velocity.Z();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void ParticleStore::SetOrbit(Handle handle, Orbit::Elements const& elements, double meanAnomaly)
+{
+	size_t const index = GetIndex(handle);
+
+	m_elements[index] = elements;
+	m_meanAnomalies[index] = meanAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetPositionsX() const
+{
+	return m_positionX;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetPositionsY() const
+{
+	return m_positionY;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetPositionsZ() const
+{
+	return m_positionZ;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetVelocitiesX() const
+{
+	return m_velocityX;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetVelocitiesY() const
+{
+	return m_velocityY;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetVelocitiesZ() const
+{
+	return m_velocityZ;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> ParticleStore::GetMasses() const
+{
+	return m_mass;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<Orbit::Elements const> ParticleStore::GetElements() const
+{
+	return m_elements;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<double const> ParticleStore::GetMeanAnomalies() const
+{
+	return m_meanAnomalies;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class ParticleStoreTestScript : public ITestScript
+{
+public:
+	ParticleStoreTestScript();
+	virtual ~ParticleStoreTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_PARTICLE_STORE_H
@@ -0,0 +1,101 @@
+#ifndef NEUTRON_PERTURBATION_H
+#define NEUTRON_PERTURBATION_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "Integrator.h"
+#include "NeutronTime.h"
+#include "Orbit.h"
+#include "Vector3.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Third-body perturbation of two-body orbits. Perturbed bodies are integrated by the integrator, relative to their reference
+/// conics (Encke's method), under the perturbing acceleration supplied here as its acceleration function: the attraction of the
+/// perturbers, which follow their own conics about the same primary.
+/// All vectors are relative to the primary, in the units of the bodies' scaled space, and are evaluated in double precision.
+/// </summary>
+namespace Perturbation // ---------------------------------------------------------------------------------------------------------
+{
+
+constexpr uint32_t	kNoPerturber			= std::numeric_limits<uint32_t>::max();
+constexpr uint32_t	kDefaultSubstepCount	= 8;			// Integration steps per propagation step.
+constexpr double	kMaximumStepFraction	= 1.0 / 32.0;	// Longest propagation step, between rectifications, as a fraction of the shortest period.
+
+/// <summary> A body whose gravity perturbs the bodies about the same primary. </summary>
+struct Perturber
+{
+	Orbitd::Elements	m_elements;				// The perturber's orbit about the primary.
+	double				m_meanAnomaly;			// The perturber's mean anomaly at the start of the step.
+	double				m_gravityParameter;		// The perturber's gravity parameter, scaled to the space.
+};
+
+/// <summary>
+/// Compute the perturbing acceleration of a body: the attraction of each perturber on the body, less its attraction on the
+/// primary (the indirect term), as the primary's frame is accelerated by the perturbers too.
+/// </summary>
+/// <param name="position"> The body's position. </param>
+/// <param name="perturbers"> The perturbers. </param>
+/// <param name="perturberPositions"> The perturbers' positions, one per perturber. </param>
+/// <param name="excludedPerturber"> The index of a perturber to skip, such as the body itself, or kNoPerturber. </param>
+Vector3d ComputeAcceleration(Vector3d const& position, std::span<Perturber const> perturbers, std::span<Vector3d const> perturberPositions,
+	uint32_t excludedPerturber = kNoPerturber);
+
+/// <summary> Compute the perturbers' positions on their conics at the given time. </summary>
+/// <param name="time"> Time since the start of the step (seconds). </param>
+/// <param name="positions"> Storage for the positions, one per perturber. </param>
+void ComputePositions(std::span<Perturber const> perturbers, double time, std::span<Vector3d> positions);
+
+/// <summary>
+/// Make the integrator's acceleration function for a batch of perturbed bodies. The perturbers' positions are evaluated once for
+/// all the acceleration evaluations at the same time. The perturbers and exclusions must outlive the function.
+/// </summary>
+/// <param name="perturbers"> The perturbers, at the start of the integration. </param>
+/// <param name="excludedPerturbers"> For each body, the index of the perturber which is the body itself, or kNoPerturber. </param>
+Integrator::TAccelerationFunction<double> MakeAccelerationFunction(std::span<Perturber const> perturbers,
+	std::span<uint32_t const> excludedPerturbers);
+
+/// <returns>
+/// The longest step by which the given bodies should be propagated before they are rectified: kMaximumStepFraction of the shortest
+/// period among them. An unbound conic's period is taken to be that of a circular orbit at its periapsis.
+/// </returns>
+/// <param name="gravityParameter"> The gravity parameter of the primary. </param>
+Time::Microseconds ComputeMaximumStep(double gravityParameter, std::span<Perturber const> perturbers,
+	std::span<Integrator::Bodyd const> bodies);
+
+/// <summary>
+/// Rectify a batch of bodies after a propagation step: each body's reference conic is recomputed from its state at the end of the
+/// step. The perturbers are advanced along their conics to the end of the step, and a perturber which is also a body takes the
+/// body's rectified conic.
+/// </summary>
+/// <param name="gravityParameter"> The gravity parameter of the primary. </param>
+/// <param name="perturbers"> The perturbers, which are advanced. </param>
+/// <param name="bodies"> The bodies, integrated by the step, whose reference conics are recomputed. </param>
+/// <param name="excludedPerturbers"> For each body, the index of the perturber which is the body itself, or kNoPerturber. </param>
+/// <param name="dT"> The time step by which the bodies were integrated. </param>
+void Rectify(double gravityParameter, std::span<Perturber> perturbers, std::span<Integrator::Bodyd> bodies,
+	std::span<uint32_t const> excludedPerturbers, Time::Microseconds dT);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class PerturbationTestScript : public ITestScript
+{
+public:
+	PerturbationTestScript();
+	virtual ~PerturbationTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Perturbation -------------------------------------------------------------------------------------------------------
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_PERTURBATION_H
@@ -0,0 +1,222 @@
+#ifndef NEUTRON_REPLAY_LOG_H
+#define NEUTRON_REPLAY_LOG_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "NeutronTime.h"
+#include "Orbit.h"
+#include "Uuid.h"
+#include "Vector3.h"
+
+#include <unordered_map>
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// An event which changes a particle's orbit, as recorded in a replay log. The particle's state is recorded relative to its
+/// host space's primary, together with the primary's gravity parameter, so that the orbit can be recomputed from the event
+/// alone. Between events the particle is on rails, and its state at any time follows analytically from the last event.
+/// </summary>
+struct ReplayEvent
+{
+	enum class Type : uint8_t
+	{
+		Creation,		// The particle was created.
+		Recompute,		// The particle's orbit was recomputed from its state, as its space was rescaled.
+		Transition,		// The particle moved into another scaling space.
+		Impulse,		// The particle's velocity was changed.
+		Count
+	};
+
+	Type				m_type				= Type::Creation;
+	Time::Microseconds	m_time				= 0;			// System time of the event.
+	Uuid				m_particleUuid		= Uuid(0);
+	Uuid				m_spaceUuid			= Uuid(0);		// The particle's host space after the event.
+	float				m_mass				= 0.f;			// The particle's mass, written with the particle's first event only.
+	float				m_gravityParameter	= 0.f;			// Gravity parameter of the host space's primary.
+	Vector3				m_position;							// Relative to the host space's primary, scaled to the host space.
+	Vector3				m_velocity;							// Relative to the host space's primary, scaled to the host space.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Append-only writer of a replay log. Events are buffered, then written in time order on each flush, so the events of an update
+/// may be recorded in any order. Records are delta-compressed: times are written as variable-length deltas from the previous
+/// event, and particles and spaces as variable-length indices into tables built up by the log itself, so a UUID (and a particle's
+/// mass) is written once, on its first appearance. A space's gravity parameter is only written when it changes. A typical event
+/// takes about 30 bytes, and only events which change an orbit are recorded.
+/// </summary>
+class ReplayRecorder
+{
+public:
+	static constexpr uint32_t	kMagic					= 0x4C50524E;	// "NRPL", little-endian.
+	static constexpr uint32_t	kVersion				= 1;
+	static constexpr uint8_t	kTypeMask				= 0x7F;		// Bits of a record's type byte holding the event type.
+	static constexpr uint8_t	kGravityParameterFlag	= 0x80;		// Set in a record's type byte if the record holds a gravity parameter.
+
+	/// <summary> Start a log, writing its header. </summary>
+	/// <param name="stream"> The binary output stream, which must outlive the recorder. </param>
+	/// <exception cref="ApiException"> Failure - the header could not be written. </exception>
+	explicit ReplayRecorder(std::ostream & stream);
+	~ReplayRecorder();
+
+	ReplayRecorder(ReplayRecorder const&) = delete;
+	ReplayRecorder & operator=(ReplayRecorder const&) = delete;
+
+	/// <summary> Buffer an event, to be written on the next flush. </summary>
+	void Record(ReplayEvent const& event);
+
+	/// <summary> Write the buffered events in time order. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - an event precedes the last event written. Failure - the stream failed. </exception>
+	void Flush();
+
+	/// <returns> The number of events written. </returns>
+	uint64_t GetEventCount() const;
+
+private:
+	void WriteVarint(uint64_t value);
+
+	template<typename T>
+	void WriteValue(T const& value);
+
+	std::ostream &							m_stream;
+	std::vector<ReplayEvent>				m_pendingEvents;		// Recorded since the last flush.
+	std::string								m_buffer;				// Encoded records, written to the stream on flush.
+
+	std::unordered_map<uint64_t, uint64_t>	m_particleIndices;		// Log index of each particle UUID written.
+	std::unordered_map<uint64_t, uint64_t>	m_spaceIndices;			// Log index of each space UUID written.
+	std::vector<float>						m_gravityParameters;	// Gravity parameter last written for each space, by log index.
+	Time::Microseconds						m_time;					// Time of the last event written.
+	uint64_t								m_eventCount;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t ReplayRecorder::GetEventCount() const
+{
+	return m_eventCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Sequential reader of a replay log. A record torn by an interrupted write, such as at the end of the log of a crashed
+/// simulation, ends the log.
+/// </summary>
+class ReplayReader
+{
+public:
+	/// <summary> Start reading a log, reading and checking its header. </summary>
+	/// <param name="stream"> The binary input stream, which must outlive the reader. </param>
+	/// <exception cref="ApiException"> Unrecognized - the stream is not a replay log of this version. </exception>
+	explicit ReplayReader(std::istream & stream);
+
+	ReplayReader(ReplayReader const&) = delete;
+	ReplayReader & operator=(ReplayReader const&) = delete;
+
+	/// <summary> Read the next event. The event's mass is always filled in, from the particle's first event. </summary>
+	/// <returns> Whether an event was read, or false at the end of the log. </returns>
+	/// <exception cref="ApiException"> Unrecognized - the log is corrupt. </exception>
+	bool Read(ReplayEvent & event);
+
+private:
+	bool ReadVarint(uint64_t & value);
+
+	template<typename T>
+	bool ReadValue(T & value);
+
+	std::istream &			m_stream;
+
+	std::vector<uint64_t>	m_particleUuids;		// UUID of each particle, by log index.
+	std::vector<float>		m_particleMasses;		// Mass of each particle, by log index.
+	std::vector<uint64_t>	m_spaceUuids;			// UUID of each space, by log index.
+	std::vector<float>		m_gravityParameters;	// Latest gravity parameter of each space, by log index.
+	Time::Microseconds		m_time;					// Time of the last event read.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Reconstruction of a recorded system at any time, by replaying its log through the analytic propagator. Each particle's orbit
+/// is recomputed from its latest event, and its state at the playback time propagated from the event in closed form, just as
+/// the system propagated it. Playback runs forward only: start a new playback to go back.
+/// </summary>
+class ReplayPlayback
+{
+public:
+	struct ParticleOrbit
+	{
+		Uuid				m_spaceUuid		= Uuid(0);	// The particle's host space.
+		float				m_mass			= 0.f;
+		Orbit::Elements		m_elements;					// Relative to the host space's primary.
+		double				m_meanAnomaly	= 0.0;		// Mean anomaly at the time of the particle's latest event.
+		Time::Microseconds	m_time			= 0;		// Time of the particle's latest event.
+	};
+
+	/// <param name="stream"> The replay log, which must outlive the playback. </param>
+	/// <exception cref="ApiException"> Unrecognized - the stream is not a replay log of this version. </exception>
+	explicit ReplayPlayback(std::istream & stream);
+
+	/// <summary> Apply every event up to and including the given time, and move the playback time to it. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the time precedes the playback time. Unrecognized - the log is corrupt. </exception>
+	void AdvanceTo(Time::Microseconds time);
+
+	Time::Microseconds GetTime() const;
+	size_t GetParticleCount() const;
+
+	/// <returns> The particle's orbit as of its latest event, or nullptr if the particle has not been created by the playback time. </returns>
+	ParticleOrbit const* FindParticle(Uuid const& particleUuid) const;
+
+	/// <summary> Compute a particle's state at the playback time. </summary>
+	/// <param name="position"> Storage for the position, relative to the host space's primary and scaled to the host space. </param>
+	/// <param name="velocity"> Storage for the velocity, relative to the host space's primary and scaled to the host space. </param>
+	/// <returns> Whether the particle exists at the playback time. </returns>
+	bool ComputeKinetics(Uuid const& particleUuid, Vector3 & position, Vector3 & velocity) const;
+
+private:
+	void Apply(ReplayEvent const& event);
+
+	ReplayReader									m_reader;
+	ReplayEvent										m_nextEvent;		// The first event not yet applied, if m_hasNextEvent.
+	bool											m_hasNextEvent;
+
+	std::unordered_map<uint64_t, ParticleOrbit>		m_particles;
+	Time::Microseconds								m_time;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Time::Microseconds ReplayPlayback::GetTime() const
+{
+	return m_time;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline size_t ReplayPlayback::GetParticleCount() const
+{
+	return m_particles.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class ReplayLogTestScript : public ITestScript
+{
+public:
+	ReplayLogTestScript();
+	virtual ~ReplayLogTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_REPLAY_LOG_H
@@ -4,18 +4,33 @@
 #include "Vector3.h"
 #include "Constants.h"
 #include "Uuid.h"
+#include "ParticleStore.h"
+#include "ObjectPool.h"
+#include "ScaledSpaceTree.h"
+#include "SpatialHashGrid.h"
 
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
+using namespace Nova;
+
 class ScaledSpaceBase
 {
 	friend class OrbitalSystem2;
 	friend class ParticleBase;
-	friend class ScaledSpaceList;
+	friend class ScaledSpaceTree;
 
 public:
-	using ParticleList = std::list<UniquePtr<ParticleBase>>;
+	using ParticleList = std::list<PoolPtr<ParticleBase>>;
+
+	/// <summary> How often OrbitalSystem2::OnUpdate propagates the particles of a space. </summary>
+	enum class UpdateTier : uint8_t
+	{
+		EveryTick,		// Propagated every tick.
+		EveryNthTick,	// Propagated every Nth tick, by the time elapsed since the last propagation.
+		OnDemand,		// Propagated only when synchronized, by OrbitalSystem2::Synchronize.
+		Count
+	};
 
 	/// <summary> Compute the scaled gravitational parameter of a primary with given mass. </summary>
 	/// <param name="trueRadius"> The true radius of the scaled space whose gravitational parameter is being computed. </param>
@@ -24,7 +39,7 @@ public:
 	static float ComputeScaledGravityParameter(float trueRadius, float primaryMass);
 
 	ScaledSpaceBase(ParticleBase * pHostParticle, float trueRadius);
-	virtual ~ScaledSpaceBase() = default;
+	virtual ~ScaledSpaceBase();
 
 	virtual void Initialize(float radius);
 
@@ -37,6 +52,11 @@ public:
 	float GetRadius() const;
 	float GetGravityParameter() const;
 
+	UpdateTier GetUpdateTier() const;
+
+	/// <returns> The system time to which the particles have been propagated, behind the system time in the lower update tiers. </returns>
+	Time::Microseconds GetEpoch() const;
+
 	float CircularOrbitSpeed(float orbitRadius) const;
 
 	/// <summary> Modify the radius. Re-intializes the scaled space with the new radius. </summary>
@@ -44,24 +64,65 @@ public:
 	/// <exception cref="ApiException"> Invalid parameter or state. </exception>
 	void SetRadius(float radius);
 
+	/// <summary>
+	/// Store the state of non-influencing particles subsequently created in this space in contiguous arrays (structure of
+	/// arrays) rather than in individually allocated particle objects. The particles remain accessible through ParticleBase.
+	/// </summary>
+	/// <exception cref="ApiException"> Invalid state - the space already contains particles. </exception>
+	void EnableParticleStore();
+
+	/// <returns> The space's particle store, or nullptr if particles are stored individually. </returns>
+	ParticleStore * GetParticleStore() const;
+
+	/// <summary>
+	/// Index the particles in this space in a uniform hash grid, for range, nearest-neighbour and pairwise proximity queries. The
+	/// index is updated as particles are created, destroyed or moved. Re-enabling the index rebuilds it with the new cell size.
+	/// </summary>
+	/// <param name="cellSize"> The cell size, relative to the space. Should be of the order of the typical query distance. </param>
+	/// <exception cref="ApiException"> Invalid parameter - the cell size is not positive. </exception>
+	void EnableSpatialIndex(float cellSize);
+
+	/// <returns> The space's spatial index, or nullptr if not enabled. </returns>
+	/// <remarks> Positions of particles in the particle store are re-read if the store has changed since the last call. </remarks>
+	SpatialHashGrid<ParticleBase *> * GetSpatialIndex();
+
 	virtual bool IsInfluencing() const = 0;
 	virtual ParticleBase const* GetPrimary() const = 0;
 	virtual Vector3 const& GetPrimaryPosition() const = 0;
 	virtual Vector3 const& GetPrimaryVelocity() const = 0;
 
+	/// <returns> The version of the primary position and velocity, which changes whenever either of them changes. </returns>
+	virtual uint64_t GetPrimaryKineticsVersion() const = 0;
+
 	Uuid				m_uuid;
 
 protected:
+	/// <summary>
+	/// Recompute the primary kinetics, if cached, from the host particle and the host particle's space. Called whenever the host
+	/// particle moves, so that the primary kinetics are only ever written by the thread moving the particles.
+	/// </summary>
+	virtual void RefreshPrimaryKinetics() = 0;
+
 	ParticleBase *		m_pHostParticle;
 	ParticleList		m_particles;
 
+	std::vector<ParticleBase *>	m_hostParticles;	// The particles in this space which host scaled spaces, in order of their first space.
+
+	ScaledSpaceTree &	m_spaceTree;			// The orbital system's space hierarchy, which links this space to its outer and inner spaces.
+	uint32_t			m_treeIndex;			// Index of this space's node in the hierarchy, valid while the hierarchy is.
+
 	float				m_trueRadius;			// Radius in meters.
 	float				m_radius;				// Radius relative to superior scaling space.
 	float				m_gravityParameter;		// Locally scaled gravitational parameter = M * G / r^3 | G = gravitational constant, M = mass of local primary, r = true radius.
 
-private:
-	ScaledSpaceBase *	m_pOuterSpace;
-	ScaledSpaceBase *	m_pInnerSpace;
+	UpdateTier			m_updateTier;			// How often the particles are propagated, chosen by the orbital system every tick.
+	Time::Microseconds	m_epoch;				// System time to which the particles have been propagated.
+	uint32_t			m_perturbedParticleCount;	// Number of perturbed particles, which keep the space in the every-tick tier.
+
+	UniquePtr<ParticleStore>	m_pParticleStore;	// Structure-of-arrays storage for particle states, or nullptr if not enabled.
+
+	UniquePtr<SpatialHashGrid<ParticleBase *>>	m_pSpatialIndex;				// Proximity index of the particles, or nullptr if not enabled.
+	uint64_t									m_spatialIndexStoreGeneration;	// Particle store generation when the index was last synchronized.
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -90,14 +151,14 @@ inline ScaledSpaceBase::ParticleList const& ScaledSpaceBase::GetParticleList() c
 
 inline ScaledSpaceBase * ScaledSpaceBase::GetOuterSpace() const
 {
-	return m_pOuterSpace;
+	return m_spaceTree.GetOuterSpace(*this);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
 inline ScaledSpaceBase * ScaledSpaceBase::GetInnerSpace() const
 {
-	return m_pInnerSpace;
+	return m_spaceTree.GetInnerSpace(*this);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -123,6 +184,27 @@ inline float ScaledSpaceBase::GetGravityParameter() const
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+inline ScaledSpaceBase::UpdateTier ScaledSpaceBase::GetUpdateTier() const
+{
+	return m_updateTier;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Time::Microseconds ScaledSpaceBase::GetEpoch() const
+{
+	return m_epoch;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline ParticleStore * ScaledSpaceBase::GetParticleStore() const
+{
+	return m_pParticleStore.get();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 inline float ScaledSpaceBase::CircularOrbitSpeed(float orbitRadius) const
 {
 	// Magnitude of velocity of a circular orbit = sqrt(gravity parameter / orbit radius).
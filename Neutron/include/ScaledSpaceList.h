@@ -3,6 +3,7 @@
 
 #include "NebulaTypes.h"
 #include "SortedList.h"
+#include "ObjectPool.h"
 
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
@@ -18,15 +19,15 @@ class ScaledSpaceBase;
 
 struct ScaledSpaceListPredicate
 {
-	bool operator()(UniquePtr<ScaledSpaceBase> const& lhs, UniquePtr<ScaledSpaceBase> const& rhs);
+	bool operator()(PoolPtr<ScaledSpaceBase> const& lhs, PoolPtr<ScaledSpaceBase> const& rhs);
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-class ScaledSpaceList : public SortedList<UniquePtr<ScaledSpaceBase>, ScaledSpaceListPredicate>
+class ScaledSpaceList : public SortedList<PoolPtr<ScaledSpaceBase>, ScaledSpaceListPredicate>
 {
-	using Base = SortedList<UniquePtr<ScaledSpaceBase>, ScaledSpaceListPredicate>;
+	using Base = SortedList<PoolPtr<ScaledSpaceBase>, ScaledSpaceListPredicate>;
 
 public:
 	using iterator = Base::iterator;
@@ -45,14 +46,12 @@ public:
 	ScaledSpaceBase & Back();
 	ScaledSpaceBase const& Back() const;
 
+	/// <summary> Allocate a scaled space from the given pool and insert it in order of decreasing true radius. </summary>
 	template<typename TScaledSpace>
-	iterator Emplace(ParticleBase * pHostParticle, float trueRadius);
+	iterator Emplace(ObjectPool<TScaledSpace> & scaledSpacePool, ParticleBase * pHostParticle, float trueRadius);
 
 	iterator FindSpaceOfInfluence();
 	const_iterator FindSpaceOfInfluence() const;
-
-private:
-	void InitializeInnerOuter(iterator newScaledSpaceIter);
 };
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -94,13 +93,10 @@ inline ScaledSpaceBase const& ScaledSpaceList::Back() const
 // --------------------------------------------------------------------------------------------------------------------------------
 
 template<typename TScaledSpace>
-inline ScaledSpaceList::iterator ScaledSpaceList::Emplace(ParticleBase * pHostParticle, float trueRadius)
+inline ScaledSpaceList::iterator ScaledSpaceList::Emplace(ObjectPool<TScaledSpace> & scaledSpacePool, ParticleBase * pHostParticle,
+	float trueRadius)
 {
-	iterator newScaledSpaceIter = Base::Emplace(std::move(MakeUnique<TScaledSpace>(pHostParticle, trueRadius)));
-
-	InitializeInnerOuter(newScaledSpaceIter);
-
-	return newScaledSpaceIter;
+	return Base::Emplace(scaledSpacePool.Make(pHostParticle, trueRadius));
 }
 
 } // namespace Neutron ------------------------------------------------------------------------------------------------------------
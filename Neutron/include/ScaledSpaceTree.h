@@ -0,0 +1,146 @@
+#ifndef NEUTRON_SCALED_SPACE_TREE_H
+#define NEUTRON_SCALED_SPACE_TREE_H
+
+#include "NebulaTypes.h"
+#include "ScaledSpaceList.h"
+#include "Vector3.h"
+#include "ITestScript.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+class ParticleBase;
+class ScaledSpaceBase;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Flat hierarchy of the scaled spaces in an orbital system, stored contiguously in depth-first order. The parent of a space is its
+/// outer space; its children are its inner space (always the first child) followed by the outermost spaces attached to the
+/// particles it contains. A parent always precedes its children and every subtree is a contiguous range, so root-ward walks are
+/// backward scans of one array and subtree sweeps are forward scans.
+/// The hierarchy is rebuilt by the orbital system as soon as a space is created or destroyed, or its true radius changes. It is
+/// built from the spaces alone - each space lists the particles in it which host spaces - so its cost is independent of the
+/// number of particles. Queries never rebuild it, and may be made concurrently between mutations. Node references and indices
+/// are invalidated by a rebuild.
+/// Positions and velocities are transformed between spaces through the root frame, using the scale factors cached on the nodes
+/// and the origin of each space (its host particle's position) relative to the root. Origins are refreshed in one depth-first pass
+/// after each rebuild and once per tick, once the particles have moved, so that transforms are constant-time reads.
+/// </summary>
+class ScaledSpaceTree
+{
+public:
+	static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+	struct Node
+	{
+		ScaledSpaceBase *	m_pSpace;
+		ParticleBase *		m_pPrimary;				// The space's primary, found without walking the host chain.
+		uint32_t			m_parentIndex;			// Index of the outer space, or kInvalidIndex for the root.
+		uint32_t			m_firstChildIndex;		// Index of the first child, or kInvalidIndex.
+		uint32_t			m_nextSiblingIndex;		// Index of the next child of the same parent, or kInvalidIndex.
+		uint32_t			m_subtreeEndIndex;		// One past the index of the last node in this space's subtree.
+		uint32_t			m_depth;				// Number of spaces between this space and the root.
+		float				m_scaleToRoot;			// Cumulative scale factor: lengths scaled to this space times this factor are scaled to the root.
+		float				m_scaleFromRoot;		// Reciprocal of m_scaleToRoot.
+	};
+
+	ScaledSpaceTree();
+
+	ScaledSpaceTree(ScaledSpaceTree const&) = delete;
+	ScaledSpaceTree & operator=(ScaledSpaceTree const&) = delete;
+
+	/// <summary> Set the outermost space, and build the hierarchy from it. </summary>
+	void SetRoot(ScaledSpaceBase * pRootSpace);
+
+	/// <summary> Mark the hierarchy as out of date, as a space is created or destroyed, until it is rebuilt. </summary>
+	void Invalidate();
+
+	/// <summary> Rebuild the hierarchy. Called by the orbital system once it has created or destroyed spaces, or resized one. </summary>
+	void Rebuild();
+
+	/// <summary> Recompute the origin of every space from its host particle's current position and velocity. </summary>
+	void RefreshOrigins();
+
+	/// <returns> Every node, in depth-first order. </returns>
+	std::span<Node const> GetNodes() const;
+
+	/// <returns> The node of the given space. The nodes of the spaces which existed at the last rebuild remain current until the next. </returns>
+	Node const& GetNode(ScaledSpaceBase const& space) const;
+
+	/// <returns> The outer space of the given space, or nullptr for the root. </returns>
+	ScaledSpaceBase * GetOuterSpace(ScaledSpaceBase const& space) const;
+
+	/// <returns> The next smaller space attached to the same host particle, or nullptr. </returns>
+	ScaledSpaceBase * GetInnerSpace(ScaledSpaceBase const& space) const;
+
+	/// <returns> The primary of the given space. </returns>
+	ParticleBase * GetPrimary(ScaledSpaceBase const& space) const;
+
+	/// <returns> The factor converting lengths scaled to one space into lengths scaled to another. </returns>
+	float GetScale(ScaledSpaceBase const& fromSpace, ScaledSpaceBase const& toSpace) const;
+
+	/// <summary> Transform a position from one space's frame into another's. </summary>
+	/// <param name="position"> The position, relative/scaled to fromSpace. </param>
+	/// <returns> The position, relative/scaled to toSpace. </returns>
+	Vector3 TransformPosition(Vector3 const& position, ScaledSpaceBase const& fromSpace, ScaledSpaceBase const& toSpace) const;
+
+	/// <summary> Transform a velocity from one space's frame into another's. </summary>
+	/// <param name="velocity"> The velocity, relative/scaled to fromSpace. </param>
+	/// <returns> The velocity, relative/scaled to toSpace. </returns>
+	Vector3 TransformVelocity(Vector3 const& velocity, ScaledSpaceBase const& fromSpace, ScaledSpaceBase const& toSpace) const;
+
+private:
+	struct Origin
+	{
+		Vector3d			m_position;				// Position of the space's host particle, scaled to the root.
+		Vector3d			m_velocity;				// Velocity of the space's host particle, scaled to the root.
+	};
+
+	/// <summary> Append the subtree of a space: the space, its inner spaces, and the spaces attached to its host particles. </summary>
+	/// <param name="spaceIter"> The space, in its host particle's attached space list. </param>
+	/// <param name="endIter"> The end of the host particle's attached space list. </param>
+	/// <returns> The index of the appended space. </returns>
+	uint32_t Append(ScaledSpaceList::const_iterator spaceIter, ScaledSpaceList::const_iterator endIter, uint32_t parentIndex,
+		uint32_t depth);
+
+	std::vector<Node>	m_nodes;
+	std::vector<Origin>	m_origins;			// Parallel to m_nodes; kept apart so that hierarchy scans stay compact.
+	ScaledSpaceBase *	m_pRootSpace;
+	bool				m_isValid;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline void ScaledSpaceTree::Invalidate()
+{
+	m_isValid = false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<ScaledSpaceTree::Node const> ScaledSpaceTree::GetNodes() const
+{
+	assert(m_isValid);
+
+	return m_nodes;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class ScaledSpaceTreeTestScript : public ITestScript
+{
+public:
+	ScaledSpaceTreeTestScript();
+	virtual ~ScaledSpaceTreeTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_SCALED_SPACE_TREE_H
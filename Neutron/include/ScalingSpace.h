@@ -5,6 +5,7 @@
 #include "Constants.h"
 #include "Maths.h"
 #include "Uuid.h"
+#include "NeutronTime.h"
 #include "SortedList.h"
 #include "ITestScript.h"
 
@@ -33,13 +34,32 @@ public:
 	/// <returns></returns>
 	static float ComputeScaledGravityParameter(float trueRadius, float primaryMass);
 
-	/// <summary> Compute the position and velocity of the local primary relative/scaled to this scaling space. </summary>
-	static void ComputePrimaryKinetics(ScalingSpace const* pScalingSpace, Vector3 & position, Vector3 & velocity);
-
 	ScalingSpace(Particle * pHost, float trueRadius);
 
 	void Initialize(float radius, bool isInfluencing);
 
+	/// <summary>
+	/// Rescale the positions and velocities of the particles in this space by the given factor, and recompute their orbits. The
+	/// rescale is recorded rather than applied: each particle applies the rescales recorded since its state was set on its next
+	/// propagation, so that rescaling a space is independent of the number of particles in it.
+	/// </summary>
+	/// <param name="rescaleFactor"> The factor, or 1 to only recompute the orbits, as when the primary's state has changed. </param>
+	void Rescale(float rescaleFactor);
+
+	/// <returns> The product of the rescale factors recorded since this space was created. </returns>
+	float GetScale() const;
+
+	/// <returns> The number of rescales recorded since this space was created. </returns>
+	uint32_t GetScaleGeneration() const;
+
+	/// <summary>
+	/// Compute the position and velocity of the local primary relative/scaled to this scaling space at the given system time.
+	/// The primary of a non-influencing space is its host particle's primary, so it moves relative to the space as the host
+	/// particle moves relative to the primary, reversed: its state is evaluated from the host particle's orbit rather than read
+	/// from the cached primary kinetics, which are only refreshed when the space is synchronized.
+	/// </summary>
+	void ComputePrimaryKinetics(Time::Microseconds time, Vector3 & position, Vector3 & velocity) const;
+
 	float GetTrueRadius() const;
 	float GetRadius() const;
 	bool IsInfluencing() const;
@@ -60,16 +80,19 @@ private:
 
 	float							m_trueRadius;			// Radius in meters.
 	float							m_radius;				// Radius relative to superior scaling space.
+	float							m_scale;				// Product of the rescale factors recorded since creation.
+	uint32_t						m_scaleGeneration;		// Number of rescales recorded since creation.
 
 	bool							m_isInfluencing;		// Whether this scaling space is attached to the local primary.
 	float							m_gravityParameter;		// Locally scaled gravitational parameter = M * G / r^3 | G = gravitational constant, M = mass of local primary, r = true radius.
 
 	Particle *						m_pPrimary;				// Pointer to the local primary.
-	Vector3							m_primaryPosition;		// Locally scaled position of the primary relative to this space.
-	Vector3							m_primaryVelocity;		// Locally scaled velocity of the primary relative to this space.
+	Vector3							m_primaryPosition;		// Locally scaled position of the primary relative to this space, when last synchronized.
+	Vector3							m_primaryVelocity;		// Locally scaled velocity of the primary relative to this space, when last synchronized.
 
 	Particle *						m_pHost;
 	std::list<UniquePtr<Particle>>	m_particles;
+	std::vector<Particle *>			m_hostParticles;		// The particles in this space which host scaling spaces, which the other particles can enter.
 	ScalingSpace *					m_pOuterSpace;
 	ScalingSpace *					m_pInnerSpace;
 };
@@ -84,6 +107,28 @@ inline float ScalingSpace::ComputeScaledGravityParameter(float trueRadius, float
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+inline void ScalingSpace::Rescale(float rescaleFactor)
+{
+	m_scale *= rescaleFactor;
+	++m_scaleGeneration;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline float ScalingSpace::GetScale() const
+{
+	return m_scale;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t ScalingSpace::GetScaleGeneration() const
+{
+	return m_scaleGeneration;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 inline float ScalingSpace::GetTrueRadius() const
 {
 	return m_trueRadius;
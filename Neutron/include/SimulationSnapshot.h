@@ -0,0 +1,171 @@
+#ifndef NEUTRON_SIMULATION_SNAPSHOT_H
+#define NEUTRON_SIMULATION_SNAPSHOT_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "NeutronTime.h"
+#include "Orbit.h"
+#include "Uuid.h"
+#include "Vector3.h"
+
+#include <atomic>
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Immutable copy of the state of an orbital system at the end of a tick. Spaces are listed in the depth-first order of the
+/// scaled space hierarchy, and the particles of each space are contiguous.
+/// Particle states can be evaluated at any time after the snapshot, such as a render time between ticks, by propagating their
+/// orbits from the snapshot time.
+/// </summary>
+struct SimulationSnapshot
+{
+	static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+	struct SpaceState
+	{
+		Uuid				m_uuid;
+		Uuid				m_hostParticleUuid;
+		uint32_t			m_parentIndex;		// Index of the outer space, or kInvalidIndex for the root.
+		uint32_t			m_firstParticle;	// Index of the space's first particle.
+		uint32_t			m_particleCount;
+		float				m_trueRadius;
+		float				m_scaleToRoot;		// Lengths scaled to this space times this factor are scaled to the root.
+		float				m_spatialIndexCellSize;	// Cell size of the space's spatial index, or zero if it has none.
+		Vector3				m_primaryPosition;	// Relative/scaled to the space.
+		Vector3				m_primaryVelocity;	// Relative/scaled to the space.
+		bool				m_isInfluencing;
+		bool				m_hasParticleStore;
+		Time::Microseconds	m_epoch;			// System time to which the space's particles were propagated, before the snapshot time in lower update tiers.
+	};
+
+	struct ParticleState
+	{
+		Uuid				m_uuid;
+		uint32_t			m_spaceIndex;		// Index of the host space.
+		float				m_mass;
+		Vector3				m_position;			// Relative/scaled to the host space.
+		Vector3				m_velocity;			// Relative/scaled to the host space.
+		Orbit::Elements		m_elements;
+		double				m_meanAnomaly;
+		bool				m_isInfluencing;
+		bool				m_hasOrbit;			// False if the particle has no orbit, in which case the elements are undefined.
+	};
+
+	/// <summary>
+	/// Evaluate a particle's state at the given time by propagating its orbit from its space's epoch. The primary is assumed to
+	/// move in a straight line from its snapshot state, which is exact for influencing spaces and a close approximation over a
+	/// tick for the rest. Particles without orbits are likewise extrapolated in a straight line.
+	/// </summary>
+	/// <typeparam name="NMethod"> The Kepler equation solution method. </typeparam>
+	/// <param name="particleIndex"> Index of the particle in the snapshot. </param>
+	/// <param name="time"> The system time. </param>
+	/// <param name="position"> Storage for the position, relative/scaled to the host space. </param>
+	/// <param name="velocity"> Storage for the velocity, relative/scaled to the host space. </param>
+	template<Kepler::Method NMethod = Kepler::Method::Tolerance>
+	void ComputeKinetics(size_t particleIndex, Time::Microseconds time, Vector3 & position, Vector3 & velocity) const;
+
+	uint64_t					m_tick;
+	Time::Microseconds			m_time = 0;			// System time at which the snapshot was taken.
+	float						m_hostMass;			// Mass of the system's host particle.
+	std::vector<SpaceState>		m_spaces;
+	std::vector<ParticleState>	m_particles;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<Kepler::Method NMethod>
+inline void SimulationSnapshot::ComputeKinetics(size_t particleIndex, Time::Microseconds time, Vector3 & position,
+	Vector3 & velocity) const
+{
+	assert(particleIndex < m_particles.size());
+
+	ParticleState const& state = m_particles[particleIndex];
+	SpaceState const& space = m_spaces[state.m_spaceIndex];
+
+	if (!state.m_hasOrbit)
+	{
+		float const particleDT = static_cast<float>((time - space.m_epoch).Get()) / static_cast<float>(Time::Microsecond);
+
+		position = state.m_position + (state.m_velocity * particleDT);
+		velocity = state.m_velocity;
+
+		return;
+	}
+
+	Orbit::Elements const& elements = state.m_elements;
+	elements.ComputeKinetics(elements.template MeanToTrueAnomaly<NMethod>(elements.PropagateMeanAnomaly(state.m_meanAnomaly, time - space.m_epoch)),
+		position, velocity);
+
+	float const dT = static_cast<float>((time - m_time).Get()) / static_cast<float>(Time::Microsecond);
+
+	position += space.m_primaryPosition + (space.m_primaryVelocity * dT);
+	velocity += space.m_primaryVelocity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Double buffer through which a single writer publishes snapshots to any number of concurrent readers. The writer fills the
+/// back buffer, then publishes it with one atomic shared pointer store; readers acquire a shared reference to the published
+/// snapshot, which stays valid and unchanged for as long as they hold it. The atomic shared pointer is not lock-free on the
+/// standard libraries in use (MSVC and libstdc++ guard it with a spin lock), but that lock is held only to copy the pointer
+/// and adjust its reference count, never while a snapshot is written or read.
+/// The buffer retired by a publish is recycled as the next back buffer once every reader has released it, so in the steady
+/// state publishing allocates nothing beyond the growth of the snapshot's arrays. If a reader still holds it, a new buffer is
+/// allocated instead, and the writer never waits.
+/// </summary>
+class SnapshotBuffer
+{
+public:
+	using SnapshotPtr = SharedPtr<SimulationSnapshot const>;
+
+	SnapshotBuffer();
+
+	SnapshotBuffer(SnapshotBuffer const&) = delete;
+	SnapshotBuffer & operator=(SnapshotBuffer const&) = delete;
+
+	/// <returns> The back buffer, to be filled by the writer. Its previous contents are unspecified. Writer thread only. </returns>
+	SimulationSnapshot & BeginWrite();
+
+	/// <summary> Publish the back buffer to readers. Writer thread only. </summary>
+	void Publish();
+
+	/// <returns> The most recently published snapshot, or nullptr if none has been published. Any thread. </returns>
+	SnapshotPtr Acquire() const;
+
+private:
+	std::atomic<SnapshotPtr>		m_pPublished;
+	SharedPtr<SimulationSnapshot>	m_pFront;		// Writable alias of the published snapshot.
+	SharedPtr<SimulationSnapshot>	m_pBack;		// The snapshot being written, or nullptr between a publish and the next write.
+	SharedPtr<SimulationSnapshot>	m_pRetired;		// The previously published snapshot, recycled once no reader holds it.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline SnapshotBuffer::SnapshotPtr SnapshotBuffer::Acquire() const
+{
+	return m_pPublished.load(std::memory_order_acquire);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class SimulationSnapshotTestScript : public ITestScript
+{
+public:
+	SimulationSnapshotTestScript();
+	virtual ~SimulationSnapshotTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_SIMULATION_SNAPSHOT_H
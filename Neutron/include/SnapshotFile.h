@@ -0,0 +1,244 @@
+#ifndef NEUTRON_SNAPSHOT_FILE_H
+#define NEUTRON_SNAPSHOT_FILE_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "MappedFile.h"
+#include "NeutronTime.h"
+#include "Orbit.h"
+#include "SimulationSnapshot.h"
+#include "Vector3.h"
+
+#include <bit>
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Binary file of a simulation snapshot, for checkpointing an orbital system and restoring it with OrbitalSystem2::Restore.
+/// The file is a fixed header followed by sections of fixed-layout records, each starting on a cache line boundary: one record
+/// per space, in hierarchy order, then one array per particle attribute (structure of arrays), with the particles of each space
+/// contiguous. Files are read through a memory mapping and the arrays are used in place, so opening a file costs the same for any
+/// number of particles, and only the pages which are accessed are ever read.
+/// Values are stored little-endian, and orbit elements in their in-memory layout: a file is only readable by a build whose
+/// version and record sizes match the writer's, which the header records and the reader checks.
+/// </summary>
+class SnapshotFile
+{
+public:
+	static constexpr uint32_t	kMagic				= 0x504E534E;	// "NSNP", little-endian.
+	static constexpr uint32_t	kVersion			= 1;
+	static constexpr size_t		kSectionAlignment	= 64;
+
+	enum class Section : uint32_t
+	{
+		Spaces,
+		ParticleUuids,
+		ParticleFlags,
+		ParticleMasses,
+		ParticlePositions,
+		ParticleVelocities,
+		ParticleMeanAnomalies,
+		ParticleElements,
+		Count
+	};
+
+	enum SpaceFlags : uint32_t
+	{
+		kSpaceInfluencing		= 1 << 0,
+		kSpaceParticleStore		= 1 << 1,
+	};
+
+	enum ParticleFlags : uint8_t
+	{
+		kParticleInfluencing	= 1 << 0,
+		kParticleHasOrbit		= 1 << 1,
+	};
+
+	struct Header
+	{
+		uint32_t	m_magic;
+		uint32_t	m_version;
+		uint32_t	m_headerSize;			// Sizes of the fixed-layout records, which must match the reader's.
+		uint32_t	m_spaceRecordSize;
+		uint32_t	m_elementsSize;
+		uint32_t	m_spaceCount;
+		uint64_t	m_particleCount;
+		uint64_t	m_fileSize;
+		uint64_t	m_tick;
+		int64_t		m_time;					// System time of the snapshot (microseconds).
+		float		m_hostMass;
+		uint32_t	m_reserved;
+		uint64_t	m_sectionOffsets[static_cast<size_t>(Section::Count)];	// Offsets from the start of the file (bytes).
+	};
+
+	struct SpaceRecord
+	{
+		uint64_t	m_uuid;
+		uint64_t	m_hostParticleUuid;
+		uint32_t	m_parentIndex;			// Index of the outer space, or SimulationSnapshot::kInvalidIndex for the root.
+		uint32_t	m_firstParticle;		// Index of the space's first particle.
+		uint32_t	m_particleCount;
+		uint32_t	m_flags;				// SpaceFlags.
+		float		m_trueRadius;
+		float		m_scaleToRoot;
+		float		m_spatialIndexCellSize;	// Zero if the space has no spatial index.
+		Vector3		m_primaryPosition;		// Relative/scaled to the space.
+		Vector3		m_primaryVelocity;		// Relative/scaled to the space.
+		uint32_t	m_reserved;
+	};
+
+	static_assert(std::endian::native == std::endian::little, "Snapshot files are little-endian, and read in place");
+	static_assert(std::is_standard_layout_v<Vector3> && (sizeof(Vector3) == 3 * sizeof(float)));
+	static_assert(std::is_standard_layout_v<Orbit::Elements>);
+
+	/// <summary>
+	/// Write a snapshot to a file. The file is written alongside the destination and then renamed over it, so a failed or
+	/// interrupted write leaves any previous file at the destination intact.
+	/// </summary>
+	/// <param name="filePath"> The destination file path. </param>
+	/// <param name="snapshot"> The snapshot to write, such as one acquired from OrbitalSystem2 by a checkpointing thread. </param>
+	/// <exception cref="ApiException"> Failure - the file could not be written. </exception>
+	static void Write(StringView filePath, SimulationSnapshot const& snapshot);
+
+	/// <summary> Map a snapshot file and validate its header and space records. </summary>
+	/// <exception cref="ApiException"> Failure - the file could not be mapped. Unrecognized - the file is not a valid snapshot for this build. </exception>
+	explicit SnapshotFile(StringView filePath);
+
+	SnapshotFile(SnapshotFile const&) = delete;
+	SnapshotFile & operator=(SnapshotFile const&) = delete;
+
+	uint64_t GetTick() const;
+	Time::Microseconds GetTime() const;
+	float GetHostMass() const;
+
+	/// <returns> The space records, in the depth-first order of the scaled space hierarchy. </returns>
+	std::span<SpaceRecord const> GetSpaces() const;
+
+	// Particle arrays, indexed by particle index. The particles of each space are contiguous.
+	std::span<uint64_t const> GetParticleUuids() const;
+	std::span<uint8_t const> GetParticleFlags() const;
+	std::span<float const> GetParticleMasses() const;
+	std::span<Vector3 const> GetParticlePositions() const;		// Relative/scaled to the host space.
+	std::span<Vector3 const> GetParticleVelocities() const;		// Relative/scaled to the host space.
+	std::span<double const> GetParticleMeanAnomalies() const;
+	std::span<Orbit::Elements const> GetParticleElements() const;	// Undefined for particles without kParticleHasOrbit.
+
+private:
+	/// <returns> The header of a file with the given counts, with every section offset laid out. </returns>
+	static Header ComputeLayout(uint32_t spaceCount, uint64_t particleCount);
+
+	template<typename T>
+	std::span<T const> GetSection(Section section, size_t count) const;
+
+	MappedFile			m_file;
+	Header const*		m_pHeader;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t SnapshotFile::GetTick() const
+{
+	return m_pHeader->m_tick;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline Time::Microseconds SnapshotFile::GetTime() const
+{
+	return Time::Microseconds(m_pHeader->m_time);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline float SnapshotFile::GetHostMass() const
+{
+	return m_pHeader->m_hostMass;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<SnapshotFile::SpaceRecord const> SnapshotFile::GetSpaces() const
+{
+	return GetSection<SpaceRecord>(Section::Spaces, m_pHeader->m_spaceCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<uint64_t const> SnapshotFile::GetParticleUuids() const
+{
+	return GetSection<uint64_t>(Section::ParticleUuids, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<uint8_t const> SnapshotFile::GetParticleFlags() const
+{
+	return GetSection<uint8_t>(Section::ParticleFlags, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<float const> SnapshotFile::GetParticleMasses() const
+{
+	return GetSection<float>(Section::ParticleMasses, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<Vector3 const> SnapshotFile::GetParticlePositions() const
+{
+	return GetSection<Vector3>(Section::ParticlePositions, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<Vector3 const> SnapshotFile::GetParticleVelocities() const
+{
+	return GetSection<Vector3>(Section::ParticleVelocities, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<double const> SnapshotFile::GetParticleMeanAnomalies() const
+{
+	return GetSection<double>(Section::ParticleMeanAnomalies, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline std::span<Orbit::Elements const> SnapshotFile::GetParticleElements() const
+{
+	return GetSection<Orbit::Elements>(Section::ParticleElements, m_pHeader->m_particleCount);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline std::span<T const> SnapshotFile::GetSection(Section section, size_t count) const
+{
+	// Section bounds are validated on opening.
+	return std::span<T const>(reinterpret_cast<T const*>(m_file.GetData().data() + m_pHeader->m_sectionOffsets[static_cast<size_t>(section)]),
+		count);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class SnapshotFileTestScript : public ITestScript
+{
+public:
+	SnapshotFileTestScript();
+	virtual ~SnapshotFileTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_SNAPSHOT_FILE_H
@@ -0,0 +1,481 @@
+#ifndef NEUTRON_SPATIAL_HASH_GRID_H
+#define NEUTRON_SPATIAL_HASH_GRID_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+#include "Exception.h"
+#include "Macros.h"
+#include "Vector3.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Uniform hash grid over the items in a scaled space, in locally scaled coordinates. Each occupied cell holds a dense array of
+/// its items and their positions, and each item's cell and slot are recorded so that moving or removing an item is O(1). Moving
+/// an item within its cell only updates its stored position.
+/// Range and pair queries visit only the cells that can contain a match; nearest-neighbour queries search outwards ring by ring.
+/// The cell size should be of the order of the typical query distance. Not thread safe.
+/// </summary>
+/// <typeparam name="TItem"> The item type, hashable and equality comparable (typically a pointer). </typeparam>
+template<typename TItem>
+class SpatialHashGrid
+{
+public:
+	using ItemPair = std::pair<TItem, TItem>;
+
+	/// <param name="cellSize"> The edge length of a cell, in locally scaled units. </param>
+	/// <exception cref="ApiException"> Invalid parameter - the cell size is not positive. </exception>
+	explicit SpatialHashGrid(float cellSize);
+
+	float GetCellSize() const;
+	size_t Size() const;
+	bool Contains(TItem const& item) const;
+
+	/// <summary> Add an item. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the item is already in the grid. </exception>
+	void Insert(TItem const& item, Vector3 const& position);
+
+	/// <summary> Move an item. Only updates the item's stored position unless it has left its cell. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the item is not in the grid. </exception>
+	void Update(TItem const& item, Vector3 const& position);
+
+	/// <summary> Remove an item. </summary>
+	/// <exception cref="ApiException"> Invalid parameter - the item is not in the grid. </exception>
+	void Remove(TItem const& item);
+
+	void Clear();
+
+	/// <summary> Find every item within a distance of a point. </summary>
+	/// <param name="results"> Storage for the found items, in no particular order. Appended to. </param>
+	void QueryRange(Vector3 const& centre, float radius, std::vector<TItem> & results) const;
+
+	/// <summary> Find the items nearest to a point. </summary>
+	/// <param name="count"> The number of items to find. Fewer are found if the grid holds fewer items. </param>
+	/// <param name="results"> Storage for the found items, nearest first. Overwritten. </param>
+	void QueryNearest(Vector3 const& centre, size_t count, std::vector<TItem> & results) const;
+
+	/// <summary> Find every pair of items within a distance of each other. </summary>
+	/// <param name="results"> Storage for the found pairs, each reported once, in no particular order. Appended to. </param>
+	void QueryPairs(float distance, std::vector<ItemPair> & results) const;
+
+private:
+	using CellKey = uint64_t;
+
+	struct Cell
+	{
+		std::vector<TItem>		m_items;
+		std::vector<Vector3>	m_positions;
+	};
+
+	struct Location
+	{
+		CellKey		m_cellKey;
+		uint32_t	m_slot;
+	};
+
+	static constexpr int32_t	kCoordinateBias = 1 << 20;	// Cell coordinates are stored biased, in 21 bits each.
+
+	static CellKey MakeKey(int32_t x, int32_t y, int32_t z);
+	static void SplitKey(CellKey key, int32_t & x, int32_t & y, int32_t & z);
+
+	int32_t ToCellCoordinate(float coordinate) const;
+	CellKey ToCellKey(Vector3 const& position) const;
+
+	void AddToCell(TItem const& item, Vector3 const& position, CellKey cellKey);
+	void RemoveFromCell(Location const& location);
+
+	/// <summary> Visit every cell intersecting an axis-aligned box of cells, or every occupied cell if that is cheaper. </summary>
+	template<typename TFunc>
+	void ForEachCellInBox(int32_t minX, int32_t minY, int32_t minZ, int32_t maxX, int32_t maxY, int32_t maxZ, TFunc && func) const;
+
+	float const									m_cellSize;
+	float const									m_inverseCellSize;
+
+	std::unordered_map<CellKey, Cell>			m_cells;
+	std::unordered_map<TItem, Location>			m_locations;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline SpatialHashGrid<TItem>::SpatialHashGrid(float cellSize) :
+	m_cellSize(cellSize),
+	m_inverseCellSize(1.f / cellSize)
+{
+	API_ASSERT_THROW(0.f < cellSize, RESULT_CODE_INVALID_PARAMETER, Fmt::Format("Invalid cell size {}", cellSize));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline float SpatialHashGrid<TItem>::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline size_t SpatialHashGrid<TItem>::Size() const
+{
+	return m_locations.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline bool SpatialHashGrid<TItem>::Contains(TItem const& item) const
+{
+	return m_locations.contains(item);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::Insert(TItem const& item, Vector3 const& position)
+{
+	API_ASSERT_THROW(!Contains(item), RESULT_CODE_INVALID_PARAMETER, "Item is already in the spatial hash grid");
+
+	AddToCell(item, position, ToCellKey(position));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::Update(TItem const& item, Vector3 const& position)
+{
+	auto locationIter = m_locations.find(item);
+	API_ASSERT_THROW(m_locations.end() != locationIter, RESULT_CODE_INVALID_PARAMETER, "Item is not in the spatial hash grid");
+
+	Location const location = locationIter->second;
+	CellKey const cellKey = ToCellKey(position);
+
+	if (cellKey == location.m_cellKey)
+	{
+		m_cells[cellKey].m_positions[location.m_slot] = position;
+		return;
+	}
+
+	RemoveFromCell(location);
+	AddToCell(item, position, cellKey);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::Remove(TItem const& item)
+{
+	auto locationIter = m_locations.find(item);
+	API_ASSERT_THROW(m_locations.end() != locationIter, RESULT_CODE_INVALID_PARAMETER, "Item is not in the spatial hash grid");
+
+	RemoveFromCell(locationIter->second);
+	m_locations.erase(item); // Not locationIter: RemoveFromCell may have updated another item's location.
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::Clear()
+{
+	m_cells.clear();
+	m_locations.clear();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::QueryRange(Vector3 const& centre, float radius, std::vector<TItem> & results) const
+{
+	float const squareRadius = radius * radius;
+
+	ForEachCellInBox(
+		ToCellCoordinate(centre.X() - radius), ToCellCoordinate(centre.Y() - radius), ToCellCoordinate(centre.Z() - radius),
+		ToCellCoordinate(centre.X() + radius), ToCellCoordinate(centre.Y() + radius), ToCellCoordinate(centre.Z() + radius),
+		[&](Cell const& cell)
+		{
+			for (size_t slot = 0; slot < cell.m_items.size(); ++slot)
+			{
+				if ((cell.m_positions[slot] - centre).SqareMagnitude() <= squareRadius)
+					results.push_back(cell.m_items[slot]);
+			}
+		});
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::QueryNearest(Vector3 const& centre, size_t count, std::vector<TItem> & results) const
+{
+	results.clear();
+
+	count = std::min(count, Size());
+	if (0 == count)
+		return;
+
+	using Candidate = std::pair<float, TItem>; // Square distance, item.
+
+	auto compare = [](Candidate const& lhs, Candidate const& rhs) { return lhs.first < rhs.first; };
+	std::vector<Candidate> candidates; // Max-heap of the nearest items found so far.
+
+	auto visitCell = [&](Cell const& cell)
+	{
+		for (size_t slot = 0; slot < cell.m_items.size(); ++slot)
+		{
+			float const squareDistance = (cell.m_positions[slot] - centre).SqareMagnitude();
+
+			if (candidates.size() < count)
+			{
+				candidates.emplace_back(squareDistance, cell.m_items[slot]);
+				std::push_heap(candidates.begin(), candidates.end(), compare);
+			}
+			else if (squareDistance < candidates.front().first)
+			{
+				std::pop_heap(candidates.begin(), candidates.end(), compare);
+				candidates.back() = Candidate(squareDistance, cell.m_items[slot]);
+				std::push_heap(candidates.begin(), candidates.end(), compare);
+			}
+		}
+	};
+
+	int32_t const x = ToCellCoordinate(centre.X());
+	int32_t const y = ToCellCoordinate(centre.Y());
+	int32_t const z = ToCellCoordinate(centre.Z());
+
+	// Search rings of cells at increasing Chebyshev distance. Every item in ring r + 1 is at least r cells from the centre, so
+	// the search ends once the candidates are complete and all nearer than that. A ring with more cells than the grid has
+	// occupied cells ends the search with a scan of the occupied cells instead.
+	for (int32_t ring = 0; ; ++ring)
+	{
+		size_t const ringCellCount = (0 == ring) ? 1 : static_cast<size_t>(24 * ring * ring + 2);
+
+		if (ringCellCount > m_cells.size())
+		{
+			candidates.clear();
+
+			for (auto const& [cellKey, cell] : m_cells)
+				visitCell(cell);
+
+			break;
+		}
+
+		for (int32_t dx = -ring; dx <= ring; ++dx)
+		{
+			for (int32_t dy = -ring; dy <= ring; ++dy)
+			{
+				bool const isOnFace = (ring == abs(dx)) || (ring == abs(dy));
+
+				for (int32_t dz = -ring; dz <= ring; dz += (isOnFace || (0 == ring)) ? 1 : 2 * ring)
+				{
+					auto cellIter = m_cells.find(MakeKey(x + dx, y + dy, z + dz));
+					if (m_cells.end() != cellIter)
+						visitCell(cellIter->second);
+				}
+			}
+		}
+
+		float const searchedDistance = static_cast<float>(ring) * m_cellSize;
+
+		if ((candidates.size() == count) && (candidates.front().first <= searchedDistance * searchedDistance))
+			break;
+	}
+
+	std::sort_heap(candidates.begin(), candidates.end(), compare);
+
+	results.reserve(candidates.size());
+	for (Candidate const& candidate : candidates)
+		results.push_back(candidate.second);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::QueryPairs(float distance, std::vector<ItemPair> & results) const
+{
+	float const squareDistance = distance * distance;
+	int32_t const reach = static_cast<int32_t>(ceilf(distance * m_inverseCellSize));
+
+	for (auto const& [cellKey, cell] : m_cells)
+	{
+		size_t const itemCount = cell.m_items.size();
+
+		for (size_t slot = 0; slot < itemCount; ++slot)
+		{
+			for (size_t otherSlot = slot + 1; otherSlot < itemCount; ++otherSlot)
+			{
+				if ((cell.m_positions[slot] - cell.m_positions[otherSlot]).SqareMagnitude() <= squareDistance)
+					results.emplace_back(cell.m_items[slot], cell.m_items[otherSlot]);
+			}
+		}
+
+		int32_t x, y, z;
+		SplitKey(cellKey, x, y, z);
+
+		// Visit only the half of the neighbourhood that follows this cell in (x, y, z) order, so that each pair is found once.
+		for (int32_t dx = 0; dx <= reach; ++dx)
+		{
+			for (int32_t dy = (0 == dx) ? 0 : -reach; dy <= reach; ++dy)
+			{
+				for (int32_t dz = ((0 == dx) && (0 == dy)) ? 1 : -reach; dz <= reach; ++dz)
+				{
+					auto otherCellIter = m_cells.find(MakeKey(x + dx, y + dy, z + dz));
+					if (m_cells.end() == otherCellIter)
+						continue;
+
+					Cell const& otherCell = otherCellIter->second;
+
+					for (size_t slot = 0; slot < itemCount; ++slot)
+					{
+						for (size_t otherSlot = 0; otherSlot < otherCell.m_items.size(); ++otherSlot)
+						{
+							if ((cell.m_positions[slot] - otherCell.m_positions[otherSlot]).SqareMagnitude() <= squareDistance)
+								results.emplace_back(cell.m_items[slot], otherCell.m_items[otherSlot]);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline typename SpatialHashGrid<TItem>::CellKey SpatialHashGrid<TItem>::MakeKey(int32_t x, int32_t y, int32_t z)
+{
+	constexpr CellKey kMask = (CellKey(1) << 21) - 1;
+
+	return ((static_cast<CellKey>(x + kCoordinateBias) & kMask) << 42) |
+		((static_cast<CellKey>(y + kCoordinateBias) & kMask) << 21) |
+		(static_cast<CellKey>(z + kCoordinateBias) & kMask);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::SplitKey(CellKey key, int32_t & x, int32_t & y, int32_t & z)
+{
+	constexpr CellKey kMask = (CellKey(1) << 21) - 1;
+
+	x = static_cast<int32_t>((key >> 42) & kMask) - kCoordinateBias;
+	y = static_cast<int32_t>((key >> 21) & kMask) - kCoordinateBias;
+	z = static_cast<int32_t>(key & kMask) - kCoordinateBias;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline int32_t SpatialHashGrid<TItem>::ToCellCoordinate(float coordinate) const
+{
+	float const cellCoordinate = floorf(coordinate * m_inverseCellSize);
+
+	// Clamp to the representable range. Scaled positions lie within the space, so only a tiny cell size can reach the limits.
+	return static_cast<int32_t>(std::clamp(cellCoordinate, static_cast<float>(1 - kCoordinateBias), static_cast<float>(kCoordinateBias - 1)));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline typename SpatialHashGrid<TItem>::CellKey SpatialHashGrid<TItem>::ToCellKey(Vector3 const& position) const
+{
+	return MakeKey(ToCellCoordinate(position.X()), ToCellCoordinate(position.Y()), ToCellCoordinate(position.Z()));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::AddToCell(TItem const& item, Vector3 const& position, CellKey cellKey)
+{
+	Cell & cell = m_cells[cellKey];
+
+	m_locations[item] = Location{ cellKey, static_cast<uint32_t>(cell.m_items.size()) };
+
+	cell.m_items.push_back(item);
+	cell.m_positions.push_back(position);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+inline void SpatialHashGrid<TItem>::RemoveFromCell(Location const& location)
+{
+	auto cellIter = m_cells.find(location.m_cellKey);
+	assert(m_cells.end() != cellIter);
+
+	Cell & cell = cellIter->second;
+	size_t const lastSlot = cell.m_items.size() - 1;
+
+	if (location.m_slot != lastSlot)
+	{
+		// Move the last item into the vacated slot to keep the cell dense.
+		cell.m_items[location.m_slot] = cell.m_items[lastSlot];
+		cell.m_positions[location.m_slot] = cell.m_positions[lastSlot];
+
+		m_locations[cell.m_items[location.m_slot]].m_slot = location.m_slot;
+	}
+
+	cell.m_items.pop_back();
+	cell.m_positions.pop_back();
+
+	if (cell.m_items.empty())
+		m_cells.erase(cellIter);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TItem>
+template<typename TFunc>
+inline void SpatialHashGrid<TItem>::ForEachCellInBox(int32_t minX, int32_t minY, int32_t minZ, int32_t maxX, int32_t maxY, int32_t maxZ,
+	TFunc && func) const
+{
+	uint64_t const boxCellCount = static_cast<uint64_t>(maxX - minX + 1) * static_cast<uint64_t>(maxY - minY + 1) *
+		static_cast<uint64_t>(maxZ - minZ + 1);
+
+	if (boxCellCount > m_cells.size())
+	{
+		for (auto const& [cellKey, cell] : m_cells)
+		{
+			int32_t x, y, z;
+			SplitKey(cellKey, x, y, z);
+
+			if ((minX <= x) && (x <= maxX) && (minY <= y) && (y <= maxY) && (minZ <= z) && (z <= maxZ))
+				func(cell);
+		}
+
+		return;
+	}
+
+	for (int32_t x = minX; x <= maxX; ++x)
+	{
+		for (int32_t y = minY; y <= maxY; ++y)
+		{
+			for (int32_t z = minZ; z <= maxZ; ++z)
+			{
+				auto cellIter = m_cells.find(MakeKey(x, y, z));
+				if (m_cells.end() != cellIter)
+					func(cellIter->second);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class SpatialHashGridTestScript : public ITestScript
+{
+public:
+	SpatialHashGridTestScript();
+	virtual ~SpatialHashGridTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_SPATIAL_HASH_GRID_H
@@ -0,0 +1,142 @@
+#ifndef NEUTRON_TASK_POOL_H
+#define NEUTRON_TASK_POOL_H
+
+#include "NebulaTypes.h"
+#include "ITestScript.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// A work-stealing thread pool. Each worker thread owns a task queue: tasks submitted from a worker are pushed to and popped from
+/// the back of its own queue (depth-first, cache-warm), and idle workers steal from the front of the other queues (the oldest,
+/// typically largest, tasks). Tasks submitted from other threads go to a shared queue which every worker steals from.
+/// Threads waiting on a task group execute queued tasks until the group completes, so tasks may submit and wait on nested
+/// task groups without deadlocking the pool.
+/// </summary>
+class TaskPool
+{
+public:
+	using Task = std::function<void()>;
+
+	/// <summary> A set of tasks which can be waited on together. Must outlive its tasks. </summary>
+	class TaskGroup
+	{
+		friend class TaskPool;
+
+	public:
+		TaskGroup() = default;
+		TaskGroup(TaskGroup const&) = delete;
+		TaskGroup & operator=(TaskGroup const&) = delete;
+
+	private:
+		std::atomic<size_t>	m_pendingCount = 0;		// Number of submitted tasks which have not completed.
+		std::mutex			m_exceptionMutex;
+		std::exception_ptr	m_pException;			// The first exception thrown by a task in the group.
+	};
+
+	/// <param name="threadCount"> The number of worker threads. Threads waiting on task groups also execute tasks. </param>
+	explicit TaskPool(size_t threadCount = std::thread::hardware_concurrency());
+	~TaskPool();
+
+	TaskPool(TaskPool const&) = delete;
+	TaskPool & operator=(TaskPool const&) = delete;
+
+	size_t GetThreadCount() const;
+
+	/// <summary> Queue a task for execution. May be called from within a task. </summary>
+	void Submit(TaskGroup & taskGroup, Task task);
+
+	/// <summary> Execute queued tasks until every task in the group has completed. </summary>
+	/// <exception> Rethrows the first exception thrown by a task in the group. </exception>
+	void Wait(TaskGroup & taskGroup);
+
+	/// <summary> Call function(begin, end) for consecutive chunks of the range [0, count) in parallel, and wait for them all. </summary>
+	template<typename TFunction>
+	void ParallelFor(size_t count, size_t chunkSize, TFunction const& function);
+
+private:
+	struct QueuedTask
+	{
+		Task			m_task;
+		TaskGroup *		m_pTaskGroup = nullptr;
+	};
+
+	struct TaskQueue
+	{
+		std::mutex				m_mutex;
+		std::deque<QueuedTask>	m_tasks;
+	};
+
+	/// <returns> The queue owned by the calling thread, or the shared queue if the caller is not a worker of this pool. </returns>
+	size_t GetQueueIndex() const;
+
+	/// <summary> Pop a task from the back of the given queue, or steal one from the front of another queue. </summary>
+	bool TryAcquire(size_t queueIndex, QueuedTask & queuedTask);
+
+	/// <summary> Execute one queued task, if there is one. </summary>
+	bool TryExecute(size_t queueIndex);
+
+	void WorkerMain(size_t queueIndex);
+
+	std::vector<UniquePtr<TaskQueue>>	m_queues;			// One queue per worker, followed by the shared queue.
+	std::vector<std::thread>			m_threads;
+
+	std::mutex							m_wakeMutex;
+	std::condition_variable				m_wakeCondition;
+	std::atomic<size_t>					m_queuedCount;		// Number of tasks in all queues.
+	bool								m_isStopping;		// Guarded by m_wakeMutex.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline size_t TaskPool::GetThreadCount() const
+{
+	return m_threads.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename TFunction>
+inline void TaskPool::ParallelFor(size_t count, size_t chunkSize, TFunction const& function)
+{
+	assert(0 < chunkSize);
+
+	TaskGroup taskGroup;
+
+	for (size_t begin = 0; begin < count; begin += chunkSize)
+	{
+		size_t const end = std::min(count, begin + chunkSize);
+
+		Submit(taskGroup, [&function, begin, end]() { function(begin, end); });
+	}
+
+	Wait(taskGroup);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class TaskPoolTestScript : public ITestScript
+{
+public:
+	TaskPoolTestScript();
+	virtual ~TaskPoolTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_TASK_POOL_H
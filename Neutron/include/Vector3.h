@@ -15,6 +15,9 @@ using namespace Nebula;
 template<typename T>
 class TVector3
 {
+	template<typename U>
+	friend class TVector3;
+
 public:
 	constexpr TVector3();
 	constexpr TVector3(T v);
@@ -237,7 +240,7 @@ inline T TVector3<T>::AngleBetweenUnitVectors(TVector3 const& lhs, TVector3 cons
 	assert(T(1) == lhs.SqareMagnitude());
 	assert(T(1) == rhs.SqareMagnitude());
 
-	return std::acosf(std::clamp(lhs.Dot(rhs), T(-1), T(1))); // Clamp in case of precision error.
+	return std::acos(std::clamp(lhs.Dot(rhs), T(-1), T(1))); // Clamp in case of precision error.
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,466 @@
+#ifndef NEUTRON_VECTOR_3_PACK_H
+#define NEUTRON_VECTOR_3_PACK_H
+
+#include "Vector3.h"
+#include "FloatPack.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// NWidth vectors stored as three packs of components (structure-of-arrays in registers), mirroring the TVector3 API.
+/// Operations perform the same IEEE-754 operations in the same order as the scalar Vector3, so each lane is bit-identical to the
+/// equivalent Vector3 computation. Predicates return FloatPack masks instead of bool.
+/// </summary>
+template<size_t NWidth>
+class TVector3Pack
+{
+public:
+	using Pack = FloatPack<NWidth>;
+
+	static constexpr size_t kWidth = NWidth;
+
+	TVector3Pack() = default;
+	TVector3Pack(Pack v);
+	TVector3Pack(Pack x, Pack y, Pack z);
+
+	/// <summary> Broadcast a vector to every lane. </summary>
+	TVector3Pack(Vector3 const& vector);
+
+	/// <returns> (0, 0, 0) in every lane. </returns>
+	static TVector3Pack Zero();
+
+	/// <summary> Load NWidth consecutive vectors. </summary>
+	static TVector3Pack Load(Vector3 const* pVectors);
+
+	/// <summary> Load NWidth consecutive vectors from separate component arrays. </summary>
+	static TVector3Pack Load(float const* pX, float const* pY, float const* pZ);
+
+	/// <summary> Compute the vector cross products. Optimised for precision, as TVector3::PreciseCross. </summary>
+	/// <param name="magnitude"> Storage for the magnitudes of the computed cross products. </param>
+	/// <param name="direction"> Storage for the directions of the computed cross products. </param>
+	static void PreciseCross(TVector3Pack const& lhs, TVector3Pack const& rhs, Pack & magnitude, TVector3Pack & direction);
+
+	/// <returns> Mask of the lanes in which the vectors are approximately parallel. </returns>
+	static Pack AreApproxParallel(TVector3Pack const& lhs, TVector3Pack const& rhs, float tolerance = std::numeric_limits<float>::epsilon());
+
+	/// <summary> Compute the angles (radians) between unit vectors, as TVector3::AngleBetweenUnitVectors. </summary>
+	static Pack AngleBetweenUnitVectors(TVector3Pack const& lhs, TVector3Pack const& rhs);
+
+	/// <summary> Store NWidth consecutive vectors. </summary>
+	void Store(Vector3 * pVectors) const;
+
+	/// <summary> Store NWidth consecutive vectors to separate component arrays. </summary>
+	void Store(float * pX, float * pY, float * pZ) const;
+
+	/// <returns> The vector in a lane. </returns>
+	Vector3 Get(size_t lane) const;
+
+	Pack X() const;
+	Pack Y() const;
+	Pack Z() const;
+
+	/// <returns> Mask of the lanes holding the zero vector. </returns>
+	Pack IsZero() const;
+
+	/// <returns> The square magnitudes of the vectors. </returns>
+	Pack SqareMagnitude() const;
+
+	/// <returns> A normalized copy of the vectors. Zero vectors are left unchanged. </returns>
+	TVector3Pack Normalized() const;
+
+	/// <returns> The dot products of these vectors and others. </returns>
+	Pack Dot(TVector3Pack const& rhs) const;
+
+	/// <returns> The cross products of these vectors (the left-hand side) and others (the right-hand side) = lhs x rhs. </returns>
+	TVector3Pack Cross(TVector3Pack const& rhs) const;
+
+	/// <summary> Compute the vector cross products = this x rhs, optimised for precision. </summary>
+	void PreciseCross(TVector3Pack const& rhs, Pack & magnitude, TVector3Pack & direction) const;
+
+	/// <returns> The cross products = this x rhs, optimised for precision. </returns>
+	TVector3Pack PreciseCross(TVector3Pack const& rhs) const;
+
+	/// <returns> Mask of the lanes in which this and the other vectors are approximately parallel. </returns>
+	Pack IsApproxParallel(TVector3Pack const& other, float tolerance = std::numeric_limits<float>::epsilon()) const;
+
+	/// <summary> Normalize the vectors. Zero vectors are left unchanged. </summary>
+	/// <returns> A reference to this (normalized) pack. </returns>
+	TVector3Pack & Normalize();
+
+	/// <returns> Mask of the lanes in which the vectors are equal. </returns>
+	Pack operator==(TVector3Pack const& rhs) const;
+
+	TVector3Pack operator+(TVector3Pack const& rhs) const;
+	TVector3Pack operator-(TVector3Pack const& rhs) const;
+	TVector3Pack operator*(Pack scalar) const;
+	TVector3Pack operator/(Pack scalar) const;
+	TVector3Pack & operator+=(TVector3Pack const& rhs);
+	TVector3Pack & operator-=(TVector3Pack const& rhs);
+	TVector3Pack & operator*=(Pack scalar);
+	TVector3Pack & operator/=(Pack scalar);
+
+	/// <returns> Lanes of trueValue where the mask is set, otherwise lanes of falseValue. </returns>
+	friend TVector3Pack Select(Pack mask, TVector3Pack const& trueValue, TVector3Pack const& falseValue)
+	{
+		return { Select(mask, trueValue.m_x, falseValue.m_x), Select(mask, trueValue.m_y, falseValue.m_y),
+			Select(mask, trueValue.m_z, falseValue.m_z) };
+	}
+
+private:
+	Pack	m_x, m_y, m_z;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth>::TVector3Pack(Pack v) :
+	m_x(v),
+	m_y(v),
+	m_z(v)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth>::TVector3Pack(Pack x, Pack y, Pack z) :
+	m_x(x),
+	m_y(y),
+	m_z(z)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth>::TVector3Pack(Vector3 const& vector) :
+	m_x(vector.X()),
+	m_y(vector.Y()),
+	m_z(vector.Z())
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::Zero()
+{
+	return TVector3Pack(Pack(0.f));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::Load(Vector3 const* pVectors)
+{
+	float x[NWidth], y[NWidth], z[NWidth];
+
+	for (size_t lane = 0; lane < NWidth; ++lane)
+	{
+		x[lane] = pVectors[lane].X();
+		y[lane] = pVectors[lane].Y();
+		z[lane] = pVectors[lane].Z();
+	}
+
+	return Load(x, y, z);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::Load(float const* pX, float const* pY, float const* pZ)
+{
+	return { Pack::Load(pX), Pack::Load(pY), Pack::Load(pZ) };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline void TVector3Pack<NWidth>::PreciseCross(TVector3Pack const& lhs, TVector3Pack const& rhs, Pack & magnitude, TVector3Pack & direction)
+{
+	Pack const lhsMagnitude = Sqrt(lhs.SqareMagnitude());
+	Pack const rhsMagnitude = Sqrt(rhs.SqareMagnitude());
+
+	TVector3Pack const lhsNormalized = lhs / lhsMagnitude;
+	TVector3Pack const rhsNormalized = rhs / rhsMagnitude;
+
+	direction = lhsNormalized.Cross(rhsNormalized).Normalize();
+
+	Pack const magnitudeProduct = lhsMagnitude * rhsMagnitude;
+
+	Pack const cosAngle = lhs.Dot(rhs) / magnitudeProduct;
+
+	Pack const sinAngle = Sqrt(Pack(1.f) - (cosAngle * cosAngle)); // Trig. ident. 1 = sin^2(a) + cos^2(a)
+
+	magnitude = magnitudeProduct * sinAngle;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::AreApproxParallel(TVector3Pack const& lhs, TVector3Pack const& rhs, float tolerance)
+{
+	return (Pack(1.f - tolerance) < lhs.Dot(rhs));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::AngleBetweenUnitVectors(TVector3Pack const& lhs, TVector3Pack const& rhs)
+{
+	Pack const cosAngle = Min(Max(lhs.Dot(rhs), Pack(-1.f)), Pack(1.f)); // Clamp in case of precision error.
+
+	// There is no packed arc cosine - evaluate it per lane.
+	float angles[NWidth];
+	for (size_t lane = 0; lane < NWidth; ++lane)
+		angles[lane] = std::acosf(cosAngle[lane]);
+
+	return Pack::Load(angles);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline void TVector3Pack<NWidth>::Store(Vector3 * pVectors) const
+{
+	float x[NWidth], y[NWidth], z[NWidth];
+	Store(x, y, z);
+
+	for (size_t lane = 0; lane < NWidth; ++lane)
+		pVectors[lane] = Vector3(x[lane], y[lane], z[lane]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline void TVector3Pack<NWidth>::Store(float * pX, float * pY, float * pZ) const
+{
+	m_x.Store(pX);
+	m_y.Store(pY);
+	m_z.Store(pZ);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline Vector3 TVector3Pack<NWidth>::Get(size_t lane) const
+{
+	assert(lane < NWidth);
+
+	return Vector3(m_x[lane], m_y[lane], m_z[lane]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::X() const
+{
+	return m_x;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::Y() const
+{
+	return m_y;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::Z() const
+{
+	return m_z;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::IsZero() const
+{
+	Pack const zero(0.f);
+
+	return (m_x == zero) & (m_y == zero) & (m_z == zero);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::SqareMagnitude() const
+{
+	return (m_x * m_x) + (m_y * m_y) + (m_z * m_z);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::Normalized() const
+{
+	Pack const sqareMagnitude = SqareMagnitude();
+
+	return Select(sqareMagnitude == Pack(0.f), *this, *this / Sqrt(sqareMagnitude));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::Dot(TVector3Pack const& rhs) const
+{
+	return (m_x * rhs.m_x) + (m_y * rhs.m_y) + (m_z * rhs.m_z);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::Cross(TVector3Pack const& rhs) const
+{
+	return {
+		(m_y * rhs.m_z) - (m_z * rhs.m_y),
+		(m_z * rhs.m_x) - (m_x * rhs.m_z),
+		(m_x * rhs.m_y) - (m_y * rhs.m_x)
+	};
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline void TVector3Pack<NWidth>::PreciseCross(TVector3Pack const& rhs, Pack & magnitude, TVector3Pack & direction) const
+{
+	PreciseCross(*this, rhs, magnitude, direction);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::PreciseCross(TVector3Pack const& rhs) const
+{
+	Pack magnitude;
+	TVector3Pack direction;
+
+	PreciseCross(*this, rhs, magnitude, direction);
+
+	return direction * magnitude;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::IsApproxParallel(TVector3Pack const& other, float tolerance) const
+{
+	return AreApproxParallel(*this, other, tolerance);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> & TVector3Pack<NWidth>::Normalize()
+{
+	*this = Normalized();
+
+	return *this;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline typename TVector3Pack<NWidth>::Pack TVector3Pack<NWidth>::operator==(TVector3Pack const& rhs) const
+{
+	return (m_x == rhs.m_x) & (m_y == rhs.m_y) & (m_z == rhs.m_z);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::operator+(TVector3Pack const& rhs) const
+{
+	return { m_x + rhs.m_x, m_y + rhs.m_y, m_z + rhs.m_z };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::operator-(TVector3Pack const& rhs) const
+{
+	return { m_x - rhs.m_x, m_y - rhs.m_y, m_z - rhs.m_z };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::operator*(Pack scalar) const
+{
+	return { scalar * m_x, scalar * m_y, scalar * m_z };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> TVector3Pack<NWidth>::operator/(Pack scalar) const
+{
+	return { m_x / scalar, m_y / scalar, m_z / scalar };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> & TVector3Pack<NWidth>::operator+=(TVector3Pack const& rhs)
+{
+	return (*this = *this + rhs);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> & TVector3Pack<NWidth>::operator-=(TVector3Pack const& rhs)
+{
+	return (*this = *this - rhs);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> & TVector3Pack<NWidth>::operator*=(Pack scalar)
+{
+	return (*this = *this * scalar);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<size_t NWidth>
+inline TVector3Pack<NWidth> & TVector3Pack<NWidth>::operator/=(Pack scalar)
+{
+	return (*this = *this / scalar);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+#if defined(NEUTRON_FLOAT_PACK_SSE)
+using Vector3x4 = TVector3Pack<4>;
+#endif
+#if defined(NEUTRON_FLOAT_PACK_AVX)
+using Vector3x8 = TVector3Pack<8>;
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class Vector3PackTestScript : public ITestScript
+{
+public:
+	Vector3PackTestScript();
+	virtual ~Vector3PackTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
+
+#endif//NEUTRON_VECTOR_3_PACK_H
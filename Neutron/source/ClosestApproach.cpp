@@ -0,0 +1,438 @@
+#include "ClosestApproach.h"
+
+#include "ParticleBase.h"
+#include "Exception.h"
+#include "TestHandler.h"
+
+namespace // detail
+{
+
+using namespace Neutron;
+using namespace Neutron::ClosestApproach;
+
+template<typename T>
+struct Kinetics
+{
+	TVector3<T>	m_position;
+	TVector3<T>	m_velocity;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+struct Separation
+{
+	int64_t		m_time;
+	T			m_distance;
+	T			m_rangeRate;	// Relative position dot relative velocity, which has the sign of the rate of change of the distance.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+struct SearchContext
+{
+	TOrbit<T> const&			m_orbit;
+	TOrbit<T> const&			m_otherOrbit;
+	T							m_threshold;
+	double						m_maxClosingSpeed;	// Upper bound on the rate of change of the distance, per microsecond.
+	int64_t						m_fineStep;
+	std::vector<Approach<T>> &	m_approaches;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> The orbiter's kinetics at the given time after its current time. </returns>
+template<typename T>
+Kinetics<T> ComputeKinetics(TOrbit<T> const& orbit, int64_t time)
+{
+	typename TOrbit<T>::Elements const& elements = orbit.GetCurrentSection().m_elements;
+
+	Kinetics<T> kinetics;
+	elements.ComputeKinetics(elements.MeanToTrueAnomaly(elements.PropagateMeanAnomaly(orbit.GetMeanAnomaly(), time)),
+		kinetics.m_position, kinetics.m_velocity);
+
+	return kinetics;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+Separation<T> Evaluate(SearchContext<T> const& context, int64_t time, Kinetics<T> const& kinetics)
+{
+	Kinetics<T> const otherKinetics = ComputeKinetics(context.m_otherOrbit, time);
+
+	TVector3<T> const relativePosition = otherKinetics.m_position - kinetics.m_position;
+	TVector3<T> const relativeVelocity = otherKinetics.m_velocity - kinetics.m_velocity;
+
+	return Separation<T>{ time, sqrt(relativePosition.SqareMagnitude()), relativePosition.Dot(relativeVelocity) };
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+Separation<T> Evaluate(SearchContext<T> const& context, int64_t time)
+{
+	return Evaluate(context, time, ComputeKinetics(context.m_orbit, time));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> The largest speed on the orbit, which is reached at periapsis: mu / h * (1 + e). </returns>
+template<typename T>
+double ComputeMaxSpeed(typename TOrbit<T>::Elements const& elements)
+{
+	return static_cast<double>(elements.m_velocityK) * (1.0 + static_cast<double>(elements.m_eccentricity));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> Whether the orbits' apsis shells are too far apart for the orbiters ever to come within the threshold. </returns>
+template<typename T>
+bool AreShellsSeparated(typename TOrbit<T>::Elements const& elements, typename TOrbit<T>::Elements const& otherElements, T threshold)
+{
+	auto computePeriapsis = [](typename TOrbit<T>::Elements const& e) { return e.m_parameter / (1 + e.m_eccentricity); };
+	auto computeApoapsis = [](typename TOrbit<T>::Elements const& e)
+		{ return (e.m_eccentricity < 1) ? e.m_parameter / (1 - e.m_eccentricity) : std::numeric_limits<T>::infinity(); };
+
+	return ((computePeriapsis(elements) - threshold) > computeApoapsis(otherElements)) ||
+		((computePeriapsis(otherElements) - threshold) > computeApoapsis(elements));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> The finest search interval: a fraction of the shorter closed-orbit period, or of the horizon. </returns>
+template<typename T>
+int64_t ComputeFineStep(typename TOrbit<T>::Elements const& elements, typename TOrbit<T>::Elements const& otherElements,
+	int64_t horizon)
+{
+	int64_t step = horizon / kOpenOrbitSamples;
+
+	for (typename TOrbit<T>::Elements const* pElements : { &elements, &otherElements })
+	{
+		if ((pElements->m_eccentricity < 1) && (0 < pElements->m_period.Get()))
+			step = std::min(step, pElements->m_period.Get() / kSamplesPerPeriod);
+	}
+
+	return std::max<int64_t>(step, 1);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Refine a minimum of the distance, bracketed by a negative and a non-negative range rate, by regula falsi (Illinois). </summary>
+template<typename T>
+void Refine(SearchContext<T> const& context, Separation<T> lower, Separation<T> upper)
+{
+	double lowerRate = lower.m_rangeRate;
+	double upperRate = upper.m_rangeRate;
+	int side = 0;
+
+	for (int iteration = 0; (iteration < kMaxRefinementIterations) && (1 < (upper.m_time - lower.m_time)); ++iteration)
+	{
+		double const fraction = lowerRate / (lowerRate - upperRate);
+		int64_t const time = std::clamp(lower.m_time + static_cast<int64_t>(fraction * static_cast<double>(upper.m_time - lower.m_time)),
+			lower.m_time + 1, upper.m_time - 1);
+
+		Separation<T> const separation = Evaluate(context, time);
+
+		if (separation.m_rangeRate < 0)
+		{
+			lower = separation;
+			lowerRate = separation.m_rangeRate;
+
+			if (-1 == side)
+				upperRate *= 0.5;
+
+			side = -1;
+		}
+		else
+		{
+			upper = separation;
+			upperRate = separation.m_rangeRate;
+
+			if (1 == side)
+				lowerRate *= 0.5;
+
+			side = 1;
+		}
+	}
+
+	Separation<T> const& closest = (lower.m_distance < upper.m_distance) ? lower : upper;
+
+	if (closest.m_distance <= context.m_threshold)
+		context.m_approaches.push_back(Approach<T>{ closest.m_time, closest.m_distance });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Search an interval for close approaches: discard it if the distance cannot fall below the threshold, else bisect it. </summary>
+template<typename T>
+void SearchInterval(SearchContext<T> const& context, Separation<T> const& start, Separation<T> const& end)
+{
+	int64_t const duration = end.m_time - start.m_time;
+
+	// The distance changes no faster than the maximum closing speed, so within the interval it is at least this.
+	double const lowerBound = 0.5 * (static_cast<double>(start.m_distance) + static_cast<double>(end.m_distance) -
+		(context.m_maxClosingSpeed * static_cast<double>(duration)));
+
+	if (lowerBound > static_cast<double>(context.m_threshold))
+		return;
+
+	if (duration <= context.m_fineStep)
+	{
+		if ((start.m_rangeRate < 0) && (0 <= end.m_rangeRate))
+			Refine(context, start, end);
+
+		return;
+	}
+
+	Separation<T> const middle = Evaluate(context, start.m_time + (duration / 2));
+
+	SearchInterval(context, start, middle);
+	SearchInterval(context, middle, end);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Search the horizon in coarse intervals, given the first orbiter's kinetics at the start of each interval and at the horizon.
+/// The ends of the horizon are minima of the distance over it when the orbiters are receding at the start or still closing at
+/// the horizon, which no sign change of the range rate brackets.
+/// </summary>
+template<typename T>
+void SearchHorizon(SearchContext<T> const& context, std::span<Kinetics<T> const> coarseKinetics, int64_t coarseStep, int64_t horizon)
+{
+	Separation<T> start = Evaluate(context, 0, coarseKinetics[0]);
+
+	if ((0 <= start.m_rangeRate) && (start.m_distance <= context.m_threshold))
+		context.m_approaches.push_back(Approach<T>{ start.m_time, start.m_distance });
+
+	for (size_t index = 1; index < coarseKinetics.size(); ++index)
+	{
+		int64_t const time = std::min(static_cast<int64_t>(index) * coarseStep, horizon);
+		Separation<T> const end = Evaluate(context, time, coarseKinetics[index]);
+
+		SearchInterval(context, start, end);
+
+		start = end;
+	}
+
+	if ((start.m_rangeRate < 0) && (start.m_distance <= context.m_threshold))
+		context.m_approaches.push_back(Approach<T>{ start.m_time, start.m_distance });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+std::vector<Kinetics<T>> ComputeCoarseKinetics(TOrbit<T> const& orbit, int64_t coarseStep, int64_t horizon)
+{
+	std::vector<Kinetics<T>> coarseKinetics;
+	coarseKinetics.reserve(static_cast<size_t>((horizon + coarseStep - 1) / coarseStep) + 1);
+
+	for (int64_t time = 0; ; time += coarseStep)
+	{
+		coarseKinetics.push_back(ComputeKinetics(orbit, std::min(time, horizon)));
+
+		if (horizon <= time)
+			break;
+	}
+
+	return coarseKinetics;
+}
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+namespace ClosestApproach // ------------------------------------------------------------------------------------------------------
+{
+
+template<typename T>
+void Find(TOrbit<T> const& orbit, TOrbit<T> const& otherOrbit, Time::Microseconds horizon, T threshold,
+	std::vector<Approach<T>> & approaches)
+{
+	typename TOrbit<T>::Elements const& elements = orbit.GetCurrentSection().m_elements;
+	typename TOrbit<T>::Elements const& otherElements = otherOrbit.GetCurrentSection().m_elements;
+
+	if ((horizon.Get() <= 0) || AreShellsSeparated<T>(elements, otherElements, threshold))
+		return;
+
+	int64_t const fineStep = ComputeFineStep<T>(elements, otherElements, horizon.Get());
+	int64_t const coarseStep = fineStep * (kSamplesPerPeriod / kCoarseSamplesPerPeriod);
+
+	SearchContext<T> const context{ orbit, otherOrbit, threshold,
+		(ComputeMaxSpeed<T>(elements) + ComputeMaxSpeed<T>(otherElements)) / static_cast<double>(Time::Microsecond), fineStep, approaches };
+
+	std::vector<Kinetics<T>> const coarseKinetics = ComputeCoarseKinetics(orbit, coarseStep, horizon.Get());
+
+	SearchHorizon<T>(context, coarseKinetics, coarseStep, horizon.Get());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void Find(TOrbit<T> const& orbit, std::span<TOrbit<T> const* const> otherOrbits, Time::Microseconds horizon, T threshold,
+	std::vector<IndexedApproach<T>> & approaches)
+{
+	if (horizon.Get() <= 0)
+		return;
+
+	typename TOrbit<T>::Elements const& elements = orbit.GetCurrentSection().m_elements;
+
+	// The first orbiter's coarse kinetics are computed once, on its own coarse grid, and shared by every pair. Each pair still
+	// bisects down to its own fine step.
+	int64_t const coarseStep = ComputeFineStep<T>(elements, elements, horizon.Get()) * (kSamplesPerPeriod / kCoarseSamplesPerPeriod);
+	std::vector<Kinetics<T>> const coarseKinetics = ComputeCoarseKinetics(orbit, coarseStep, horizon.Get());
+
+	double const maxSpeed = ComputeMaxSpeed<T>(elements);
+	std::vector<Approach<T>> pairApproaches;
+
+	for (size_t index = 0; index < otherOrbits.size(); ++index)
+	{
+		TOrbit<T> const& otherOrbit = *otherOrbits[index];
+		typename TOrbit<T>::Elements const& otherElements = otherOrbit.GetCurrentSection().m_elements;
+
+		if (AreShellsSeparated<T>(elements, otherElements, threshold))
+			continue;
+
+		pairApproaches.clear();
+
+		SearchContext<T> const context{ orbit, otherOrbit, threshold,
+			(maxSpeed + ComputeMaxSpeed<T>(otherElements)) / static_cast<double>(Time::Microsecond),
+			ComputeFineStep<T>(elements, otherElements, horizon.Get()), pairApproaches };
+
+		SearchHorizon<T>(context, coarseKinetics, coarseStep, horizon.Get());
+
+		for (Approach<T> const& approach : pairApproaches)
+			approaches.push_back(IndexedApproach<T>{ index, approach });
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Find(ParticleBase & particle, ParticleBase & otherParticle, Time::Microseconds horizon, float threshold,
+	std::vector<Approach<float>> & approaches)
+{
+	API_ASSERT_THROW(particle.GetHostSpace() == otherParticle.GetHostSpace(), RESULT_CODE_INVALID_PARAMETER,
+		"Particles must be in the same scaled space");
+
+	Orbit::Elements const*const pElements = particle.GetElements();
+	Orbit::Elements const*const pOtherElements = otherParticle.GetElements();
+
+	API_ASSERT_THROW((nullptr != pElements) && (nullptr != pOtherElements), RESULT_CODE_INVALID_PARAMETER, "Particle has no orbit");
+
+	Orbit orbit, otherOrbit;
+	orbit.Initialize(*pElements, particle.GetMeanAnomaly());
+	otherOrbit.Initialize(*pOtherElements, otherParticle.GetMeanAnomaly());
+
+	Find(orbit, otherOrbit, horizon, threshold, approaches);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template void Find<float>(Orbit const&, Orbit const&, Time::Microseconds, float, std::vector<Approach<float>> &);
+template void Find<double>(Orbitd const&, Orbitd const&, Time::Microseconds, double, std::vector<Approach<double>> &);
+
+template void Find<float>(Orbit const&, std::span<Orbit const* const>, Time::Microseconds, float, std::vector<IndexedApproach<float>> &);
+template void Find<double>(Orbitd const&, std::span<Orbitd const* const>, Time::Microseconds, double, std::vector<IndexedApproach<double>> &);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ClosestApproachTestScript::ClosestApproachTestScript() :
+	ITestScript("ClosestApproach")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ClosestApproachTestScript::~ClosestApproachTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ClosestApproachTestScript::RunImpl(TestHandler & testHandler)
+{
+	// Unit gravity parameter: a unit circular orbit has unit speed and a period of 2 Pi seconds.
+	Orbit prograde, retrograde, eccentric, distant;
+	prograde.Initialize(1.f, Vector3(1.f, 0.f, 0.f), Vector3(0.f, 1.f, 0.f));
+	retrograde.Initialize(1.f, Vector3(-1.f, 0.f, 0.f), Vector3(0.f, 1.f, 0.f));
+	eccentric.Initialize(1.f, Vector3(0.f, -0.6f, 0.02f), Vector3(1.5f, 0.f, 0.f));
+	distant.Initialize(1.f, Vector3(5.f, 0.f, 0.f), Vector3(0.f, sqrtf(0.2f), 0.f));
+
+	Time::Microseconds const period = prograde.GetCurrentSection().m_elements.m_period;
+
+	// Counter-rotating orbiters on the same circle meet at a quarter and three quarters of a period.
+	std::vector<Approach<float>> approaches;
+	Find(prograde, retrograde, period, 0.01f, approaches);
+
+	testHandler.Assert(approaches.size(), 2ull, "Counter-rotating approach count");
+	testHandler.Assert(llabs(approaches[0].m_time.Get() - (period.Get() / 4)) < 1000, true, "First approach time");
+	testHandler.Assert(llabs(approaches[1].m_time.Get() - (3 * period.Get() / 4)) < 1000, true, "Second approach time");
+	testHandler.Assert(approaches[0].m_distance < 1e-3f, true, "First approach distance");
+
+	// The closest approach of a crossing eccentric orbit agrees with dense sampling.
+	Time::Microseconds const horizon = 4 * period.Get();
+
+	approaches.clear();
+	Find(prograde, eccentric, horizon, 0.5f, approaches);
+
+	float sampledMinimum = std::numeric_limits<float>::max();
+	for (int64_t time = 0; time <= horizon.Get(); time += horizon.Get() / 200000)
+	{
+		Kinetics<float> const kinetics = ComputeKinetics(prograde, time);
+		Kinetics<float> const otherKinetics = ComputeKinetics(eccentric, time);
+
+		sampledMinimum = std::min(sampledMinimum, sqrtf((otherKinetics.m_position - kinetics.m_position).SqareMagnitude()));
+	}
+
+	float foundMinimum = std::numeric_limits<float>::max();
+	for (Approach<float> const& approach : approaches)
+		foundMinimum = std::min(foundMinimum, approach.m_distance);
+
+	testHandler.Assert(fabsf(foundMinimum - sampledMinimum) < 1e-3f, true, "Closest approach matches dense sampling");
+
+	// Batched screening matches the pairwise search, and rejects the distant orbit from its elements.
+	Orbit const* otherOrbits[] = { &retrograde, &distant, &eccentric };
+
+	std::vector<IndexedApproach<float>> indexedApproaches;
+	Find(prograde, std::span<Orbit const* const>(otherOrbits), horizon, 0.5f, indexedApproaches);
+
+	std::vector<Approach<float>> pairApproaches;
+	Find(prograde, retrograde, horizon, 0.5f, pairApproaches);
+	Find(prograde, eccentric, horizon, 0.5f, pairApproaches);
+
+	bool isBatchMatch = (indexedApproaches.size() == pairApproaches.size());
+	for (size_t index = 0; isBatchMatch && (index < indexedApproaches.size()); ++index)
+	{
+		isBatchMatch = (indexedApproaches[index].m_index != 1) &&
+			(llabs(indexedApproaches[index].m_approach.m_time.Get() - pairApproaches[index].m_time.Get()) < 1000);
+	}
+
+	testHandler.Assert(isBatchMatch, true, "Batched search matches pairwise search");
+
+	// Orbiters within the threshold and receding at the start have their closest approach at the start.
+	Orbit receding;
+	receding.Initialize(1.f, Vector3(1.005f, 0.f, 0.f), Vector3(0.1f, 1.f, 0.f));
+
+	approaches.clear();
+	Find(prograde, receding, period.Get() / 8, 0.01f, approaches);
+
+	testHandler.Assert((1 == approaches.size()) && (0 == approaches[0].m_time.Get()) && (fabsf(approaches[0].m_distance - 0.005f) < 1e-4f),
+		true, "Approach at the start of the horizon");
+
+	// Orbiters within the threshold and still closing at the horizon have their closest approach at the horizon.
+	Time::Microseconds const closingHorizon = (period.Get() / 4) - (period.Get() / 400);
+
+	approaches.clear();
+	Find(prograde, retrograde, closingHorizon, 0.05f, approaches);
+
+	testHandler.Assert((1 == approaches.size()) && (approaches[0].m_time.Get() == closingHorizon.Get()) && (approaches[0].m_distance < 0.05f),
+		true, "Approach at the end of the horizon");
+}
+
+} // namespace ClosestApproach ----------------------------------------------------------------------------------------------------
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,572 @@
+#include "Integrator.h"
+
+#include "Constants.h"
+#include "Exception.h"
+#include "TestHandler.h"
+
+namespace // detail
+{
+
+using namespace Neutron;
+using namespace Neutron::Integrator;
+
+// Yoshida's fourth-order composition weights: w1 = 1 / (2 - 2^(1/3)), w0 = -2^(1/3) / (2 - 2^(1/3)).
+constexpr double kYoshidaW1 = 1.3512071919596578;
+constexpr double kYoshidaW0 = -1.7024143839193155;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Equations of motion of a body's deviation from its reference conic. Times are measured in seconds from the start of the
+/// integration. The body's mean anomaly is held at the model's epoch, the time of the last rectification, until the integration
+/// is finished.
+/// </summary>
+template<typename T>
+class TDeviationModel
+{
+public:
+	using Vector3T = TVector3<T>;
+
+	TDeviationModel(T gravityParameter, TBody<T> & body, size_t bodyIndex, TAccelerationFunction<T> const& accelerationFunction) :
+		m_gravityParameter(gravityParameter),
+		m_body(body),
+		m_bodyIndex(bodyIndex),
+		m_accelerationFunction(accelerationFunction),
+		m_epoch(0.0)
+	{
+	}
+
+	/// <returns> The mean anomaly on the reference conic at the given time. </returns>
+	double ComputeMeanAnomaly(double time) const
+	{
+		typename TOrbit<T>::Elements const& elements = m_body.m_elements;
+
+		double meanAnomaly = m_body.m_meanAnomaly + static_cast<double>(elements.m_meanMotion) * (time - m_epoch);
+
+		// As Elements::PropagateMeanAnomaly, but at any time rather than whole microseconds.
+		if ((TOrbit<T>::Type::Circle == elements.m_type) || (TOrbit<T>::Type::Ellipse == elements.m_type))
+		{
+			meanAnomaly = fmod(meanAnomaly, kPI2);
+
+			if (meanAnomaly < 0.0)
+				meanAnomaly += kPI2;
+		}
+
+		return meanAnomaly;
+	}
+
+	/// <summary> Compute the state on the reference conic at the given time. </summary>
+	void ComputeReference(double time, Vector3T & position, Vector3T & velocity) const
+	{
+		m_body.m_elements.ComputeKinetics(m_body.m_elements.MeanToTrueAnomaly(ComputeMeanAnomaly(time)), position, velocity);
+	}
+
+	/// <returns> The acceleration of the deviation at the given time. </returns>
+	Vector3T ComputeAcceleration(double time, Vector3T const& positionDeviation) const
+	{
+		Vector3T referencePosition, referenceVelocity;
+		ComputeReference(time, referencePosition, referenceVelocity);
+
+		Vector3T const position = referencePosition + positionDeviation;
+
+		// The difference between the two-body accelerations at the true and the reference positions, without the cancellation of
+		// subtracting them (Battin): -mu / rho^3 * (d + f(q) * r), where rho^2 = r^2 * (1 + q), and f(q) = (1 + q)^(3/2) - 1.
+		T const q = positionDeviation.Dot(positionDeviation - position * T(2)) / position.SqareMagnitude();
+		T const f = q * (T(3) + q * (T(3) + q)) / (T(1) + pow(T(1) + q, T(1.5)));
+
+		T const referenceSquareDistance = referencePosition.SqareMagnitude();
+		T const referenceCubeDistance = referenceSquareDistance * sqrt(referenceSquareDistance);
+
+		Vector3T acceleration = (positionDeviation + position * f) * (-m_gravityParameter / referenceCubeDistance) + m_body.m_acceleration;
+
+		if (m_accelerationFunction)
+			acceleration += m_accelerationFunction(m_bodyIndex, time, position);
+
+		return acceleration;
+	}
+
+	/// <summary> Rectify the body if its deviation has grown beyond the given ratio of its distance to the primary. </summary>
+	/// <returns> Whether the body was rectified. </returns>
+	bool RectifyIfDeviated(double time, T rectificationRatio)
+	{
+		Vector3T referencePosition, referenceVelocity;
+		ComputeReference(time, referencePosition, referenceVelocity);
+
+		T const ratioSquared = rectificationRatio * rectificationRatio;
+
+		if (!(ratioSquared * referencePosition.SqareMagnitude() < m_body.m_positionDeviation.SqareMagnitude()))
+			return false;
+
+		Rectify(time, referencePosition, referenceVelocity);
+
+		return true;
+	}
+
+	/// <summary> Recompute the body's reference conic from its state at the given time, and reset its deviation. </summary>
+	void Rectify(double time)
+	{
+		Vector3T referencePosition, referenceVelocity;
+		ComputeReference(time, referencePosition, referenceVelocity);
+
+		Rectify(time, referencePosition, referenceVelocity);
+	}
+
+	/// <summary> Advance the body's mean anomaly to the end of the integration, and compute its state there. </summary>
+	void Finish(double time)
+	{
+		ComputeReference(time, m_body.m_position, m_body.m_velocity);
+
+		m_body.m_meanAnomaly = ComputeMeanAnomaly(time);
+		m_epoch = time;
+
+		m_body.m_position += m_body.m_positionDeviation;
+		m_body.m_velocity += m_body.m_velocityDeviation;
+	}
+
+private:
+	void Rectify(double time, Vector3T const& referencePosition, Vector3T const& referenceVelocity)
+	{
+		Vector3T const position = referencePosition + m_body.m_positionDeviation;
+		Vector3T const velocity = referenceVelocity + m_body.m_velocityDeviation;
+
+		m_body.m_elements.Compute(m_gravityParameter, position, velocity);
+		m_body.m_meanAnomaly = m_body.m_elements.TrueToMeanAnomaly(m_body.m_elements.ComputeTrueAnomaly(position));
+		m_body.m_positionDeviation = Vector3T::Zero();
+		m_body.m_velocityDeviation = Vector3T::Zero();
+
+		m_epoch = time;
+
+		++m_body.m_rectificationCount;
+	}
+
+	T									m_gravityParameter;
+	TBody<T> &							m_body;
+	size_t								m_bodyIndex;
+	TAccelerationFunction<T> const&		m_accelerationFunction;
+	double								m_epoch;	// Time at which the body's mean anomaly lies on the reference conic.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void StepRungeKutta4(TDeviationModel<T> const& model, TBody<T> & body, double time, double step)
+{
+	using Vector3T = TVector3<T>;
+
+	T const halfStep = static_cast<T>(0.5 * step);
+	T const sixthStep = static_cast<T>(step / 6.0);
+
+	Vector3T const& position = body.m_positionDeviation;
+	Vector3T const& velocity = body.m_velocityDeviation;
+
+	Vector3T const k1r = velocity;
+	Vector3T const k1v = model.ComputeAcceleration(time, position);
+	Vector3T const k2r = velocity + k1v * halfStep;
+	Vector3T const k2v = model.ComputeAcceleration(time + 0.5 * step, position + k1r * halfStep);
+	Vector3T const k3r = velocity + k2v * halfStep;
+	Vector3T const k3v = model.ComputeAcceleration(time + 0.5 * step, position + k2r * halfStep);
+	Vector3T const k4r = velocity + k3v * static_cast<T>(step);
+	Vector3T const k4v = model.ComputeAcceleration(time + step, position + k3r * static_cast<T>(step));
+
+	body.m_positionDeviation += (k1r + (k2r + k3r) * T(2) + k4r) * sixthStep;
+	body.m_velocityDeviation += (k1v + (k2v + k3v) * T(2) + k4v) * sixthStep;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Kick-drift-kick leapfrog step, from and updating the acceleration at the start of the step. </summary>
+template<typename T>
+void StepVelocityVerlet(TDeviationModel<T> const& model, TBody<T> & body, double time, double step, TVector3<T> & acceleration)
+{
+	T const halfStep = static_cast<T>(0.5 * step);
+
+	body.m_velocityDeviation += acceleration * halfStep;
+	body.m_positionDeviation += body.m_velocityDeviation * static_cast<T>(step);
+
+	acceleration = model.ComputeAcceleration(time + step, body.m_positionDeviation);
+
+	body.m_velocityDeviation += acceleration * halfStep;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void StepYoshida4(TDeviationModel<T> const& model, TBody<T> & body, double time, double step, TVector3<T> & acceleration)
+{
+	StepVelocityVerlet(model, body, time, kYoshidaW1 * step, acceleration);
+	StepVelocityVerlet(model, body, time + kYoshidaW1 * step, kYoshidaW0 * step, acceleration);
+	StepVelocityVerlet(model, body, time + (kYoshidaW1 + kYoshidaW0) * step, kYoshidaW1 * step, acceleration);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Dormand-Prince 5(4) step, which uses the acceleration at the start of the step and computes the acceleration at its end (first
+/// same as last). The body is only advanced if the step is accepted: if its error is within the tolerance, or it is forced.
+/// </summary>
+/// <returns> The error of the step relative to the tolerance. </returns>
+template<typename T>
+T StepDormandPrince54(TDeviationModel<T> const& model, TBody<T> & body, double time, double step, T tolerance, bool isForced,
+	TVector3<T> & acceleration)
+{
+	using Vector3T = TVector3<T>;
+
+	static constexpr double c2 = 1.0 / 5.0, c3 = 3.0 / 10.0, c4 = 4.0 / 5.0, c5 = 8.0 / 9.0;
+
+	static constexpr double a21 = 1.0 / 5.0;
+	static constexpr double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+	static constexpr double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+	static constexpr double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0, a53 = 64448.0 / 6561.0, a54 = -212.0 / 729.0;
+	static constexpr double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0, a64 = 49.0 / 176.0, a65 = -5103.0 / 18656.0;
+	static constexpr double b1 = 35.0 / 384.0, b3 = 500.0 / 1113.0, b4 = 125.0 / 192.0, b5 = -2187.0 / 6784.0, b6 = 11.0 / 84.0;
+
+	// Differences between the fifth- and fourth-order weights.
+	static constexpr double e1 = b1 - 5179.0 / 57600.0, e3 = b3 - 7571.0 / 16695.0, e4 = b4 - 393.0 / 640.0,
+		e5 = b5 + 92097.0 / 339200.0, e6 = b6 - 187.0 / 2100.0, e7 = -1.0 / 40.0;
+
+	Vector3T const& r = body.m_positionDeviation;
+	Vector3T const& v = body.m_velocityDeviation;
+
+	auto const h = [step](double coefficient) { return static_cast<T>(coefficient * step); };
+
+	Vector3T const k1r = v;
+	Vector3T const k1v = acceleration;
+
+	Vector3T const k2r = v + k1v * h(a21);
+	Vector3T const k2v = model.ComputeAcceleration(time + c2 * step, r + k1r * h(a21));
+
+	Vector3T const k3r = v + k1v * h(a31) + k2v * h(a32);
+	Vector3T const k3v = model.ComputeAcceleration(time + c3 * step, r + k1r * h(a31) + k2r * h(a32));
+
+	Vector3T const k4r = v + k1v * h(a41) + k2v * h(a42) + k3v * h(a43);
+	Vector3T const k4v = model.ComputeAcceleration(time + c4 * step, r + k1r * h(a41) + k2r * h(a42) + k3r * h(a43));
+
+	Vector3T const k5r = v + k1v * h(a51) + k2v * h(a52) + k3v * h(a53) + k4v * h(a54);
+	Vector3T const k5v = model.ComputeAcceleration(time + c5 * step, r + k1r * h(a51) + k2r * h(a52) + k3r * h(a53) + k4r * h(a54));
+
+	Vector3T const k6r = v + k1v * h(a61) + k2v * h(a62) + k3v * h(a63) + k4v * h(a64) + k5v * h(a65);
+	Vector3T const k6v = model.ComputeAcceleration(time + step,
+		r + k1r * h(a61) + k2r * h(a62) + k3r * h(a63) + k4r * h(a64) + k5r * h(a65));
+
+	Vector3T const nextR = r + k1r * h(b1) + k3r * h(b3) + k4r * h(b4) + k5r * h(b5) + k6r * h(b6);
+	Vector3T const nextV = v + k1v * h(b1) + k3v * h(b3) + k4v * h(b4) + k5v * h(b5) + k6v * h(b6);
+
+	Vector3T const k7r = nextV;
+	Vector3T const k7v = model.ComputeAcceleration(time + step, nextR);
+
+	Vector3T const errorR = k1r * h(e1) + k3r * h(e3) + k4r * h(e4) + k5r * h(e5) + k6r * h(e6) + k7r * h(e7);
+	Vector3T const errorV = k1v * h(e1) + k3v * h(e3) + k4v * h(e4) + k5v * h(e5) + k6v * h(e6) + k7v * h(e7);
+
+	T const error = std::max({ fabs(errorR.X()), fabs(errorR.Y()), fabs(errorR.Z()), fabs(errorV.X()), fabs(errorV.Y()),
+		fabs(errorV.Z()) }) / tolerance;
+
+	if ((error <= T(1)) || isForced)
+	{
+		body.m_positionDeviation = nextR;
+		body.m_velocityDeviation = nextV;
+		acceleration = k7v;
+	}
+
+	return error;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void IntegrateFixed(TDeviationModel<T> & model, TBody<T> & body, Time::Microseconds dT, TSettings<T> const& settings)
+{
+	int64_t const stepCount = (dT.Get() + settings.m_maximumStep.Get() - 1) / settings.m_maximumStep.Get();
+
+	TVector3<T> acceleration = model.ComputeAcceleration(0.0, body.m_positionDeviation);
+
+	// Steps end on whole microseconds, so that every step ends at the same time whatever the method.
+	Time::Microseconds time = 0;
+
+	for (int64_t index = 1; index <= stepCount; ++index)
+	{
+		Time::Microseconds const nextTime = dT.Get() * index / stepCount;
+
+		double const timeSeconds = static_cast<double>(time.Get()) / static_cast<double>(Time::Microsecond);
+		double const step = static_cast<double>((nextTime - time).Get()) / static_cast<double>(Time::Microsecond);
+
+		switch (settings.m_method)
+		{
+		case Method::RungeKutta4:
+			StepRungeKutta4(model, body, timeSeconds, step);
+			break;
+
+		case Method::VelocityVerlet:
+			StepVelocityVerlet(model, body, timeSeconds, step, acceleration);
+			break;
+
+		case Method::Yoshida4:
+			StepYoshida4(model, body, timeSeconds, step, acceleration);
+			break;
+
+		default:
+			assert(false); // Not a fixed-step method.
+		}
+
+		++body.m_stepCount;
+		time = nextTime;
+
+		double const nextTimeSeconds = static_cast<double>(nextTime.Get()) / static_cast<double>(Time::Microsecond);
+
+		if (model.RectifyIfDeviated(nextTimeSeconds, settings.m_rectificationRatio))
+			acceleration = model.ComputeAcceleration(nextTimeSeconds, body.m_positionDeviation);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void IntegrateAdaptive(TDeviationModel<T> & model, TBody<T> & body, Time::Microseconds dT, TSettings<T> const& settings)
+{
+	double const end = static_cast<double>(dT.Get()) / static_cast<double>(Time::Microsecond);
+	double const minimumStep = static_cast<double>(settings.m_minimumStep.Get()) / static_cast<double>(Time::Microsecond);
+	double const maximumStep = static_cast<double>(settings.m_maximumStep.Get()) / static_cast<double>(Time::Microsecond);
+
+	double step = (0 < body.m_stepSize.Get()) ? static_cast<double>(body.m_stepSize.Get()) / static_cast<double>(Time::Microsecond) : maximumStep;
+	step = std::clamp(step, minimumStep, maximumStep);
+
+	TVector3<T> acceleration = model.ComputeAcceleration(0.0, body.m_positionDeviation);
+
+	double time = 0.0;
+
+	while (time < end)
+	{
+		// The last step is shortened to end the integration, without disturbing the step size carried to the next integration.
+		double const thisStep = std::min(step, end - time);
+		bool const isMinimumStep = (thisStep <= minimumStep);
+
+		// A step at the minimum size is accepted whatever its error.
+		T const error = StepDormandPrince54(model, body, time, thisStep, settings.m_tolerance, isMinimumStep, acceleration);
+
+		++body.m_stepCount;
+
+		// Standard controller: scale by the fifth root of the inverse error, with a safety factor, within [0.2, 5] per step.
+		double const scale = (T(0) < error) ? std::clamp(0.9 * pow(static_cast<double>(error), -0.2), 0.2, 5.0) : 5.0;
+
+		if ((error <= T(1)) || isMinimumStep)
+		{
+			time = (thisStep == end - time) ? end : time + thisStep;
+
+			if (model.RectifyIfDeviated(time, settings.m_rectificationRatio))
+				acceleration = model.ComputeAcceleration(time, body.m_positionDeviation);
+
+			if (thisStep < step)
+				continue; // The shortened last step says nothing about the step size.
+		}
+
+		step = std::clamp(thisStep * scale, minimumStep, maximumStep);
+	}
+
+	body.m_stepSize = std::max<int64_t>(1, llround(step * static_cast<double>(Time::Microsecond)));
+}
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+namespace Integrator // -----------------------------------------------------------------------------------------------------------
+{
+
+template<typename T>
+void Initialize(TBody<T> & body, T gravityParameter, TVector3<T> const& position, TVector3<T> const& velocity)
+{
+	body.m_elements.Compute(gravityParameter, position, velocity);
+	body.m_meanAnomaly = body.m_elements.TrueToMeanAnomaly(body.m_elements.ComputeTrueAnomaly(position));
+	body.m_positionDeviation = TVector3<T>::Zero();
+	body.m_velocityDeviation = TVector3<T>::Zero();
+	body.m_position = position;
+	body.m_velocity = velocity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void Integrate(T gravityParameter, std::span<TBody<T>> bodies, Time::Microseconds dT, TSettings<T> const& settings,
+	TAccelerationFunction<T> const& accelerationFunction)
+{
+	API_ASSERT_THROW(settings.m_method < Method::Count, RESULT_CODE_INVALID_PARAMETER, "Unrecognized integration method");
+	API_ASSERT_THROW((0 < settings.m_minimumStep.Get()) && (settings.m_minimumStep.Get() <= settings.m_maximumStep.Get()),
+		RESULT_CODE_INVALID_PARAMETER, "Steps must satisfy 0 < minimum step <= maximum step");
+	API_ASSERT_THROW((T(0) < settings.m_tolerance) && (T(0) < settings.m_rectificationRatio), RESULT_CODE_INVALID_PARAMETER,
+		"Tolerance and rectification ratio must be positive");
+	API_ASSERT_THROW(0 <= dT.Get(), RESULT_CODE_INVALID_PARAMETER, "Time step must not be negative");
+
+	double const end = static_cast<double>(dT.Get()) / static_cast<double>(Time::Microsecond);
+
+	for (size_t index = 0; index < bodies.size(); ++index)
+	{
+		TBody<T> & body = bodies[index];
+
+		body.m_stepCount = 0;
+		body.m_rectificationCount = 0;
+
+		TDeviationModel<T> model(gravityParameter, body, index, accelerationFunction);
+
+		bool const isCoasting = (TVector3<T>::Zero() == body.m_acceleration) && !accelerationFunction;
+
+		// A zero time step leaves the body in place, and only writes its outputs.
+		if (0 < dT.Get())
+		{
+			if (isCoasting)
+			{
+				// Without acceleration the body follows a conic exactly: the conic through its state, one analytic step.
+				if ((TVector3<T>::Zero() != body.m_positionDeviation) || (TVector3<T>::Zero() != body.m_velocityDeviation))
+					model.Rectify(0.0);
+
+				body.m_stepCount = 1;
+			}
+			else if (Method::DormandPrince54 == settings.m_method)
+			{
+				IntegrateAdaptive(model, body, dT, settings);
+			}
+			else
+			{
+				IntegrateFixed(model, body, dT, settings);
+			}
+		}
+
+		model.Finish(end);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template void Initialize(TBody<float> &, float, TVector3<float> const&, TVector3<float> const&);
+template void Initialize(TBody<double> &, double, TVector3<double> const&, TVector3<double> const&);
+template void Integrate(float, std::span<TBody<float>>, Time::Microseconds, TSettings<float> const&, TAccelerationFunction<float> const&);
+template void Integrate(double, std::span<TBody<double>>, Time::Microseconds, TSettings<double> const&, TAccelerationFunction<double> const&);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+IntegratorTestScript::IntegratorTestScript() :
+	ITestScript("Integrator")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+IntegratorTestScript::~IntegratorTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void IntegratorTestScript::RunImpl(TestHandler & testHandler)
+{
+	static constexpr double gravityParameter = 1.0;
+	static constexpr double radius = 0.5;
+
+	Vector3d const position(radius, 0.0, 0.0);
+	Vector3d const velocity(0.0, sqrt(gravityParameter / radius), 0.0);
+
+	Bodyd initialBody;
+	Initialize(initialBody, gravityParameter, position, velocity);
+
+	Time::Microseconds const dT = initialBody.m_elements.m_period.Get() / 4;
+	Vector3d const thrust(0.0, 2e-2, 0.0); // Prograde, a few percent of gravity.
+
+	// Reference: the full motion under gravity and thrust, integrated in many small classic Runge-Kutta steps (Cowell's method).
+	Vector3d referencePosition = position;
+	Vector3d referenceVelocity = velocity;
+	{
+		auto const computeAcceleration = [&](Vector3d const& atPosition)
+		{
+			double const squareDistance = atPosition.SqareMagnitude();
+			return atPosition * (-gravityParameter / (squareDistance * sqrt(squareDistance))) + thrust;
+		};
+
+		static constexpr int kStepCount = 20000;
+		double const step = static_cast<double>(dT.Get()) / Time::Microsecond / kStepCount;
+
+		for (int index = 0; index < kStepCount; ++index)
+		{
+			Vector3d const k1r = referenceVelocity;
+			Vector3d const k1v = computeAcceleration(referencePosition);
+			Vector3d const k2r = referenceVelocity + k1v * (0.5 * step);
+			Vector3d const k2v = computeAcceleration(referencePosition + k1r * (0.5 * step));
+			Vector3d const k3r = referenceVelocity + k2v * (0.5 * step);
+			Vector3d const k3v = computeAcceleration(referencePosition + k2r * (0.5 * step));
+			Vector3d const k4r = referenceVelocity + k3v * step;
+			Vector3d const k4v = computeAcceleration(referencePosition + k3r * step);
+
+			referencePosition += (k1r + (k2r + k3r) * 2.0 + k4r) * (step / 6.0);
+			referenceVelocity += (k1v + (k2v + k3v) * 2.0 + k4v) * (step / 6.0);
+		}
+	}
+
+	// Every method follows the thrusting body, coasting bodies take one analytic step, and the deviation is rectified as it grows.
+	static constexpr std::array<char const*, static_cast<size_t>(Method::Count)> kMethodNames = { "RK4", "DOPRI", "Verlet", "Yoshida" };
+
+	for (uint8_t methodIndex = 0; methodIndex < static_cast<uint8_t>(Method::Count); ++methodIndex)
+	{
+		Settingsd settings;
+		settings.m_method = static_cast<Method>(methodIndex);
+		settings.m_maximumStep = dT.Get() / 200;
+		settings.m_tolerance = 1e-10;
+		settings.m_rectificationRatio = 1e-3;
+
+		std::array<Bodyd, 2> bodies = { initialBody, initialBody };
+		bodies[0].m_acceleration = thrust;
+
+		Integrate(gravityParameter, std::span<Bodyd>(bodies), dT, settings);
+
+		char const*const name = kMethodNames[methodIndex];
+		double const tolerance = (Method::VelocityVerlet == settings.m_method) ? 1e-8 : 1e-14;
+
+		testHandler.Assert((bodies[0].m_position - referencePosition).SqareMagnitude() < tolerance, true,
+			Fmt::Format("{} position matches reference", name));
+		testHandler.Assert((bodies[0].m_velocity - referenceVelocity).SqareMagnitude() < tolerance, true,
+			Fmt::Format("{} velocity matches reference", name));
+		testHandler.Assert(0 < bodies[0].m_rectificationCount, true, Fmt::Format("{} rectifies the thrusting body", name));
+		testHandler.Assert(bodies[1].m_stepCount, 1u, Fmt::Format("{} coasting body takes one step", name));
+	}
+
+	// Adaptive steps: thrust that turns on halfway through needs small steps only around the switch, and a float body follows the
+	// double body to float precision.
+	Settingsd adaptiveSettings;
+	adaptiveSettings.m_maximumStep = dT;
+	adaptiveSettings.m_tolerance = 1e-8;
+
+	Bodyd switchedBody = initialBody;
+	Integrate<double>(gravityParameter, std::span<Bodyd>(&switchedBody, 1), dT, adaptiveSettings, [&](size_t, double time, Vector3d const&)
+	{
+		return (2.0 * time < static_cast<double>(dT.Get()) / Time::Microsecond) ? Vector3d::Zero() : thrust;
+	});
+
+	testHandler.Assert((1 < switchedBody.m_stepCount) && (switchedBody.m_stepCount < 200), true, "Adaptive steps follow the acceleration");
+
+	Settings floatSettings;
+	floatSettings.m_maximumStep = dT;
+	floatSettings.m_tolerance = 1e-5f;
+
+	Body floatBody;
+	Initialize(floatBody, static_cast<float>(gravityParameter), Vector3(position), Vector3(velocity));
+	floatBody.m_acceleration = Vector3(thrust);
+
+	Integrate(static_cast<float>(gravityParameter), std::span<Body>(&floatBody, 1), dT, floatSettings);
+
+	testHandler.Assert((Vector3d(floatBody.m_position) - referencePosition).SqareMagnitude() < 1e-8, true, "Float body matches reference");
+
+	bool isException;
+	try
+	{
+		Settingsd invalidSettings;
+		invalidSettings.m_minimumStep = 0;
+
+		Integrate(gravityParameter, std::span<Bodyd>(&switchedBody, 1), dT, invalidSettings);
+		isException = false;
+	}
+	catch (ApiException const&)
+	{
+		isException = true;
+	}
+	testHandler.Assert(isException, true, "Invalid settings cause exception");
+}
+
+} // namespace Integrator ---------------------------------------------------------------------------------------------------------
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
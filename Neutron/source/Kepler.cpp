@@ -0,0 +1,549 @@
+#include "Kepler.h"
+
+#include "Constants.h"
+#include "Exception.h"
+#include "TestHandler.h"
+
+namespace // detail
+{
+
+using namespace Neutron;
+
+constexpr size_t	kTableEccentricityCount	= 33;	// Table rows: eccentricities 0, 1/32, ..., 1.
+constexpr size_t	kTableMeanAnomalyCount	= 65;	// Table columns: mean anomalies 0, Pi/64, ..., Pi.
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> One Halley step towards the root of the elliptic Kepler equation. </summary>
+inline double HalleyEllipticStep(double eccentricAnomaly, double meanAnomaly, double eccentricity)
+{
+	double const sinE = sin(eccentricAnomaly);
+	double const cosE = cos(eccentricAnomaly);
+
+	double const f = eccentricAnomaly - (eccentricity * sinE) - meanAnomaly;
+	double const df = 1.0 - (eccentricity * cosE);
+	double const ddf = eccentricity * sinE;
+
+	return f / (df - (0.5 * f * ddf / df));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> One Halley step towards the root of the hyperbolic Kepler equation. </summary>
+inline double HalleyHyperbolicStep(double hyperbolicAnomaly, double meanAnomaly, double eccentricity)
+{
+	double const sinhF = sinh(hyperbolicAnomaly);
+	double const coshF = cosh(hyperbolicAnomaly);
+
+	double const f = (eccentricity * sinhF) - hyperbolicAnomaly - meanAnomaly;
+	double const df = (eccentricity * coshF) - 1.0;
+	double const ddf = eccentricity * sinhF;
+
+	return f / (df - (0.5 * f * ddf / df));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline double HyperbolicStarter(double meanAnomaly, double eccentricity)
+{
+	return std::copysign(log((2.0 * fabs(meanAnomaly) / eccentricity) + 1.8), meanAnomaly);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+inline double EllipticStarter(double meanAnomaly, double eccentricity)
+{
+	return meanAnomaly + std::copysign(0.85 * eccentricity, sin(meanAnomaly)); // Danby's starter, valid for any mean anomaly.
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+double SolveEllipticTolerance(double meanAnomaly, double eccentricity)
+{
+	double eccentricAnomaly = EllipticStarter(meanAnomaly, eccentricity);
+
+	for (int i = 0; i < Kepler::kMaxIterations; ++i)
+	{
+		double const delta = HalleyEllipticStep(eccentricAnomaly, meanAnomaly, eccentricity);
+		eccentricAnomaly -= delta;
+
+		if (fabs(delta) < Kepler::kTolerance)
+			break;
+	}
+
+	return eccentricAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> x - sin(x), summed as a series below |x| = 1, where the difference would cancel. </returns>
+inline double XMinusSinX(double x)
+{
+	if (1.0 <= fabs(x))
+		return x - sin(x);
+
+	double const x2 = x * x;
+	double term = x * x2 / 6.0;
+	double sum = term;
+
+	// x - sin(x) = x^3 / 3! - x^5 / 5! + x^7 / 7! - ...
+	for (int k = 2; fabs(term) > kEps * fabs(sum); ++k)
+	{
+		term *= -x2 / static_cast<double>(2 * k * ((2 * k) + 1));
+		sum += term;
+	}
+
+	return sum;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> sinh(x) - x, summed as a series below |x| = 1, where the difference would cancel. </returns>
+inline double SinhXMinusX(double x)
+{
+	if (1.0 <= fabs(x))
+		return sinh(x) - x;
+
+	double const x2 = x * x;
+	double term = x * x2 / 6.0;
+	double sum = term;
+
+	// sinh(x) - x = x^3 / 3! + x^5 / 5! + x^7 / 7! + ...
+	for (int k = 2; fabs(term) > kEps * fabs(sum); ++k)
+	{
+		term *= x2 / static_cast<double>(2 * k * ((2 * k) + 1));
+		sum += term;
+	}
+
+	return sum;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Kepler's equation in series form: M = (1 - e) * E + e * (E - sin(E)), or M = (e - 1) * F + e * (sinh(F) - F). </summary>
+inline double NearParabolicEquation(double anomaly, double eccentricity)
+{
+	return (eccentricity < 1.0) ? (((1.0 - eccentricity) * anomaly) + (eccentricity * XMinusSinX(anomaly))) :
+		(((eccentricity - 1.0) * anomaly) + (eccentricity * SinhXMinusX(anomaly)));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> One Halley step towards the root of Kepler's equation in series form. </summary>
+inline double HalleyNearParabolicStep(double anomaly, double meanAnomaly, double eccentricity)
+{
+	bool const isElliptic = (eccentricity < 1.0);
+
+	// 1 - cos(E) = 2 * sin^2(E / 2) and cosh(F) - 1 = 2 * sinh^2(F / 2), without cancellation.
+	double const halfSine = isElliptic ? sin(0.5 * anomaly) : sinh(0.5 * anomaly);
+
+	double const f = NearParabolicEquation(anomaly, eccentricity) - meanAnomaly;
+	double const df = fabs(1.0 - eccentricity) + (2.0 * eccentricity * halfSine * halfSine);
+	double const ddf = eccentricity * (isElliptic ? sin(anomaly) : sinh(anomaly));
+
+	return f / (df - (0.5 * f * ddf / df));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> The root of the cubic approximation of Kepler's equation near e = 1, M = |1 - e| * x + e * x^3 / 6 (Cardano). </summary>
+inline double NearParabolicStarter(double meanAnomaly, double eccentricity)
+{
+	double const p = 6.0 * fabs(1.0 - eccentricity) / eccentricity;
+	double const halfQ = -3.0 * meanAnomaly / eccentricity;
+	double const root = sqrt((halfQ * halfQ) + (p * p * p / 27.0));
+
+	return cbrt(root - halfQ) - cbrt(root + halfQ);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Eccentric anomalies over the closed orbit domain [0, 1] x [0, Pi], the starters of the StarterTable method. </summary>
+class StarterTable
+{
+public:
+	StarterTable()
+	{
+		for (size_t row = 0; row < kTableEccentricityCount; ++row)
+		{
+			double const eccentricity = static_cast<double>(row) / static_cast<double>(kTableEccentricityCount - 1);
+
+			for (size_t column = 0; column < kTableMeanAnomalyCount; ++column)
+			{
+				double const meanAnomaly = kPI * static_cast<double>(column) / static_cast<double>(kTableMeanAnomalyCount - 1);
+
+				m_eccentricAnomalies[(row * kTableMeanAnomalyCount) + column] = (0 == column) ? 0.0 :
+					SolveEllipticTolerance(meanAnomaly, eccentricity);
+			}
+		}
+	}
+
+	/// <returns> The bilinearly interpolated eccentric anomaly of a mean anomaly in [0, Pi]. </returns>
+	double Lookup(double meanAnomaly, double eccentricity) const
+	{
+		double const u = meanAnomaly * (static_cast<double>(kTableMeanAnomalyCount - 1) / kPI);
+		double const v = eccentricity * static_cast<double>(kTableEccentricityCount - 1);
+
+		size_t const column = std::min(static_cast<size_t>(u), kTableMeanAnomalyCount - 2);
+		size_t const row = std::min(static_cast<size_t>(v), kTableEccentricityCount - 2);
+
+		double const fu = u - static_cast<double>(column);
+		double const fv = v - static_cast<double>(row);
+
+		double const* pRow = &m_eccentricAnomalies[(row * kTableMeanAnomalyCount) + column];
+		double const lower = pRow[0] + (fu * (pRow[1] - pRow[0]));
+		double const upper = pRow[kTableMeanAnomalyCount] + (fu * (pRow[kTableMeanAnomalyCount + 1] - pRow[kTableMeanAnomalyCount]));
+
+		return lower + (fv * (upper - lower));
+	}
+
+private:
+	std::array<double, kTableEccentricityCount * kTableMeanAnomalyCount>	m_eccentricAnomalies;
+};
+
+StarterTable const	s_starterTable;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void AssertBatchSizes(size_t inputCount, size_t eccentricityCount, size_t outputCount)
+{
+	API_ASSERT_THROW((inputCount == outputCount) && (eccentricityCount == outputCount), RESULT_CODE_INVALID_PARAMETER,
+		Fmt::Format("Mismatched batch sizes: {} mean anomalies, {} eccentricities, {} anomalies", inputCount, eccentricityCount, outputCount));
+}
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+namespace Kepler // ---------------------------------------------------------------------------------------------------------------
+{
+
+template<Method NMethod>
+double SolveElliptic(double meanAnomaly, double eccentricity)
+{
+	if constexpr (Method::FixedHalley == NMethod)
+	{
+		double eccentricAnomaly = EllipticStarter(meanAnomaly, eccentricity);
+
+		for (int i = 0; i < kFixedHalleyIterations; ++i)
+			eccentricAnomaly -= HalleyEllipticStep(eccentricAnomaly, meanAnomaly, eccentricity);
+
+		return eccentricAnomaly;
+	}
+	else if constexpr (Method::StarterTable == NMethod)
+	{
+		// Reduce the mean anomaly to [0, Pi] using E(M + 2 Pi k) = E(M) + 2 Pi k and E(2 Pi - M) = 2 Pi - E(M).
+		double const wrapped = meanAnomaly - (kPI2 * floor(meanAnomaly / kPI2));
+		bool const isUpperHalf = (kPI < wrapped);
+		double const reduced = isUpperHalf ? (kPI2 - wrapped) : wrapped;
+
+		double const starter = s_starterTable.Lookup(reduced, eccentricity);
+		double eccentricAnomaly = (isUpperHalf ? (kPI2 - starter) : starter) + (meanAnomaly - wrapped);
+
+		for (int i = 0; i < kStarterNewtonIterations; ++i)
+		{
+			double const f = eccentricAnomaly - (eccentricity * sin(eccentricAnomaly)) - meanAnomaly;
+			eccentricAnomaly -= f / (1.0 - (eccentricity * cos(eccentricAnomaly)));
+		}
+
+		return eccentricAnomaly;
+	}
+	else
+	{
+		return SolveEllipticTolerance(meanAnomaly, eccentricity);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<Method NMethod>
+double SolveHyperbolic(double meanAnomaly, double eccentricity)
+{
+	double hyperbolicAnomaly = HyperbolicStarter(meanAnomaly, eccentricity);
+
+	if constexpr (Method::Tolerance == NMethod)
+	{
+		for (int i = 0; i < kMaxIterations; ++i)
+		{
+			double const delta = HalleyHyperbolicStep(hyperbolicAnomaly, meanAnomaly, eccentricity);
+			hyperbolicAnomaly -= delta;
+
+			if (fabs(delta) < kTolerance * std::max(1.0, fabs(hyperbolicAnomaly)))
+				break;
+		}
+	}
+	else
+	{
+		for (int i = 0; i < kFixedHalleyIterations; ++i)
+			hyperbolicAnomaly -= HalleyHyperbolicStep(hyperbolicAnomaly, meanAnomaly, eccentricity);
+	}
+
+	return hyperbolicAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+double SolveParabolic(double meanAnomaly)
+{
+	double const root = sqrt((9.0 * meanAnomaly * meanAnomaly) + 1.0);
+
+	return cbrt((3.0 * meanAnomaly) + root) + cbrt((3.0 * meanAnomaly) - root);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<Method NMethod>
+double SolveNearParabolic(double meanAnomaly, double eccentricity)
+{
+	// The elliptic equation is reduced to M in [-Pi, Pi] using E(M + 2 Pi k) = E(M) + 2 Pi k.
+	double const revolutions = (eccentricity < 1.0) ? (kPI2 * round(meanAnomaly / kPI2)) : 0.0;
+	double const reduced = meanAnomaly - revolutions;
+
+	double anomaly = NearParabolicStarter(reduced, eccentricity);
+
+	// Far from periapsis the hyperbolic cubic overshoots: the logarithmic starter is then nearer.
+	if (1.0 < eccentricity)
+		anomaly = std::copysign(std::min(fabs(anomaly), fabs(HyperbolicStarter(reduced, eccentricity))), reduced);
+
+	if constexpr (Method::Tolerance == NMethod)
+	{
+		for (int i = 0; i < kMaxIterations; ++i)
+		{
+			double const delta = HalleyNearParabolicStep(anomaly, reduced, eccentricity);
+			anomaly -= delta;
+
+			if (fabs(delta) < kTolerance * std::max(1.0, fabs(anomaly)))
+				break;
+		}
+	}
+	else
+	{
+		for (int i = 0; i < kFixedHalleyIterations; ++i)
+			anomaly -= HalleyNearParabolicStep(anomaly, reduced, eccentricity);
+	}
+
+	return anomaly + revolutions;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+double NearParabolicMeanAnomaly(double anomaly, double eccentricity)
+{
+	return NearParabolicEquation(anomaly, eccentricity);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<Method NMethod>
+void SolveElliptic(std::span<double const> meanAnomalies, std::span<double const> eccentricities, std::span<double> eccentricAnomalies)
+{
+	AssertBatchSizes(meanAnomalies.size(), eccentricities.size(), eccentricAnomalies.size());
+
+	size_t const count = eccentricAnomalies.size();
+	for (size_t index = 0; index < count; ++index)
+		eccentricAnomalies[index] = SolveElliptic<NMethod>(meanAnomalies[index], eccentricities[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<Method NMethod>
+void SolveHyperbolic(std::span<double const> meanAnomalies, std::span<double const> eccentricities, std::span<double> hyperbolicAnomalies)
+{
+	AssertBatchSizes(meanAnomalies.size(), eccentricities.size(), hyperbolicAnomalies.size());
+
+	size_t const count = hyperbolicAnomalies.size();
+	for (size_t index = 0; index < count; ++index)
+		hyperbolicAnomalies[index] = SolveHyperbolic<NMethod>(meanAnomalies[index], eccentricities[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void SolveParabolic(std::span<double const> meanAnomalies, std::span<double> parabolicAnomalies)
+{
+	AssertBatchSizes(meanAnomalies.size(), parabolicAnomalies.size(), parabolicAnomalies.size());
+
+	size_t const count = parabolicAnomalies.size();
+	for (size_t index = 0; index < count; ++index)
+		parabolicAnomalies[index] = SolveParabolic(meanAnomalies[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<Method NMethod>
+void SolveNearParabolic(std::span<double const> meanAnomalies, std::span<double const> eccentricities, std::span<double> anomalies)
+{
+	AssertBatchSizes(meanAnomalies.size(), eccentricities.size(), anomalies.size());
+
+	size_t const count = anomalies.size();
+	for (size_t index = 0; index < count; ++index)
+		anomalies[index] = SolveNearParabolic<NMethod>(meanAnomalies[index], eccentricities[index]);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template double SolveElliptic<Method::FixedHalley>(double, double);
+template double SolveElliptic<Method::StarterTable>(double, double);
+template double SolveElliptic<Method::Tolerance>(double, double);
+
+template double SolveHyperbolic<Method::FixedHalley>(double, double);
+template double SolveHyperbolic<Method::StarterTable>(double, double);
+template double SolveHyperbolic<Method::Tolerance>(double, double);
+
+template double SolveNearParabolic<Method::FixedHalley>(double, double);
+template double SolveNearParabolic<Method::StarterTable>(double, double);
+template double SolveNearParabolic<Method::Tolerance>(double, double);
+
+template void SolveElliptic<Method::FixedHalley>(std::span<double const>, std::span<double const>, std::span<double>);
+template void SolveElliptic<Method::StarterTable>(std::span<double const>, std::span<double const>, std::span<double>);
+template void SolveElliptic<Method::Tolerance>(std::span<double const>, std::span<double const>, std::span<double>);
+
+template void SolveHyperbolic<Method::FixedHalley>(std::span<double const>, std::span<double const>, std::span<double>);
+template void SolveHyperbolic<Method::StarterTable>(std::span<double const>, std::span<double const>, std::span<double>);
+template void SolveHyperbolic<Method::Tolerance>(std::span<double const>, std::span<double const>, std::span<double>);
+
+template void SolveNearParabolic<Method::FixedHalley>(std::span<double const>, std::span<double const>, std::span<double>);
+template void SolveNearParabolic<Method::StarterTable>(std::span<double const>, std::span<double const>, std::span<double>);
+template void SolveNearParabolic<Method::Tolerance>(std::span<double const>, std::span<double const>, std::span<double>);
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+KeplerTestScript::KeplerTestScript() :
+	ITestScript("Kepler")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+KeplerTestScript::~KeplerTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void KeplerTestScript::RunImpl(TestHandler & testHandler)
+{
+	// Mean anomalies over two revolutions, in both directions, for eccentricities up to 0.95.
+	std::vector<double> meanAnomalies, eccentricities;
+	for (int eccentricityIndex = 0; eccentricityIndex <= 19; ++eccentricityIndex)
+	{
+		for (int meanAnomalyIndex = -40; meanAnomalyIndex <= 40; ++meanAnomalyIndex)
+		{
+			meanAnomalies.push_back(0.157 * meanAnomalyIndex);
+			eccentricities.push_back(0.05 * eccentricityIndex);
+		}
+	}
+
+	size_t const count = meanAnomalies.size();
+	std::vector<double> anomalies(count);
+
+	auto const ellipticResidual = [&](size_t index)
+	{
+		return fabs(anomalies[index] - (eccentricities[index] * sin(anomalies[index])) - meanAnomalies[index]);
+	};
+
+	SolveElliptic<Method::Tolerance>(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index) { return ellipticResidual(index) < 1e-12; }, TestHandler::FRangeIndex(),
+		[](size_t) { return true; }, "Elliptic tolerance method residual", { 0, count - 1 });
+
+	SolveElliptic<Method::FixedHalley>(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index) { return ellipticResidual(index) < 1e-12; }, TestHandler::FRangeIndex(),
+		[](size_t) { return true; }, "Elliptic fixed Halley method residual", { 0, count - 1 });
+
+	SolveElliptic<Method::StarterTable>(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index) { return ellipticResidual(index) < 1e-8; }, TestHandler::FRangeIndex(),
+		[](size_t) { return true; }, "Elliptic starter table method residual", { 0, count - 1 });
+
+	testHandler.Assert<bool, size_t>([&](size_t index)
+	{
+		return anomalies[index] == SolveElliptic<Method::StarterTable>(meanAnomalies[index], eccentricities[index]);
+
+	}, TestHandler::FRangeIndex(), [](size_t) { return true; }, "Batched solutions equal single solutions", { 0, count - 1 });
+
+	// Hyperbolic orbits.
+	for (double & eccentricity : eccentricities)
+		eccentricity += 1.1;
+
+	auto const hyperbolicResidual = [&](size_t index)
+	{
+		return fabs((eccentricities[index] * sinh(anomalies[index])) - anomalies[index] - meanAnomalies[index]) /
+			std::max(1.0, fabs(meanAnomalies[index]));
+	};
+
+	SolveHyperbolic<Method::Tolerance>(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index) { return hyperbolicResidual(index) < 1e-12; }, TestHandler::FRangeIndex(),
+		[](size_t) { return true; }, "Hyperbolic tolerance method residual", { 0, count - 1 });
+
+	SolveHyperbolic<Method::FixedHalley>(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index) { return hyperbolicResidual(index) < 1e-9; }, TestHandler::FRangeIndex(),
+		[](size_t) { return true; }, "Hyperbolic fixed Halley method residual", { 0, count - 1 });
+
+	// Parabolic orbits.
+	SolveParabolic(meanAnomalies, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index)
+	{
+		double const parabolicAnomaly = anomalies[index];
+		return fabs((0.5 * parabolicAnomaly) + (parabolicAnomaly * parabolicAnomaly * parabolicAnomaly / 6.0) - meanAnomalies[index]) <
+			1e-12 * std::max(1.0, fabs(meanAnomalies[index]));
+
+	}, TestHandler::FRangeIndex(), [](size_t) { return true; }, "Parabolic residual", { 0, count - 1 });
+
+	// Near-parabolic orbits, either side of e = 1, down to the small mean anomalies at which the standard forms cancel.
+	meanAnomalies.clear();
+	eccentricities.clear();
+
+	for (double const eccentricity : { 0.9, 0.95, 0.99, 0.999, 0.99999, 1.00001, 1.001, 1.01, 1.05, 1.1 })
+	{
+		for (int meanAnomalyIndex = -40; meanAnomalyIndex <= 40; ++meanAnomalyIndex)
+		{
+			meanAnomalies.push_back(0.157 * meanAnomalyIndex);
+			eccentricities.push_back(eccentricity);
+		}
+
+		for (double const meanAnomaly : { 1e-12, -1e-9, 1e-6, -1e-3 })
+		{
+			meanAnomalies.push_back(meanAnomaly);
+			eccentricities.push_back(eccentricity);
+		}
+	}
+
+	size_t const nearCount = meanAnomalies.size();
+	anomalies.resize(nearCount);
+
+	SolveNearParabolic(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index)
+	{
+		return fabs(NearParabolicMeanAnomaly(anomalies[index], eccentricities[index]) - meanAnomalies[index]) <=
+			1e-12 * fabs(meanAnomalies[index]);
+
+	}, TestHandler::FRangeIndex(), [](size_t) { return true; }, "Near-parabolic residual relative to the mean anomaly", { 0, nearCount - 1 });
+
+	testHandler.Assert<bool, size_t>([&](size_t index)
+	{
+		double const anomaly = anomalies[index];
+		double const eccentricity = eccentricities[index];
+		double const meanAnomaly = (eccentricity < 1.0) ? (anomaly - (eccentricity * sin(anomaly))) : ((eccentricity * sinh(anomaly)) - anomaly);
+
+		return fabs(meanAnomaly - meanAnomalies[index]) < 1e-12 * std::max(1.0, fabs(meanAnomalies[index]));
+
+	}, TestHandler::FRangeIndex(), [](size_t) { return true; }, "Near-parabolic solutions satisfy the standard forms", { 0, nearCount - 1 });
+
+	testHandler.Assert<bool, size_t>([&](size_t index)
+	{
+		return anomalies[index] == SolveNearParabolic(meanAnomalies[index], eccentricities[index]);
+
+	}, TestHandler::FRangeIndex(), [](size_t) { return true; }, "Batched near-parabolic solutions equal single solutions", { 0, nearCount - 1 });
+
+	SolveNearParabolic<Method::FixedHalley>(meanAnomalies, eccentricities, anomalies);
+	testHandler.Assert<bool, size_t>([&](size_t index)
+	{
+		return fabs(NearParabolicMeanAnomaly(anomalies[index], eccentricities[index]) - meanAnomalies[index]) <=
+			1e-12 * fabs(meanAnomalies[index]);
+
+	}, TestHandler::FRangeIndex(), [](size_t) { return true; }, "Near-parabolic fixed Halley method residual", { 0, nearCount - 1 });
+}
+
+} // namespace Kepler -------------------------------------------------------------------------------------------------------------
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -3,12 +3,24 @@
 // Include all project headers for library building.
 //#include "PhysicsEngine.h"
 #include "Vector3.h"
+#include "Vector3Pack.h"
 #include "NeutronTime.h"
 #include "OrbitalSystem.h"
 #include "OrbitalSystem2.h"
+#include "ScaledSpaceTree.h"
+#include "SpatialHashGrid.h"
+#include "SimulationSnapshot.h"
+#include "SnapshotFile.h"
+#include "ReplayLog.h"
 #include "ScalingSpace.h"
 #include "Particle.h"
 #include "Orbit.h"
+#include "Kepler.h"
+#include "ClosestApproach.h"
+#include "Perturbation.h"
+#include "Integrator.h"
+#include "ParticleStore.h"
+#include "TaskPool.h"
 
 #include "NebulaTypes.h" // For pool testing.
 
@@ -21,11 +33,23 @@ void AddTests(Nebula::TestHandler & testHandler)
 
 	//testHandler.Register(MakeShared<PhysicsEngineTestScript>());
 	testHandler.Register(MakeShared<Vector3TestScript>(), "Neutron");
+	testHandler.Register(MakeShared<Vector3PackTestScript>(), "Neutron");
 	testHandler.Register(MakeShared<Time::TimeTestScript>(), "Neutron");
 	testHandler.Register(MakeShared<OrbitalSystemTestScript>(), "Neutron");
 	testHandler.Register(MakeShared<OrbitalSystem2TestScript>(), "Neutron");
+	testHandler.Register(MakeShared<ScaledSpaceTreeTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<SpatialHashGridTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<SimulationSnapshotTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<SnapshotFileTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<ReplayLogTestScript>(), "Neutron");
 	testHandler.Register(MakeShared<ScalingSpaceTestScript>(), "Neutron");
 	testHandler.Register(MakeShared<OrbitTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<Kepler::KeplerTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<ClosestApproach::ClosestApproachTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<Perturbation::PerturbationTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<Integrator::IntegratorTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<ParticleStoreTestScript>(), "Neutron");
+	testHandler.Register(MakeShared<TaskPoolTestScript>(), "Neutron");
 
 	// Pool testing.
 	std::pmr::pool_options poolOptions;
@@ -74,6 +74,30 @@ void TimeTestScript::RunImpl(TestHandler & testHandler)
 	testHandler.Assert<Seconds, size_t>([](size_t index) { return Seconds(index) - Seconds(index); }, TestHandler::FRangeIndex(),
 		TestHandler::FRangeZero(), "operator-", { 0, 1000, 100 });
 
+	// Simulation clock: a 144 Hz frame rate over 10 Hz ticks.
+	SimulationClock clock(100000, 4);
+
+	uint32_t tickCount = 0;
+	for (int frame = 0; frame < 144; ++frame)
+		tickCount += clock.Advance(6944);
+
+	testHandler.Assert(tickCount, 9u, "Ticks due after 144 frames");
+	testHandler.Assert(clock.GetTime(), Microseconds(900000), "Simulation time after 144 frames");
+	testHandler.Assert(clock.GetRenderTime(), Microseconds(144 * 6944), "Render time after 144 frames");
+	testHandler.Assert(clock.GetInterpolationFactor() < 1.0, true, "Interpolation factor is less than one tick");
+
+	// No drift: every microsecond advanced is either consumed by a tick or held in the remainder.
+	for (int frame = 0; frame < 1000000; ++frame)
+		clock.Advance(6944);
+
+	testHandler.Assert(clock.GetRenderTime(), Microseconds(1000144ll * 6944), "Render time after 1,000,144 frames");
+
+	// A long frame drops the ticks beyond the limit.
+	SimulationClock stalledClock(100000, 4);
+
+	testHandler.Assert(stalledClock.Advance(1050000), 4u, "Ticks due after a long frame are limited");
+	testHandler.Assert(stalledClock.GetRenderTime(), Microseconds(450000), "Dropped ticks are discarded");
+
 	return;
 
 	Seconds seconds1(1);
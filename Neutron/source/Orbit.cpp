@@ -1,113 +1,443 @@
 #include "Orbit.h"
 
-#include "ScalingSpace.h"
+#include "Constants.h"
+#include "Vector3Pack.h"
 
-namespace Neutron // --------------------------------------------------------------------------------------------------------------
+namespace // detail
 {
 
-Orbit::Orbit() :
-	m_sections(1),
-	m_currentSectionIndex(0),
-	m_trueAnomaly(0.0)
+/// <summary>
+/// Compute the elements of NWidth orbits at once. All arithmetic is performed on FloatPack lanes with branchless orbit type
+/// selection, so every width produces bit-identical results; only the orientation angles (acos) are computed per lane.
+/// </summary>
+template<size_t NWidth>
+void ComputeElementsKernel(float gravityParameter, Neutron::Vector3 const* pPositions, Neutron::Vector3 const* pVelocities,
+	Neutron::Orbit::Elements * pElements)
 {
-	assert(1 == m_sections.size());
-	m_sections.front() = MakeUnique<Section>();
+	using namespace Neutron;
+	using Pack = FloatPack<NWidth>;
+	using Type = Orbit::Type;
+	using Vector3Pack = TVector3Pack<NWidth>;
+
+	Vector3Pack const position = Vector3Pack::Load(pPositions);
+	Vector3Pack const velocity = Vector3Pack::Load(pVelocities);
+
+	Pack const zero(0.f), one(1.f), mu(gravityParameter);
+
+	// Angular momentum (H) = R x V.
+	Pack angularMomentum;
+	Vector3Pack perifocalZ;
+	position.PreciseCross(velocity, angularMomentum, perifocalZ);
+
+	Vector3Pack const angularMomentumVector = perifocalZ * angularMomentum;
+
+	Pack const parameter = angularMomentum * angularMomentum / mu; // Orbit parameter (p) = H^2 / g.
+	Pack const velocityK = mu / angularMomentum;
+	Pack const massK = (mu * mu) / (angularMomentum * angularMomentum * angularMomentum);
+
+	Vector3Pack const positionDirection = position.Normalized();
+
+	// Eccentricity (e) = | ((V X H) / u) - (R / r) |.
+	Pack crossMagnitude;
+	Vector3Pack crossDirection;
+	velocity.PreciseCross(angularMomentumVector, crossMagnitude, crossDirection);
+
+	Vector3Pack const eccentricityVector = ((crossDirection * crossMagnitude) / mu) - positionDirection;
+	Pack const eccentricitySquared = eccentricityVector.Dot(eccentricityVector);
+	Pack eccentricity = Sqrt(eccentricitySquared);
+
+	// Branchless orbit type selection.
+	Pack const isCircle = (eccentricity < Pack(kEccentricityEpsilon));
+	Pack const isEllipse = AndNot(isCircle, eccentricity < Pack(1.f - kEccentricityEpsilon));
+	Pack const isHyperbola = (Pack(1.f + kEccentricityEpsilon) < eccentricity);
+	Pack const isParabola = AndNot(isCircle | isEllipse | isHyperbola, Pack(std::bit_cast<float>(0xFFFFFFFFu)));
+
+	eccentricity = Select(isCircle, zero, eccentricity);
+
+	Vector3Pack const perifocalX = Select(isCircle, positionDirection, eccentricityVector / eccentricity);
+	Vector3Pack const perifocalY = perifocalZ.Cross(perifocalX);
+
+	// Eccentricity term (e').
+	Pack const eccentricityTerm = Select(isCircle, one, Select(isEllipse, one - eccentricitySquared,
+		Select(isHyperbola, eccentricitySquared - one, zero)));
+	Pack const eccentricityTermRoot = Sqrt(eccentricityTerm);
+
+	// A parabola's axes are infinite and it has no period. Its mean motion, in Barker's equation, is sqrt(mu / p^3) = mu^2 / h^3.
+	Pack const infinity(std::numeric_limits<float>::infinity());
+
+	Pack const semiMajor = Select(isParabola, infinity, parameter / eccentricityTerm); // Semi-major axis (a) = p / e'.
+	Pack const semiMinor = Select(isParabola, infinity, semiMajor * eccentricityTermRoot); // Semi-minor axis (b) = a * sqrt(e').
+	Pack const meanMotion = Select(isParabola, massK, massK * eccentricityTerm * eccentricityTermRoot); // Mean motion (n) = mu^2 / h^3 * e'^(3/2).
+	Pack const periodSeconds = Select(isParabola, zero, (Pack(kPI2f) * semiMajor * semiMinor) / angularMomentum); // Orbit period (t) = 2 * Pi * a * b / h.
+
+	// Signed distance (c) from occupied focus to the centre of the perifocal frame: p / (1 + e) - a for closed orbits, + a for hyperbolae.
+	Pack const periapsis = parameter / (one + eccentricity);
+	Pack const centreOffset = Select(isHyperbola, periapsis + semiMajor, Select(isParabola, periapsis, periapsis - semiMajor));
+
+	for (size_t lane = 0; lane < NWidth; ++lane)
+	{
+		Orbit::Elements & elements = pElements[lane];
+
+		API_ASSERT_THROW(0 < angularMomentum[lane], RESULT_CODE_INVALID_PARAMETER,
+			Fmt::Format("Angular momentum evaluated to zero from position ({}), velocity ({}).", pPositions[lane], pVelocities[lane]));
+
+		elements.m_angularMomentum = angularMomentum[lane];
+		elements.m_eccentricity = eccentricity[lane];
+		elements.m_velocityK = velocityK[lane];
+		elements.m_massK = massK[lane];
+		elements.m_meanMotion = meanMotion[lane];
+
+		elements.m_type = (0.f != isCircle[lane]) ? Type::Circle : (0.f != isEllipse[lane]) ? Type::Ellipse :
+			(0.f != isHyperbola[lane]) ? Type::Hyperbola : Type::Parabola;
+
+		elements.m_semiMajor = semiMajor[lane];
+		elements.m_semiMinor = semiMinor[lane];
+		elements.m_centreOffset = centreOffset[lane];
+		elements.m_period = Time::Microseconds::Convert(periodSeconds[lane]);
+		elements.m_parameter = parameter[lane];
+
+		elements.m_perifocalX = perifocalX.Get(lane);
+		elements.m_perifocalY = perifocalY.Get(lane);
+		elements.m_perifocalZ = perifocalZ.Get(lane);
+
+		elements.ComputeOrientation();
+	}
 }
 
-// --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-void Orbit::Elements::Compute(float gravityParameter, Vector3 const& position, Vector3 const& velocity)
+/// <summary> Compute the elements of one orbit. The scalar counterpart of ComputeElementsKernel, for orbits without a SIMD path. </summary>
+template<typename T>
+void ComputeElementsScalar(T gravityParameter, Neutron::TVector3<T> const& position, Neutron::TVector3<T> const& velocity,
+	typename Neutron::TOrbit<T>::Elements & elements)
 {
-	// Angular momentum (H) = R x V.
-	position.PreciseCross(velocity, m_angularMomentum, m_perifocalZ);
+	using namespace Neutron;
+	using Type = TOrbit<T>::Type;
+	using Vector3T = TVector3<T>;
 
-	Vector3 angularMomentumVector = m_angularMomentum * m_perifocalZ;
+	// Angular momentum (H) = R x V.
+	position.PreciseCross(velocity, elements.m_angularMomentum, elements.m_perifocalZ);
 
-	API_ASSERT_THROW(0 < m_angularMomentum, RESULT_CODE_INVALID_PARAMETER,
+	API_ASSERT_THROW(0 < elements.m_angularMomentum, RESULT_CODE_INVALID_PARAMETER,
 		Fmt::Format("Angular momentum evaluated to zero from position ({}), velocity ({}).", position, velocity));
 
-	m_parameter = m_angularMomentum * m_angularMomentum / gravityParameter; // Orbit parameter (p) = H^2 / g.
-	m_velocityK = gravityParameter / m_angularMomentum;
-	m_massK = gravityParameter * gravityParameter / powf(m_angularMomentum, 3.f);
+	Vector3T const angularMomentumVector = elements.m_perifocalZ * elements.m_angularMomentum;
 
-	Vector3 positionDirection = position.Normalized();
+	T const angularMomentum = elements.m_angularMomentum;
+	elements.m_parameter = angularMomentum * angularMomentum / gravityParameter; // Orbit parameter (p) = H^2 / g.
+	elements.m_velocityK = gravityParameter / angularMomentum;
+	elements.m_massK = (gravityParameter * gravityParameter) / (angularMomentum * angularMomentum * angularMomentum);
 
-	Vector3 eccentrictyVector = (velocity.PreciseCross(angularMomentumVector) / gravityParameter) - positionDirection;
-	float eccentricitySquared = eccentrictyVector.SqareMagnitude();
-	m_eccentricity = Maths::Sqrt(eccentricitySquared); // Eccentricity (e) = | ((V X H) / u) - (R / r) |.
+	Vector3T const positionDirection = position.Normalized();
 
-	float eccentricityTerm; // Eccentricity term (e').
-	if (m_eccentricity < kEccentricityEpsilon)
-	{
-		m_eccentricity = 0.f;
-		m_type = Type::Circle;
+	// Eccentricity (e) = | ((V X H) / u) - (R / r) |.
+	Vector3T const eccentricityVector = (velocity.PreciseCross(angularMomentumVector) / gravityParameter) - positionDirection;
+	T const eccentricitySquared = eccentricityVector.Dot(eccentricityVector);
+	elements.m_eccentricity = Maths::Sqrt<T>(eccentricitySquared);
 
-		m_perifocalX = positionDirection;
-		m_perifocalY = m_perifocalZ.Cross(m_perifocalX);
+	T eccentricityTerm; // Eccentricity term (e').
+	if (elements.m_eccentricity < kEccentricityEpsilonOf<T>)
+	{
+		elements.m_eccentricity = 0;
+		elements.m_type = Type::Circle;
+		elements.m_perifocalX = positionDirection;
 
-		eccentricityTerm = 1.f;
+		eccentricityTerm = 1;
 	}
 	else
 	{
-		m_perifocalX = eccentrictyVector / m_eccentricity;
-		m_perifocalY = m_perifocalZ.Cross(m_perifocalX);
+		elements.m_perifocalX = eccentricityVector / elements.m_eccentricity;
 
-		if (m_eccentricity < (1.f - kEccentricityEpsilon))
+		if (elements.m_eccentricity < (1 - kEccentricityEpsilonOf<T>))
 		{
-			m_type = Type::Ellipse;
-			eccentricityTerm = 1.f - eccentricitySquared;
+			elements.m_type = Type::Ellipse;
+			eccentricityTerm = 1 - eccentricitySquared;
 		}
-		else if ((1.f + kEccentricityEpsilon) < m_eccentricity)
+		else if ((1 + kEccentricityEpsilonOf<T>) < elements.m_eccentricity)
 		{
-			m_type = Type::Hyperbola;
-			eccentricityTerm = eccentricitySquared - 1.f;
+			elements.m_type = Type::Hyperbola;
+			eccentricityTerm = eccentricitySquared - 1;
 		}
 		else
 		{
-			assert(false); // TODO - parabolic orbits ...
+			elements.m_type = Type::Parabola;
+			eccentricityTerm = 0;
 		}
 	}
 
-	m_semiMajor = m_parameter / eccentricityTerm; // Semi-major axis (a) = p / e'.
-	m_semiMinor = m_semiMajor * Maths::Sqrt(eccentricityTerm); // Semi-minor axis (b) = a * sqrt(e').
+	elements.m_perifocalY = elements.m_perifocalZ.Cross(elements.m_perifocalX);
+
+	if (Type::Parabola == elements.m_type)
+	{
+		// A parabola's axes are infinite and it has no period. Its mean motion, in Barker's equation, is sqrt(mu / p^3) = mu^2 / h^3.
+		elements.m_semiMajor = std::numeric_limits<T>::infinity();
+		elements.m_semiMinor = std::numeric_limits<T>::infinity();
+		elements.m_meanMotion = elements.m_massK;
+		elements.m_period = 0;
+	}
+	else
+	{
+		T const eccentricityTermRoot = Maths::Sqrt<T>(eccentricityTerm);
+
+		elements.m_semiMajor = elements.m_parameter / eccentricityTerm; // Semi-major axis (a) = p / e'.
+		elements.m_semiMinor = elements.m_semiMajor * eccentricityTermRoot; // Semi-minor axis (b) = a * sqrt(e').
+		elements.m_meanMotion = elements.m_massK * eccentricityTerm * eccentricityTermRoot; // Mean motion (n) = mu^2 / h^3 * e'^(3/2).
+
+		T const periodSeconds = (static_cast<T>(kPI2) * elements.m_semiMajor * elements.m_semiMinor) / angularMomentum; // Orbit period (t) = 2 * Pi * a * b / h.
+		elements.m_period = Time::Microseconds::Convert(periodSeconds);
+	}
+
+	// Signed distance (c) from occupied focus to the centre of the perifocal frame: p / (1 + e) - a for closed orbits, + a for hyperbolae.
+	T const periapsis = elements.m_parameter / (1 + elements.m_eccentricity);
+	elements.m_centreOffset = (Type::Hyperbola == elements.m_type) ? (periapsis + elements.m_semiMajor) :
+		(Type::Parabola == elements.m_type) ? periapsis : (periapsis - elements.m_semiMajor);
+
+	elements.ComputeOrientation();
+}
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+template<typename T>
+TOrbit<T>::TOrbit() :
+	m_sections(1),
+	m_currentSectionIndex(0),
+	m_trueAnomaly(0.0),
+	m_meanAnomaly(0.0)
+{
+	assert(1 == m_sections.size());
+	m_sections.front() = MakeUnique<Section>();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::Initialize(T gravityParameter, Vector3T const& position, Vector3T const& velocity)
+{
+	Elements elements;
+	elements.Compute(gravityParameter, position, velocity);
+
+	Initialize(elements, position);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::Initialize(Elements const& elements, Vector3T const& position)
+{
+	DiscardPrediction();
+
+	Section & section = GetCurrentSection();
+	section.m_elements = elements;
+
+	m_trueAnomaly = elements.ComputeTrueAnomaly(position);
+	m_meanAnomaly = elements.TrueToMeanAnomaly(m_trueAnomaly);
+
+	section.m_trueAnomalyEntry = m_trueAnomaly;
+	section.m_meanAnomalyEntry = m_meanAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::Initialize(Elements const& elements, double meanAnomaly)
+{
+	DiscardPrediction();
+
+	Section & section = GetCurrentSection();
+	section.m_elements = elements;
+
+	m_meanAnomaly = meanAnomaly;
+	m_trueAnomaly = elements.MeanToTrueAnomaly(meanAnomaly);
+
+	section.m_trueAnomalyEntry = m_trueAnomaly;
+	section.m_meanAnomalyEntry = m_meanAnomaly;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+TOrbit<T>::Section & TOrbit<T>::AppendSection()
+{
+	if (0 < m_currentSectionIndex)
+	{
+		m_sections.erase(m_sections.begin(), m_sections.begin() + m_currentSectionIndex);
+		m_currentSectionIndex = 0;
+	}
+
+	return *m_sections.emplace_back(MakeUnique<Section>());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::DiscardPrediction()
+{
+	m_sections.resize(m_currentSectionIndex + 1);
+
+	GetCurrentSection().m_isExitResolved = false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::ComputeElements(T gravityParameter, std::span<Vector3T const> positions, std::span<Vector3T const> velocities,
+	std::span<Elements> elements)
+{
+	API_ASSERT_THROW((positions.size() == elements.size()) && (velocities.size() == elements.size()), RESULT_CODE_INVALID_PARAMETER,
+		Fmt::Format("Mismatched batch sizes: {} positions, {} velocities, {} elements", positions.size(), velocities.size(), elements.size()));
+
+	size_t const count = elements.size();
+	size_t index = 0;
+
+	if constexpr (std::is_same_v<T, float>)
+	{
+		DispatchFloatPack([&]<size_t NWidth>()
+		{
+			for (; (index + NWidth) <= count; index += NWidth)
+				ComputeElementsKernel<NWidth>(gravityParameter, &positions[index], &velocities[index], &elements[index]);
+		});
+
+		for (; index < count; ++index)
+			ComputeElementsKernel<1>(gravityParameter, &positions[index], &velocities[index], &elements[index]);
+	}
+	else
+	{
+		for (; index < count; ++index)
+			ComputeElementsScalar<T>(gravityParameter, positions[index], velocities[index], elements[index]);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::Elements::Compute(T gravityParameter, Vector3T const& position, Vector3T const& velocity)
+{
+	ComputeElements(gravityParameter, std::span<Vector3T const>(&position, 1), std::span<Vector3T const>(&velocity, 1),
+		std::span<Elements>(this, 1));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::Elements::ComputeOrientation()
+{
+	Vector3T const referenceX(kReferenceX), referenceY(kReferenceY), referenceZ(kReferenceZ);
+
+	m_inclination = Vector3T::AngleBetweenUnitVectors(m_perifocalZ, referenceZ); // Inclination (i), the angle between the reference and perifocal Z-axes = acos(Zp DOT Zr)
+	m_ascendingNodeDirection = m_perifocalZ.IsApproxParallel(referenceZ) ? m_perifocalX : referenceZ.Cross(m_perifocalZ).Normalized();
+
+	m_rightAscension = Vector3T::AngleBetweenUnitVectors(m_ascendingNodeDirection, referenceX);
+	if (m_ascendingNodeDirection.Dot(referenceY) < 0)
+		m_rightAscension = static_cast<T>(kPI2) - m_rightAscension;
+
+	m_argumentPeriapsis = Vector3T::AngleBetweenUnitVectors(m_ascendingNodeDirection, m_perifocalX);
+	if (m_ascendingNodeDirection.Dot(m_perifocalY) < 0)
+		m_argumentPeriapsis = static_cast<T>(kPI2) - m_argumentPeriapsis;
+
+	// TODO - orientation ?
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
 
-	float periodSeconds = (kPIf * m_semiMajor * m_semiMinor) / m_angularMomentum; // Orbit period (t) = Pi * a * b / h.
-	m_period = Time::Microseconds::Convert(periodSeconds);
+template<typename T>
+double TOrbit<T>::Elements::ComputeTrueAnomaly(Vector3T const& position) const
+{
+	return atan2(static_cast<double>(position.Dot(m_perifocalY)), static_cast<double>(position.Dot(m_perifocalX)));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+double TOrbit<T>::Elements::TrueToMeanAnomaly(double trueAnomaly) const
+{
+	double const eccentricity = m_eccentricity;
 
-	m_centreOffset = m_parameter / (1.f + m_eccentricity); // Signed distance (c) from occupied focus to the centre of the perifocal frame.
 	switch (m_type)
 	{
-	case Type::Circle: // Fall through ...
+	case Type::Circle:
+		return trueAnomaly;
+
 	case Type::Ellipse:
-		m_centreOffset -= m_semiMajor; // c = p / (1 + e) - a
-		break;
+	{
+		// Eccentric anomaly (E) = 2 * atan(sqrt((1 - e) / (1 + e)) * tan(v / 2)), mean anomaly (M) = E - e * sin(E).
+		double const eccentricAnomaly = 2.0 * atan2(sqrt(1.0 - eccentricity) * sin(0.5 * trueAnomaly),
+			sqrt(1.0 + eccentricity) * cos(0.5 * trueAnomaly));
+
+		if ((1.0 - eccentricity) < Kepler::kNearParabolicBand)
+			return Kepler::NearParabolicMeanAnomaly(eccentricAnomaly, eccentricity);
+
+		return eccentricAnomaly - (eccentricity * sin(eccentricAnomaly));
+	}
 
 	case Type::Parabola:
-		assert(false); // TODO - parabolic orbits ...
+	{
+		// Parabolic anomaly (D) = tan(v / 2), mean anomaly (M) = D / 2 + D^3 / 6.
+		double const parabolicAnomaly = tan(0.5 * trueAnomaly);
+
+		return (0.5 * parabolicAnomaly) + (parabolicAnomaly * parabolicAnomaly * parabolicAnomaly / 6.0);
+	}
 
 	case Type::Hyperbola:
-		m_centreOffset += m_semiMajor; // c = p / (1 + e) + a
-		break;
+	{
+		// Hyperbolic anomaly (F) = 2 * atanh(sqrt((e - 1) / (e + 1)) * tan(v / 2)), mean anomaly (M) = e * sinh(F) - F.
+		double const hyperbolicAnomaly = 2.0 * atanh(sqrt((eccentricity - 1.0) / (eccentricity + 1.0)) * tan(0.5 * trueAnomaly));
+
+		if ((eccentricity - 1.0) < Kepler::kNearParabolicBand)
+			return Kepler::NearParabolicMeanAnomaly(hyperbolicAnomaly, eccentricity);
+
+		return (eccentricity * sinh(hyperbolicAnomaly)) - hyperbolicAnomaly;
+	}
 
 	default:
 		throw Exception(RESULT_CODE_UNRECOGNIZED, "Unrecognized orbit type");
 	}
+}
 
-	m_inclination = Vector3::AngleBetweenUnitVectors(m_perifocalZ, kReferenceZ); // Inclination (i), the angle between the reference and perifocal Z-axes = acos(Zp DOT Zr)
-	m_ascendingNodeDirection = m_perifocalZ.IsApproxParallel(kReferenceZ) ? m_perifocalX : kReferenceZ.Cross(m_perifocalZ).Normalized();
+// --------------------------------------------------------------------------------------------------------------------------------
 
-	m_rightAscension = Vector3::AngleBetweenUnitVectors(m_ascendingNodeDirection, kReferenceX);
-	if (m_ascendingNodeDirection.Dot(kReferenceY) < 0.f)
-		m_rightAscension = kPI2f - m_rightAscension;
+template<typename T>
+double TOrbit<T>::Elements::PropagateMeanAnomaly(double meanAnomaly, Time::Microseconds dT) const
+{
+	double const dTSeconds = static_cast<double>(dT.Get()) / static_cast<double>(Time::Microsecond);
 
-	m_argumentPeriapsis = Vector3::AngleBetweenUnitVectors(m_ascendingNodeDirection, m_perifocalX);
-	if (m_ascendingNodeDirection.Dot(m_perifocalY) < 0.f)
-		m_argumentPeriapsis = kPI2f - m_argumentPeriapsis;
+	meanAnomaly += static_cast<double>(m_meanMotion) * dTSeconds;
 
-	// TODO - orientation ?
+	if ((Type::Circle == m_type) || (Type::Ellipse == m_type))
+	{
+		meanAnomaly = fmod(meanAnomaly, kPI2);
+
+		if (meanAnomaly < 0.0)
+			meanAnomaly += kPI2;
+	}
+
+	return meanAnomaly;
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void TOrbit<T>::Elements::ComputeKinetics(double trueAnomaly, Vector3T & position, Vector3T & velocity) const
+{
+	T const cosTrueAnomaly = static_cast<T>(cos(trueAnomaly));
+	T const sinTrueAnomaly = static_cast<T>(sin(trueAnomaly));
+
+	T const radius = m_parameter / (1 + (m_eccentricity * cosTrueAnomaly)); // Orbit equation (r) = p / (1 + e * cos(v)).
+
+	position = ((m_perifocalX * cosTrueAnomaly) + (m_perifocalY * sinTrueAnomaly)) * radius;
+
+	// Velocity (V) = mu / h * (-sin(v) * Xp + (e + cos(v)) * Yp).
+	velocity = ((m_perifocalX * -sinTrueAnomaly) + (m_perifocalY * (m_eccentricity + cosTrueAnomaly))) * m_velocityK;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template class TOrbit<float>;
+template class TOrbit<double>;
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
@@ -135,6 +465,112 @@ void OrbitTestScript::RunImpl(TestHandler & testHandler)
 	elements.Compute(gravityParameter, position, velocity);
 
 	testHandler.Assert(static_cast<unsigned>(elements.m_type), static_cast<unsigned>(Orbit::Type::Circle), "Circular orbit");
+	testHandler.Assert(elements.m_period.Get(), Time::Microseconds::Convert(kPI2).Get(), "Circular orbit period is 2 * Pi / sqrt(gravity parameter / r^3)");
+
+	// Kepler propagation.
+	Orbit orbit;
+	orbit.Initialize(gravityParameter, position, velocity);
+
+	Vector3 propagatedPosition, propagatedVelocity;
+	orbit.Propagate(Time::Microseconds::Convert(0.25 * kPI2), propagatedPosition, propagatedVelocity);
+
+	testHandler.Assert((propagatedPosition - Vector3(0.f, 1.f, 0.f)).SqareMagnitude() < 1e-8f, true, "Circular orbit propagated by a quarter period");
+	testHandler.Assert((propagatedVelocity - Vector3(-1.f, 0.f, 0.f)).SqareMagnitude() < 1e-8f, true, "Circular orbit velocity after a quarter period");
+
+	elements.Compute(gravityParameter, position, Vector3(0.f, 1.2f, 0.2f));
+	testHandler.Assert(static_cast<unsigned>(elements.m_type), static_cast<unsigned>(Orbit::Type::Ellipse), "Elliptical orbit");
+	testHandler.Assert<bool, int>([&](int index)
+	{
+		double const meanAnomaly = 0.5 * index;
+		return fabs(elements.TrueToMeanAnomaly(elements.MeanToTrueAnomaly(meanAnomaly)) - meanAnomaly) < 1e-9;
+
+	}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Elliptical mean anomaly round trip", TestHandler::IndexRange<int>(0, 6));
+
+	elements.Compute(gravityParameter, position, Vector3(0.f, 1.8f, 0.f));
+	testHandler.Assert(static_cast<unsigned>(elements.m_type), static_cast<unsigned>(Orbit::Type::Hyperbola), "Hyperbolic orbit");
+	testHandler.Assert<bool, int>([&](int index)
+	{
+		double const meanAnomaly = 2.0 * index;
+		return fabs(elements.TrueToMeanAnomaly(elements.MeanToTrueAnomaly(meanAnomaly)) - meanAnomaly) < 1e-9 * std::max(1.0, fabs(meanAnomaly));
+
+	}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Hyperbolic mean anomaly round trip", TestHandler::IndexRange<int>(-5, 5));
+
+	// Near-parabolic orbits either side of e = 1, from periapsis speeds just below and above the escape speed sqrt(2).
+	testHandler.Assert<bool, int>([&](int index)
+	{
+		elements.Compute(gravityParameter, position, Vector3(0.f, sqrtf(2.f) * (1.f + (1e-3f * static_cast<float>(index))), 0.f));
+
+		for (int meanAnomalyIndex = -40; meanAnomalyIndex <= 40; ++meanAnomalyIndex)
+		{
+			double const meanAnomaly = 1e-3 * meanAnomalyIndex * abs(meanAnomalyIndex);
+			if (fabs(elements.TrueToMeanAnomaly(elements.MeanToTrueAnomaly(meanAnomaly)) - meanAnomaly) >= 1e-12 * std::max(1e-3, fabs(meanAnomaly)))
+				return false;
+		}
+
+		return true;
+
+	}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Near-parabolic mean anomaly round trip", TestHandler::IndexRange<int>(-5, 5));
+
+	// Parabolic propagation - from periapsis (r = 1, p = 2), the parabolic anomaly D = tan(v / 2) reaches 1 at mean anomaly 2 / 3.
+	Orbit parabolicOrbit;
+	parabolicOrbit.Initialize(gravityParameter, position, Vector3(0.f, sqrtf(2.f), 0.f));
+
+	Orbit::Elements const& parabolicElements = parabolicOrbit.GetCurrentSection().m_elements;
+	testHandler.Assert(static_cast<unsigned>(parabolicElements.m_type), static_cast<unsigned>(Orbit::Type::Parabola), "Parabolic orbit");
+
+	parabolicOrbit.Propagate(Time::Microseconds::Convert((2.0 / 3.0) / parabolicElements.m_meanMotion), propagatedPosition, propagatedVelocity);
+
+	testHandler.Assert((propagatedPosition - Vector3(0.f, 2.f, 0.f)).SqareMagnitude() < 1e-8f, true, "Parabolic orbit propagated to a true anomaly of Pi / 2");
+	testHandler.Assert((propagatedVelocity - Vector3(-1.f, 1.f, 0.f) * sqrtf(0.5f)).SqareMagnitude() < 1e-8f, true,
+		"Parabolic orbit velocity at a true anomaly of Pi / 2");
+
+	// Batched elements - an odd count exercises both full packs and the scalar remainder.
+	std::vector<Vector3> positions, velocities;
+	for (int i = 0; i < 11; ++i)
+	{
+		positions.push_back(Vector3(1.f + 0.1f * i, 0.2f * i, 0.05f * i));
+		velocities.push_back(Vector3(-0.1f * i, 0.8f + 0.05f * i, 0.1f));
+	}
+
+	std::vector<Orbit::Elements> batchElements(positions.size());
+	Orbit::ComputeElements(gravityParameter, positions, velocities, batchElements);
+
+	testHandler.Assert<bool, int>([&](int index)
+	{
+		Orbit::Elements expected;
+		expected.Compute(gravityParameter, positions[index], velocities[index]);
+
+		Orbit::Elements const& actual = batchElements[index];
+		return (actual.m_type == expected.m_type) && (actual.m_eccentricity == expected.m_eccentricity) &&
+			(actual.m_semiMajor == expected.m_semiMajor) && (actual.m_meanMotion == expected.m_meanMotion) &&
+			(actual.m_period == expected.m_period) && (actual.m_perifocalX == expected.m_perifocalX) &&
+			(actual.m_perifocalY == expected.m_perifocalY) && (actual.m_argumentPeriapsis == expected.m_argumentPeriapsis);
+
+	}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Batched elements match single elements", TestHandler::IndexRange<int>(0, 10));
+
+	// Double precision - the circular orbit has unit angular speed, so the orbiter's angle equals the (whole microsecond) time.
+	Orbitd orbitd;
+	orbitd.Initialize(static_cast<double>(gravityParameter), Vector3d(position), Vector3d(velocity));
+
+	Time::Microseconds const dT = Time::Microseconds::Convert(0.25 * kPI2);
+	double const angle = static_cast<double>(dT.Get()) / static_cast<double>(Time::Microsecond);
+
+	Vector3d propagatedPositiond, propagatedVelocityd;
+	orbitd.Propagate(dT, propagatedPositiond, propagatedVelocityd);
+
+	testHandler.Assert(static_cast<unsigned>(orbitd.GetCurrentSection().m_elements.m_type), static_cast<unsigned>(Orbitd::Type::Circle),
+		"Double precision circular orbit");
+	testHandler.Assert((propagatedPositiond - Vector3d(cos(angle), sin(angle), 0.0)).SqareMagnitude() < 1e-24, true,
+		"Double precision circular orbit propagated by a quarter period");
+
+	elements.Compute(gravityParameter, position, Vector3(0.f, 1.2f, 0.2f));
+
+	Orbitd::Elements elementsd;
+	elementsd.Compute(static_cast<double>(gravityParameter), Vector3d(position), Vector3d(0.0, 1.2, 0.2));
+
+	testHandler.Assert(static_cast<unsigned>(elementsd.m_type), static_cast<unsigned>(Orbitd::Type::Ellipse), "Double precision elliptical orbit");
+	testHandler.Assert(fabs(elementsd.m_semiMajor - static_cast<double>(elements.m_semiMajor)) < 1e-5, true,
+		"Double precision semi-major axis agrees with float");
 
 	//assert(false); // TODO - elements for circular orbit with period of 1 minute ...
 }
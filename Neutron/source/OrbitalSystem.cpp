@@ -4,26 +4,157 @@
 #include "ScalingSpace.h"
 #include "TestHandler.h"
 
+namespace // detail
+{
+
+using namespace Neutron;
+
+constexpr float kTestHostMass				= 1e30f;
+constexpr float kTestHostSpaceTrueRadius	= 8e12f;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> An orbital system set up by the tests, and the particles they create in it. </summary>
+struct TestSystem
+{
+	OrbitalSystem			m_orbitalSystem{ kTestHostMass, kTestHostSpaceTrueRadius };
+	std::vector<Particle *>	m_particles;	// The particles created through the fixture, in creation order.
+
+	/// <param name="spaceRadii"> The true radii of the top level spaces to create, as fractions of the host space's. </param>
+	explicit TestSystem(std::initializer_list<float> spaceRadii = {})
+	{
+		for (float radius : spaceRadii)
+			m_orbitalSystem.CreateScalingSpace(radius * kTestHostSpaceTrueRadius);
+	}
+
+	ScalingSpace & GetHostSpace()
+	{
+		return m_orbitalSystem.GetHostSpace();
+	}
+
+	ScalingSpace & GetInnermostSpace()
+	{
+		return **--m_orbitalSystem.GetScalingSpaces().cend();
+	}
+
+	/// <summary> Create a particle at a radius and angle in the xy plane of a space, moving at a multiple of the circular orbit speed. </summary>
+	Particle & CreateOrbiter(ScalingSpace & space, float mass, float radius, float angle, float speedFactor = 1.f)
+	{
+		Vector3 const position(radius * cosf(angle), radius * sinf(angle), 0.f);
+		Vector3 const velocity = Vector3(-sinf(angle), cosf(angle), 0.f) * (space.CircularOrbitSpeed(radius) * speedFactor);
+
+		return *m_particles.emplace_back(&m_orbitalSystem.CreateParticle(mass, position, velocity, space));
+	}
+};
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
 OrbitalSystem::OrbitalSystem(float hostMass, float hostSpaceTrueRadius) :
-	m_pHostParticle(MakeUnique<Particle>(hostMass, hostSpaceTrueRadius))
+	m_pHostParticle(MakeUnique<Particle>(hostMass, hostSpaceTrueRadius)),
+	m_time(0),
+	m_pTaskPool(nullptr),
+	m_pReplayRecorder(nullptr)
 {
+	InitializeScalingSpace(GetHostSpace());
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
 void OrbitalSystem::Reset(float hostMass, float hostSpaceTrueRadius)
 {
+	m_particleUpdateQueue = ParticleUpdateQueue();
+	m_time = 0;
+
 	m_pHostParticle = MakeUnique<Particle>(hostMass, hostSpaceTrueRadius);
+
+	InitializeScalingSpace(GetHostSpace());
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
 void OrbitalSystem::OnUpdate(Time::Microseconds dT)
 {
-	// TODO - update particles ...
+	m_time += dT;
+
+	while (!m_particleUpdateQueue.Empty() && (m_particleUpdateQueue.Front().m_time.Get() <= m_time.Get()))
+	{
+		// Wake every particle whose event is due. Events rescheduled within this round fall due in the next round.
+		m_dueEvents.clear();
+
+		while (!m_particleUpdateQueue.Empty() && (m_particleUpdateQueue.Front().m_time.Get() <= m_time.Get()))
+		{
+			ParticleEvent const particleEvent = m_particleUpdateQueue.Front();
+			m_particleUpdateQueue.Pop();
+
+			if (particleEvent.m_eventId != particleEvent.m_pParticle->m_eventId)
+				continue; // Stale - the particle has been rescheduled since this event was queued.
+
+			m_dueEvents.push_back(particleEvent); // A particle has at most one valid event, so each is propagated once.
+		}
+
+		// Propagation only writes the particle's own state, so the woken particles are independent.
+		ForEachChunk(m_dueEvents.size(), [&](size_t begin, size_t end)
+		{
+			for (size_t index = begin; index < end; ++index)
+			{
+				Particle & particle = *m_dueEvents[index].m_pParticle;
+				particle.Propagate(m_dueEvents[index].m_time - particle.m_epoch);
+			}
+		});
+
+		// Record the orbits recomputed by pending rescales, applied on propagation.
+		for (ParticleEvent const& particleEvent : m_dueEvents)
+		{
+			Particle & particle = *particleEvent.m_pParticle;
+
+			if (particle.m_isRescaled)
+			{
+				particle.m_isRescaled = false;
+
+				// The recomputed orbit's exit is resolved from the rescale, so that an exit which falls due at the event is
+				// taken even if the state falls just short of the boundary (see DetectCrossing()).
+				if (particle.m_pHostSpace->m_isInfluencing && !particle.m_orbit.GetCurrentSection().m_isExitResolved)
+					ResolveSectionExit(particle, 0);
+
+				RecordOrbit(ReplayEvent::Type::Recompute, particle);
+			}
+		}
+
+		// Transfers modify the scaling space tree, so they are applied on this thread. Moving a particle which hosts scaling
+		// spaces rescales them, so such particles are transferred first, one at a time in queue order.
+		for (ParticleEvent const& particleEvent : m_dueEvents)
+		{
+			if (!particleEvent.m_pParticle->m_attachedSpaces.empty())
+				ProcessParticleEvent(*particleEvent.m_pParticle);
+		}
+
+		ProcessTransitions();
+	}
+
+	FlushReplay();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::Synchronize()
+{
+	if (nullptr == m_pTaskPool)
+	{
+		for (UniquePtr<ScalingSpace> & pScalingSpace : m_pHostParticle->m_attachedSpaces)
+			SynchronizeScalingSpace(*pScalingSpace, m_time);
+
+		return;
+	}
+
+	TaskPool::TaskGroup taskGroup;
+
+	for (UniquePtr<ScalingSpace> & pScalingSpace : m_pHostParticle->m_attachedSpaces)
+		SubmitSynchronizeScalingSpace(taskGroup, *pScalingSpace);
+
+	m_pTaskPool->Wait(taskGroup);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -34,10 +165,14 @@ ScalingSpace & OrbitalSystem::CreateScalingSpace(float trueRadius)
 
 	ScalingSpace & scalingSpace = **scalingSpaceListIter;
 
-	float const radius = (nullptr == scalingSpace.m_pOuterSpace) ? 1.f : trueRadius / scalingSpace.m_pOuterSpace->m_trueRadius;
-
 	InitializeScalingSpace(scalingSpace);
 
+	// The particles of the former outermost space had no outer space to leave for.
+	if ((nullptr == scalingSpace.m_pOuterSpace) && (nullptr != scalingSpace.m_pInnerSpace))
+		ScheduleSpaceParticles(*scalingSpace.m_pInnerSpace);
+
+	FlushReplay();
+
 	return scalingSpace;
 }
 
@@ -59,39 +194,103 @@ Particle & OrbitalSystem::CreateParticle(float mass, Vector3 position, Vector3 v
 
 	UniquePtr<Particle> & pNewParticle =
 		hostSpace.m_particles.emplace_back(
-			std::move(MakeUnique<Particle>(Particle::State{ mass, position, velocity }, &hostSpace)));
+			std::move(MakeUnique<Particle>(Particle::State{ mass, position, velocity }, &hostSpace, m_time)));
 
-	float const radiusOfInfluence = ComputeRadiusOfInfluence(pNewParticle->m_pElements->m_semiMajor, pNewParticle->m_state.m_mass,
+	float const radiusOfInfluence = ComputeRadiusOfInfluence(pNewParticle->m_orbit.GetCurrentSection().m_elements.m_semiMajor, pNewParticle->m_state.m_mass,
 		hostSpace.GetPrimary().m_state.m_mass);
 
 	if (kMinimumRadiusOfInfluence < radiusOfInfluence)
 	{
 		float const trueRadiusOfInfluence = radiusOfInfluence * hostSpace.GetTrueRadius();
 
-		ScalingSpace & spaceOfInfluence =
-			**(pNewParticle->m_attachedSpaces.Emplace(std::move(MakeUnique<ScalingSpace>(pNewParticle.get(), trueRadiusOfInfluence))));
+		ScalingSpace & spaceOfInfluence = **EmplaceScalingSpace(trueRadiusOfInfluence, *pNewParticle);
 
 		spaceOfInfluence.Initialize(radiusOfInfluence, true);
+
+		hostSpace.m_hostParticles.push_back(pNewParticle.get());
+
+		ScheduleSiblings(*pNewParticle);
 	}
 
+	ScheduleParticle(*pNewParticle);
+
+	RecordOrbit(ReplayEvent::Type::Creation, *pNewParticle);
+	FlushReplay();
+
 	return *pNewParticle;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+void OrbitalSystem::ApplyImpulse(Particle & particle, Vector3 const& deltaVelocity)
+{
+	API_ASSERT_THROW(nullptr != particle.m_pHostSpace, RESULT_CODE_INVALID_PARAMETER, "The system host particle does not move");
+
+	particle.Propagate(m_time - particle.m_epoch);
+
+	particle.Set(particle.m_state.m_localPosition, particle.m_state.m_localVelocity + deltaVelocity, particle.m_pHostSpace);
+
+	ScheduleParticle(particle);
+
+	// The trajectories of particles which leave the attached spaces depend on the particle's trajectory.
+	for (UniquePtr<ScalingSpace> & pAttachedSpace : particle.m_attachedSpaces)
+		ScheduleScalingSpace(*pAttachedSpace);
+
+	if (!particle.m_attachedSpaces.empty())
+		ScheduleSiblings(particle);
+
+	RecordOrbit(ReplayEvent::Type::Impulse, particle);
+	FlushReplay();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 ScalingSpace & OrbitalSystem::CreateScalingSpace(float trueRadius, Particle & hostParticle)
 {
+	if (hostParticle.m_attachedSpaces.empty())
+		hostParticle.m_pHostSpace->m_hostParticles.push_back(&hostParticle);
+
 	Particle::ScalingSpaceList::iterator scalingSpaceListIter = EmplaceScalingSpace(trueRadius, hostParticle);
 
 	ScalingSpace & scalingSpace = **scalingSpaceListIter;
 
+	// Whether the space is influencing depends on the host's existing space of influence, which the new space must not be taken for.
+	scalingSpace.m_isInfluencing = false;
+
 	InitializeScalingSpace(scalingSpace);
 
+	FlushReplay();
+
 	return scalingSpace;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+size_t OrbitalSystem::PredictTrajectory(Particle & particle, size_t sectionCount, Time::Microseconds horizon)
+{
+	API_ASSERT_THROW(nullptr != particle.m_pHostSpace, RESULT_CODE_INVALID_PARAMETER, "The system host particle has no trajectory");
+
+	if (particle.IsRescalePending())
+		particle.ApplyRescale();
+
+	Orbit & orbit = particle.m_orbit;
+
+	Time::Microseconds const horizonTime = m_time + horizon;
+
+	while (orbit.GetSectionCount() < sectionCount)
+	{
+		if (horizonTime.Get() < orbit.GetSection(orbit.GetSectionCount() - 1).m_entryTime.Get())
+			break;
+
+		if (!PredictNextSection(particle))
+			break;
+	}
+
+	return std::min(sectionCount, orbit.GetSectionCount());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 Particle::ScalingSpaceList::iterator OrbitalSystem::EmplaceScalingSpace(float trueRadius, Particle & hostParticle)
 {
 	Particle::ScalingSpaceList::iterator scalingSpaceListIter =
@@ -141,10 +340,20 @@ void OrbitalSystem::InitializeScalingSpace(ScalingSpace & scalingSpace)
 
 		scalingSpace.Initialize(radius, isInfluencing);
 
-		for (UniquePtr<Particle> & pParticle : scalingSpace.m_particles)
+		// Particles which host no scaling spaces apply the rescale when their next event falls due, or when they are evaluated.
+		// Particles which host scaling spaces are rescaled here, as the states of their attached spaces depend on them.
+		scalingSpace.Rescale(rescaleFactor);
+
+		// A copy, as host particles which ascend leave the list.
+		std::vector<Particle *> const hostParticles(scalingSpace.m_hostParticles);
+
+		for (Particle * pParticle : hostParticles)
 		{
-			Vector3 rescaledPosition = pParticle->m_state.m_localPosition * rescaleFactor;
-			Vector3 rescaledVelocity = pParticle->m_state.m_localVelocity * rescaleFactor;
+			// The pending rescale includes any the particle had yet to apply.
+			float const pendingRescale = pParticle->ComputePendingRescale();
+
+			Vector3 rescaledPosition = pParticle->m_state.m_localPosition * pendingRescale;
+			Vector3 rescaledVelocity = pParticle->m_state.m_localVelocity * pendingRescale;
 
 			if (ShouldAscend(sqrtf(rescaledPosition.SqareMagnitude())))
 			{
@@ -159,18 +368,7 @@ void OrbitalSystem::InitializeScalingSpace(ScalingSpace & scalingSpace)
 			}
 		}
 
-		for (UniquePtr<Particle> & pParticle : scalingSpace.m_pOuterSpace->m_particles)
-		{
-			float const radialDistance = sqrtf(pParticle->m_state.m_localPosition.SqareMagnitude());
-
-			if (ShouldDescend(radialDistance, scalingSpace))
-			{
-				Vector3 const rescaledPosition = pParticle->m_state.m_localPosition / radius;
-				Vector3 const rescaledVelocity = pParticle->m_state.m_localVelocity / radius;
-
-				InitializeParticle(*pParticle, rescaledPosition, rescaledVelocity, scalingSpace);
-			}
-		}
+		CaptureOuterParticles(scalingSpace);
 	}
 
 	if (nullptr != scalingSpace.m_pInnerSpace)
@@ -191,124 +389,1499 @@ void OrbitalSystem::RecomputeRadius(ScalingSpace & scalingSpace)
 
 	scalingSpace.Initialize(newRadius, scalingSpace.m_isInfluencing);
 
+	// The particles' predicted exits lead to the former outer space: the orbits are recomputed, lazily as in
+	// InitializeScalingSpace(). The events are kept, as the space's boundary is where it was.
+	scalingSpace.Rescale(1.f);
+
 	if (!scalingSpace.m_isInfluencing)
 	{
-		for (UniquePtr<Particle> & pParticle : scalingSpace.m_particles)
-			InitializeParticle(*pParticle, pParticle->m_state.m_localPosition, pParticle->m_state.m_localVelocity, scalingSpace);
+		// The primary's state relative to the space has changed, which the states of the attached spaces depend on.
+		for (Particle * pParticle : scalingSpace.m_hostParticles)
+		{
+			float const pendingRescale = pParticle->ComputePendingRescale();
+
+			InitializeParticle(*pParticle, pParticle->m_state.m_localPosition * pendingRescale, pParticle->m_state.m_localVelocity * pendingRescale,
+				scalingSpace);
+		}
 	}
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-void OrbitalSystem::InitializeParticle(Particle & particle, Vector3 const& position, Vector3 const& velocity,
-	ScalingSpace & scalingSpace)
+void OrbitalSystem::CaptureOuterParticles(ScalingSpace & scalingSpace)
 {
-	particle.Set(position, velocity, &scalingSpace);
-
-	float const radiusOfInfluence =
-		ComputeRadiusOfInfluence(particle.m_pElements->m_semiMajor, particle.m_state.m_mass, scalingSpace.GetPrimary().m_state.m_mass);
+	ScalingSpace & outerSpace = *scalingSpace.m_pOuterSpace;
+	Particle * const pHostParticle = scalingSpace.m_pHost;
 
-	float const trueRadiusOfInfluence = radiusOfInfluence * scalingSpace.GetTrueRadius();
+	// The space is centred on its host particle, which lies at the outer space's centre unless the outer space is its host space.
+	bool const isHostInOuterSpace = (outerSpace.m_pHost != pHostParticle);
 
-	Particle::ScalingSpaceList::iterator spaceOfInfluenceIter = particle.m_attachedSpaces.FindSpaceOfInfluence();
-	if (particle.m_attachedSpaces.end() == spaceOfInfluenceIter)
+	std::list<UniquePtr<Particle>>::iterator particleIter = outerSpace.m_particles.begin();
+	while (outerSpace.m_particles.end() != particleIter)
 	{
-		if (kMinimumRadiusOfInfluence < radiusOfInfluence)
-		{
-			spaceOfInfluenceIter = EmplaceScalingSpace(trueRadiusOfInfluence, particle);
+		Particle & particle = **particleIter;
+		++particleIter; // Entering the space splices the particle out of the list.
+
+		if (&particle == pHostParticle)
+			continue;
 
-			ScalingSpace & spaceOfInfluence = **spaceOfInfluenceIter;
+		// Each particle is tested where it is at its own epoch, as if rescaled, so that no particle needs to be propagated.
+		Vector3 position, velocity;
+		particle.ComputeKinetics(particle.m_epoch, position, velocity);
 
-			spaceOfInfluence.m_isInfluencing = true;
+		if (isHostInOuterSpace)
+		{
+			Vector3 hostPosition, hostVelocity;
+			pHostParticle->ComputeKinetics(particle.m_epoch, hostPosition, hostVelocity);
 
-			InitializeScalingSpace(spaceOfInfluence);
+			position -= hostPosition;
+			velocity -= hostVelocity;
 		}
-	}
-	else
-	{
-		ScalingSpace & spaceOfInfluence = **spaceOfInfluenceIter;
 
-		if (kMinimumRadiusOfInfluence < radiusOfInfluence)
+		if (!ShouldDescend(sqrtf(position.SqareMagnitude()), scalingSpace))
 		{
-			spaceOfInfluence.m_trueRadius = trueRadiusOfInfluence;
+			// The space's boundary, and the sibling bounds of its events if the space is the host's outermost, have changed.
+			particle.DiscardPrediction();
 
-			particle.m_attachedSpaces.Sort(spaceOfInfluenceIter);
+			ScheduleParticle(particle);
 
-			InitializeScalingSpace(spaceOfInfluence);
+			continue;
 		}
-		else
+
+		position /= scalingSpace.m_radius;
+		velocity /= scalingSpace.m_radius;
+
+		if (!scalingSpace.m_isInfluencing)
 		{
-			assert(false); // TODO - set influence and all smaller spaces to non-influencing ...
+			// The states of the particles in a non-influencing space are offset by its cached primary kinetics.
+			Vector3 primaryPosition, primaryVelocity;
+			scalingSpace.ComputePrimaryKinetics(particle.m_epoch, primaryPosition, primaryVelocity);
+
+			position += scalingSpace.m_primaryPosition - primaryPosition;
+			velocity += scalingSpace.m_primaryVelocity - primaryVelocity;
 		}
+
+		TransferParticle(particle, scalingSpace, position, velocity);
+
+		ScheduleParticle(particle);
+
+		for (UniquePtr<ScalingSpace> & pAttachedSpace : particle.m_attachedSpaces)
+			ScheduleScalingSpace(*pAttachedSpace);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::InitializeParticle(Particle & particle, Vector3 const& position, Vector3 const& velocity,
+	ScalingSpace & scalingSpace)
+{
+	// A rescale changes neither the particle's true orbit nor, so, the true radius of its space of influence: only the particle's
+	// state, its predicted sections and the events of its attached spaces need to be recomputed.
+	if (&scalingSpace == particle.m_pHostSpace)
+	{
+		particle.Set(position, velocity, &scalingSpace);
+
+		RecordOrbit(ReplayEvent::Type::Recompute, particle);
+	}
+	else
+	{
+		TransferParticle(particle, scalingSpace, position, velocity);
 	}
 
-	assert(false); // TODO ...
+	ScheduleParticle(particle);
+
+	for (UniquePtr<ScalingSpace> & pAttachedSpace : particle.m_attachedSpaces)
+		ScheduleScalingSpace(*pAttachedSpace);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::SynchronizeScalingSpace(ScalingSpace & scalingSpace, Time::Microseconds time)
+{
+	if (!scalingSpace.m_isInfluencing)
+		scalingSpace.ComputePrimaryKinetics(time, scalingSpace.m_primaryPosition, scalingSpace.m_primaryVelocity);
+
+	for (UniquePtr<Particle> & pParticle : scalingSpace.m_particles)
+	{
+		pParticle->Propagate(time - pParticle->m_epoch);
+
+		for (UniquePtr<ScalingSpace> & pAttachedSpace : pParticle->m_attachedSpaces)
+			SynchronizeScalingSpace(*pAttachedSpace, time);
+	}
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
-OrbitalSystemTestScript::OrbitalSystemTestScript() :
-	ITestScript("OrbitalSystem")
+void OrbitalSystem::SubmitSynchronizeScalingSpace(TaskPool::TaskGroup & taskGroup, ScalingSpace & scalingSpace)
 {
+	m_pTaskPool->Submit(taskGroup, [this, &taskGroup, &scalingSpace]()
+	{
+		// The host particle, and so every particle up the tree, has been propagated before this task was submitted.
+		if (!scalingSpace.m_isInfluencing)
+			scalingSpace.ComputePrimaryKinetics(m_time, scalingSpace.m_primaryPosition, scalingSpace.m_primaryVelocity);
+
+		std::list<UniquePtr<Particle>>::iterator chunkBegin = scalingSpace.m_particles.begin();
+
+		while (scalingSpace.m_particles.end() != chunkBegin)
+		{
+			std::list<UniquePtr<Particle>>::iterator chunkEnd = chunkBegin;
+			for (size_t count = 0; (count < kParallelChunkSize) && (scalingSpace.m_particles.end() != chunkEnd); ++count)
+				++chunkEnd;
+
+			m_pTaskPool->Submit(taskGroup, [this, &taskGroup, chunkBegin, chunkEnd]()
+			{
+				for (std::list<UniquePtr<Particle>>::iterator particleIter = chunkBegin; particleIter != chunkEnd; ++particleIter)
+				{
+					Particle & particle = **particleIter;
+
+					particle.Propagate(m_time - particle.m_epoch);
+
+					for (UniquePtr<ScalingSpace> & pAttachedSpace : particle.m_attachedSpaces)
+						SubmitSynchronizeScalingSpace(taskGroup, *pAttachedSpace);
+				}
+			});
+
+			chunkBegin = chunkEnd;
+		}
+	});
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-OrbitalSystemTestScript::~OrbitalSystemTestScript()
+bool OrbitalSystem::ComputeEventDelay(Particle const& particle, double & delay)
 {
+	ScalingSpace const& scalingSpace = *particle.m_pHostSpace;
+	ScalingSpace const*const pInnerSpace = scalingSpace.m_pInnerSpace;
+
+	assert(!scalingSpace.m_isInfluencing); // Crossings of influencing spaces are resolved exactly, by ResolveSectionExit().
+
+	bool const canAscend = (nullptr != scalingSpace.m_pOuterSpace);
+	bool const canDescend = (nullptr != pInnerSpace);
+
+	if (!(canAscend || canDescend))
+		return false;
+
+	Vector3 localPosition, localVelocity;
+	ComputeLocalKinetics(particle, localPosition, localVelocity);
+
+	float const radialDistance = sqrtf(localPosition.SqareMagnitude());
+
+	float margin = std::numeric_limits<float>::max();
+	if (canAscend)
+		margin = kScalingSpaceEscapeRadius - radialDistance;
+	if (canDescend)
+		margin = std::min(margin, radialDistance - pInnerSpace->m_radius);
+
+	// Bound the time to reach the nearest boundary by the greatest speed the particle can have relative to the space: the
+	// primary moves relative to the space as the host particle moves relative to the primary, so its speed is at most the host
+	// particle's speed at periapsis, to which the particle's own speed at periapsis is added.
+	Particle const& hostParticle = *scalingSpace.m_pHost;
+
+	float const primarySpeedBound = ComputeSpeedBound(hostParticle.m_orbit.GetCurrentSection().m_elements) *
+		(hostParticle.m_pHostSpace->m_trueRadius / scalingSpace.m_trueRadius);
+
+	float const speedBound = primarySpeedBound + ComputeSpeedBound(particle.m_orbit.GetCurrentSection().m_elements);
+
+	delay = std::max(0.f, margin) / speedBound;
+
+	return true;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-void OrbitalSystemTestScript::RunImpl(TestHandler & testHandler)
+bool OrbitalSystem::ComputeSiblingDelay(Particle const& particle, double & delay)
 {
-	static constexpr float hostMass = 1e30f, hostSpaceTrueRadius = 8e12f;
-	static float const hostGravityParameter = ScalingSpace::ComputeScaledGravityParameter(hostSpaceTrueRadius, hostMass);
+	ScalingSpace const& scalingSpace = *particle.m_pHostSpace;
 
-	TestHandler::OutputMode const outputMode = testHandler.SetOutputMode(TestHandler::VERBOSE);
+	bool hasEvent = false;
+	delay = std::numeric_limits<double>::max();
 
-	OrbitalSystem orbitalSystem(hostMass, hostSpaceTrueRadius);
+	Vector3 localPosition, localVelocity;
+	float speedBound = 0.f;
 
-	Particle::ScalingSpaceList const& hostScalingSpaces = orbitalSystem.GetScalingSpaces();
+	for (Particle const* pHostParticle : scalingSpace.m_hostParticles)
+	{
+		if (pHostParticle == &particle)
+			continue;
 
-	testHandler.Assert(hostScalingSpaces.size(), 1ull, "Host scaling space exists");
+		if (!hasEvent)
+		{
+			ComputeLocalKinetics(particle, localPosition, localVelocity);
 
-	ScalingSpace & hostSpace = orbitalSystem.GetHostSpace();
+			speedBound = ComputeSpeedBound(particle.m_orbit.GetCurrentSection().m_elements);
+		}
 
-	testHandler.Assert(hostSpace.m_uuid, (*hostScalingSpaces.begin())->m_uuid, "Host space UUID");
+		delay = std::min(delay, ComputeHostParticleDelay(particle, localPosition, speedBound, *pHostParticle));
+		hasEvent = true;
+	}
 
-	// Host space.
-	testHandler.Assert(hostSpace.GetRadius(), 1.f, "Host space radius");
-	testHandler.Assert(hostSpace.GetTrueRadius(), hostSpaceTrueRadius, "Host space true radius");
-	testHandler.Assert(hostSpace.GetGravityParameter(), hostGravityParameter, "Host space gravity parameter");
+	return hasEvent;
+}
 
-	// Adding host spaces.
-	testHandler.Assert<int, int>([&](int index)
+// --------------------------------------------------------------------------------------------------------------------------------
+
+double OrbitalSystem::ComputeHostParticleDelay(Particle const& particle, Vector3 const& localPosition, float speedBound,
+	Particle const& hostParticle)
+{
+	// Both particles orbit the space's primary, so their relative speed is at most the sum of their speeds at periapsis.
+	Vector3 hostPosition, hostVelocity;
+	hostParticle.ComputeKinetics(particle.m_epoch, hostPosition, hostVelocity);
+
+	float const margin = sqrtf((localPosition - hostPosition).SqareMagnitude()) - (*hostParticle.m_attachedSpaces.begin())->m_radius;
+	float const relativeSpeedBound = speedBound + ComputeSpeedBound(hostParticle.m_orbit.GetCurrentSection().m_elements);
+
+	return static_cast<double>(std::max(0.f, margin) / relativeSpeedBound);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem::ComputeCrossingDelay(Orbit::Elements const& elements, ScalingSpace const& scalingSpace, double meanAnomaly,
+	double & delay, ScalingSpace *& pNextSpace)
+{
+	assert(scalingSpace.m_isInfluencing);
+
+	ScalingSpace *const pInnerSpace = scalingSpace.m_pInnerSpace;
+
+	bool const canAscend = (nullptr != scalingSpace.m_pOuterSpace);
+	bool const canDescend = (nullptr != pInnerSpace);
+
+	if (!(canAscend || canDescend))
+		return false;
+
+	if (Orbit::Type::Circle == elements.m_type)
+		return false; // Constant radial distance - a circular orbit never crosses a boundary.
+
+	bool const isClosed = (Orbit::Type::Ellipse == elements.m_type);
+	double const meanMotion = static_cast<double>(elements.m_meanMotion);
+
+	bool hasEvent = false;
+	delay = std::numeric_limits<double>::max();
+
+	// Time until the orbiter reaches the given mean anomaly, or false if an open orbit has already passed it.
+	auto computeDelay = [&](double crossingMeanAnomaly, double & meanAnomalyDelay)
 	{
-		float const trueRadius = hostSpaceTrueRadius / powf(2.f, static_cast<float>(index));
-		float const radius = 1.f / powf(2.f, static_cast<float>(index));
+		double deltaMeanAnomaly = crossingMeanAnomaly - meanAnomaly;
 
-		ScalingSpace & newHostSpace = orbitalSystem.CreateScalingSpace(trueRadius);
+		if (isClosed)
+		{
+			deltaMeanAnomaly = fmod(deltaMeanAnomaly, kPI2);
+			if (deltaMeanAnomaly < 0.0)
+				deltaMeanAnomaly += kPI2;
+		}
+		else if (deltaMeanAnomaly < 0.0)
+		{
+			return false;
+		}
 
-		testHandler.Assert(newHostSpace.GetTrueRadius(), trueRadius, "True radius");
-		testHandler.Assert(newHostSpace.GetRadius(), radius, "Radius");
+		meanAnomalyDelay = deltaMeanAnomaly / meanMotion;
 
-		auto newSpaceIter = --hostScalingSpaces.cend();
-		testHandler.Assert((*newSpaceIter)->m_uuid, newHostSpace.m_uuid, "List position");
+		return true;
+	};
 
-		auto prevSpaceIter = newSpaceIter; --prevSpaceIter;
-		testHandler.Assert(reinterpret_cast<uintptr_t>(newHostSpace.m_pInnerSpace), reinterpret_cast<uintptr_t>(nullptr), "Inner space pointer");
-		testHandler.Assert(reinterpret_cast<uintptr_t>(newHostSpace.m_pOuterSpace), reinterpret_cast<uintptr_t>(prevSpaceIter->get()), "Outer space pointer");
-		testHandler.Assert(reinterpret_cast<uintptr_t>((*prevSpaceIter)->m_pInnerSpace), reinterpret_cast<uintptr_t>(newSpaceIter->get()), "Outer space's inner space pointer");
+	// Radial distance (r) = p / (1 + e * cos(v)) -> cos(v) = (p / r - 1) / e.
+	auto crossingTrueAnomaly = [&](float radius)
+	{
+		return acos(std::clamp((static_cast<double>(elements.m_parameter) / radius - 1.0) / elements.m_eccentricity, -1.0, 1.0));
+	};
 
-		return static_cast<int>(hostScalingSpaces.size());
+	if (canAscend && (!isClosed || (kScalingSpaceEscapeRadius < elements.m_parameter / (1.f - elements.m_eccentricity))))
+	{
+		double ascendDelay;
+		if (computeDelay(elements.TrueToMeanAnomaly(crossingTrueAnomaly(kScalingSpaceEscapeRadius)), ascendDelay)) // Outbound.
+		{
+			delay = ascendDelay;
+			pNextSpace = scalingSpace.m_pOuterSpace;
+			hasEvent = true;
+		}
+	}
 
-	}, TestHandler::FRangeIndex<int>(), TestHandler::FRangeIndex<int>(1), "Adding host spaces", TestHandler::IndexRange<int>{ 1, 10 });
+	if (canDescend && (elements.m_parameter / (1.f + elements.m_eccentricity) < pInnerSpace->m_radius))
+	{
+		double descendDelay;
+		if (computeDelay(elements.TrueToMeanAnomaly(-crossingTrueAnomaly(pInnerSpace->m_radius)), descendDelay) && // Inbound.
+			(descendDelay < delay))
+		{
+			delay = descendDelay;
+			pNextSpace = pInnerSpace;
+			hasEvent = true;
+		}
+	}
 
-	// Creating particles.
-	Particle & newParticle = orbitalSystem.CreateParticle(1.f, { 0.75f, 0.f, 0.f },
-		{ 0.f, hostSpace.CircularOrbitSpeed(0.75f), 0.f }, hostSpace);
+	return hasEvent;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Time::Microseconds OrbitalSystem::RoundEventDelay(double delay)
+{
+	// Round up to the next whole microsecond so that the event never falls before the crossing it anticipates.
+	static constexpr double kMaximumDelay = static_cast<double>(std::numeric_limits<int64_t>::max() / 2) / Time::Microsecond;
+
+	return std::max<int64_t>(1, static_cast<int64_t>(ceil(std::min(delay, kMaximumDelay) * Time::Microsecond)));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ResolveSectionExit(Particle & particle, size_t index)
+{
+	Orbit::Section & section = particle.m_orbit.GetSection(index);
+	ScalingSpace const& scalingSpace = *particle.GetSectionSpace(index);
+
+	section.m_isExitResolved = true;
+
+	double delay;
+	ScalingSpace * pNextSpace = nullptr;
+	if (!scalingSpace.m_isInfluencing || !ComputeCrossingDelay(section.m_elements, scalingSpace, section.m_meanAnomalyEntry, delay, pNextSpace))
+	{
+		particle.ResolveSectionExit(nullptr);
+		return;
+	}
+
+	Time::Microseconds const exitDelay = RoundEventDelay(delay);
+
+	particle.ResolveSectionExit(pNextSpace);
+	section.m_exitTime = section.m_entryTime + exitDelay;
+	section.m_trueAnomalyExit =
+		section.m_elements.MeanToTrueAnomaly(section.m_elements.PropagateMeanAnomaly(section.m_meanAnomalyEntry, exitDelay));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem::PredictNextSection(Particle & particle)
+{
+	Orbit & orbit = particle.m_orbit;
+	size_t const index = orbit.GetSectionCount() - 1;
+	Orbit::Section & section = orbit.GetSection(index);
+
+	if (!section.m_isExitResolved)
+		ResolveSectionExit(particle, index);
+
+	if (nullptr == particle.GetSectionNextSpace(index))
+		return false;
+
+	ScalingSpace & scalingSpace = *particle.GetSectionSpace(index);
+	ScalingSpace & nextSpace = *particle.GetSectionNextSpace(index);
+
+	if (!nextSpace.m_isInfluencing)
+		return false; // The primary of the next space moves relative to it, so the next section's exit cannot be predicted.
+
+	Vector3 position, velocity;
+	section.m_elements.ComputeKinetics(section.m_trueAnomalyExit, position, velocity);
+
+	position += scalingSpace.m_primaryPosition;
+	velocity += scalingSpace.m_primaryVelocity;
+
+	if (&nextSpace == scalingSpace.m_pOuterSpace)
+	{
+		position *= scalingSpace.m_radius;
+		velocity *= scalingSpace.m_radius;
+
+		if (nextSpace.m_pHost != scalingSpace.m_pHost)
+		{
+			// The outer space is the host particle's host space: offset by the host particle's predicted state.
+			Vector3 hostPosition, hostVelocity;
+			if (!PredictKinetics(*scalingSpace.m_pHost, nextSpace, section.m_exitTime, hostPosition, hostVelocity))
+				return false;
+
+			position += hostPosition;
+			velocity += hostVelocity;
+		}
+	}
+	else
+	{
+		position /= nextSpace.m_radius;
+		velocity /= nextSpace.m_radius;
+	}
+
+	Vector3 const positionFromPrimary = position - nextSpace.m_primaryPosition;
+	Vector3 const velocityFromPrimary = velocity - nextSpace.m_primaryVelocity;
+
+	Orbit::Section & nextSection = orbit.AppendSection(); // Note: may release sections before the current one, but not `section`.
+
+	nextSection.m_elements.Compute(nextSpace.m_gravityParameter, positionFromPrimary, velocityFromPrimary);
+	nextSection.m_entryTime = section.m_exitTime;
+	nextSection.m_trueAnomalyEntry = nextSection.m_elements.ComputeTrueAnomaly(positionFromPrimary);
+	nextSection.m_meanAnomalyEntry = nextSection.m_elements.TrueToMeanAnomaly(nextSection.m_trueAnomalyEntry);
+
+	return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem::PredictKinetics(Particle & particle, ScalingSpace const& scalingSpace, Time::Microseconds time, Vector3 & position,
+	Vector3 & velocity)
+{
+	Orbit & orbit = particle.m_orbit;
+
+	for (size_t index = 0; index < orbit.GetSectionCount(); ++index)
+	{
+		Orbit::Section & section = orbit.GetSection(index);
+
+		if (time.Get() < section.m_entryTime.Get())
+			return false; // Earlier than the particle's current section.
+
+		if (!section.m_isExitResolved)
+			ResolveSectionExit(particle, index);
+
+		ScalingSpace const& sectionSpace = *particle.GetSectionSpace(index);
+
+		bool const isInSection = !sectionSpace.m_isInfluencing || (nullptr == particle.GetSectionNextSpace(index)) ||
+			(time.Get() < section.m_exitTime.Get());
+
+		if (isInSection)
+		{
+			if (&sectionSpace != &scalingSpace)
+				return false;
+
+			section.ComputeKinetics(time, position, velocity);
+
+			Vector3 primaryPosition, primaryVelocity;
+			scalingSpace.ComputePrimaryKinetics(time, primaryPosition, primaryVelocity);
+
+			position += primaryPosition;
+			velocity += primaryVelocity;
+
+			return true;
+		}
+
+		if ((index + 1 == orbit.GetSectionCount()) && !PredictNextSection(particle))
+			return false; // Beyond the particle's predictable trajectory.
+	}
+
+	return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::MoveParticle(Particle & particle, ScalingSpace & scalingSpace)
+{
+	std::list<UniquePtr<Particle>> & particles = particle.m_pHostSpace->m_particles;
+
+	std::list<UniquePtr<Particle>>::iterator particleIter = std::find_if(particles.begin(), particles.end(),
+		[&](UniquePtr<Particle> const& pParticle) { return pParticle.get() == &particle; });
+
+	assert(particles.end() != particleIter);
+
+	scalingSpace.m_particles.splice(scalingSpace.m_particles.end(), particles, particleIter);
+
+	// The outermost space attached to the particle is scaled relative to the particle's host space.
+	if (!particle.m_attachedSpaces.empty())
+	{
+		std::vector<Particle *> & hostParticles = particle.m_pHostSpace->m_hostParticles;
+		hostParticles.erase(std::find(hostParticles.begin(), hostParticles.end(), &particle));
+
+		scalingSpace.m_hostParticles.push_back(&particle);
+	}
+
+	particle.m_pHostSpace = &scalingSpace;
+
+	if (!particle.m_attachedSpaces.empty())
+	{
+		ScalingSpace & attachedSpace = **particle.m_attachedSpaces.begin();
+
+		attachedSpace.m_pOuterSpace = &scalingSpace;
+		attachedSpace.Initialize(attachedSpace.m_trueRadius / scalingSpace.m_trueRadius, attachedSpace.m_isInfluencing);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::TransferParticle(Particle & particle, ScalingSpace & scalingSpace, Vector3 const& position, Vector3 const& velocity)
+{
+	MoveParticle(particle, scalingSpace);
+
+	particle.Set(position, velocity, &scalingSpace);
+
+	RecordOrbit(ReplayEvent::Type::Transition, particle);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::RecordOrbit(ReplayEvent::Type type, Particle const& particle)
+{
+	if (nullptr == m_pReplayRecorder)
+		return;
+
+	ScalingSpace const& scalingSpace = *particle.m_pHostSpace;
+
+	ReplayEvent event;
+	event.m_type = type;
+	event.m_time = particle.m_epoch;
+	event.m_particleUuid = particle.m_uuid;
+	event.m_spaceUuid = scalingSpace.m_uuid;
+	event.m_mass = particle.m_state.m_mass;
+	event.m_gravityParameter = scalingSpace.m_gravityParameter;
+	event.m_position = particle.m_state.m_localPosition - scalingSpace.m_primaryPosition;
+	event.m_velocity = particle.m_state.m_localVelocity - scalingSpace.m_primaryVelocity;
+
+	m_pReplayRecorder->Record(event);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::FlushReplay()
+{
+	if (nullptr != m_pReplayRecorder)
+		m_pReplayRecorder->Flush();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ScheduleParticle(Particle & particle)
+{
+	++particle.m_eventId; // Invalidates any queued event.
+
+	if (particle.IsRescalePending())
+	{
+		// The event is computed on the orbit which the particle follows once rescaled.
+		particle.ApplyRescale();
+		particle.m_isRescaled = false;
+
+		RecordOrbit(ReplayEvent::Type::Recompute, particle);
+	}
+
+	Time::Microseconds eventTime = 0;
+	bool hasEvent = false;
+
+	if (particle.m_pHostSpace->m_isInfluencing)
+	{
+		Orbit::Section & section = particle.m_orbit.GetCurrentSection();
+
+		if (!section.m_isExitResolved)
+			ResolveSectionExit(particle, 0);
+
+		hasEvent = (nullptr != particle.GetSectionNextSpace(0));
+		eventTime = section.m_exitTime;
+	}
+	else
+	{
+		double delay;
+		hasEvent = ComputeEventDelay(particle, delay);
+		eventTime = particle.m_epoch + RoundEventDelay(delay);
+	}
+
+	// Wake the particle in time to enter the spaces of the other particles in its space, which the exit does not account for.
+	double siblingDelay;
+	if (ComputeSiblingDelay(particle, siblingDelay))
+	{
+		Time::Microseconds const siblingEventTime = particle.m_epoch + RoundEventDelay(siblingDelay);
+
+		if (!hasEvent || (siblingEventTime.Get() < eventTime.Get()))
+			eventTime = siblingEventTime;
+
+		hasEvent = true;
+	}
+
+	if (!hasEvent)
+	{
+		particle.m_eventTime = std::numeric_limits<int64_t>::max();
+		return;
+	}
+
+	assert(particle.m_epoch.Get() < eventTime.Get()); // Would wake the particle at its epoch again, and again.
+
+	particle.m_eventTime = eventTime;
+
+	m_particleUpdateQueue.Insert(ParticleEvent{ eventTime, &particle, particle.m_eventId });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ScheduleScalingSpace(ScalingSpace & scalingSpace)
+{
+	for (UniquePtr<Particle> & pParticle : scalingSpace.m_particles)
+	{
+		pParticle->DiscardPrediction(); // Predicted crossings depend on the radii of the spaces.
+
+		ScheduleParticle(*pParticle);
+
+		for (UniquePtr<ScalingSpace> & pAttachedSpace : pParticle->m_attachedSpaces)
+			ScheduleScalingSpace(*pAttachedSpace);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ScheduleSpaceParticles(ScalingSpace & scalingSpace)
+{
+	for (UniquePtr<Particle> & pParticle : scalingSpace.m_particles)
+	{
+		pParticle->DiscardPrediction();
+
+		ScheduleParticle(*pParticle);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ScheduleSiblings(Particle & hostParticle)
+{
+	// Only the siblings whose events fall after the time they could reach the particle's spaces are rescheduled. The bounds from
+	// where the particle was are at worst early, and the sibling is rescheduled when it wakes.
+	for (UniquePtr<Particle> & pParticle : hostParticle.m_pHostSpace->m_particles)
+	{
+		Particle & particle = *pParticle;
+
+		if (&particle == &hostParticle)
+			continue;
+
+		if (!particle.IsRescalePending())
+		{
+			Vector3 localPosition, localVelocity;
+			ComputeLocalKinetics(particle, localPosition, localVelocity);
+
+			float const speedBound = ComputeSpeedBound(particle.m_orbit.GetCurrentSection().m_elements);
+			double const delay = ComputeHostParticleDelay(particle, localPosition, speedBound, hostParticle);
+
+			if (particle.m_eventTime.Get() <= (particle.m_epoch + RoundEventDelay(delay)).Get())
+				continue;
+		}
+
+		ScheduleParticle(particle);
+	}
+}
+
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ProcessParticleEvent(Particle & particle)
+{
+	bool hasMoved = false;
+
+	if (HasPredictedCrossing(particle))
+	{
+		MoveParticle(particle, *particle.GetSectionSpace(1));
+
+		EnterPredictedSection(particle);
+
+		RecordOrbit(ReplayEvent::Type::Transition, particle);
+
+		hasMoved = true;
+	}
+	else
+	{
+		ScalingSpace * pScalingSpace = nullptr;
+		Vector3 position, velocity;
+
+		if (DetectCrossing(particle, pScalingSpace, position, velocity))
+		{
+			TransferParticle(particle, *pScalingSpace, position, velocity);
+
+			hasMoved = true;
+		}
+	}
+
+	ScheduleParticle(particle);
+
+	if (hasMoved && !particle.m_attachedSpaces.empty())
+	{
+		// The trajectories of particles which leave the attached spaces depend on the particle's trajectory, and the particles of
+		// the space entered can now enter them.
+		for (UniquePtr<ScalingSpace> & pAttachedSpace : particle.m_attachedSpaces)
+			ScheduleScalingSpace(*pAttachedSpace);
+
+		ScheduleSiblings(particle);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem::HasPredictedCrossing(Particle & particle)
+{
+	Orbit const& orbit = particle.m_orbit;
+	Orbit::Section const& section = orbit.GetCurrentSection();
+
+	// A particle may be woken before its section's exit, to check whether it enters the space of another particle.
+	if ((nullptr == particle.GetSectionNextSpace(0)) || (particle.m_epoch.Get() < section.m_exitTime.Get()))
+		return false;
+
+	return (1 < orbit.GetSectionCount()) || PredictNextSection(particle);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::EnterPredictedSection(Particle & particle)
+{
+	assert(particle.GetSectionSpace(1) == particle.m_pHostSpace); // The particle has been moved to the space entered.
+
+	particle.AdvanceSection();
+
+	Orbit::Section const& section = particle.m_orbit.GetCurrentSection();
+	ScalingSpace const& scalingSpace = *particle.m_pHostSpace;
+
+	Vector3 positionFromPrimary, velocityFromPrimary;
+	section.m_elements.ComputeKinetics(section.m_trueAnomalyEntry, positionFromPrimary, velocityFromPrimary);
+
+	particle.m_state.m_localPosition = scalingSpace.m_primaryPosition + positionFromPrimary;
+	particle.m_state.m_localVelocity = scalingSpace.m_primaryVelocity + velocityFromPrimary;
+
+	// The state is scaled to the space entered as it is now. Predictions are discarded when a space is rescaled.
+	particle.m_scale = scalingSpace.m_scale;
+	particle.m_scaleGeneration = scalingSpace.m_scaleGeneration;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem::DetectCrossing(Particle const& particle, ScalingSpace *& pScalingSpace, Vector3 & position, Vector3 & velocity)
+{
+	ScalingSpace & scalingSpace = *particle.m_pHostSpace;
+
+	Vector3 localPosition, localVelocity;
+	ComputeLocalKinetics(particle, localPosition, localVelocity);
+
+	float const radialDistance = sqrtf(localPosition.SqareMagnitude());
+
+	// A resolved exit which is due is taken even if the state, at the event rounded to a whole microsecond, falls just short of
+	// the boundary. Otherwise the particle, its next section unpredictable, would be woken at the same time again.
+	Orbit::Section const& section = particle.m_orbit.GetCurrentSection();
+	bool const isExitDue = scalingSpace.m_isInfluencing && section.m_isExitResolved && (nullptr != particle.GetSectionNextSpace(0)) &&
+		(section.m_exitTime.Get() <= particle.m_epoch.Get());
+
+	ScalingSpace const* const pExitSpace = isExitDue ? particle.GetSectionNextSpace(0) : nullptr;
+
+	pScalingSpace = nullptr;
+
+	if ((nullptr != scalingSpace.m_pOuterSpace) && ((pExitSpace == scalingSpace.m_pOuterSpace) || ShouldAscend(radialDistance)))
+	{
+		pScalingSpace = scalingSpace.m_pOuterSpace;
+
+		position = localPosition * scalingSpace.m_radius;
+		velocity = localVelocity * scalingSpace.m_radius;
+
+		if (pScalingSpace->m_pHost != scalingSpace.m_pHost)
+		{
+			// The outer space is the host particle's host space: offset by the host particle's state at the particle's epoch,
+			// which the host particle, woken only by its own events, has not necessarily been propagated to.
+			Vector3 hostPosition, hostVelocity;
+			scalingSpace.m_pHost->ComputeKinetics(particle.m_epoch, hostPosition, hostVelocity);
+
+			position += hostPosition;
+			velocity += hostVelocity;
+		}
+	}
+	else if ((nullptr != scalingSpace.m_pInnerSpace) &&
+		((pExitSpace == scalingSpace.m_pInnerSpace) || ShouldDescend(radialDistance, *scalingSpace.m_pInnerSpace)))
+	{
+		pScalingSpace = scalingSpace.m_pInnerSpace;
+
+		position = localPosition / pScalingSpace->m_radius;
+		velocity = localVelocity / pScalingSpace->m_radius;
+	}
+	else
+	{
+		// Enter the outermost space attached to another particle in the space, relative to that particle.
+		for (Particle * pHostParticle : scalingSpace.m_hostParticles)
+		{
+			if (pHostParticle == &particle)
+				continue;
+
+			ScalingSpace & attachedSpace = **pHostParticle->m_attachedSpaces.begin();
+
+			Vector3 hostPosition, hostVelocity;
+			pHostParticle->ComputeKinetics(particle.m_epoch, hostPosition, hostVelocity);
+
+			Vector3 const relativePosition = localPosition - hostPosition;
+
+			if (ShouldDescend(sqrtf(relativePosition.SqareMagnitude()), attachedSpace))
+			{
+				pScalingSpace = &attachedSpace;
+
+				position = relativePosition / attachedSpace.m_radius;
+				velocity = (localVelocity - hostVelocity) / attachedSpace.m_radius;
+
+				break;
+			}
+		}
+
+		if (nullptr == pScalingSpace)
+			return false;
+	}
+
+	if (!pScalingSpace->m_isInfluencing)
+	{
+		// The states of the particles in a non-influencing space are offset by its cached primary kinetics.
+		Vector3 primaryPosition, primaryVelocity;
+		pScalingSpace->ComputePrimaryKinetics(particle.m_epoch, primaryPosition, primaryVelocity);
+
+		position += pScalingSpace->m_primaryPosition - primaryPosition;
+		velocity += pScalingSpace->m_primaryVelocity - primaryVelocity;
+	}
+
+	return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ComputeLocalKinetics(Particle const& particle, Vector3 & position, Vector3 & velocity)
+{
+	if (particle.m_pHostSpace->m_isInfluencing)
+	{
+		position = particle.m_state.m_localPosition;
+		velocity = particle.m_state.m_localVelocity;
+	}
+	else
+	{
+		// The state is offset by the cached primary kinetics: place the primary where it is at the particle's epoch.
+		particle.ComputeKinetics(particle.m_epoch, position, velocity);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem::ProcessTransitions()
+{
+	m_batchParticles.clear();
+	m_transitions.clear();
+	m_spaceOrder.clear();
+
+	// Detect the crossings in queue order. Predicting a section may extend the prediction of the particle's host particle, so
+	// detection is not done in parallel.
+	for (ParticleEvent const& particleEvent : m_dueEvents)
+	{
+		Particle & particle = *particleEvent.m_pParticle;
+
+		if (!particle.m_attachedSpaces.empty())
+			continue; // Already processed.
+
+		m_batchParticles.push_back(&particle);
+
+		Transition transition;
+		transition.m_pParticle = &particle;
+		transition.m_pSourceSpace = particle.m_pHostSpace;
+
+		if (HasPredictedCrossing(particle))
+		{
+			transition.m_pSpace = particle.GetSectionSpace(1);
+			transition.m_isPredicted = true;
+		}
+		else if (!DetectCrossing(particle, transition.m_pSpace, transition.m_position, transition.m_velocity))
+		{
+			continue;
+		}
+
+		m_spaceOrder.emplace(transition.m_pSourceSpace, static_cast<uint32_t>(m_spaceOrder.size()));
+		m_spaceOrder.emplace(transition.m_pSpace, static_cast<uint32_t>(m_spaceOrder.size()));
+
+		m_transitions.push_back(transition);
+	}
+
+	// Group by source space, then by destination space and kind, in order of first appearance.
+	std::stable_sort(m_transitions.begin(), m_transitions.end(), [&](Transition const& lhs, Transition const& rhs)
+	{
+		uint32_t const lhsSource = m_spaceOrder[lhs.m_pSourceSpace], rhsSource = m_spaceOrder[rhs.m_pSourceSpace];
+		uint32_t const lhsSpace = m_spaceOrder[lhs.m_pSpace], rhsSpace = m_spaceOrder[rhs.m_pSpace];
+
+		return std::tie(lhsSource, lhsSpace, lhs.m_isPredicted) < std::tie(rhsSource, rhsSpace, rhs.m_isPredicted);
+	});
+
+	size_t const transitionCount = m_transitions.size();
+
+	m_transitionPositions.resize(transitionCount);
+	m_transitionVelocities.resize(transitionCount);
+	m_transitionElements.resize(transitionCount);
+
+	uint32_t groupCount = 0;
+
+	for (size_t begin = 0, end = 0; begin < transitionCount; begin = end)
+	{
+		Transition const& first = m_transitions[begin];
+
+		for (end = begin; (end < transitionCount) && (m_transitions[end].m_pSourceSpace == first.m_pSourceSpace) &&
+			(m_transitions[end].m_pSpace == first.m_pSpace) && (m_transitions[end].m_isPredicted == first.m_isPredicted); ++end)
+		{
+			m_transitions[end].m_groupIndex = groupCount;
+		}
+
+		++groupCount;
+
+		if (first.m_isPredicted)
+			continue;
+
+		// Recompute the group's orbits about the primary of the space entered in one batch.
+		ScalingSpace const& scalingSpace = *first.m_pSpace;
+
+		for (size_t index = begin; index < end; ++index)
+		{
+			m_transitionPositions[index] = m_transitions[index].m_position - scalingSpace.GetPrimaryPosition();
+			m_transitionVelocities[index] = m_transitions[index].m_velocity - scalingSpace.GetPrimaryVelocity();
+		}
+
+		Orbit::ComputeElements(scalingSpace.GetGravityParameter(),
+			std::span<Vector3 const>(m_transitionPositions.data() + begin, end - begin),
+			std::span<Vector3 const>(m_transitionVelocities.data() + begin, end - begin),
+			std::span<Orbit::Elements>(m_transitionElements.data() + begin, end - begin));
+	}
+
+	// Walk each source space's particle list once, moving the particles which leave it to their groups' lists.
+	if (m_groupParticles.size() < groupCount)
+		m_groupParticles.resize(groupCount);
+
+	for (size_t begin = 0, end = 0; begin < transitionCount; begin = end)
+	{
+		ScalingSpace & sourceSpace = *m_transitions[begin].m_pSourceSpace;
+
+		m_particleGroups.clear();
+
+		for (end = begin; (end < transitionCount) && (m_transitions[end].m_pSourceSpace == &sourceSpace); ++end)
+			m_particleGroups.emplace(m_transitions[end].m_pParticle, m_transitions[end].m_groupIndex);
+
+		std::list<UniquePtr<Particle>> & particles = sourceSpace.m_particles;
+
+		size_t remainingCount = m_particleGroups.size();
+
+		for (std::list<UniquePtr<Particle>>::iterator particleIter = particles.begin(); (0 < remainingCount) && (particles.end() != particleIter); )
+		{
+			std::list<UniquePtr<Particle>>::iterator const currentIter = particleIter++;
+
+			auto const groupIter = m_particleGroups.find(currentIter->get());
+			if (m_particleGroups.end() == groupIter)
+				continue;
+
+			std::list<UniquePtr<Particle>> & groupParticles = m_groupParticles[groupIter->second];
+			groupParticles.splice(groupParticles.end(), particles, currentIter);
+
+			--remainingCount;
+		}
+
+		assert(0 == remainingCount);
+	}
+
+	// Splice each group into the space entered, and set its particles there.
+	for (size_t index = 0; index < transitionCount; ++index)
+	{
+		Transition const& transition = m_transitions[index];
+		Particle & particle = *transition.m_pParticle;
+
+		std::list<UniquePtr<Particle>> & groupParticles = m_groupParticles[transition.m_groupIndex];
+
+		if (!groupParticles.empty())
+			transition.m_pSpace->m_particles.splice(transition.m_pSpace->m_particles.end(), groupParticles);
+
+		particle.m_pHostSpace = transition.m_pSpace;
+
+		if (transition.m_isPredicted)
+			EnterPredictedSection(particle);
+		else
+			particle.Set(transition.m_position, transition.m_velocity, transition.m_pSpace, m_transitionElements[index]);
+
+		RecordOrbit(ReplayEvent::Type::Transition, particle);
+	}
+
+	// Resolve the next exits of the particles in influencing spaces in parallel, then schedule every particle in queue order.
+	ForEachChunk(m_batchParticles.size(), [&](size_t begin, size_t end)
+	{
+		for (size_t index = begin; index < end; ++index)
+		{
+			Particle & particle = *m_batchParticles[index];
+			Orbit::Section & section = particle.m_orbit.GetCurrentSection();
+
+			if (particle.m_pHostSpace->m_isInfluencing && !section.m_isExitResolved)
+				ResolveSectionExit(particle, 0);
+		}
+	});
+
+	for (Particle * pParticle : m_batchParticles)
+		ScheduleParticle(*pParticle);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+OrbitalSystemTestScript::OrbitalSystemTestScript() :
+	ITestScript("OrbitalSystem")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+OrbitalSystemTestScript::~OrbitalSystemTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystemTestScript::RunImpl(TestHandler & testHandler)
+{
+	static constexpr float hostMass = kTestHostMass, hostSpaceTrueRadius = kTestHostSpaceTrueRadius;
+	static float const hostGravityParameter = ScalingSpace::ComputeScaledGravityParameter(hostSpaceTrueRadius, hostMass);
+
+	TestHandler::OutputMode const outputMode = testHandler.SetOutputMode(TestHandler::VERBOSE);
+
+	OrbitalSystem orbitalSystem(hostMass, hostSpaceTrueRadius);
+
+	Particle::ScalingSpaceList const& hostScalingSpaces = orbitalSystem.GetScalingSpaces();
+
+	testHandler.Assert(hostScalingSpaces.size(), 1ull, "Host scaling space exists");
+
+	ScalingSpace & hostSpace = orbitalSystem.GetHostSpace();
+
+	testHandler.Assert(hostSpace.m_uuid, (*hostScalingSpaces.begin())->m_uuid, "Host space UUID");
+
+	// Host space.
+	testHandler.Assert(hostSpace.GetRadius(), 1.f, "Host space radius");
+	testHandler.Assert(hostSpace.GetTrueRadius(), hostSpaceTrueRadius, "Host space true radius");
+	testHandler.Assert(hostSpace.GetGravityParameter(), hostGravityParameter, "Host space gravity parameter");
+
+	// Adding host spaces.
+	testHandler.Assert<int, int>([&](int index)
+	{
+		float const trueRadius = hostSpaceTrueRadius / powf(2.f, static_cast<float>(index));
+		float const radius = 1.f / powf(2.f, static_cast<float>(index));
+
+		ScalingSpace & newHostSpace = orbitalSystem.CreateScalingSpace(trueRadius);
+
+		testHandler.Assert(newHostSpace.GetTrueRadius(), trueRadius, "True radius");
+		testHandler.Assert(newHostSpace.GetRadius(), radius, "Radius");
+
+		auto newSpaceIter = --hostScalingSpaces.cend();
+		testHandler.Assert((*newSpaceIter)->m_uuid, newHostSpace.m_uuid, "List position");
+
+		auto prevSpaceIter = newSpaceIter; --prevSpaceIter;
+		testHandler.Assert(reinterpret_cast<uintptr_t>(newHostSpace.m_pInnerSpace), reinterpret_cast<uintptr_t>(nullptr), "Inner space pointer");
+		testHandler.Assert(reinterpret_cast<uintptr_t>(newHostSpace.m_pOuterSpace), reinterpret_cast<uintptr_t>(prevSpaceIter->get()), "Outer space pointer");
+		testHandler.Assert(reinterpret_cast<uintptr_t>((*prevSpaceIter)->m_pInnerSpace), reinterpret_cast<uintptr_t>(newSpaceIter->get()), "Outer space's inner space pointer");
+
+		return static_cast<int>(hostScalingSpaces.size());
+
+	}, TestHandler::FRangeIndex<int>(), TestHandler::FRangeIndex<int>(1), "Adding host spaces", TestHandler::IndexRange<int>{ 1, 10 });
+
+	// Creating particles.
+	Particle & newParticle = orbitalSystem.CreateParticle(1.f, { 0.75f, 0.f, 0.f },
+		{ 0.f, hostSpace.CircularOrbitSpeed(0.75f), 0.f }, hostSpace);
+
+	// Updating particles.
+	orbitalSystem.OnUpdate(newParticle.m_orbit.GetCurrentSection().m_elements.m_period);
+	orbitalSystem.Synchronize();
+
+	testHandler.Assert((newParticle.GetState().m_localPosition - Vector3(0.75f, 0.f, 0.f)).SqareMagnitude() < 1e-6f, true,
+		"Particle returns to its initial position after one orbit period");
+
+	// Evaluating between ticks matches updating to the same time.
+	Time::Microseconds const quarterPeriod = newParticle.m_orbit.GetCurrentSection().m_elements.m_period.Get() / 4;
+
+	Vector3 renderPosition, renderVelocity;
+	newParticle.ComputeKinetics(orbitalSystem.GetTime() + quarterPeriod, renderPosition, renderVelocity);
+
+	orbitalSystem.OnUpdate(quarterPeriod);
+	orbitalSystem.Synchronize();
+
+	testHandler.Assert((newParticle.GetState().m_localPosition - renderPosition).SqareMagnitude() < 1e-10f, true,
+		"Particle state evaluated ahead of its epoch matches the updated state");
+
+	// Scheduled scaling space transitions: periapsis (~0.107) lies inside the third inner host space (radius 1/8).
+	Particle & eccentricParticle = orbitalSystem.CreateParticle(1.f, { 0.75f, 0.f, 0.f },
+		{ 0.f, 0.5f * hostSpace.CircularOrbitSpeed(0.75f), 0.f }, hostSpace);
+
+	Time::Microseconds const halfPeriod = eccentricParticle.m_orbit.GetCurrentSection().m_elements.m_period.Get() / 2;
+
+	// Predicted trajectory: down through the host spaces to the periapsis space, and back out to the apoapsis space.
+	Orbit const& trajectory = eccentricParticle.GetOrbit();
+
+	testHandler.Assert(orbitalSystem.PredictTrajectory(eccentricParticle, 7, halfPeriod.Get() * 2), 7ull, "Predicted section count");
+	testHandler.Assert<float, int>([&](int index) { return eccentricParticle.GetSectionSpace(index)->GetTrueRadius(); },
+		TestHandler::FRangeIndex<int>(), [](int index) { return hostSpaceTrueRadius / powf(2.f, static_cast<float>(3 - abs(index - 3))); },
+		"Predicted section spaces", TestHandler::IndexRange<int>(0, 6));
+	testHandler.Assert<bool, int>([&](int index) { return trajectory.GetSection(index).m_entryTime == trajectory.GetSection(index - 1).m_exitTime; },
+		TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Predicted sections are contiguous", TestHandler::IndexRange<int>(1, 6));
+
+	Time::Microseconds const periapsisEntryTime = trajectory.GetSection(3).m_entryTime;
+
+	orbitalSystem.OnUpdate(halfPeriod);
+
+	testHandler.Assert(eccentricParticle.GetHostSpace()->GetTrueRadius(), hostSpaceTrueRadius / 8.f, "Particle descends to periapsis space");
+	testHandler.Assert(trajectory.GetCurrentSection().m_entryTime.Get(), periapsisEntryTime.Get(), "Particle follows the predicted trajectory");
+
+	orbitalSystem.OnUpdate(halfPeriod);
+
+	testHandler.Assert(eccentricParticle.GetHostSpace()->m_uuid, hostSpace.m_uuid, "Particle ascends to apoapsis space");
+
+	// Parallel update.
+	{
+		TaskPool taskPool(4);
+
+		TestSystem serialSystem, parallelSystem;
+		parallelSystem.m_orbitalSystem.SetTaskPool(&taskPool);
+
+		for (TestSystem * pSystem : { &serialSystem, &parallelSystem })
+		{
+			for (int i = 0; i < 200; ++i)
+				pSystem->CreateOrbiter(pSystem->GetHostSpace(), 1.f, 0.1f + 0.004f * static_cast<float>(i), 0.f, 0.6f + 0.002f * static_cast<float>(i));
+		}
+
+		for (int step = 0; step < 16; ++step)
+		{
+			serialSystem.m_orbitalSystem.OnUpdate(halfPeriod.Get() / 8);
+			parallelSystem.m_orbitalSystem.OnUpdate(halfPeriod.Get() / 8);
+		}
+
+		serialSystem.m_orbitalSystem.Synchronize();
+		parallelSystem.m_orbitalSystem.Synchronize();
+
+		testHandler.Assert<bool, int>([&](int index)
+		{
+			return serialSystem.m_particles[index]->GetState().m_localPosition == parallelSystem.m_particles[index]->GetState().m_localPosition;
+
+		}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Parallel update matches serial update", TestHandler::IndexRange<int>(0, 199));
+	}
+
+	// Parallel update with transitions: more particles cross between nested spaces in a tick than fit in one chunk.
+	{
+		static constexpr int kParticleCount = 256;
+
+		TaskPool taskPool(4);
+
+		TestSystem serialSystem({ 0.5f, 0.25f, 0.125f }), parallelSystem({ 0.5f, 0.25f, 0.125f });
+		parallelSystem.m_orbitalSystem.SetTaskPool(&taskPool);
+
+		for (TestSystem * pSystem : { &serialSystem, &parallelSystem })
+		{
+			for (int i = 0; i < kParticleCount; ++i)
+				pSystem->CreateOrbiter(pSystem->GetHostSpace(), 1.f, 0.75f, 0.0245f * static_cast<float>(i), 0.3f);
+		}
+
+		std::vector<Particle *> const& parallelParticles = parallelSystem.m_particles;
+
+		size_t maxTransitionCount = 0;
+		std::vector<ScalingSpace const*> hostSpaces(kParticleCount);
+
+		for (int step = 0; step < 16; ++step)
+		{
+			for (int i = 0; i < kParticleCount; ++i)
+				hostSpaces[i] = parallelParticles[i]->GetHostSpace();
+
+			serialSystem.m_orbitalSystem.OnUpdate(halfPeriod.Get() / 8);
+			parallelSystem.m_orbitalSystem.OnUpdate(halfPeriod.Get() / 8);
+
+			size_t transitionCount = 0;
+			for (int i = 0; i < kParticleCount; ++i)
+				transitionCount += (hostSpaces[i] != parallelParticles[i]->GetHostSpace()) ? 1 : 0;
+
+			maxTransitionCount = std::max(maxTransitionCount, transitionCount);
+		}
+
+		serialSystem.m_orbitalSystem.Synchronize();
+		parallelSystem.m_orbitalSystem.Synchronize();
+
+		testHandler.Assert(kParallelChunkSize < maxTransitionCount, true, "Transitions in a tick span several parallel chunks");
+		testHandler.Assert<bool, int>([&](int index)
+		{
+			Particle const& serialParticle = *serialSystem.m_particles[index];
+			Particle const& parallelParticle = *parallelParticles[index];
+
+			return (serialParticle.GetHostSpace()->GetTrueRadius() == parallelParticle.GetHostSpace()->GetTrueRadius()) &&
+				(serialParticle.GetState().m_localPosition == parallelParticle.GetState().m_localPosition) &&
+				(serialParticle.GetState().m_localVelocity == parallelParticle.GetState().m_localVelocity);
+
+		}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Parallel transitions match serial transitions",
+			TestHandler::IndexRange<int>(0, kParticleCount - 1));
+	}
+
+	// Batched transitions: a debris cloud crossing the spaces together follows the same trajectories as each particle alone.
+	{
+		static constexpr int kDebrisCount = 32;
+
+		auto const createDebris = [&](TestSystem & system, int index)
+		{
+			system.CreateOrbiter(system.GetHostSpace(), 1.f, 0.75f, 0.02f * static_cast<float>(index), 0.4f + 0.01f * static_cast<float>(index));
+		};
+
+		TestSystem cloudSystem({ 0.5f, 0.25f, 0.125f });
+		std::vector<UniquePtr<TestSystem>> aloneSystems;
+
+		for (int index = 0; index < kDebrisCount; ++index)
+		{
+			createDebris(cloudSystem, index);
+
+			aloneSystems.push_back(MakeUnique<TestSystem>(std::initializer_list<float>{ 0.5f, 0.25f, 0.125f }));
+			createDebris(*aloneSystems.back(), index);
+		}
+
+		for (int step = 0; step < 16; ++step)
+		{
+			cloudSystem.m_orbitalSystem.OnUpdate(halfPeriod.Get() / 4);
+
+			for (UniquePtr<TestSystem> & pAloneSystem : aloneSystems)
+				pAloneSystem->m_orbitalSystem.OnUpdate(halfPeriod.Get() / 4);
+		}
+
+		cloudSystem.m_orbitalSystem.Synchronize();
+
+		for (UniquePtr<TestSystem> & pAloneSystem : aloneSystems)
+			pAloneSystem->m_orbitalSystem.Synchronize();
+
+		std::set<float> debrisSpaceRadii;
+		for (Particle const* pParticle : cloudSystem.m_particles)
+			debrisSpaceRadii.insert(pParticle->GetHostSpace()->GetTrueRadius());
+
+		testHandler.Assert(1 < debrisSpaceRadii.size(), true, "Debris cloud spreads across the spaces");
+		testHandler.Assert<bool, int>([&](int index)
+		{
+			Particle const& cloudParticle = *cloudSystem.m_particles[index];
+			Particle const& aloneParticle = *aloneSystems[index]->m_particles[0];
+
+			return (cloudParticle.GetHostSpace()->GetTrueRadius() == aloneParticle.GetHostSpace()->GetTrueRadius()) &&
+				(cloudParticle.GetState().m_localPosition == aloneParticle.GetState().m_localPosition) &&
+				(cloudParticle.GetState().m_localVelocity == aloneParticle.GetState().m_localVelocity);
+
+		}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Debris cloud matches debris alone", TestHandler::IndexRange<int>(0, kDebrisCount - 1));
+	}
+
+	// Lazy rescaling: a space created around an existing space recomputes the orbits of the inner space's particles when each
+	// particle's own event falls due, as if the spaces had been created first.
+	{
+		TestSystem lazySystem({ 0.125f }), eagerSystem({ 0.25f, 0.125f });
+
+		// Leaves the inner space, for the space created around it in the lazy system.
+		Particle & lazyParticle = lazySystem.CreateOrbiter(lazySystem.GetInnermostSpace(), 1.f, 0.1f, 0.f, 1.37f);
+		Particle & eagerParticle = eagerSystem.CreateOrbiter(eagerSystem.GetInnermostSpace(), 1.f, 0.1f, 0.f, 1.37f);
+
+		lazySystem.m_orbitalSystem.CreateScalingSpace(hostSpaceTrueRadius / 4.f);
+		lazySystem.m_orbitalSystem.OnUpdate(1);
+		eagerSystem.m_orbitalSystem.OnUpdate(1);
+
+		testHandler.Assert(lazyParticle.IsRescalePending() && (lazyParticle.GetEpoch().Get() == 0), true,
+			"Rescale is deferred to the particle's own event");
+
+		Time::Microseconds const period = eagerParticle.GetOrbit().GetCurrentSection().m_elements.m_period;
+
+		Vector3 lazyPosition, lazyVelocity, eagerPosition, eagerVelocity;
+		lazyParticle.ComputeKinetics(period.Get() / 8, lazyPosition, lazyVelocity);
+		eagerParticle.ComputeKinetics(period.Get() / 8, eagerPosition, eagerVelocity);
+
+		testHandler.Assert((lazyPosition == eagerPosition) && (lazyVelocity == eagerVelocity), true,
+			"Evaluating a particle accounts for its pending rescale");
+
+		for (int step = 0; step < 16; ++step)
+		{
+			lazySystem.m_orbitalSystem.OnUpdate(period.Get() / 16);
+			eagerSystem.m_orbitalSystem.OnUpdate(period.Get() / 16);
+		}
+
+		lazySystem.m_orbitalSystem.Synchronize();
+		eagerSystem.m_orbitalSystem.Synchronize();
+
+		testHandler.Assert((lazyParticle.GetHostSpace()->GetTrueRadius() == eagerParticle.GetHostSpace()->GetTrueRadius()) &&
+			((lazyParticle.GetState().m_localPosition - eagerParticle.GetState().m_localPosition).SqareMagnitude() < 1e-10f) &&
+			((lazyParticle.GetState().m_localVelocity - eagerParticle.GetState().m_localVelocity).SqareMagnitude() < 1e-10f), true,
+			"Lazy rescale matches eager rescale");
+	}
+
+	// A space created around a particle takes in the particles near the particle, relative to where the particle is.
+	{
+		static constexpr float kPlanetMass = 1e27f;
+
+		OrbitalSystem captureSystem(hostMass, hostSpaceTrueRadius);
+		ScalingSpace & captureHostSpace = captureSystem.GetHostSpace();
+
+		Particle & planet = captureSystem.CreateParticle(kPlanetMass, { 0.5f, 0.f, 0.f },
+			{ 0.f, hostSpace.CircularOrbitSpeed(0.5f), 0.f }, captureHostSpace);
+		Particle & nearParticle = captureSystem.CreateParticle(1.f, { 0.55f, 0.f, 0.f },
+			{ 0.f, hostSpace.CircularOrbitSpeed(0.55f), 0.f }, captureHostSpace);
+		Particle & farParticle = captureSystem.CreateParticle(1.f, { 0.f, 0.05f, 0.f },
+			{ -hostSpace.CircularOrbitSpeed(0.05f), 0.f, 0.f }, captureHostSpace);
+
+		ScalingSpace & planetSpace = captureSystem.CreateScalingSpace(0.08f * hostSpaceTrueRadius, planet);
+
+		testHandler.Assert((nearParticle.GetHostSpace() == &planetSpace) && (farParticle.GetHostSpace() == &captureHostSpace) &&
+			(planet.GetHostSpace() == &captureHostSpace), true, "Space created around a particle takes in the particles near it");
+	}
+
+	// A space around a planet containing a moon with a space of its own is resized when a larger space is created around the planet,
+	// and the moon keeps to the trajectory it follows in a system where the spaces were created largest first.
+	{
+		static constexpr float kPlanetMass = 1e27f;
+
+		// The particles are created in order: planet, then moon.
+		auto const setUpResizeSystem = [&](TestSystem & system, std::initializer_list<float> planetSpaceRadii)
+		{
+			Particle & planet = system.CreateOrbiter(system.GetHostSpace(), kPlanetMass, 0.5f, 0.f);
+			Particle & moon = system.CreateOrbiter(system.GetHostSpace(), 1.f, 0.55f, 0.f);
+
+			system.m_orbitalSystem.CreateScalingSpace(0.005f * hostSpaceTrueRadius, moon);
+
+			// The planet's spaces take the moon in as they are created.
+			for (float radius : planetSpaceRadii)
+				system.m_orbitalSystem.CreateScalingSpace(radius * hostSpaceTrueRadius, planet);
+		};
+
+		TestSystem resizedSystem, referenceSystem;
+		setUpResizeSystem(resizedSystem, { 0.08f });
+		setUpResizeSystem(referenceSystem, { 0.16f, 0.08f });
+
+		Particle & planet = *resizedSystem.m_particles[0];
+		Particle & moon = *resizedSystem.m_particles[1];
+		Particle const& referenceMoon = *referenceSystem.m_particles[1];
+
+		ScalingSpace *const pMoonHostSpace = moon.GetHostSpace();
+		Vector3 const moonPosition = moon.GetState().m_localPosition;
+
+		resizedSystem.m_orbitalSystem.CreateScalingSpace(0.16f * hostSpaceTrueRadius, planet);
+
+		testHandler.Assert((moon.GetHostSpace() == pMoonHostSpace) && (pMoonHostSpace->GetTrueRadius() == 0.08f * hostSpaceTrueRadius) &&
+			(moon.GetState().m_localPosition == moonPosition), true, "Resizing a space keeps its host particles");
+
+		Time::Microseconds const period = planet.GetOrbit().GetCurrentSection().m_elements.m_period;
+
+		for (int step = 0; step < 8; ++step)
+		{
+			resizedSystem.m_orbitalSystem.OnUpdate(period.Get() / 256);
+			referenceSystem.m_orbitalSystem.OnUpdate(period.Get() / 256);
+		}
+
+		resizedSystem.m_orbitalSystem.Synchronize();
+		referenceSystem.m_orbitalSystem.Synchronize();
+
+		testHandler.Assert((moon.GetHostSpace()->GetTrueRadius() == referenceMoon.GetHostSpace()->GetTrueRadius()) &&
+			((moon.GetState().m_localPosition - referenceMoon.GetState().m_localPosition).SqareMagnitude() < 1e-10f),
+			true, "Host particle in a resized space matches a system created at its final size");
+	}
+
+	// Particle-hosted spaces: a particle flying by a planet enters the planet's spaces where its own trajectory takes it, and
+	// leaves them relative to where the planet is at the time, which the planet, woken by no events, has not been propagated to.
+	{
+		static constexpr float kPlanetMass = 1e27f;
+		static constexpr int kStepCount = 400;
+
+		float const planetSpeed = hostSpace.CircularOrbitSpeed(0.5f);
+
+		struct FlybyResult
+		{
+			bool	m_hasEntered = false;
+			bool	m_hasLeft = false;
+			float	m_entryError = 0.f;			// Distance from the entry position to the position on the particle's original orbit.
+			float	m_exitDistance = 0.f;		// Distance from the planet on leaving, scaled to the space left.
+			float	m_finalError = 0.f;			// Distance from the final position to the position on the particle's original orbit.
+		};
+
+		auto const flyBy = [&](Vector3 const& position, float spaceTrueRadius)
+		{
+			OrbitalSystem flybySystem(hostMass, hostSpaceTrueRadius);
+			OrbitalSystem ghostSystem(hostMass, hostSpaceTrueRadius);
+
+			ScalingSpace & flybyHostSpace = flybySystem.GetHostSpace();
+
+			Particle & planet = flybySystem.CreateParticle(kPlanetMass, { 0.5f, 0.f, 0.f }, { 0.f, planetSpeed, 0.f }, flybyHostSpace);
+
+			ScalingSpace & planetSpace = (0.f < spaceTrueRadius) ? flybySystem.CreateScalingSpace(spaceTrueRadius, planet) :
+				**planet.GetScalingSpaceList().begin();
+
+			Vector3 const velocity(0.f, 1.3f * planetSpeed, 0.f);
+
+			Particle & particle = flybySystem.CreateParticle(1.f, position, velocity, flybyHostSpace);
+			Particle & ghost = ghostSystem.CreateParticle(1.f, position, velocity, ghostSystem.GetHostSpace());
+
+			Time::Microseconds const step = planet.GetOrbit().GetCurrentSection().m_elements.m_period.Get() / 1000;
+
+			FlybyResult result;
+
+			for (int index = 0; index < kStepCount; ++index)
+			{
+				flybySystem.OnUpdate(step);
+				ghostSystem.OnUpdate(step);
+
+				bool const isInPlanetSpace = (particle.GetHostSpace() == &planetSpace);
+				if (isInPlanetSpace == result.m_hasEntered)
+					continue;
+
+				Vector3 localPosition, localVelocity, planetPosition, planetVelocity, ghostPosition, ghostVelocity;
+				particle.ComputeKinetics(particle.GetEpoch(), localPosition, localVelocity);
+				planet.ComputeKinetics(particle.GetEpoch(), planetPosition, planetVelocity);
+				ghost.ComputeKinetics(particle.GetEpoch(), ghostPosition, ghostVelocity);
+
+				if (isInPlanetSpace)
+				{
+					result.m_hasEntered = true;
+					result.m_entryError = sqrtf((localPosition * planetSpace.GetRadius() + planetPosition - ghostPosition).SqareMagnitude());
+				}
+				else if (particle.GetHostSpace() == &flybyHostSpace)
+				{
+					result.m_hasLeft = true;
+					result.m_exitDistance = sqrtf((localPosition - planetPosition).SqareMagnitude()) / planetSpace.GetRadius();
+					break;
+				}
+			}
+
+			flybySystem.OnUpdate(step.Get() * (kStepCount / 2));
+			ghostSystem.OnUpdate(step.Get() * (kStepCount / 2));
+			flybySystem.Synchronize();
+			ghostSystem.Synchronize();
+
+			result.m_finalError = sqrtf((particle.GetState().m_localPosition - ghost.GetState().m_localPosition).SqareMagnitude());
+
+			return result;
+		};
+
+		// Through the planet's space of influence, where the planet's gravity bends the particle's trajectory.
+		FlybyResult const influencingResult = flyBy({ 0.51f, -0.15f, 0.f }, 0.f);
+
+		testHandler.Assert(influencingResult.m_hasEntered && (influencingResult.m_entryError < 1e-5f), true,
+			"Particle enters another particle's space of influence on its trajectory");
+		testHandler.Assert(influencingResult.m_hasLeft && (kScalingSpaceEscapeRadius < influencingResult.m_exitDistance) &&
+			(influencingResult.m_exitDistance < 1.1f), true, "Particle leaves a space of influence from the host particle's current position");
+
+		// Through a larger, non-influencing space, in which the particle keeps orbiting the system host.
+		FlybyResult const nonInfluencingResult = flyBy({ 0.55f, -0.15f, 0.f }, 0.08f * hostSpaceTrueRadius);
+
+		testHandler.Assert(nonInfluencingResult.m_hasEntered && (nonInfluencingResult.m_entryError < 1e-5f), true,
+			"Particle enters another particle's non-influencing space on its trajectory");
+		testHandler.Assert(nonInfluencingResult.m_hasLeft && (kScalingSpaceEscapeRadius < nonInfluencingResult.m_exitDistance) &&
+			(nonInfluencingResult.m_exitDistance < 1.1f), true, "Particle leaves a non-influencing space from the host particle's current position");
+		testHandler.Assert(nonInfluencingResult.m_finalError < 1e-5f, true,
+			"Particle crossing a non-influencing space follows its orbit about the moving primary");
+	}
+
+	// Leaving a space of influence for a non-influencing outer space: the next section cannot be predicted, so the particle
+	// takes its resolved exit when the event is due.
+	{
+		static constexpr float kPlanetMass = 1e27f;
+
+		OrbitalSystem escapeSystem(hostMass, hostSpaceTrueRadius);
+
+		Particle & planet = escapeSystem.CreateParticle(kPlanetMass, { 0.5f, 0.f, 0.f },
+			{ 0.f, hostSpace.CircularOrbitSpeed(0.5f), 0.f }, escapeSystem.GetHostSpace());
+
+		ScalingSpace & influencingSpace = **planet.GetScalingSpaceList().begin();
+		ScalingSpace & outerSpace = escapeSystem.CreateScalingSpace(0.08f * hostSpaceTrueRadius, planet);
+
+		testHandler.Assert(influencingSpace.IsInfluencing() && !outerSpace.IsInfluencing() && (influencingSpace.m_pOuterSpace == &outerSpace),
+			true, "Space of influence lies in a non-influencing space");
+
+		Particle & particle = escapeSystem.CreateParticle(1.f, { 0.25f, 0.f, 0.f },
+			{ 0.f, 2.f * influencingSpace.CircularOrbitSpeed(0.25f), 0.f }, influencingSpace);
+
+		Time::Microseconds const step = particle.GetOrbit().GetCurrentSection().m_exitTime.Get() / 4;
+
+		for (int index = 0; (index < 8) && (particle.GetHostSpace() == &influencingSpace); ++index)
+			escapeSystem.OnUpdate(step);
+
+		testHandler.Assert(particle.GetHostSpace() == &outerSpace, true, "Particle leaves a space of influence for a non-influencing space");
+	}
+
+	// An impulse to a planet reschedules the particles which could reach its spaces sooner, but not those whose events are bound
+	// by another planet which they are nearer.
+	{
+		static constexpr float kPlanetMass = 1e27f;
+
+		OrbitalSystem siblingSystem(hostMass, hostSpaceTrueRadius);
+		ScalingSpace & siblingHostSpace = siblingSystem.GetHostSpace();
+
+		Particle & planet = siblingSystem.CreateParticle(kPlanetMass, { 0.5f, 0.f, 0.f },
+			{ 0.f, hostSpace.CircularOrbitSpeed(0.5f), 0.f }, siblingHostSpace);
+		siblingSystem.CreateParticle(kPlanetMass, { -0.5f, 0.f, 0.f }, { 0.f, -hostSpace.CircularOrbitSpeed(0.5f), 0.f }, siblingHostSpace);
+
+		Particle & nearParticle = siblingSystem.CreateParticle(1.f, { 0.5f, 0.1f, 0.f },
+			{ -hostSpace.CircularOrbitSpeed(0.51f), 0.f, 0.f }, siblingHostSpace);
+		Particle & otherParticle = siblingSystem.CreateParticle(1.f, { -0.5f, -0.1f, 0.f },
+			{ hostSpace.CircularOrbitSpeed(0.51f), 0.f, 0.f }, siblingHostSpace);
+
+		uint32_t const nearEventId = nearParticle.m_eventId;
+		uint32_t const otherEventId = otherParticle.m_eventId;
+
+		siblingSystem.ApplyImpulse(planet, { 0.f, 0.1f * hostSpace.CircularOrbitSpeed(0.5f), 0.f });
+
+		testHandler.Assert((nearParticle.m_eventId != nearEventId) && (otherParticle.m_eventId == otherEventId), true,
+			"Impulse reschedules only the particles whose events depend on the planet");
+	}
 
 	// Adding scaling space between existing spaces.
 
@@ -1,170 +1,1120 @@
 #include "OrbitalSystem2.h"
 
+#include "SnapshotFile.h"
 #include "TestHandler.h"
 #include "Exception.h"
 
+namespace // detail
+{
+
+using namespace Neutron;
+
+constexpr float kTestHostMass			= 1e30f;
+constexpr float kTestHostSpaceRadius	= 8e12f;
+constexpr float kTestPlanetMass			= 1e27f;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> An orbital system set up by the tests, and the particles they create in it. </summary>
+struct TestSystem
+{
+	OrbitalSystem2				m_orbitalSystem{ kTestHostMass, kTestHostSpaceRadius };
+	std::vector<ParticleBase *>	m_particles;	// The particles created through the fixture, in creation order.
+
+	ScaledSpaceBase & GetHostSpace()
+	{
+		return *m_orbitalSystem.GetHostSpace();
+	}
+
+	/// <summary> Create a particle along an axis of a space, moving in the xy plane at a multiple of the circular orbit speed. </summary>
+	ParticleBase & CreateOrbiter(ScaledSpaceBase & space, float mass, float radius, Vector3 const& direction, bool isInfluencing,
+		float speedFactor = 1.f)
+	{
+		Vector3 const velocity = Vector3(-direction.Y(), direction.X(), 0.f) * (space.CircularOrbitSpeed(radius) * speedFactor);
+
+		return *m_particles.emplace_back(m_orbitalSystem.CreateParticle(space, mass, direction * radius, velocity, isInfluencing));
+	}
+
+	/// <summary> Create an influencing planet on a circular orbit along an axis of the host space. </summary>
+	ParticleBase & CreatePlanet(Vector3 const& direction = Vector3(1.f, 0.f, 0.f))
+	{
+		return CreateOrbiter(GetHostSpace(), kTestPlanetMass, 0.7f, direction, true);
+	}
+};
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
-OrbitalSystem2::OrbitalSystem2(float hostMass, float hostSpaceTrueRadius) :
-	m_pHostParticle(std::move(MakeUnique<HostParticle>(*this, hostMass)))
+UniquePtr<OrbitalSystem2> OrbitalSystem2::Restore(SnapshotFile const& file)
+{
+	std::span<SnapshotFile::SpaceRecord const> const spaces = file.GetSpaces();
+	std::span<uint64_t const> const uuids = file.GetParticleUuids();
+	std::span<uint8_t const> const flags = file.GetParticleFlags();
+	std::span<float const> const masses = file.GetParticleMasses();
+	std::span<Vector3 const> const positions = file.GetParticlePositions();
+	std::span<Vector3 const> const velocities = file.GetParticleVelocities();
+	std::span<Orbit::Elements const> const elements = file.GetParticleElements();
+
+	UniquePtr<OrbitalSystem2> pOrbitalSystem = MakeUnique<OrbitalSystem2>(file.GetHostMass(), spaces[0].m_trueRadius);
+	OrbitalSystem2 & orbitalSystem = *pOrbitalSystem;
+
+	orbitalSystem.m_pHostParticle->m_uuid = Uuid(spaces[0].m_hostParticleUuid);
+	orbitalSystem.m_snapshotTick = file.GetTick();
+	orbitalSystem.m_time = file.GetTime();
+	orbitalSystem.GetHostSpace()->m_epoch = file.GetTime(); // Every other space is created at the system time.
+
+	// Only the particles which host spaces are looked up as the hierarchy is rebuilt. Spaces are in hierarchy order, so each
+	// space's host particle is created, with the particles of its outer space, before the space itself.
+	std::unordered_map<uint64_t, ParticleBase *> hostParticles;
+
+	for (SnapshotFile::SpaceRecord const& record : spaces)
+		hostParticles.emplace(record.m_hostParticleUuid, nullptr);
+
+	hostParticles[spaces[0].m_hostParticleUuid] = orbitalSystem.GetHostParticle();
+
+	for (size_t spaceIndex = 0; spaceIndex < spaces.size(); ++spaceIndex)
+	{
+		SnapshotFile::SpaceRecord const& record = spaces[spaceIndex];
+		ScaledSpaceBase * pSpace = orbitalSystem.GetHostSpace();
+
+		if (0 != spaceIndex)
+		{
+			ParticleBase *const pHostParticle = hostParticles[record.m_hostParticleUuid];
+			API_ASSERT_THROW(nullptr != pHostParticle, RESULT_CODE_INVALID_PARAMETER,
+				Fmt::Format("Space {} precedes its host particle {}", record.m_uuid, record.m_hostParticleUuid));
+
+			// An influencing particle's sphere of influence was created with the particle, from its elements.
+			ScaledSpaceBase *const pSpaceOfInfluence = pHostParticle->GetSpaceOfInfluence();
+
+			if ((nullptr != pSpaceOfInfluence) && (pSpaceOfInfluence->m_trueRadius == record.m_trueRadius))
+				pSpace = pSpaceOfInfluence;
+			else
+				pSpace = orbitalSystem.CreateScaledSpace(*pHostParticle, record.m_trueRadius);
+		}
+
+		API_ASSERT_THROW(pSpace->IsInfluencing() == (0 != (record.m_flags & SnapshotFile::kSpaceInfluencing)), RESULT_CODE_INVALID_PARAMETER,
+			Fmt::Format("Space {} was not restored with its recorded influence", record.m_uuid));
+
+		pSpace->m_uuid = Uuid(record.m_uuid);
+
+		if (0 != (record.m_flags & SnapshotFile::kSpaceParticleStore))
+		{
+			pSpace->EnableParticleStore();
+			pSpace->m_pParticleStore->Reserve(record.m_particleCount);
+		}
+
+		if (0.f < record.m_spatialIndexCellSize)
+			pSpace->EnableSpatialIndex(record.m_spatialIndexCellSize);
+
+		for (size_t index = record.m_firstParticle; index < record.m_firstParticle + record.m_particleCount; ++index)
+		{
+			API_ASSERT_THROW(0 != (flags[index] & SnapshotFile::kParticleHasOrbit), RESULT_CODE_INVALID_PARAMETER,
+				Fmt::Format("Particle {} has no orbit", uuids[index]));
+
+			ParticleBase *const pParticle = orbitalSystem.CreateParticleImpl(*pSpace, masses[index], positions[index], velocities[index],
+				0 != (flags[index] & SnapshotFile::kParticleInfluencing), elements[index]);
+
+			pParticle->m_uuid = Uuid(uuids[index]);
+
+			std::unordered_map<uint64_t, ParticleBase *>::iterator const iterator = hostParticles.find(uuids[index]);
+
+			if (hostParticles.end() != iterator)
+				iterator->second = pParticle;
+		}
+	}
+
+	orbitalSystem.m_scaledSpaceTree.Rebuild();
+
+	return pOrbitalSystem;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+OrbitalSystem2::OrbitalSystem2(float hostMass, float hostSpaceTrueRadius) :
+	m_pHostParticle(std::move(MakeUnique<HostParticle>(*this, hostMass))),
+	m_snapshotTick(0),
+	m_time(0),
+	m_tickCount(0),
+	m_pObserverSpace(nullptr),
+	m_observerPosition(Vector3::Zero()),
+	m_pTaskPool(nullptr)
+{
+	InfluencingSpace * pHostSpace = m_pHostParticle->EmplaceScaledSpace(m_influencingSpacePool, hostSpaceTrueRadius);
+	m_scaledSpaceTree.SetRoot(pHostSpace);
+	pHostSpace->Initialize(1.f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceBase * OrbitalSystem2::CreateScaledSpace(ParticleBase & hostParticle, float trueRadius)
+{
+	bool isInfluencing = false;
+
+	if (!hostParticle.m_attachedSpaces.empty())
+	{
+		if (trueRadius < hostParticle.m_attachedSpaces.Back().m_trueRadius)
+		{
+			isInfluencing = hostParticle.IsInfluencing();
+		}
+		else if (trueRadius < hostParticle.m_attachedSpaces.Front().m_trueRadius)
+		{
+			throw ApiException(RESULT_CODE_INVALID_PARAMETER,
+				"True radius must be greater or less than all existing scaled spaces on the particle.");
+		}
+	}
+
+	// The new space is created at the system time, so its host particle must be too.
+	if (nullptr != hostParticle.m_pHostSpace)
+		Synchronize(*hostParticle.m_pHostSpace);
+
+	return CreateScaledSpaceImpl(&hostParticle, trueRadius, isInfluencing);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ParticleBase * OrbitalSystem2::CreateParticle(ScaledSpaceBase & hostSpace, float mass, Vector3 position, Vector3 velocity,
+	bool isInfluencing)
+{
+	ValidateParticlePosition(position, hostSpace.GetInnerSpace());
+	Synchronize(hostSpace);
+
+	Orbit::Elements elements;
+	elements.Compute(hostSpace.GetGravityParameter(), position - hostSpace.GetPrimaryPosition(), velocity - hostSpace.GetPrimaryVelocity());
+
+	if (isInfluencing)
+		ValidateRadiusOfInfluence(mass, hostSpace.GetPrimary()->m_mass, elements);
+
+	ParticleBase *const pParticle = CreateParticleImpl(hostSpace, mass, position, velocity, isInfluencing, elements);
+
+	if (isInfluencing)
+		m_scaledSpaceTree.Rebuild();
+
+	return pParticle;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ParticleBase * OrbitalSystem2::CreateParticle(ScaledSpaceBase & hostSpace, float mass, Vector3 position, bool isInfluencing)
+{
+	hostSpace.CircularOrbitSpeed(sqrtf(position.SqareMagnitude()));
+
+	assert(false); // TODO - circular orbit velocity direction
+	Vector3 circularOrbitVelocity;
+
+	return CreateParticle(hostSpace, mass, position, circularOrbitVelocity, isInfluencing);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::CreateParticles(std::span<ParticleDesc const> descs, std::vector<ParticleBase *> & particles)
+{
+	// Validate the descriptions before anything is changed.
+	for (ParticleDesc const& desc : descs)
+	{
+		API_ASSERT_THROW(nullptr != desc.m_pHostSpace, RESULT_CODE_INVALID_PARAMETER, "Particle host space is nullptr");
+		ValidateParticlePosition(desc.m_position, desc.m_pHostSpace->GetInnerSpace());
+	}
+
+	// Order the descriptions by host space, keeping the given order within each space.
+	std::vector<uint32_t> order(descs.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+		[&](uint32_t lhs, uint32_t rhs) { return std::less<ScaledSpaceBase *>()(descs[lhs].m_pHostSpace, descs[rhs].m_pHostSpace); });
+
+	std::vector<Vector3> positions, velocities;
+	std::vector<Orbit::Elements> elements(descs.size()); // In host space order.
+
+	positions.reserve(descs.size());
+	velocities.reserve(descs.size());
+
+	for (size_t begin = 0, end = 0; begin < order.size(); begin = end)
+	{
+		ScaledSpaceBase *const pHostSpace = descs[order[begin]].m_pHostSpace;
+
+		// The orbits are computed at the system time. Synchronizing only brings the space's existing particles to it, as any read
+		// of them would, so it leaves the system's state at that time unchanged if the batch is rejected.
+		Synchronize(*pHostSpace);
+
+		Vector3 const primaryPosition = pHostSpace->GetPrimaryPosition();
+		Vector3 const primaryVelocity = pHostSpace->GetPrimaryVelocity();
+
+		positions.clear();
+		velocities.clear();
+
+		for (end = begin; (end < order.size()) && (descs[order[end]].m_pHostSpace == pHostSpace); ++end)
+		{
+			ParticleDesc const& desc = descs[order[end]];
+
+			positions.push_back(desc.m_position - primaryPosition);
+			velocities.push_back(desc.m_velocity - primaryVelocity);
+		}
+
+		std::span<Orbit::Elements> const spaceElements = std::span<Orbit::Elements>(elements).subspan(begin, end - begin);
+		Orbit::ComputeElements(pHostSpace->GetGravityParameter(), positions, velocities, spaceElements);
+
+		float const primaryMass = pHostSpace->GetPrimary()->m_mass;
+
+		for (size_t index = begin; index < end; ++index)
+		{
+			ParticleDesc const& desc = descs[order[index]];
+
+			if (desc.m_isInfluencing)
+				ValidateRadiusOfInfluence(desc.m_mass, primaryMass, elements[index]);
+		}
+	}
+
+	// Every description is valid and every orbit computed: reserve the particle stores, then create the particles.
+	for (size_t begin = 0, end = 0; begin < order.size(); begin = end)
+	{
+		ScaledSpaceBase *const pHostSpace = descs[order[begin]].m_pHostSpace;
+		size_t storedCount = 0;
+
+		for (end = begin; (end < order.size()) && (descs[order[end]].m_pHostSpace == pHostSpace); ++end)
+			storedCount += descs[order[end]].m_isInfluencing ? 0 : 1;
+
+		if (nullptr != pHostSpace->m_pParticleStore)
+			pHostSpace->m_pParticleStore->Reserve(pHostSpace->m_pParticleStore->Size() + storedCount);
+	}
+
+	size_t const firstIndex = particles.size();
+	particles.resize(firstIndex + descs.size());
+
+	for (size_t index = 0; index < order.size(); ++index)
+	{
+		ParticleDesc const& desc = descs[order[index]];
+
+		particles[firstIndex + order[index]] = CreateParticleImpl(*desc.m_pHostSpace, desc.m_mass, desc.m_position, desc.m_velocity,
+			desc.m_isInfluencing, elements[index]);
+	}
+
+	// The spaces of influence of the batch join the hierarchy in one rebuild.
+	m_scaledSpaceTree.Rebuild();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::DestroyParticle(ParticleBase * pParticleBase)
+{
+	API_ASSERT_THROW(m_pHostParticle->m_uuid != pParticleBase->m_uuid, RESULT_CODE_INVALID_PARAMETER, "Cannot destroy the host particle");
+
+	ScaledSpaceBase & hostSpace = *pParticleBase->m_pHostSpace;
+	ScaledSpaceBase::ParticleList & particleList = hostSpace.m_particles;
+
+	for (ScaledSpaceBase::ParticleList::const_iterator citerator = particleList.cbegin(); particleList.cend() != citerator; ++citerator)
+	{
+		if ((*citerator)->m_uuid == pParticleBase->m_uuid)
+		{
+			if (nullptr != hostSpace.m_pSpatialIndex)
+				hostSpace.m_pSpatialIndex->Remove(pParticleBase);
+
+			if (IsPerturbed(*pParticleBase))
+				--hostSpace.m_perturbedParticleCount;
+
+			bool const hasAttachedSpaces = !pParticleBase->m_attachedSpaces.empty();
+
+			particleList.erase(citerator);
+
+			if (hasAttachedSpaces)
+				m_scaledSpaceTree.Rebuild();
+
+			return;
+		}
+	}
+
+	assert(false); // We shouldn't be here!
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::OnUpdate(Time::Microseconds dT)
+{
+	m_time += dT;
+	++m_tickCount;
+
+	UpdateTiers();
+
+	bool const isNthTick = (0 == m_tickCount % m_levelOfDetail.m_tickInterval);
+
+	if (nullptr == m_pTaskPool)
+	{
+		// Spaces are visited in hierarchy order, so each space's host particle is propagated before the space's primary kinetics are read.
+		for (ScaledSpaceTree::Node const& node : m_scaledSpaceTree.GetNodes())
+		{
+			if (IsDue(*node.m_pSpace, isNthTick))
+				PropagateSpace(*node.m_pSpace, m_propagationScratch);
+		}
+	}
+	else
+	{
+		TaskPool::TaskGroup taskGroup;
+
+		SubmitPropagateSpace(taskGroup, 0, isNthTick);
+
+		m_pTaskPool->Wait(taskGroup);
+	}
+
+	m_scaledSpaceTree.RefreshOrigins();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::SubmitPropagateSpace(TaskPool::TaskGroup & taskGroup, uint32_t nodeIndex, bool isNthTick)
+{
+	m_pTaskPool->Submit(taskGroup, [this, &taskGroup, nodeIndex, isNthTick]()
+	{
+		std::span<ScaledSpaceTree::Node const> const nodes = m_scaledSpaceTree.GetNodes();
+		ScaledSpaceBase & space = *nodes[nodeIndex].m_pSpace;
+
+		if (IsDue(space, isNthTick))
+		{
+			// Scratch storage of its own, as sibling spaces are propagated concurrently. It is only filled by perturbed particles.
+			PropagationScratch scratch;
+			PropagateSpace(space, scratch);
+		}
+
+		// The space's particles, which host its child spaces, have been propagated: the children can now be, independently.
+		for (uint32_t childIndex = nodes[nodeIndex].m_firstChildIndex; ScaledSpaceTree::kInvalidIndex != childIndex;
+			childIndex = nodes[childIndex].m_nextSiblingIndex)
+		{
+			SubmitPropagateSpace(taskGroup, childIndex, isNthTick);
+		}
+	});
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::SetLevelOfDetail(LevelOfDetail const& levelOfDetail)
+{
+	API_ASSERT_THROW(0 < levelOfDetail.m_tickInterval, RESULT_CODE_INVALID_PARAMETER, "Tick interval must be positive");
+	API_ASSERT_THROW(levelOfDetail.m_nearDistance <= levelOfDetail.m_farDistance, RESULT_CODE_INVALID_PARAMETER,
+		"Near distance must not exceed far distance");
+
+	m_levelOfDetail = levelOfDetail;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::SetObserver(ScaledSpaceBase const* pSpace, Vector3 const& position)
+{
+	m_pObserverSpace = pSpace;
+	m_observerPosition = position;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::SetUpdateTierFunction(UpdateTierFunction updateTierFunction)
+{
+	m_updateTierFunction = std::move(updateTierFunction);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::Synchronize(ScaledSpaceBase & space)
+{
+	if (m_time == space.m_epoch)
+		return;
+
+	PropagateLaggingSpaces(space);
+
+	m_scaledSpaceTree.RefreshOrigins();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::SetPerturbed(ParticleBase & particle, bool isPerturbed)
+{
+	Particle *const pParticle = AsIndividualParticle(particle);
+
+	API_ASSERT_THROW(nullptr != pParticle, RESULT_CODE_INVALID_PARAMETER,
+		"Only particles held individually, rather than the host particle or particles in a particle store, can be perturbed");
+
+	if (pParticle->IsPerturbed() == isPerturbed)
+		return;
+
+	ScaledSpaceBase & hostSpace = *pParticle->m_pHostSpace;
+
+	// The particle is perturbed from the system time on, so its space, which is then propagated every tick, must not lag.
+	Synchronize(hostSpace);
+
+	pParticle->SetPerturbed(isPerturbed);
+
+	if (isPerturbed)
+		++hostSpace.m_perturbedParticleCount;
+	else
+		--hostSpace.m_perturbedParticleCount;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem2::IsPerturbed(ParticleBase const& particle) const
+{
+	Particle const*const pParticle = AsIndividualParticle(particle);
+
+	return (nullptr != pParticle) && pParticle->IsPerturbed();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::SetPrecision(ParticleBase & particle, Precision precision)
+{
+	Particle *const pParticle = AsIndividualParticle(particle);
+
+	API_ASSERT_THROW(nullptr != pParticle, RESULT_CODE_INVALID_PARAMETER,
+		"Only particles held individually, rather than the host particle or particles in a particle store, have a choice of precision");
+
+	// The orbit is recomputed from the particle's state, which must be at the system time.
+	Synchronize(*particle.m_pHostSpace);
+
+	pParticle->SetPrecision(precision);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+OrbitalSystem2::Precision OrbitalSystem2::GetPrecision(ParticleBase const& particle) const
+{
+	Particle const*const pParticle = AsIndividualParticle(particle);
+
+	return (nullptr == pParticle) ? Precision::Single : pParticle->GetPrecision();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::PublishSnapshot()
+{
+	SimulationSnapshot & snapshot = m_snapshotBuffer.BeginWrite();
+
+	snapshot.m_tick = ++m_snapshotTick;
+	snapshot.m_time = m_time;
+	snapshot.m_hostMass = m_pHostParticle->m_mass;
+	snapshot.m_spaces.clear();
+	snapshot.m_particles.clear();
+
+	// Spaces are copied in hierarchy order, so the nodes' parent indices are also snapshot space indices.
+	for (ScaledSpaceTree::Node const& node : m_scaledSpaceTree.GetNodes())
+	{
+		ScaledSpaceBase const& space = *node.m_pSpace;
+		uint32_t const spaceIndex = static_cast<uint32_t>(snapshot.m_spaces.size());
+
+		float const spatialIndexCellSize = (nullptr == space.m_pSpatialIndex) ? 0.f : space.m_pSpatialIndex->GetCellSize();
+
+		snapshot.m_spaces.push_back(SimulationSnapshot::SpaceState{ space.m_uuid, space.m_pHostParticle->m_uuid, node.m_parentIndex,
+			static_cast<uint32_t>(snapshot.m_particles.size()), static_cast<uint32_t>(space.m_particles.size()),
+			space.m_trueRadius, node.m_scaleToRoot, spatialIndexCellSize, space.GetPrimaryPosition(), space.GetPrimaryVelocity(),
+			space.IsInfluencing(), nullptr != space.m_pParticleStore, space.m_epoch });
+
+		for (PoolPtr<ParticleBase> const& pParticle : space.m_particles)
+		{
+			SimulationSnapshot::ParticleState & state = snapshot.m_particles.emplace_back();
+
+			state.m_uuid = pParticle->m_uuid;
+			state.m_spaceIndex = spaceIndex;
+			state.m_mass = pParticle->m_mass;
+			state.m_isInfluencing = pParticle->IsInfluencing();
+
+			// The states are copied as at the space's epoch, which readers propagate from.
+			double meanAnomaly;
+			pParticle->GetEpochState(state.m_position, state.m_velocity, meanAnomaly);
+
+			Orbit::Elements const*const pElements = pParticle->GetElements();
+			state.m_hasOrbit = (nullptr != pElements);
+
+			if (state.m_hasOrbit)
+			{
+				state.m_elements = *pElements;
+				state.m_meanAnomaly = meanAnomaly;
+			}
+		}
+	}
+
+	m_snapshotBuffer.Publish();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::ValidateParticlePosition(Vector3 const& position, ScaledSpaceBase const* pInnerSpace)
+{
+	float const distance = sqrtf(position.SqareMagnitude());
+
+	API_ASSERT_THROW(distance < kScalingSpaceEscapeRadius, RESULT_CODE_INVALID_PARAMETER,
+		Fmt::Format("Position {} is outside the scaling space!", position));
+
+	if (nullptr != pInnerSpace)
+	{
+		API_ASSERT_THROW(pInnerSpace->m_radius < distance, RESULT_CODE_INVALID_PARAMETER,
+			Fmt::Format("Position {} is inside the inner scaling space!", position));
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::ValidateRadiusOfInfluence(float mass, float primaryMass, Orbit::Elements const& elements)
+{
+	// The radius of influence is taken from the semi-major axis, so is only defined for a bound orbit.
+	API_ASSERT_THROW((Orbit::Type::Parabola != elements.m_type) && (Orbit::Type::Hyperbola != elements.m_type), RESULT_CODE_INVALID_PARAMETER,
+		"An influencing particle must have a bound orbit");
+
+	float const radiusOfInfluence = ParticleBase::ComputeRadiusOfInfluence(elements.m_semiMajor, mass, primaryMass);
+
+	API_ASSERT_THROW((kMinimumRadiusOfInfluence <= radiusOfInfluence) && (radiusOfInfluence < kMaximumScalingSpaceRadius),
+		RESULT_CODE_INVALID_PARAMETER, Fmt::Format("Radius of influence {} must be a value in the range [{}, {})", radiusOfInfluence,
+		kMinimumRadiusOfInfluence, kMaximumScalingSpaceRadius));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+OrbitalSystem2::Particle * OrbitalSystem2::AsIndividualParticle(ParticleBase const& particle)
+{
+	ScaledSpaceBase const*const pHostSpace = particle.m_pHostSpace;
+
+	// Every non-influencing particle in a space with a particle store is held in the store.
+	if ((nullptr == pHostSpace) || (!particle.IsInfluencing() && (nullptr != pHostSpace->m_pParticleStore)))
+		return nullptr;
+
+	return const_cast<Particle *>(static_cast<Particle const*>(&particle));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceBase * OrbitalSystem2::CreateScaledSpaceImpl(ParticleBase * pHostParticle, float trueRadius, bool isInfluencing)
+{
+	ScaledSpaceBase * pNewScaledSpace = nullptr;
+	ScaledSpaceBase * pOuterSpace = nullptr;
+
+	if (isInfluencing)
+	{
+		pNewScaledSpace = pHostParticle->EmplaceScaledSpace(m_influencingSpacePool, trueRadius);
+		m_scaledSpaceTree.Rebuild();
+
+		pOuterSpace = pNewScaledSpace->GetOuterSpace();
+
+		assert((nullptr == pOuterSpace) || pOuterSpace->IsInfluencing());
+	}
+	else
+	{
+		pNewScaledSpace = pHostParticle->EmplaceScaledSpace(m_nonInfluencingSpacePool, trueRadius);
+		m_scaledSpaceTree.Rebuild();
+
+		pOuterSpace = pNewScaledSpace->GetOuterSpace();
+
+		assert(nullptr != pOuterSpace); // The highest space should never be non-influencing.
+		assert(!pOuterSpace->IsInfluencing() || (pOuterSpace->m_pHostParticle != pNewScaledSpace->m_pHostParticle));
+	}
+
+	float const radius = (nullptr == pOuterSpace) ? 1.f : trueRadius / pOuterSpace->m_trueRadius;
+
+	if (!((kMinimumScalingSpaceRadius <= radius) && (radius < kMaximumScalingSpaceRadius)))
+	{
+		assert(false); // TODO - handle invalid size ...
+
+		API_ASSERT_THROW(false, RESULT_CODE_INVALID_PARAMETER,
+			Fmt::Format("Radius must be a value in the range [{}, {})", kMinimumScalingSpaceRadius, kMaximumScalingSpaceRadius));
+	}
+
+	pNewScaledSpace->Initialize(radius);
+
+	return pNewScaledSpace;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ParticleBase * OrbitalSystem2::CreateParticleImpl(ScaledSpaceBase & hostSpace, float mass, Vector3 const& position,
+	Vector3 const& velocity, bool isInfluencing, Orbit::Elements const& elements)
+{
+	PoolPtr<ParticleBase> pNewParticle;
+
+	if (isInfluencing)
+		pNewParticle = m_influencingParticlePool.Make(*this, &hostSpace, mass, position, velocity, elements);
+	else if (nullptr != hostSpace.m_pParticleStore)
+		pNewParticle = m_storedParticlePool.Make(*this, &hostSpace, mass, position, velocity, elements);
+	else
+		pNewParticle = m_particlePool.Make(*this, &hostSpace, mass, position, velocity, elements);
+
+	ParticleBase *const pParticle = hostSpace.m_particles.emplace_back(std::move(pNewParticle)).get();
+
+	if (nullptr != hostSpace.m_pSpatialIndex)
+		hostSpace.m_pSpatialIndex->Insert(pParticle, position);
+
+	return pParticle;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::UpdateTiers()
+{
+	using UpdateTier = ScaledSpaceBase::UpdateTier;
+
+	std::span<ScaledSpaceTree::Node const> const nodes = m_scaledSpaceTree.GetNodes();
+
+	for (ScaledSpaceTree::Node const& node : nodes)
+	{
+		ScaledSpaceBase & space = *node.m_pSpace;
+
+		if (m_updateTierFunction)
+		{
+			space.m_updateTier = m_updateTierFunction(space);
+		}
+		else if (nullptr != m_pObserverSpace)
+		{
+			// The space spans a radius of one in its own frame, so the distance is in radii of the space.
+			float const distance = sqrtf(m_scaledSpaceTree.TransformPosition(m_observerPosition, *m_pObserverSpace, space).SqareMagnitude());
+
+			if (distance < m_levelOfDetail.m_nearDistance)
+				space.m_updateTier = UpdateTier::EveryTick;
+			else if (distance < m_levelOfDetail.m_farDistance)
+				space.m_updateTier = UpdateTier::EveryNthTick;
+			else
+				space.m_updateTier = UpdateTier::OnDemand;
+		}
+		else
+		{
+			space.m_updateTier = UpdateTier::EveryTick;
+		}
+
+		// Perturbed particles are integrated about the perturbers' positions at the start of each step, which must stay short.
+		if (0 < space.m_perturbedParticleCount)
+			space.m_updateTier = UpdateTier::EveryTick;
+	}
+
+	// Nodes are in depth-first order, so visiting them in reverse raises each space's inner spaces before the space itself.
+	for (size_t index = nodes.size(); 0 < index--; )
+	{
+		uint32_t const parentIndex = nodes[index].m_parentIndex;
+
+		if (ScaledSpaceTree::kInvalidIndex == parentIndex)
+			continue;
+
+		ScaledSpaceBase & parentSpace = *nodes[parentIndex].m_pSpace;
+		parentSpace.m_updateTier = std::min(parentSpace.m_updateTier, nodes[index].m_pSpace->m_updateTier);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool OrbitalSystem2::IsDue(ScaledSpaceBase const& space, bool isNthTick)
+{
+	switch (space.m_updateTier)
+	{
+	case ScaledSpaceBase::UpdateTier::EveryTick:
+		return true;
+
+	case ScaledSpaceBase::UpdateTier::EveryNthTick:
+		return isNthTick;
+
+	default:
+		return false;
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::PropagateSpace(ScaledSpaceBase & space, PropagationScratch & scratch)
+{
+	Time::Microseconds const dT = m_time - space.m_epoch;
+	space.m_epoch = m_time; // First, so that the particles' getters read their states at the start of the step.
+
+	if (space.m_particles.empty() || (0 == dT.Get()))
+		return;
+
+	Vector3 const primaryPosition = space.GetPrimaryPosition();
+	Vector3 const primaryVelocity = space.GetPrimaryVelocity();
+
+	std::vector<Perturbation::Perturber> & perturbers = scratch.m_perturbers;
+	std::vector<Integrator::Bodyd> & perturbedBodies = scratch.m_perturbedBodies;
+	std::vector<uint32_t> & excludedPerturbers = scratch.m_excludedPerturbers;
+	std::vector<Particle *> & perturbedParticles = scratch.m_perturbedParticles;
+
+	perturbers.clear();
+	perturbedBodies.clear();
+	excludedPerturbers.clear();
+	perturbedParticles.clear();
+
+	double const gravityParameter = space.GetGravityParameter();
+
+	// The perturbers and the reference conics are all taken at the start of the step, before any particle is moved. They are
+	// evaluated in double precision from each particle's orbit rather than from its position less the primary position: the
+	// primary of a non-influencing space has already moved to the end of the step with the host particle. A space without
+	// perturbed particles needs neither.
+	if (0 < space.m_perturbedParticleCount)
+	{
+		for (PoolPtr<ParticleBase> const& pParticle : space.m_particles)
+		{
+			if (!pParticle->IsInfluencing())
+				continue;
+
+			Particle const*const pIndividualParticle = AsIndividualParticle(*pParticle);
+			assert(nullptr != pIndividualParticle); // Influencing particles are never held in a particle store.
+
+			Vector3d position, velocity;
+			pIndividualParticle->ComputeOrbitKinetics(position, velocity);
+
+			Perturbation::Perturber & perturber = perturbers.emplace_back();
+			perturber.m_elements.Compute(gravityParameter, position, velocity);
+			perturber.m_meanAnomaly = perturber.m_elements.TrueToMeanAnomaly(perturber.m_elements.ComputeTrueAnomaly(position));
+			perturber.m_gravityParameter = ScaledSpaceBase::ComputeScaledGravityParameter(space.m_trueRadius, pParticle->m_mass);
+		}
+
+		uint32_t perturberIndex = 0;
+
+		for (PoolPtr<ParticleBase> const& pParticle : space.m_particles)
+		{
+			Particle *const pIndividualParticle = AsIndividualParticle(*pParticle);
+
+			uint32_t const index = pParticle->IsInfluencing() ? perturberIndex++ : Perturbation::kNoPerturber;
+
+			if ((nullptr == pIndividualParticle) || !pIndividualParticle->IsPerturbed() || perturbers.empty())
+				continue;
+
+			Vector3d position, velocity;
+			pIndividualParticle->ComputeOrbitKinetics(position, velocity);
+
+			Integrator::Initialize(perturbedBodies.emplace_back(), gravityParameter, position, velocity);
+
+			excludedPerturbers.push_back(index);
+			perturbedParticles.push_back(pIndividualParticle);
+		}
+	}
+
+	if (nullptr != space.m_pParticleStore)
+		space.m_pParticleStore->Propagate(dT, primaryPosition, primaryVelocity);
+
+	bool const isPerturbing = !perturbers.empty();
+
+	auto const propagateParticles = [&space, dT, isPerturbing](ScaledSpaceBase::ParticleList::iterator begin,
+		ScaledSpaceBase::ParticleList::iterator end)
+	{
+		for (ScaledSpaceBase::ParticleList::iterator particleIter = begin; particleIter != end; ++particleIter)
+		{
+			ParticleBase & particle = **particleIter;
+			Particle *const pIndividualParticle = AsIndividualParticle(particle);
+
+			if (nullptr == pIndividualParticle)
+			{
+				if (nullptr != space.m_pSpatialIndex)
+					space.m_pSpatialIndex->Update(&particle, particle.GetPosition());
+
+				// Stored particles are moved in bulk by the store: refresh the spaces attached to them here.
+				if (!particle.m_attachedSpaces.empty())
+					particle.OnKineticsChanged();
+			}
+			else if (!pIndividualParticle->IsPerturbed() || !isPerturbing)
+			{
+				pIndividualParticle->Propagate(dT);
+			}
+		}
+	};
+
+	// The particles on rails are independent of one another, so they are propagated in chunks in parallel, unless the spatial
+	// index, which each of them updates, is enabled.
+	if ((nullptr == m_pTaskPool) || (nullptr != space.m_pSpatialIndex) || (space.m_particles.size() <= kParallelChunkSize))
+	{
+		propagateParticles(space.m_particles.begin(), space.m_particles.end());
+	}
+	else
+	{
+		TaskPool::TaskGroup taskGroup;
+
+		ScaledSpaceBase::ParticleList::iterator chunkBegin = space.m_particles.begin();
+
+		while (space.m_particles.end() != chunkBegin)
+		{
+			ScaledSpaceBase::ParticleList::iterator chunkEnd = chunkBegin;
+			for (size_t count = 0; (count < kParallelChunkSize) && (space.m_particles.end() != chunkEnd); ++count)
+				++chunkEnd;
+
+			m_pTaskPool->Submit(taskGroup, [&propagateParticles, chunkBegin, chunkEnd]() { propagateParticles(chunkBegin, chunkEnd); });
+
+			chunkBegin = chunkEnd;
+		}
+
+		m_pTaskPool->Wait(taskGroup);
+	}
+
+	if (perturbedBodies.empty())
+		return;
+
+	// The step is divided into chunks short enough for the deviations to stay small, with the bodies rectified after each, so
+	// that every chunk is integrated about a fresh osculating conic whatever the length of the step.
+	Time::Microseconds const maximumStep = Perturbation::ComputeMaximumStep(gravityParameter, perturbers, perturbedBodies);
+	int64_t const chunkCount = (dT.Get() - 1) / maximumStep.Get() + 1;
+
+	Integrator::Settingsd settings;
+	settings.m_method = Integrator::Method::Yoshida4;
+	settings.m_maximumStep = std::max<int64_t>(1, maximumStep.Get() / Perturbation::kDefaultSubstepCount);
+
+	Time::Microseconds time = 0;
+
+	for (int64_t chunk = 1; chunk <= chunkCount; ++chunk)
+	{
+		Time::Microseconds const nextTime = dT.Get() * chunk / chunkCount;
+
+		Integrator::Integrate(gravityParameter, std::span<Integrator::Bodyd>(perturbedBodies), nextTime - time, settings,
+			Perturbation::MakeAccelerationFunction(perturbers, excludedPerturbers));
+		Perturbation::Rectify(gravityParameter, perturbers, perturbedBodies, excludedPerturbers, nextTime - time);
+
+		time = nextTime;
+	}
+
+	// Each perturbed particle's orbit is recomputed from its perturbed state, to be the next step's reference conic.
+	for (size_t index = 0; index < perturbedBodies.size(); ++index)
+	{
+		perturbedParticles[index]->SetKinetics(primaryPosition + Vector3(perturbedBodies[index].m_position),
+			primaryVelocity + Vector3(perturbedBodies[index].m_velocity));
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::ComputePrimaryKinetics(ScaledSpaceBase const& space, Vector3 & position, Vector3 & velocity) const
+{
+	ParticleBase const& hostParticle = *space.m_pHostParticle;
+
+	// A space is propagated at least as often as its inner spaces, so a host space which is current has current outer spaces.
+	if (space.IsInfluencing() || !IsLagging(*hostParticle.m_pHostSpace))
+	{
+		position = space.GetPrimaryPosition();
+		velocity = space.GetPrimaryVelocity();
+
+		return;
+	}
+
+	ScaledSpaceBase const& hostSpace = *hostParticle.m_pHostSpace;
+
+	Vector3 hostSpacePrimaryPosition, hostSpacePrimaryVelocity;
+	ComputePrimaryKinetics(hostSpace, hostSpacePrimaryPosition, hostSpacePrimaryVelocity);
+
+	// As NonInfluencingSpace::RefreshPrimaryKinetics, from the host particle where it is at the system time.
+	float const scaleFactor = m_scaledSpaceTree.GetScale(hostSpace, space);
+
+	position = (hostSpacePrimaryPosition - hostParticle.GetPosition()) * scaleFactor;
+	velocity = (hostSpacePrimaryVelocity - hostParticle.GetVelocity()) * scaleFactor;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::PropagateLaggingSpaces(ScaledSpaceBase & space)
 {
-	InfluencingSpace * pHostSpace = m_pHostParticle->EmplaceScaledSpace<InfluencingSpace>(hostSpaceTrueRadius);
-	pHostSpace->Initialize(1.f);
+	if (m_time == space.m_epoch)
+		return;
+
+	ScaledSpaceBase *const pOuterSpace = space.GetOuterSpace();
+
+	if (nullptr != pOuterSpace)
+		PropagateLaggingSpaces(*pOuterSpace);
+
+	PropagateSpace(space, m_propagationScratch);
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-ScaledSpaceBase * OrbitalSystem2::CreateScaledSpace(ParticleBase & hostParticle, float trueRadius)
+OrbitalSystem2::HostParticle::HostParticle(OrbitalSystem2 & orbitalSystem, float hostMass) :
+	ParticleBase(orbitalSystem, nullptr, hostMass)
 {
-	bool isInfluencing = false;
+}
 
-	if (!hostParticle.m_attachedSpaces.empty())
-	{
-		if (trueRadius < hostParticle.m_attachedSpaces.Back().m_trueRadius)
-		{
-			isInfluencing = hostParticle.IsInfluencing();
-		}
-		else if (trueRadius < hostParticle.m_attachedSpaces.Front().m_trueRadius)
-		{
-			throw ApiException(RESULT_CODE_INVALID_PARAMETER,
-				"True radius must be greater or less than all existing scaled spaces on the particle.");
-		}
-	}
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
 
-	return CreateScaledSpaceImpl(&hostParticle, trueRadius, isInfluencing);
+OrbitalSystem2::Particle::Particle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity,
+	Orbit::Elements const& elements) :
+	ParticleBase(orbitalSystem, pHostSpace, mass),
+	m_position(position),
+	m_velocity(velocity),
+	m_pOrbit(MakeUnique<Orbit>()),
+	m_pOrbitd(nullptr),
+	m_isPerturbed(false)
+{
+	m_pOrbit->Initialize(elements, position - pHostSpace->GetPrimaryPosition());
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-ParticleBase * OrbitalSystem2::CreateParticle(ScaledSpaceBase & hostSpace, float mass, Vector3 position, Vector3 velocity,
-	bool isInfluencing)
+void OrbitalSystem2::Particle::SetKinetics(Vector3 const& position, Vector3 const& velocity)
 {
-	API_ASSERT_THROW(sqrtf(position.SqareMagnitude()) < kScalingSpaceEscapeRadius, RESULT_CODE_INVALID_PARAMETER,
-		Fmt::Format("Position {} is outside the scaling space!", position));
+	m_position = position;
+	m_velocity = velocity;
 
-	if (nullptr != hostSpace.m_pInnerSpace)
-	{
-		API_ASSERT_THROW(hostSpace.m_pInnerSpace->m_radius < sqrtf(position.SqareMagnitude()), RESULT_CODE_INVALID_PARAMETER,
-			Fmt::Format("Position {} is inside the inner scaling space!", position));
-	}
+	Vector3 const localPosition = position - m_pHostSpace->GetPrimaryPosition();
+	Vector3 const localVelocity = velocity - m_pHostSpace->GetPrimaryVelocity();
 
-	UniquePtr<ParticleBase> &pNewParticle = hostSpace.m_particles.emplace_back();
+	m_pOrbit->Initialize(m_pHostSpace->GetGravityParameter(), localPosition, localVelocity);
 
-	if (isInfluencing)
-		pNewParticle = MakeUnique<InfluencingParticle>(*this, &hostSpace, mass, position, velocity);
-	else
-		pNewParticle = MakeUnique<Particle>(*this, &hostSpace, mass, position, velocity);
+	if (nullptr != m_pOrbitd)
+		m_pOrbitd->Initialize(m_pHostSpace->GetGravityParameter(), Vector3d(localPosition), Vector3d(localVelocity));
 
-	return pNewParticle.get();
+	if (nullptr != m_pHostSpace->m_pSpatialIndex)
+		m_pHostSpace->m_pSpatialIndex->Update(this, position);
+
+	OnKineticsChanged();
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-ParticleBase * OrbitalSystem2::CreateParticle(ScaledSpaceBase & hostSpace, float mass, Vector3 position, bool isInfluencing)
+void OrbitalSystem2::Particle::Propagate(Time::Microseconds dT)
 {
-	hostSpace.CircularOrbitSpeed(sqrtf(position.SqareMagnitude()));
+	if (nullptr == m_pOrbitd)
+	{
+		m_pOrbit->Propagate(dT, m_position, m_velocity);
+	}
+	else
+	{
+		Vector3d position, velocity;
+		m_pOrbitd->Propagate(dT, position, velocity);
 
-	assert(false); // TODO - circular orbit velocity direction
-	Vector3 circularOrbitVelocity;
+		m_position = Vector3(position);
+		m_velocity = Vector3(velocity);
+	}
 
-	return CreateParticle(hostSpace, mass, position, circularOrbitVelocity, isInfluencing);
+	m_position += m_pHostSpace->GetPrimaryPosition();
+	m_velocity += m_pHostSpace->GetPrimaryVelocity();
+
+	if (nullptr != m_pHostSpace->m_pSpatialIndex)
+		m_pHostSpace->m_pSpatialIndex->Update(this, m_position);
+
+	OnKineticsChanged();
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-void OrbitalSystem2::DestroyParticle(ParticleBase * pParticleBase)
+void OrbitalSystem2::Particle::ComputeKinetics(Vector3 & position, Vector3 & velocity) const
 {
-	API_ASSERT_THROW(m_pHostParticle->m_uuid != pParticleBase->m_uuid, RESULT_CODE_INVALID_PARAMETER, "Cannot destroy the host particle");
-
-	ScaledSpaceBase::ParticleList & particleList = pParticleBase->m_pHostSpace->m_particles;
+	Time::Microseconds const dT = m_orbitalSystem.m_time - m_pHostSpace->m_epoch;
 
-	for (ScaledSpaceBase::ParticleList::const_iterator citerator = particleList.cbegin(); particleList.cend() != citerator; ++citerator)
+	if (nullptr == m_pOrbitd)
 	{
-		if ((*citerator)->m_uuid == pParticleBase->m_uuid)
-		{
-			particleList.erase(citerator);
-			return;
-		}
+		Orbit::Elements const& elements = m_pOrbit->GetCurrentSection().m_elements;
+		elements.ComputeKinetics(elements.MeanToTrueAnomaly(elements.PropagateMeanAnomaly(m_pOrbit->GetMeanAnomaly(), dT)), position, velocity);
+	}
+	else
+	{
+		Orbitd::Elements const& elements = m_pOrbitd->GetCurrentSection().m_elements;
+
+		Vector3d positiond, velocityd;
+		elements.ComputeKinetics(elements.MeanToTrueAnomaly(elements.PropagateMeanAnomaly(m_pOrbitd->GetMeanAnomaly(), dT)), positiond, velocityd);
+
+		position = Vector3(positiond);
+		velocity = Vector3(velocityd);
 	}
 
-	assert(false); // We shouldn't be here!
+	Vector3 primaryPosition, primaryVelocity;
+	m_orbitalSystem.ComputePrimaryKinetics(*m_pHostSpace, primaryPosition, primaryVelocity);
+
+	position += primaryPosition;
+	velocity += primaryVelocity;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-ScaledSpaceBase * OrbitalSystem2::CreateScaledSpaceImpl(ParticleBase * pHostParticle, float trueRadius, bool isInfluencing)
+void OrbitalSystem2::Particle::ComputeOrbitKinetics(Vector3d & position, Vector3d & velocity) const
 {
-	ScaledSpaceBase * pNewScaledSpace = nullptr;
-
-	if (isInfluencing)
+	if (nullptr == m_pOrbitd)
 	{
-		pNewScaledSpace = pHostParticle->EmplaceScaledSpace<InfluencingSpace>(trueRadius);
+		Vector3 positionf, velocityf;
+		m_pOrbit->GetCurrentSection().m_elements.ComputeKinetics(m_pOrbit->GetTrueAnomaly(), positionf, velocityf);
 
-		assert((nullptr == pNewScaledSpace->m_pOuterSpace) || pNewScaledSpace->m_pOuterSpace->IsInfluencing());
+		position = Vector3d(positionf);
+		velocity = Vector3d(velocityf);
 	}
 	else
 	{
-		pNewScaledSpace = pHostParticle->EmplaceScaledSpace<NonInfluencingSpace>(trueRadius);
-
-		assert(nullptr != pNewScaledSpace->m_pOuterSpace); // The highest space should never be non-influencing.
-		assert(!pNewScaledSpace->m_pOuterSpace->IsInfluencing() ||
-			(pNewScaledSpace->m_pOuterSpace->m_pHostParticle != pNewScaledSpace->m_pHostParticle));
+		m_pOrbitd->GetCurrentSection().m_elements.ComputeKinetics(m_pOrbitd->GetTrueAnomaly(), position, velocity);
 	}
+}
 
-	float const radius = (nullptr == pNewScaledSpace->m_pOuterSpace) ? 1.f :
-		trueRadius / pNewScaledSpace->m_pOuterSpace->m_trueRadius;
+// --------------------------------------------------------------------------------------------------------------------------------
 
-	if (!((kMinimumScalingSpaceRadius <= radius) && (radius < kMaximumScalingSpaceRadius)))
-	{
-		assert(false); // TODO - handle invalid size ...
+void OrbitalSystem2::Particle::GetEpochState(Vector3 & position, Vector3 & velocity, double & meanAnomaly) const
+{
+	position = m_position;
+	velocity = m_velocity;
+	meanAnomaly = (nullptr == m_pOrbitd) ? m_pOrbit->GetMeanAnomaly() : m_pOrbitd->GetMeanAnomaly();
+}
 
-		API_ASSERT_THROW(false, RESULT_CODE_INVALID_PARAMETER,
-			Fmt::Format("Radius must be a value in the range [{}, {})", kMinimumScalingSpaceRadius, kMaximumScalingSpaceRadius));
-	}
+// --------------------------------------------------------------------------------------------------------------------------------
 
-	pNewScaledSpace->Initialize(radius);
+void OrbitalSystem2::Particle::SetPrecision(Precision precision)
+{
+	if (precision == GetPrecision())
+		return;
 
-	return pNewScaledSpace;
+	Vector3 const localPosition = m_position - m_pHostSpace->GetPrimaryPosition();
+	Vector3 const localVelocity = m_velocity - m_pHostSpace->GetPrimaryVelocity();
+
+	if (Precision::Double == precision)
+	{
+		m_pOrbitd = MakeUnique<Orbitd>();
+		m_pOrbitd->Initialize(m_pHostSpace->GetGravityParameter(), Vector3d(localPosition), Vector3d(localVelocity));
+	}
+	else
+	{
+		// The float orbit's anomalies were not advanced while the particle was propagated in double precision.
+		m_pOrbitd.reset();
+		m_pOrbit->Initialize(m_pHostSpace->GetGravityParameter(), localPosition, localVelocity);
+	}
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-OrbitalSystem2::HostParticle::HostParticle(OrbitalSystem2 & orbitalSystem, float hostMass) :
-	ParticleBase(orbitalSystem, nullptr, hostMass)
+OrbitalSystem2::InfluencingParticle::InfluencingParticle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity,
+	Orbit::Elements const& elements) :
+	Particle(orbitalSystem, pHostSpace, mass, position, velocity, elements)
 {
+	float const radiusOfInfluence = ComputeRadiusOfInfluence(elements.m_semiMajor, mass, pHostSpace->GetPrimary()->m_mass);
+	assert((kMinimumRadiusOfInfluence <= radiusOfInfluence) && (radiusOfInfluence < kMaximumScalingSpaceRadius)); // Validated by the orbital system.
+
+	float const trueRadiusOfInfluence = radiusOfInfluence * pHostSpace->GetTrueRadius();
+	m_pSpaceOfInfluence = EmplaceScaledSpace(orbitalSystem.m_influencingSpacePool, trueRadiusOfInfluence);
+
+	m_pSpaceOfInfluence->Initialize(radiusOfInfluence);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-OrbitalSystem2::Particle::Particle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity) :
+OrbitalSystem2::StoredParticle::StoredParticle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position,
+	Vector3 velocity, Orbit::Elements const& elements) :
 	ParticleBase(orbitalSystem, pHostSpace, mass),
-	m_position(position),
-	m_velocity(velocity),
-	m_pOrbit(MakeUnique<Orbit>())
+	m_particleStore(*pHostSpace->m_pParticleStore),
+	m_handle(m_particleStore.Add(mass, position, velocity))
 {
-	Orbit::Elements &elements = m_pOrbit->GetCurrentSection().m_elements;
+	double const trueAnomaly = elements.ComputeTrueAnomaly(position - pHostSpace->GetPrimaryPosition());
 
-	elements.Compute(pHostSpace->GetGravityParameter(), position - pHostSpace->GetPrimaryPosition(),
-		velocity - pHostSpace->GetPrimaryVelocity());
+	m_particleStore.SetOrbit(m_handle, elements, elements.TrueToMeanAnomaly(trueAnomaly));
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
+
+OrbitalSystem2::StoredParticle::~StoredParticle()
+{
+	m_particleStore.Remove(m_handle);
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 
-OrbitalSystem2::InfluencingParticle::InfluencingParticle(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass, Vector3 position, Vector3 velocity) :
-	Particle(orbitalSystem, pHostSpace, mass, position, velocity)
+void OrbitalSystem2::StoredParticle::ComputeKinetics(Vector3 & position, Vector3 & velocity) const
 {
-	Orbit::Elements &elements = m_pOrbit->GetCurrentSection().m_elements;
+	Orbit::Elements const& elements = m_particleStore.GetElements(m_handle);
+	double const meanAnomaly = elements.PropagateMeanAnomaly(m_particleStore.GetMeanAnomaly(m_handle), m_orbitalSystem.m_time - m_pHostSpace->m_epoch);
 
-	float const radiusOfInfluence = ComputeRadiusOfInfluence(elements.m_semiMajor, mass, pHostSpace->GetPrimary()->m_mass);
+	elements.ComputeKinetics(elements.MeanToTrueAnomaly(meanAnomaly), position, velocity);
 
-	float const trueRadiusOfInfluence = radiusOfInfluence * pHostSpace->GetTrueRadius();
-	m_pSpaceOfInfluence = EmplaceScaledSpace<InfluencingSpace>(trueRadiusOfInfluence);
+	Vector3 primaryPosition, primaryVelocity;
+	m_orbitalSystem.ComputePrimaryKinetics(*m_pHostSpace, primaryPosition, primaryVelocity);
 
-	m_pSpaceOfInfluence->Initialize(radiusOfInfluence);
+	position += primaryPosition;
+	velocity += primaryVelocity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void OrbitalSystem2::StoredParticle::GetEpochState(Vector3 & position, Vector3 & velocity, double & meanAnomaly) const
+{
+	position = m_particleStore.GetPosition(m_handle);
+	velocity = m_particleStore.GetVelocity(m_handle);
+	meanAnomaly = m_particleStore.GetMeanAnomaly(m_handle);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
@@ -185,8 +1135,8 @@ OrbitalSystem2TestScript::~OrbitalSystem2TestScript()
 
 void OrbitalSystem2TestScript::RunImpl(TestHandler & testHandler)
 {
-	static constexpr float HOST_MASS = 1e30f;
-	static constexpr float HOST_SPACE_RADIUS = 8e12f;
+	static constexpr float HOST_MASS = kTestHostMass;
+	static constexpr float HOST_SPACE_RADIUS = kTestHostSpaceRadius;
 
 	OrbitalSystem2 orbitalSystem(HOST_MASS, HOST_SPACE_RADIUS);
 
@@ -329,6 +1279,19 @@ void OrbitalSystem2TestScript::RunImpl(TestHandler & testHandler)
 	testHandler.Assert(sqrtf(particleScaledSpace.GetPrimaryPosition().SqareMagnitude()), orbitRadius / particleScaledSpaceRadius, "Particle scaled space primary distance");
 	testHandler.Assert(particleScaledSpace.GetPrimaryVelocity(), particleVelocity * -1.f / particleScaledSpaceRadius, "Particle scaled space primary velocity");
 
+	// Cached primary kinetics are recomputed only when the host chain changes.
+	uint64_t const primaryKineticsVersion = particleScaledSpace.GetPrimaryKineticsVersion();
+
+	testHandler.Assert(particleScaledSpace.GetPrimaryKineticsVersion(), primaryKineticsVersion, "Unchanged host chain keeps primary kinetics");
+
+	static_cast<OrbitalSystem2::Particle &>(particle).SetKinetics(particlePosition * 0.5f, particleVelocity);
+
+	testHandler.Assert(particleScaledSpace.GetPrimaryKineticsVersion() != primaryKineticsVersion, true, "Moving the host recomputes primary kinetics");
+	testHandler.Assert(sqrtf(particleScaledSpace.GetPrimaryPosition().SqareMagnitude()), 0.5f * orbitRadius / particleScaledSpaceRadius,
+		"Particle scaled space primary distance after moving the host");
+
+	static_cast<OrbitalSystem2::Particle &>(particle).SetKinetics(particlePosition, particleVelocity);
+
 	const float particleScaledSpaceNewRadius = 0.04f;
 	const float particleScaledSpaceNewTrueRadius = HOST_SPACE_RADIUS * particleScaledSpaceNewRadius;
 
@@ -336,6 +1299,379 @@ void OrbitalSystem2TestScript::RunImpl(TestHandler & testHandler)
 
 	testHandler.Assert(particleScaledSpace.GetTrueRadius(), particleScaledSpaceNewTrueRadius, "Particle scaled space new true radius");
 	testHandler.Assert(particleScaledSpace.GetRadius(), particleScaledSpaceNewRadius, "Particle scaled space new radius");
+
+	// Particle store.
+	particleScaledSpace.EnableParticleStore();
+
+	const Vector3 storedParticlePosition(0.5f, 0.f, 0.f);
+	const Vector3 storedParticleVelocity(0.f, 1.f, 0.f);
+
+	ParticleBase * pStoredParticle = orbitalSystem.CreateParticle(particleScaledSpace, particleMass, storedParticlePosition,
+		storedParticleVelocity, false);
+
+	testHandler.Assert(particleScaledSpace.GetParticleStore()->Size(), 1ull, "Particle store size");
+	testHandler.Assert(pStoredParticle->GetPosition(), storedParticlePosition, "Stored particle position");
+	testHandler.Assert(pStoredParticle->GetVelocity(), storedParticleVelocity, "Stored particle velocity");
+	testHandler.Assert(particleScaledSpace.GetParticleStore()->GetPositionsX()[0], storedParticlePosition.X(), "Particle store position array");
+
+	orbitalSystem.DestroyParticle(pStoredParticle);
+
+	testHandler.Assert(particleScaledSpace.GetParticleStore()->Size(), 0ull, "Particle store size after destroying particle");
+
+	// Batch creation, across the host space and the particle's (stored) space.
+	std::vector<OrbitalSystem2::ParticleDesc> descs;
+	for (int index = 0; index < 20; ++index)
+	{
+		float const radius = 0.2f + 0.02f * static_cast<float>(index);
+		ScaledSpaceBase *const pSpace = (0 == (index % 2)) ? &hostSpace : &particleScaledSpace;
+
+		descs.push_back({ pSpace, particleMass, Vector3(radius, 0.f, 0.f), Vector3(0.f, 1.1f * pSpace->CircularOrbitSpeed(radius), 0.f),
+			false });
+	}
+
+	size_t const hostParticleCount = hostSpace.GetParticleList().size();
+
+	std::vector<ParticleBase *> batchParticles;
+	orbitalSystem.CreateParticles(descs, batchParticles);
+
+	testHandler.Assert(batchParticles.size(), descs.size(), "Batch particle count");
+	testHandler.Assert(hostSpace.GetParticleList().size(), hostParticleCount + 10, "Batch particles placed in the host space");
+	testHandler.Assert(particleScaledSpace.GetParticleStore()->Size(), 10ull, "Batch particles placed in the particle store");
+	testHandler.Assert<bool, int>([&](int index)
+	{
+		Orbit reference;
+		ScaledSpaceBase const& space = *descs[index].m_pHostSpace;
+		reference.Initialize(space.GetGravityParameter(), descs[index].m_position - space.GetPrimaryPosition(),
+			descs[index].m_velocity - space.GetPrimaryVelocity());
+
+		ParticleBase const& batchParticle = *batchParticles[index];
+
+		return (batchParticle.GetHostSpace() == descs[index].m_pHostSpace) && (batchParticle.GetPosition() == descs[index].m_position) &&
+			(batchParticle.GetElements()->m_period == reference.GetCurrentSection().m_elements.m_period) &&
+			(batchParticle.GetMeanAnomaly() == reference.GetMeanAnomaly());
+
+	}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Batch particles match single creation", TestHandler::IndexRange<int>(0, 19));
+
+	// An invalid description rejects the whole batch.
+	descs.back().m_position = Vector3(2.f * kScalingSpaceEscapeRadius, 0.f, 0.f);
+
+	try
+	{
+		orbitalSystem.CreateParticles(descs, batchParticles);
+		isException = false;
+	}
+	catch (ApiException const&)
+	{
+		isException = true;
+	}
+	testHandler.Assert(isException, true, "Invalid batch causes exception");
+	testHandler.Assert(hostSpace.GetParticleList().size(), hostParticleCount + 10, "Invalid batch creates no particles");
+
+	// A space of influence out of range rejects the whole batch, leaving the particle stores as they were.
+	descs.back().m_position = Vector3(0.5f, 0.f, 0.f);
+	descs.push_back({ &hostSpace, 1e27f, Vector3(0.7f, 0.f, 0.f), Vector3(0.f, 2.f * hostSpace.CircularOrbitSpeed(0.7f), 0.f), true });
+
+	try
+	{
+		orbitalSystem.CreateParticles(descs, batchParticles);
+		isException = false;
+	}
+	catch (ApiException const&)
+	{
+		isException = true;
+	}
+	testHandler.Assert(isException, true, "Unbound influencing particle in a batch causes exception");
+	testHandler.Assert((hostSpace.GetParticleList().size() == hostParticleCount + 10) && (particleScaledSpace.GetParticleStore()->Size() == 10),
+		true, "Batch with an invalid space of influence creates nothing");
+
+	// Update: twin particles beside an influencing planet, one on rails and one perturbed by the planet.
+	{
+		// The perturbed particle is the last created.
+		auto const setUpTwins = [&](TestSystem & system, bool hasRailParticle)
+		{
+			system.CreatePlanet();
+
+			if (hasRailParticle)
+				system.CreateOrbiter(system.GetHostSpace(), particleMass, 0.6f, Vector3(1.f, 0.f, 0.f), false);
+
+			system.m_orbitalSystem.SetPerturbed(system.CreateOrbiter(system.GetHostSpace(), particleMass, 0.6f, Vector3(1.f, 0.f, 0.f), false), true);
+		};
+
+		TestSystem updateSystem;
+		setUpTwins(updateSystem, true);
+
+		OrbitalSystem2 & orbitalSystem = updateSystem.m_orbitalSystem;
+		ParticleBase & railParticle = *updateSystem.m_particles[1];
+		ParticleBase & perturbedParticle = *updateSystem.m_particles[2];
+
+		testHandler.Assert(orbitalSystem.IsPerturbed(perturbedParticle) && !orbitalSystem.IsPerturbed(railParticle), true, "Perturbed flag");
+
+		Orbit reference;
+		reference.Initialize(updateSystem.GetHostSpace().GetGravityParameter(), railParticle.GetPosition(), railParticle.GetVelocity());
+
+		Time::Microseconds const dT = reference.GetCurrentSection().m_elements.m_period.Get() / 64;
+
+		for (int step = 0; step < 8; ++step)
+			orbitalSystem.OnUpdate(dT);
+
+		Vector3 referencePosition, referenceVelocity;
+		reference.Propagate(dT.Get() * 8, referencePosition, referenceVelocity);
+
+		testHandler.Assert((railParticle.GetPosition() - referencePosition).SqareMagnitude() < 1e-10f, true,
+			"Unperturbed particle follows its orbit");
+		testHandler.Assert(1e-8f < (perturbedParticle.GetPosition() - railParticle.GetPosition()).SqareMagnitude(), true,
+			"Perturbed particle deviates from its orbit");
+		testHandler.Assert(perturbedParticle.GetElements()->m_semiMajor != railParticle.GetElements()->m_semiMajor, true, "Perturbed particle's orbit is rectified");
+
+		// A step of a whole period is divided so that it follows the same perturbed trajectory as many short steps.
+		TestSystem shortStepSystem, longStepSystem;
+		setUpTwins(shortStepSystem, false);
+		setUpTwins(longStepSystem, false);
+
+		for (int step = 0; step < 64; ++step)
+			shortStepSystem.m_orbitalSystem.OnUpdate(dT);
+
+		longStepSystem.m_orbitalSystem.OnUpdate(dT.Get() * 64);
+
+		float const longStepError = (longStepSystem.m_particles.back()->GetPosition() - shortStepSystem.m_particles.back()->GetPosition()).SqareMagnitude();
+		testHandler.Assert(longStepError < 1e-8f, true, "Perturbed particle propagated by a whole period in one step matches short steps");
+
+		try
+		{
+			orbitalSystem.SetPerturbed(*orbitalSystem.GetHostParticle(), true);
+			isException = false;
+		}
+		catch (ApiException const&)
+		{
+			isException = true;
+		}
+		testHandler.Assert(isException, true, "Perturbing the host particle causes exception");
+	}
+
+	// Update in a space attached to a moving particle: a perturbed particle is integrated from its state at the start of the step,
+	// though the space's primary moves with the host particle before the space is propagated.
+	{
+		// The particles are created in order: planet, perturber, rail particle and perturbed particle.
+		auto const setUpMovingSystem = [&](TestSystem & system, float perturberMass)
+		{
+			ParticleBase & planet = system.CreateOrbiter(system.GetHostSpace(), 1e10f, 0.5f, Vector3(1.f, 0.f, 0.f), false);
+			ScaledSpaceBase & planetSpace = *system.m_orbitalSystem.CreateScaledSpace(planet, HOST_SPACE_RADIUS * 0.05f);
+
+			system.CreateOrbiter(planetSpace, perturberMass, 0.5f, Vector3(-1.f, 0.f, 0.f), true, 0.f);
+			system.CreateOrbiter(planetSpace, 1e10f, 0.3f, Vector3(1.f, 0.f, 0.f), false, 0.f);
+			system.m_orbitalSystem.SetPerturbed(system.CreateOrbiter(planetSpace, 1e10f, 0.3f, Vector3(1.f, 0.f, 0.f), false, 0.f), true);
+		};
+
+		// Whose perturber is negligible keeps to its conic.
+		TestSystem negligibleSystem;
+		setUpMovingSystem(negligibleSystem, 1e18f);
+
+		Time::Microseconds const dT = negligibleSystem.m_particles[0]->GetElements()->m_period.Get() / 256;
+
+		for (int step = 0; step < 8; ++step)
+			negligibleSystem.m_orbitalSystem.OnUpdate(dT);
+
+		ParticleBase const& railParticle = *negligibleSystem.m_particles[2];
+		ParticleBase const& perturbedParticle = *negligibleSystem.m_particles[3];
+
+		testHandler.Assert(((perturbedParticle.GetPosition() - railParticle.GetPosition()).SqareMagnitude() < 1e-8f) &&
+			((perturbedParticle.GetVelocity() - railParticle.GetVelocity()).SqareMagnitude() < 1e-8f), true,
+			"Perturbed particle in a space attached to a moving particle keeps to its conic");
+
+		// Whose perturber is not follows the same trajectory through one long step as through short ones, though the primary
+		// moves further in the long step.
+		TestSystem shortStepSystem, longStepSystem;
+		setUpMovingSystem(shortStepSystem, 1e25f);
+		setUpMovingSystem(longStepSystem, 1e25f);
+
+		for (int step = 0; step < 8; ++step)
+			shortStepSystem.m_orbitalSystem.OnUpdate(dT);
+
+		longStepSystem.m_orbitalSystem.OnUpdate(dT.Get() * 8);
+
+		testHandler.Assert(1e-9f < (shortStepSystem.m_particles[3]->GetPosition() - shortStepSystem.m_particles[2]->GetPosition()).SqareMagnitude(),
+			true, "Perturbed particle in a space attached to a moving particle deviates from its conic");
+		testHandler.Assert((longStepSystem.m_particles[3]->GetPosition() - shortStepSystem.m_particles[3]->GetPosition()).SqareMagnitude() < 1e-8f,
+			true, "Perturbed particle in a space attached to a moving particle propagated in one step matches short steps");
+	}
+
+	// Primary kinetics of a space attached to a stored particle follow the particle as the store propagates it.
+	{
+		OrbitalSystem2 storeSystem(HOST_MASS, HOST_SPACE_RADIUS);
+		ScaledSpaceBase & storeSpace = *storeSystem.GetHostSpace();
+		storeSpace.EnableParticleStore();
+
+		ParticleBase & storedHost = *storeSystem.CreateParticle(storeSpace, particleMass, Vector3(0.5f, 0.f, 0.f),
+			Vector3(0.f, storeSpace.CircularOrbitSpeed(0.5f), 0.f), false);
+		ScaledSpaceBase & attachedSpace = *storeSystem.CreateScaledSpace(storedHost, HOST_SPACE_RADIUS * 0.05f);
+
+		for (int step = 0; step < 4; ++step)
+			storeSystem.OnUpdate(storedHost.GetElements()->m_period.Get() / 16);
+
+		testHandler.Assert((attachedSpace.GetPrimaryPosition() + storedHost.GetPosition() / 0.05f).SqareMagnitude() < 1e-6f, true,
+			"Stored host's space primary position follows the host");
+		testHandler.Assert((attachedSpace.GetPrimaryVelocity() + storedHost.GetVelocity() / 0.05f).SqareMagnitude() < 1e-6f, true,
+			"Stored host's space primary velocity follows the host");
+	}
+
+	// Precision: over many orbits, a double precision particle keeps to its true orbit, where the float elements drift.
+	{
+		OrbitalSystem2 precisionSystem(HOST_MASS, HOST_SPACE_RADIUS);
+		ScaledSpaceBase & precisionSpace = *precisionSystem.GetHostSpace();
+
+		Vector3 const position(0.6f, 0.f, 0.f);
+		Vector3 const velocity(0.f, precisionSpace.CircularOrbitSpeed(0.6f) * 1.2f, 0.1f);
+
+		ParticleBase & singleParticle = *precisionSystem.CreateParticle(precisionSpace, particleMass, position, velocity, false);
+		ParticleBase & doubleParticle = *precisionSystem.CreateParticle(precisionSpace, particleMass, position, velocity, false);
+
+		precisionSystem.SetPrecision(doubleParticle, OrbitalSystem2::Precision::Double);
+
+		testHandler.Assert(precisionSystem.GetPrecision(doubleParticle) == OrbitalSystem2::Precision::Double &&
+			precisionSystem.GetPrecision(singleParticle) == OrbitalSystem2::Precision::Single, true, "Particle precision");
+
+		Orbitd reference;
+		reference.Initialize(precisionSpace.GetGravityParameter(), Vector3d(position), Vector3d(velocity));
+
+		Time::Microseconds const dT = doubleParticle.GetElements()->m_period.Get() * 997 + 12345;
+
+		for (int step = 0; step < 8; ++step)
+			precisionSystem.OnUpdate(dT);
+
+		Vector3d referencePosition, referenceVelocity;
+		reference.Propagate(dT.Get() * 8, referencePosition, referenceVelocity);
+
+		float const singleError = (singleParticle.GetPosition() - Vector3(referencePosition)).SqareMagnitude();
+		float const doubleError = (doubleParticle.GetPosition() - Vector3(referencePosition)).SqareMagnitude();
+
+		testHandler.Assert(doubleError < 1e-10f, true, "Double precision particle follows its orbit");
+		testHandler.Assert(doubleError < singleError, true, "Double precision particle drifts less than single precision");
+	}
+
+	// Parallel update: sibling spaces are propagated concurrently once their outer space has been, and the particles of a large
+	// space in chunks.
+	{
+		auto const setUpParallelSystem = [&](TestSystem & system)
+		{
+			ScaledSpaceBase & space = system.GetHostSpace();
+
+			for (int i = 0; i < 200; ++i)
+				system.CreateOrbiter(space, 1e10f, 0.1f + 0.002f * static_cast<float>(i), Vector3(1.f, 0.f, 0.f), false, 0.9f);
+
+			// Two planets, whose spaces of influence are siblings, with particles enough for several chunks each.
+			for (Vector3 const& direction : { Vector3(1.f, 0.f, 0.f), Vector3(0.f, 1.f, 0.f) })
+			{
+				ScaledSpaceBase & planetSpace = *system.CreatePlanet(direction).GetSpaceOfInfluence();
+
+				for (int i = 0; i < 150; ++i)
+					system.CreateOrbiter(planetSpace, 1e10f, 0.2f + 0.004f * static_cast<float>(i), Vector3(1.f, 0.f, 0.f), false, 1.1f);
+			}
+
+			system.m_orbitalSystem.SetPerturbed(system.CreateOrbiter(space, 1e10f, 0.6f, Vector3(0.f, -1.f, 0.f), false), true);
+		};
+
+		TaskPool taskPool(4);
+
+		TestSystem serialSystem, parallelSystem;
+		setUpParallelSystem(serialSystem);
+		setUpParallelSystem(parallelSystem);
+		parallelSystem.m_orbitalSystem.SetTaskPool(&taskPool);
+
+		Time::Microseconds const dT = serialSystem.m_particles[0]->GetElements()->m_period.Get() / 64;
+
+		for (int step = 0; step < 16; ++step)
+		{
+			serialSystem.m_orbitalSystem.OnUpdate(dT);
+			parallelSystem.m_orbitalSystem.OnUpdate(dT);
+		}
+
+		int const particleCount = static_cast<int>(serialSystem.m_particles.size());
+
+		testHandler.Assert<bool, int>([&](int index)
+		{
+			return (serialSystem.m_particles[index]->GetPosition() == parallelSystem.m_particles[index]->GetPosition()) &&
+				(serialSystem.m_particles[index]->GetVelocity() == parallelSystem.m_particles[index]->GetVelocity());
+
+		}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Parallel update matches serial update",
+			TestHandler::IndexRange<int>(0, particleCount - 1));
+	}
+
+	// Level of detail: a moon of a planet, with the observer at the host, and a twin system propagating every space every tick.
+	{
+		using UpdateTier = ScaledSpaceBase::UpdateTier;
+
+		// The moon is the last particle created, in the planet's space of influence.
+		auto const setUpMoonSystem = [](TestSystem & system)
+		{
+			ScaledSpaceBase & moonSpace = *system.CreatePlanet().GetSpaceOfInfluence();
+
+			system.CreateOrbiter(moonSpace, 1e20f, 0.3f, Vector3(1.f, 0.f, 0.f), false);
+		};
+
+		TestSystem lodSystem, referenceSystem;
+		setUpMoonSystem(lodSystem);
+		setUpMoonSystem(referenceSystem);
+
+		OrbitalSystem2 & orbitalSystem = lodSystem.m_orbitalSystem;
+		ScaledSpaceBase *const pMoonSpace = lodSystem.m_particles[0]->GetSpaceOfInfluence();
+		ParticleBase *const pMoon = lodSystem.m_particles.back();
+		ParticleBase *const pReferenceMoon = referenceSystem.m_particles.back();
+
+		// The planet's space lies some tens of its radii from the observer.
+		orbitalSystem.SetLevelOfDetail(OrbitalSystem2::LevelOfDetail{ 4, 1.f, 8.f });
+		orbitalSystem.SetObserver(orbitalSystem.GetHostSpace(), Vector3::Zero());
+
+		Time::Microseconds const dT = pMoon->GetElements()->m_period.Get() / 64;
+
+		for (int step = 0; step < 8; ++step)
+		{
+			orbitalSystem.OnUpdate(dT);
+			referenceSystem.m_orbitalSystem.OnUpdate(dT);
+		}
+
+		testHandler.Assert((UpdateTier::OnDemand == pMoonSpace->GetUpdateTier()) && (0 == pMoonSpace->GetEpoch().Get()),
+			true, "Distant space is not propagated");
+		testHandler.Assert(((pMoon->GetPosition() - pReferenceMoon->GetPosition()).SqareMagnitude() < 1e-10f) &&
+			((pMoon->GetVelocity() - pReferenceMoon->GetVelocity()).SqareMagnitude() < 1e-10f), true,
+			"Particle in a lagging space is read where it is at the system time");
+
+		orbitalSystem.Synchronize(*pMoonSpace);
+
+		testHandler.Assert((pMoonSpace->GetEpoch() == orbitalSystem.GetTime()) &&
+			((pMoon->GetPosition() - pReferenceMoon->GetPosition()).SqareMagnitude() < 1e-10f), true,
+			"Synchronized space matches propagation every tick");
+
+		// The update tier function replaces the observer distance.
+		orbitalSystem.SetUpdateTierFunction([&](ScaledSpaceBase const& space)
+			{ return (&space == pMoonSpace) ? UpdateTier::EveryNthTick : UpdateTier::EveryTick; });
+
+		Time::Microseconds const epoch = pMoonSpace->GetEpoch();
+
+		for (int step = 0; step < 3; ++step)
+			orbitalSystem.OnUpdate(dT);
+
+		bool const isLagging = (pMoonSpace->GetEpoch() == epoch);
+		orbitalSystem.OnUpdate(dT);
+
+		testHandler.Assert(isLagging && (pMoonSpace->GetEpoch() == orbitalSystem.GetTime()), true,
+			"Space is propagated every Nth tick");
+
+		// A space is propagated at least as often as its inner spaces.
+		orbitalSystem.SetUpdateTierFunction([&](ScaledSpaceBase const& space)
+			{ return (&space == orbitalSystem.GetHostSpace()) ? UpdateTier::OnDemand : UpdateTier::EveryTick; });
+		orbitalSystem.OnUpdate(dT);
+
+		testHandler.Assert(UpdateTier::EveryTick == orbitalSystem.GetHostSpace()->GetUpdateTier(), true,
+			"Outer space is raised to inner space's tier");
+
+		// A space with perturbed particles is propagated every tick, whatever its chosen tier.
+		orbitalSystem.SetUpdateTierFunction([&](ScaledSpaceBase const&) { return UpdateTier::OnDemand; });
+		orbitalSystem.SetPerturbed(*pMoon, true);
+		orbitalSystem.OnUpdate(dT);
+
+		testHandler.Assert((UpdateTier::EveryTick == pMoonSpace->GetUpdateTier()) &&
+			(pMoonSpace->GetEpoch() == orbitalSystem.GetTime()), true, "Space with perturbed particles is propagated every tick");
+	}
 }
 
 } // namespace Neutron ------------------------------------------------------------------------------------------------------------
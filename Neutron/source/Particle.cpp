@@ -5,19 +5,21 @@
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
-Particle::Particle(State const& state, ScalingSpace * pHostSpace) :
+Particle::Particle(State const& state, ScalingSpace * pHostSpace, Time::Microseconds epoch) :
 	m_state(state),
-	m_pElements(std::move(MakeUnique<Orbit::Elements>())),
+	m_epoch(epoch),
+	m_eventId(0),
+	m_eventTime(std::numeric_limits<int64_t>::max()),
+	m_scale(1.f),
+	m_scaleGeneration(0),
+	m_isRescaled(false),
 	m_pHostSpace(pHostSpace)
 {
-	Vector3 const positionFromPrimary = m_state.m_localPosition - pHostSpace->GetPrimaryPosition();
-	Vector3 const velocityFromPrimary = m_state.m_localVelocity - pHostSpace->GetPrimaryVelocity();
-
-	m_pElements->Compute(pHostSpace->GetGravityParameter(), positionFromPrimary, velocityFromPrimary);
+	Set(m_state.m_localPosition, m_state.m_localVelocity, pHostSpace);
 
 	// TODO - move to OrbitalSystem ...
 	/*float const radiusOfInfluence =
-		ComputeRadiusOfInfluence(m_pElements->m_semiMajor, m_state.m_mass, pHostSpace->GetPrimary().m_state.m_mass);
+		ComputeRadiusOfInfluence(m_orbit.GetCurrentSection().m_elements.m_semiMajor, m_state.m_mass, pHostSpace->GetPrimary().m_state.m_mass);
 
 	if (kMinimumRadiusOfInfluence < radiusOfInfluence)
 	{
@@ -34,6 +36,12 @@ Particle::Particle(State const& state, ScalingSpace * pHostSpace) :
 
 Particle::Particle(float mass, float hostSpaceTrueRadius) :
 	m_state{ .m_mass = mass },
+	m_epoch(0),
+	m_eventId(0),
+	m_eventTime(std::numeric_limits<int64_t>::max()),
+	m_scale(1.f),
+	m_scaleGeneration(0),
+	m_isRescaled(false),
 	m_pHostSpace(nullptr)
 {
 	m_attachedSpaces.Emplace(std::move(MakeUnique<ScalingSpace>(this, hostSpaceTrueRadius)));
@@ -42,19 +50,31 @@ Particle::Particle(float mass, float hostSpaceTrueRadius) :
 // --------------------------------------------------------------------------------------------------------------------------------
 
 void Particle::Set(Vector3 const& position, Vector3 const& velocity, ScalingSpace * pHostSpace)
+{
+	Orbit::Elements elements;
+	elements.Compute(pHostSpace->GetGravityParameter(), position - pHostSpace->GetPrimaryPosition(),
+		velocity - pHostSpace->GetPrimaryVelocity());
+
+	Set(position, velocity, pHostSpace, elements);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::Set(Vector3 const& position, Vector3 const& velocity, ScalingSpace * pHostSpace, Orbit::Elements const& elements)
 {
 	m_state.m_localPosition = position;
 	m_state.m_localVelocity = velocity;
 	m_pHostSpace = pHostSpace;
+	m_scale = pHostSpace->GetScale();
+	m_scaleGeneration = pHostSpace->GetScaleGeneration();
 
-	Vector3 const positionFromPrimary = m_state.m_localPosition - m_pHostSpace->GetPrimaryPosition();
-	Vector3 const velocityFromPrimary = m_state.m_localVelocity - m_pHostSpace->GetPrimaryVelocity();
-
-	m_pElements->Compute(m_pHostSpace->GetGravityParameter(), positionFromPrimary, velocityFromPrimary);
+	m_orbit.Initialize(elements, m_state.m_localPosition - m_pHostSpace->GetPrimaryPosition());
+	m_orbit.GetCurrentSection().m_entryTime = m_epoch;
+	m_nextSpaces.clear();
 
 	// TODO - move to OrbitalSystem ...
 	/*float const radiusOfInfluence =
-		ComputeRadiusOfInfluence(m_pElements->m_semiMajor, m_state.m_mass, m_pHostSpace->GetPrimary().m_state.m_mass);
+		ComputeRadiusOfInfluence(m_orbit.GetCurrentSection().m_elements.m_semiMajor, m_state.m_mass, m_pHostSpace->GetPrimary().m_state.m_mass);
 
 	float const trueRadiusOfInfluence = radiusOfInfluence * pHostSpace->GetTrueRadius();
 
@@ -77,6 +97,107 @@ void Particle::Set(Vector3 const& position, Vector3 const& velocity, ScalingSpac
 	}*/
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::ApplyRescale()
+{
+	assert(IsRescalePending());
+
+	float const rescaleFactor = ComputePendingRescale();
+
+	Set(m_state.m_localPosition * rescaleFactor, m_state.m_localVelocity * rescaleFactor, m_pHostSpace);
+
+	m_isRescaled = true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::ResolveSectionExit(ScalingSpace * pNextSpace)
+{
+	assert(m_nextSpaces.size() < m_orbit.GetSectionCount()); // Sections are only predicted past resolved exits.
+
+	m_nextSpaces.push_back(pNextSpace);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::DiscardPrediction()
+{
+	m_orbit.DiscardPrediction();
+	m_nextSpaces.clear();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::AdvanceSection()
+{
+	assert(!m_nextSpaces.empty());
+
+	m_orbit.AdvanceSection();
+	m_nextSpaces.pop_front();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::Propagate(Time::Microseconds dT)
+{
+	assert(nullptr != m_pHostSpace); // The system host particle does not move.
+
+	if (IsRescalePending())
+		ApplyRescale();
+
+	Vector3 positionFromPrimary, velocityFromPrimary;
+	m_orbit.Propagate(dT, positionFromPrimary, velocityFromPrimary);
+
+	m_state.m_localPosition = m_pHostSpace->GetPrimaryPosition() + positionFromPrimary;
+	m_state.m_localVelocity = m_pHostSpace->GetPrimaryVelocity() + velocityFromPrimary;
+
+	m_epoch += dT;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::ComputeKinetics(Time::Microseconds time, Vector3 & position, Vector3 & velocity) const
+{
+	ComputeOrbitKinetics(time, position, velocity);
+
+	Vector3 primaryPosition, primaryVelocity;
+	m_pHostSpace->ComputePrimaryKinetics(time, primaryPosition, primaryVelocity);
+
+	position += primaryPosition;
+	velocity += primaryVelocity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Particle::ComputeOrbitKinetics(Time::Microseconds time, Vector3 & positionFromPrimary, Vector3 & velocityFromPrimary) const
+{
+	assert(nullptr != m_pHostSpace); // The system host particle does not move.
+
+	Orbit::Elements const* pElements = &m_orbit.GetCurrentSection().m_elements;
+	double meanAnomaly = m_orbit.GetMeanAnomaly();
+
+	Orbit::Elements rescaledElements;
+	if (IsRescalePending())
+	{
+		// Evaluate on the orbit which the particle will follow once it applies the rescale, without applying it.
+		float const rescaleFactor = ComputePendingRescale();
+
+		Vector3 const positionFromPrimary = m_state.m_localPosition * rescaleFactor - m_pHostSpace->GetPrimaryPosition();
+
+		rescaledElements.Compute(m_pHostSpace->GetGravityParameter(), positionFromPrimary,
+			m_state.m_localVelocity * rescaleFactor - m_pHostSpace->GetPrimaryVelocity());
+
+		pElements = &rescaledElements;
+		meanAnomaly = rescaledElements.TrueToMeanAnomaly(rescaledElements.ComputeTrueAnomaly(positionFromPrimary));
+	}
+
+	Orbit::Elements const& elements = *pElements;
+
+	elements.ComputeKinetics(elements.MeanToTrueAnomaly(elements.PropagateMeanAnomaly(meanAnomaly, time - m_epoch)),
+		positionFromPrimary, velocityFromPrimary);
+}
+
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
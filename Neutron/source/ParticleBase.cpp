@@ -9,7 +9,8 @@ namespace Neutron // -----------------------------------------------------------
 ParticleBase::ParticleBase(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHostSpace, float mass) :
 	m_orbitalSystem(orbitalSystem),
 	m_pHostSpace(pHostSpace),
-	m_mass(mass)
+	m_mass(mass),
+	m_generation(0)
 {
 }
 
@@ -17,6 +18,40 @@ ParticleBase::ParticleBase(OrbitalSystem2 & orbitalSystem, ScaledSpaceBase * pHo
 
 ParticleBase::~ParticleBase()
 {
+	if (!m_attachedSpaces.empty() && (nullptr != m_pHostSpace))
+	{
+		std::vector<ParticleBase *> & hostParticles = m_pHostSpace->m_hostParticles;
+		hostParticles.erase(std::find(hostParticles.begin(), hostParticles.end(), this));
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleBase::GetEpochState(Vector3 & position, Vector3 & velocity, double & meanAnomaly) const
+{
+	position = GetPosition();
+	velocity = GetVelocity();
+	meanAnomaly = (nullptr == GetElements()) ? 0.0 : GetMeanAnomaly();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleBase::OnSpaceAttached()
+{
+	if ((1 == m_attachedSpaces.size()) && (nullptr != m_pHostSpace))
+		m_pHostSpace->m_hostParticles.push_back(this);
+
+	m_orbitalSystem.GetScaledSpaceTree().Invalidate();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleBase::OnKineticsChanged()
+{
+	++m_generation;
+
+	for (PoolPtr<ScaledSpaceBase> & pAttachedSpace : m_attachedSpaces)
+		pAttachedSpace->RefreshPrimaryKinetics();
 }
 
 } // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,195 @@
+#include "ParticleStore.h"
+
+#include "Constants.h"
+#include "TestHandler.h"
+#include "Exception.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+ParticleStore::Handle ParticleStore::Add(float mass, Vector3 const& position, Vector3 const& velocity)
+{
+	uint32_t const index = static_cast<uint32_t>(m_mass.size());
+
+	m_positionX.push_back(position.X());
+	m_positionY.push_back(position.Y());
+	m_positionZ.push_back(position.Z());
+	m_velocityX.push_back(velocity.X());
+	m_velocityY.push_back(velocity.Y());
+	m_velocityZ.push_back(velocity.Z());
+	m_mass.push_back(mass);
+	m_elements.emplace_back();
+	m_meanAnomalies.push_back(0.0);
+
+	Handle handle;
+	if (m_freeHandles.empty())
+	{
+		handle = static_cast<Handle>(m_handleToIndex.size());
+		m_handleToIndex.push_back(index);
+	}
+	else
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_handleToIndex[handle] = index;
+	}
+
+	m_indexToHandle.push_back(handle);
+
+	return handle;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleStore::Remove(Handle handle)
+{
+	API_ASSERT_THROW(Contains(handle), RESULT_CODE_INVALID_PARAMETER, Fmt::Format("Particle store does not contain handle {}", handle));
+
+	size_t const index = m_handleToIndex[handle];
+	size_t const lastIndex = m_mass.size() - 1;
+
+	if (index != lastIndex)
+	{
+		// Move the last particle into the vacated slot to keep the arrays dense.
+		m_positionX[index] = m_positionX[lastIndex];
+		m_positionY[index] = m_positionY[lastIndex];
+		m_positionZ[index] = m_positionZ[lastIndex];
+		m_velocityX[index] = m_velocityX[lastIndex];
+		m_velocityY[index] = m_velocityY[lastIndex];
+		m_velocityZ[index] = m_velocityZ[lastIndex];
+		m_mass[index] = m_mass[lastIndex];
+		m_elements[index] = m_elements[lastIndex];
+		m_meanAnomalies[index] = m_meanAnomalies[lastIndex];
+
+		Handle const lastHandle = m_indexToHandle[lastIndex];
+		m_indexToHandle[index] = lastHandle;
+		m_handleToIndex[lastHandle] = static_cast<uint32_t>(index);
+	}
+
+	m_positionX.pop_back();
+	m_positionY.pop_back();
+	m_positionZ.pop_back();
+	m_velocityX.pop_back();
+	m_velocityY.pop_back();
+	m_velocityZ.pop_back();
+	m_mass.pop_back();
+	m_elements.pop_back();
+	m_meanAnomalies.pop_back();
+	m_indexToHandle.pop_back();
+
+	m_handleToIndex[handle] = kInvalidIndex;
+	m_freeHandles.push_back(handle);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleStore::Reserve(size_t count)
+{
+	m_positionX.reserve(count);
+	m_positionY.reserve(count);
+	m_positionZ.reserve(count);
+	m_velocityX.reserve(count);
+	m_velocityY.reserve(count);
+	m_velocityZ.reserve(count);
+	m_mass.reserve(count);
+	m_elements.reserve(count);
+	m_meanAnomalies.reserve(count);
+	m_indexToHandle.reserve(count);
+	m_handleToIndex.reserve(count);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleStore::Propagate(Time::Microseconds dT, Vector3 const& primaryPosition, Vector3 const& primaryVelocity)
+{
+	size_t const size = m_mass.size();
+
+	++m_generation;
+
+	for (size_t index = 0; index < size; ++index)
+	{
+		Orbit::Elements const& elements = m_elements[index];
+
+		double const meanAnomaly = elements.PropagateMeanAnomaly(m_meanAnomalies[index], dT);
+		m_meanAnomalies[index] = meanAnomaly;
+
+		Vector3 position, velocity;
+		elements.ComputeKinetics(elements.MeanToTrueAnomaly(meanAnomaly), position, velocity);
+
+		position += primaryPosition;
+		velocity += primaryVelocity;
+
+		m_positionX[index] = position.X();
+		m_positionY[index] = position.Y();
+		m_positionZ[index] = position.Z();
+		m_velocityX[index] = velocity.X();
+		m_velocityY[index] = velocity.Y();
+		m_velocityZ[index] = velocity.Z();
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ParticleStoreTestScript::ParticleStoreTestScript() :
+	ITestScript("ParticleStore")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ParticleStoreTestScript::~ParticleStoreTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ParticleStoreTestScript::RunImpl(TestHandler & testHandler)
+{
+	ParticleStore particleStore;
+
+	std::vector<ParticleStore::Handle> handles;
+	for (int i = 0; i < 4; ++i)
+		handles.push_back(particleStore.Add(static_cast<float>(i), Vector3(static_cast<float>(i)), Vector3(-static_cast<float>(i))));
+
+	testHandler.Assert(particleStore.Size(), 4ull, "Particle store size after adding");
+
+	particleStore.Remove(handles[1]);
+
+	testHandler.Assert(particleStore.Size(), 3ull, "Particle store size after removing");
+	testHandler.Assert(particleStore.Contains(handles[1]), false, "Removed handle is released");
+	testHandler.Assert(particleStore.GetIndex(handles[3]), 1ull, "Last particle moves into the vacated slot");
+
+	testHandler.Assert<bool, int>([&](int index)
+	{
+		ParticleStore::Handle const handle = handles[index];
+
+		return (particleStore.GetMass(handle) == static_cast<float>(index)) &&
+			(particleStore.GetPosition(handle) == Vector3(static_cast<float>(index))) &&
+			(particleStore.GetVelocity(handle) == Vector3(-static_cast<float>(index)));
+
+	}, TestHandler::FRangeIndex<int>(), [](int) { return true; }, "Handles remain valid after removal", TestHandler::IndexRange<int>(2, 3));
+
+	ParticleStore::Handle const reusedHandle = particleStore.Add(5.f, Vector3(5.f), Vector3(-5.f));
+
+	testHandler.Assert(reusedHandle, handles[1], "Released handle is reused");
+	testHandler.Assert(particleStore.GetPositionsX()[particleStore.GetIndex(reusedHandle)], 5.f, "Positions are stored contiguously by index");
+
+	// Orbits are propagated from the element and mean anomaly columns.
+	Vector3 const position(1.f, 0.f, 0.f);
+	Vector3 const velocity(0.f, 1.f, 0.f);
+
+	Orbit::Elements elements;
+	elements.Compute(1.f, position, velocity);
+
+	ParticleStore orbitStore;
+	ParticleStore::Handle const orbitHandle = orbitStore.Add(1.f, position, velocity);
+	orbitStore.SetOrbit(orbitHandle, elements, elements.TrueToMeanAnomaly(elements.ComputeTrueAnomaly(position)));
+	orbitStore.Propagate(Time::Microseconds::Convert(0.25 * kPI2), Vector3(1.f), Vector3::Zero());
+
+	testHandler.Assert((orbitStore.GetPosition(orbitHandle) - Vector3(1.f, 2.f, 1.f)).SqareMagnitude() < 1e-8f, true,
+		"Stored orbit propagated by a quarter period, offset by the primary position");
+	testHandler.Assert(fabs(orbitStore.GetMeanAnomaly(orbitHandle) - 0.25 * kPI2) < 1e-6, true, "Stored mean anomaly advanced");
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
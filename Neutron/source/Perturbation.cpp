@@ -0,0 +1,291 @@
+#include "Perturbation.h"
+
+#include "Constants.h"
+#include "Exception.h"
+#include "TestHandler.h"
+
+namespace // detail
+{
+
+using namespace Neutron;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns> The two-body acceleration at the given position: -mu * r / |r|^3. </returns>
+inline Vector3d ComputeTwoBodyAcceleration(double gravityParameter, Vector3d const& position)
+{
+	double const squareDistance = position.SqareMagnitude();
+
+	return position * (-gravityParameter / (squareDistance * sqrt(squareDistance)));
+}
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+namespace Perturbation // ---------------------------------------------------------------------------------------------------------
+{
+
+Vector3d ComputeAcceleration(Vector3d const& position, std::span<Perturber const> perturbers, std::span<Vector3d const> perturberPositions,
+	uint32_t excludedPerturber)
+{
+	assert(perturbers.size() == perturberPositions.size());
+
+	Vector3d acceleration = Vector3d::Zero();
+
+	for (size_t index = 0; index < perturbers.size(); ++index)
+	{
+		if (excludedPerturber == index)
+			continue;
+
+		double const gravityParameter = perturbers[index].m_gravityParameter;
+		Vector3d const& perturberPosition = perturberPositions[index];
+
+		// Direct term: towards the perturber. Indirect term: the primary's acceleration towards the perturber.
+		acceleration -= ComputeTwoBodyAcceleration(gravityParameter, perturberPosition - position);
+		acceleration += ComputeTwoBodyAcceleration(gravityParameter, perturberPosition);
+	}
+
+	return acceleration;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ComputePositions(std::span<Perturber const> perturbers, double time, std::span<Vector3d> positions)
+{
+	assert(perturbers.size() == positions.size());
+
+	for (size_t index = 0; index < perturbers.size(); ++index)
+	{
+		Orbitd::Elements const& elements = perturbers[index].m_elements;
+
+		// As Elements::PropagateMeanAnomaly, but at any time rather than whole microseconds.
+		double meanAnomaly = perturbers[index].m_meanAnomaly + elements.m_meanMotion * time;
+
+		if ((Orbitd::Type::Circle == elements.m_type) || (Orbitd::Type::Ellipse == elements.m_type))
+		{
+			meanAnomaly = fmod(meanAnomaly, kPI2);
+
+			if (meanAnomaly < 0.0)
+				meanAnomaly += kPI2;
+		}
+
+		Vector3d velocity;
+		elements.ComputeKinetics(elements.MeanToTrueAnomaly(meanAnomaly), positions[index], velocity);
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Integrator::TAccelerationFunction<double> MakeAccelerationFunction(std::span<Perturber const> perturbers,
+	std::span<uint32_t const> excludedPerturbers)
+{
+	return [perturbers, excludedPerturbers, positions = std::vector<Vector3d>(perturbers.size()),
+		positionTime = std::numeric_limits<double>::quiet_NaN()](size_t bodyIndex, double time, Vector3d const& position) mutable
+	{
+		// The stages of a step evaluate the perturbers at the same times, and fixed steps end at the same times for every body.
+		if (time != positionTime)
+		{
+			ComputePositions(perturbers, time, positions);
+			positionTime = time;
+		}
+
+		return ComputeAcceleration(position, perturbers, positions, excludedPerturbers[bodyIndex]);
+	};
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Time::Microseconds ComputeMaximumStep(double gravityParameter, std::span<Perturber const> perturbers,
+	std::span<Integrator::Bodyd const> bodies)
+{
+	double shortestPeriod = std::numeric_limits<double>::infinity();
+
+	auto const includePeriod = [&](Orbitd::Elements const& elements)
+	{
+		if ((Orbitd::Type::Circle == elements.m_type) || (Orbitd::Type::Ellipse == elements.m_type))
+		{
+			shortestPeriod = std::min(shortestPeriod, static_cast<double>(elements.m_period.Get()));
+		}
+		else
+		{
+			double const periapsis = elements.m_parameter / (1.0 + elements.m_eccentricity);
+			double const periodSeconds = kPI2 * sqrt(periapsis * periapsis * periapsis / gravityParameter);
+
+			shortestPeriod = std::min(shortestPeriod, periodSeconds * static_cast<double>(Time::Microsecond));
+		}
+	};
+
+	for (Perturber const& perturber : perturbers)
+		includePeriod(perturber.m_elements);
+
+	for (Integrator::Bodyd const& body : bodies)
+		includePeriod(body.m_elements);
+
+	if (std::isinf(shortestPeriod))
+		return std::numeric_limits<int64_t>::max();
+
+	return std::max<int64_t>(1, llround(shortestPeriod * kMaximumStepFraction));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Rectify(double gravityParameter, std::span<Perturber> perturbers, std::span<Integrator::Bodyd> bodies,
+	std::span<uint32_t const> excludedPerturbers, Time::Microseconds dT)
+{
+	assert(bodies.size() == excludedPerturbers.size());
+
+	for (Perturber & perturber : perturbers)
+		perturber.m_meanAnomaly = perturber.m_elements.PropagateMeanAnomaly(perturber.m_meanAnomaly, dT);
+
+	for (size_t index = 0; index < bodies.size(); ++index)
+	{
+		Integrator::Bodyd & body = bodies[index];
+
+		Integrator::Initialize(body, gravityParameter, body.m_position, body.m_velocity);
+
+		if (kNoPerturber != excludedPerturbers[index])
+		{
+			perturbers[excludedPerturbers[index]].m_elements = body.m_elements;
+			perturbers[excludedPerturbers[index]].m_meanAnomaly = body.m_meanAnomaly;
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+PerturbationTestScript::PerturbationTestScript() :
+	ITestScript("Perturbation")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+PerturbationTestScript::~PerturbationTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void PerturbationTestScript::RunImpl(TestHandler & testHandler)
+{
+	static constexpr double gravityParameter = 1.0;
+
+	auto const makeConic = [](double radius, double & meanAnomaly)
+	{
+		Vector3d const position(radius, 0.0, 0.0);
+
+		Orbitd::Elements elements;
+		elements.Compute(gravityParameter, position, Vector3d(0.0, sqrt(gravityParameter / radius), 0.0));
+		meanAnomaly = elements.TrueToMeanAnomaly(elements.ComputeTrueAnomaly(position));
+
+		return elements;
+	};
+
+	Vector3d const initialPosition(0.5, 0.0, 0.0);
+	Vector3d const initialVelocity(0.0, sqrt(gravityParameter / 0.5), 0.0);
+
+	Integrator::Bodyd body;
+	Integrator::Initialize(body, gravityParameter, initialPosition, initialVelocity);
+
+	Time::Microseconds const dT = body.m_elements.m_period.Get() / 4;
+	double const dTSeconds = static_cast<double>(dT.Get()) / Time::Microsecond;
+
+	// The deviation is kept, rather than rectified, so that it can be measured.
+	Integrator::Settingsd settings;
+	settings.m_method = Integrator::Method::Yoshida4;
+	settings.m_maximumStep = dT.Get() / 64;
+	settings.m_rectificationRatio = 1.0;
+
+	uint32_t const notExcluded = kNoPerturber;
+
+	// Unperturbed, the body follows its reference conic.
+	{
+		Integrator::Bodyd unperturbed = body;
+		Integrator::Integrate(gravityParameter, std::span<Integrator::Bodyd>(&unperturbed, 1), dT, settings,
+			MakeAccelerationFunction({}, std::span<uint32_t const>(&notExcluded, 1)));
+
+		testHandler.Assert(unperturbed.m_positionDeviation == Vector3d::Zero(), true, "Unperturbed body follows its reference conic");
+	}
+
+	// Perturbed by an outer body, Encke's method matches a fine integration of the full motion (Cowell's method, RK4).
+	Perturber perturber;
+	perturber.m_elements = makeConic(0.8, perturber.m_meanAnomaly);
+	perturber.m_meanAnomaly += 0.5; // Ahead of the body.
+	perturber.m_gravityParameter = 1e-3;
+
+	std::span<Perturber const> const perturbers(&perturber, 1);
+
+	Integrator::Bodyd perturbed = body;
+	Integrator::Integrate(gravityParameter, std::span<Integrator::Bodyd>(&perturbed, 1), dT, settings,
+		MakeAccelerationFunction(perturbers, std::span<uint32_t const>(&notExcluded, 1)));
+
+	Vector3d position = initialPosition;
+	Vector3d velocity = initialVelocity;
+
+	auto const computeFullAcceleration = [&](double seconds, Vector3d const& atPosition)
+	{
+		Vector3d perturberPosition;
+		ComputePositions(perturbers, seconds, std::span<Vector3d>(&perturberPosition, 1));
+
+		return ComputeTwoBodyAcceleration(gravityParameter, atPosition) +
+			ComputeAcceleration(atPosition, perturbers, std::span<Vector3d const>(&perturberPosition, 1));
+	};
+
+	static constexpr int kCowellStepCount = 4000;
+	double const stepSeconds = dTSeconds / kCowellStepCount;
+
+	for (int step = 0; step < kCowellStepCount; ++step)
+	{
+		double const seconds = step * stepSeconds;
+
+		Vector3d const k1v = computeFullAcceleration(seconds, position);
+		Vector3d const k1r = velocity;
+		Vector3d const k2v = computeFullAcceleration(seconds + 0.5 * stepSeconds, position + k1r * (0.5 * stepSeconds));
+		Vector3d const k2r = velocity + k1v * (0.5 * stepSeconds);
+		Vector3d const k3v = computeFullAcceleration(seconds + 0.5 * stepSeconds, position + k2r * (0.5 * stepSeconds));
+		Vector3d const k3r = velocity + k2v * (0.5 * stepSeconds);
+		Vector3d const k4v = computeFullAcceleration(seconds + stepSeconds, position + k3r * stepSeconds);
+		Vector3d const k4r = velocity + k3v * stepSeconds;
+
+		position += (k1r + k2r * 2.0 + k3r * 2.0 + k4r) * (stepSeconds / 6.0);
+		velocity += (k1v + k2v * 2.0 + k3v * 2.0 + k4v) * (stepSeconds / 6.0);
+	}
+
+	testHandler.Assert(1e-4 < perturbed.m_positionDeviation.SqareMagnitude(), false, "Deviation is small relative to the orbit");
+	testHandler.Assert(1e-8 < perturbed.m_positionDeviation.SqareMagnitude(), true, "Perturber deflects the body");
+	testHandler.Assert((perturbed.m_position - position).SqareMagnitude() < 1e-12, true, "Encke position matches Cowell integration");
+	testHandler.Assert((perturbed.m_velocity - velocity).SqareMagnitude() < 1e-11, true, "Encke velocity matches Cowell integration");
+
+	// A body is not perturbed by itself.
+	Integrator::Bodyd selfPerturbed = body;
+	uint32_t const selfExcluded = 0;
+
+	Perturber self{ body.m_elements, body.m_meanAnomaly, 1e-3 };
+	Integrator::Integrate(gravityParameter, std::span<Integrator::Bodyd>(&selfPerturbed, 1), dT, settings,
+		MakeAccelerationFunction(std::span<Perturber const>(&self, 1), std::span<uint32_t const>(&selfExcluded, 1)));
+
+	testHandler.Assert(selfPerturbed.m_positionDeviation == Vector3d::Zero(), true, "Body is not perturbed by itself");
+
+	// Steps are bounded by the shorter of the two periods, and rectification moves the deviation into the reference conic.
+	testHandler.Assert(ComputeMaximumStep(gravityParameter, perturbers, std::span<Integrator::Bodyd const>(&body, 1)).Get(),
+		static_cast<int64_t>(llround(static_cast<double>(body.m_elements.m_period.Get()) * kMaximumStepFraction)),
+		"Maximum step is a fraction of the shortest period");
+
+	Vector3d const perturbedPosition = perturbed.m_position;
+	Vector3d const perturbedVelocity = perturbed.m_velocity;
+
+	Rectify(gravityParameter, std::span<Perturber>(&perturber, 1), std::span<Integrator::Bodyd>(&perturbed, 1),
+		std::span<uint32_t const>(&notExcluded, 1), dT);
+
+	Vector3d rectifiedPosition, rectifiedVelocity;
+	perturbed.m_elements.ComputeKinetics(perturbed.m_elements.MeanToTrueAnomaly(perturbed.m_meanAnomaly), rectifiedPosition,
+		rectifiedVelocity);
+
+	testHandler.Assert((perturbed.m_positionDeviation == Vector3d::Zero()) && ((rectifiedPosition - perturbedPosition).SqareMagnitude() < 1e-20) &&
+		((rectifiedVelocity - perturbedVelocity).SqareMagnitude() < 1e-20), true, "Rectified conic passes through the perturbed state");
+}
+
+} // namespace Perturbation -------------------------------------------------------------------------------------------------------
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,457 @@
+#include "ReplayLog.h"
+
+#include "OrbitalSystem.h"
+#include "TestHandler.h"
+#include "Exception.h"
+
+#include <bit>
+
+namespace // detail
+{
+
+using namespace Neutron;
+
+constexpr size_t kMaxVarintSize = 10; // Bytes of a 64 bit value, at 7 bits per byte.
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+ReplayRecorder::ReplayRecorder(std::ostream & stream) :
+	m_stream(stream),
+	m_time(0),
+	m_eventCount(0)
+{
+	WriteValue(kMagic);
+	WriteValue(kVersion);
+
+	Flush();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ReplayRecorder::~ReplayRecorder()
+{
+	assert(m_pendingEvents.empty()); // Events recorded since the last flush are lost.
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ReplayRecorder::Record(ReplayEvent const& event)
+{
+	assert(event.m_type < ReplayEvent::Type::Count);
+
+	m_pendingEvents.push_back(event);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ReplayRecorder::Flush()
+{
+	// Events recorded at the same time keep their recorded order.
+	std::stable_sort(m_pendingEvents.begin(), m_pendingEvents.end(),
+		[](ReplayEvent const& lhs, ReplayEvent const& rhs) { return lhs.m_time.Get() < rhs.m_time.Get(); });
+
+	if (!m_pendingEvents.empty())
+	{
+		Time::Microseconds const firstTime = m_pendingEvents.front().m_time;
+
+		API_ASSERT_THROW(m_time.Get() <= firstTime.Get(), RESULT_CODE_INVALID_PARAMETER,
+			Fmt::Format("Event time ({}) precedes the last event written ({})", firstTime.Get(), m_time.Get()));
+	}
+
+	for (ReplayEvent const& event : m_pendingEvents)
+	{
+		// Gravity parameters change only when a space is rescaled, so most records omit theirs.
+		auto const [spaceIter, isNewSpace] = m_spaceIndices.try_emplace(event.m_spaceUuid.Get(), m_spaceIndices.size());
+		uint64_t const spaceIndex = spaceIter->second;
+
+		if (isNewSpace)
+			m_gravityParameters.push_back(event.m_gravityParameter);
+
+		bool const hasGravityParameter = isNewSpace || (m_gravityParameters[spaceIndex] != event.m_gravityParameter);
+		m_gravityParameters[spaceIndex] = event.m_gravityParameter;
+
+		WriteValue(static_cast<uint8_t>(static_cast<uint8_t>(event.m_type) | (hasGravityParameter ? kGravityParameterFlag : 0)));
+		WriteVarint(static_cast<uint64_t>(event.m_time.Get() - m_time.Get()));
+
+		// An index one past the end of a table introduces a new entry, whose UUID follows.
+		auto const [particleIter, isNewParticle] = m_particleIndices.try_emplace(event.m_particleUuid.Get(), m_particleIndices.size());
+
+		WriteVarint(particleIter->second);
+		if (isNewParticle)
+		{
+			WriteValue(event.m_particleUuid.Get());
+			WriteValue(event.m_mass);
+		}
+
+		WriteVarint(spaceIndex);
+		if (isNewSpace)
+			WriteValue(event.m_spaceUuid.Get());
+
+		if (hasGravityParameter)
+			WriteValue(event.m_gravityParameter);
+
+		WriteValue(event.m_position);
+		WriteValue(event.m_velocity);
+
+		m_time = event.m_time;
+	}
+
+	m_eventCount += m_pendingEvents.size();
+	m_pendingEvents.clear();
+
+	m_stream.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+	m_stream.flush(); // Events written before a crash are kept.
+	m_buffer.clear();
+
+	API_ASSERT_THROW(m_stream.good(), RESULT_CODE_FAILURE, "Failed to write the replay log");
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ReplayRecorder::WriteVarint(uint64_t value)
+{
+	// Little-endian base 128: 7 bits per byte, with the high bit set on every byte but the last.
+	while (0x80 <= value)
+	{
+		m_buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+
+	m_buffer.push_back(static_cast<char>(value));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+void ReplayRecorder::WriteValue(T const& value)
+{
+	static_assert(std::endian::native == std::endian::little, "Replay logs are little-endian");
+	static_assert(std::is_standard_layout_v<T>);
+
+	m_buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ReplayReader::ReplayReader(std::istream & stream) :
+	m_stream(stream),
+	m_time(0)
+{
+	uint32_t magic = 0, version = 0;
+
+	API_ASSERT_THROW(ReadValue(magic) && (ReplayRecorder::kMagic == magic), RESULT_CODE_UNRECOGNIZED, "Not a replay log");
+	API_ASSERT_THROW(ReadValue(version) && (ReplayRecorder::kVersion == version), RESULT_CODE_UNRECOGNIZED,
+		Fmt::Format("Unsupported replay log version ({})", version));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool ReplayReader::Read(ReplayEvent & event)
+{
+	// Tables are only extended once a record is complete, so a torn record leaves the reader as it was.
+	uint8_t typeByte;
+	if (!ReadValue(typeByte))
+		return false;
+
+	uint8_t const type = typeByte & ReplayRecorder::kTypeMask;
+
+	API_ASSERT_THROW(type < static_cast<uint8_t>(ReplayEvent::Type::Count), RESULT_CODE_UNRECOGNIZED,
+		Fmt::Format("Unrecognized replay event type ({})", type));
+
+	uint64_t timeDelta, particleIndex, spaceIndex;
+	uint64_t particleUuid = 0, spaceUuid = 0;
+	float mass = 0.f;
+
+	if (!ReadVarint(timeDelta) || !ReadVarint(particleIndex))
+		return false;
+
+	bool const isNewParticle = (m_particleUuids.size() == particleIndex);
+
+	API_ASSERT_THROW(particleIndex <= m_particleUuids.size(), RESULT_CODE_UNRECOGNIZED, "Replay event particle index out of range");
+
+	if (isNewParticle && !(ReadValue(particleUuid) && ReadValue(mass)))
+		return false;
+
+	if (!ReadVarint(spaceIndex))
+		return false;
+
+	bool const isNewSpace = (m_spaceUuids.size() == spaceIndex);
+
+	API_ASSERT_THROW(spaceIndex <= m_spaceUuids.size(), RESULT_CODE_UNRECOGNIZED, "Replay event space index out of range");
+	API_ASSERT_THROW(!isNewSpace || (0 != (typeByte & ReplayRecorder::kGravityParameterFlag)), RESULT_CODE_UNRECOGNIZED,
+		"Replay event introduces a space without its gravity parameter");
+
+	if (isNewSpace && !ReadValue(spaceUuid))
+		return false;
+
+	float gravityParameter = isNewSpace ? 0.f : m_gravityParameters[spaceIndex];
+
+	if ((0 != (typeByte & ReplayRecorder::kGravityParameterFlag)) && !ReadValue(gravityParameter))
+		return false;
+
+	Vector3 position, velocity;
+	if (!ReadValue(position) || !ReadValue(velocity))
+		return false;
+
+	if (isNewParticle)
+	{
+		m_particleUuids.push_back(particleUuid);
+		m_particleMasses.push_back(mass);
+	}
+
+	if (isNewSpace)
+	{
+		m_spaceUuids.push_back(spaceUuid);
+		m_gravityParameters.push_back(gravityParameter);
+	}
+
+	m_gravityParameters[spaceIndex] = gravityParameter;
+	m_time += static_cast<int64_t>(timeDelta);
+
+	event.m_type = static_cast<ReplayEvent::Type>(type);
+	event.m_time = m_time;
+	event.m_particleUuid = Uuid(m_particleUuids[particleIndex]);
+	event.m_spaceUuid = Uuid(m_spaceUuids[spaceIndex]);
+	event.m_mass = m_particleMasses[particleIndex];
+	event.m_gravityParameter = gravityParameter;
+	event.m_position = position;
+	event.m_velocity = velocity;
+
+	return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool ReplayReader::ReadVarint(uint64_t & value)
+{
+	value = 0;
+
+	for (size_t index = 0; index < kMaxVarintSize; ++index)
+	{
+		uint8_t byte;
+		if (!ReadValue(byte))
+			return false;
+
+		value |= static_cast<uint64_t>(byte & 0x7F) << (7 * index);
+
+		if (0 == (byte & 0x80))
+			return true;
+	}
+
+	throw ApiException(RESULT_CODE_UNRECOGNIZED, "Replay log varint is too long");
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+bool ReplayReader::ReadValue(T & value)
+{
+	m_stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+
+	return (static_cast<std::streamsize>(sizeof(T)) == m_stream.gcount());
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ReplayPlayback::ReplayPlayback(std::istream & stream) :
+	m_reader(stream),
+	m_hasNextEvent(false),
+	m_time(0)
+{
+	m_hasNextEvent = m_reader.Read(m_nextEvent);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ReplayPlayback::AdvanceTo(Time::Microseconds time)
+{
+	API_ASSERT_THROW(m_time.Get() <= time.Get(), RESULT_CODE_INVALID_PARAMETER,
+		Fmt::Format("Playback time ({}) precedes the current playback time ({})", time.Get(), m_time.Get()));
+
+	while (m_hasNextEvent && (m_nextEvent.m_time.Get() <= time.Get()))
+	{
+		Apply(m_nextEvent);
+
+		m_hasNextEvent = m_reader.Read(m_nextEvent);
+	}
+
+	m_time = time;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ReplayPlayback::ParticleOrbit const* ReplayPlayback::FindParticle(Uuid const& particleUuid) const
+{
+	std::unordered_map<uint64_t, ParticleOrbit>::const_iterator const particleIter = m_particles.find(particleUuid.Get());
+
+	return (m_particles.end() == particleIter) ? nullptr : &particleIter->second;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool ReplayPlayback::ComputeKinetics(Uuid const& particleUuid, Vector3 & position, Vector3 & velocity) const
+{
+	ParticleOrbit const*const pParticle = FindParticle(particleUuid);
+
+	if (nullptr == pParticle)
+		return false;
+
+	Orbit::Elements const& elements = pParticle->m_elements;
+
+	elements.ComputeKinetics(elements.MeanToTrueAnomaly(elements.PropagateMeanAnomaly(pParticle->m_meanAnomaly, m_time - pParticle->m_time)),
+		position, velocity);
+
+	return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ReplayPlayback::Apply(ReplayEvent const& event)
+{
+	// Every event carries the particle's full state, so the orbit is recomputed from the event alone, as the system computed it.
+	ParticleOrbit & particle = m_particles[event.m_particleUuid.Get()];
+
+	particle.m_spaceUuid = event.m_spaceUuid;
+	particle.m_mass = event.m_mass;
+	particle.m_elements.Compute(event.m_gravityParameter, event.m_position, event.m_velocity);
+	particle.m_meanAnomaly = particle.m_elements.TrueToMeanAnomaly(particle.m_elements.ComputeTrueAnomaly(event.m_position));
+	particle.m_time = event.m_time;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ReplayLogTestScript::ReplayLogTestScript() :
+	ITestScript("ReplayLog")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ReplayLogTestScript::~ReplayLogTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ReplayLogTestScript::RunImpl(TestHandler & testHandler)
+{
+	static constexpr float hostMass = 1e30f, hostSpaceTrueRadius = 8e12f;
+	static constexpr int particleCount = 8;
+
+	// Nested host spaces, and eccentric particles whose periapses lie in the innermost space, so that every orbit crosses
+	// scaling space boundaries.
+	OrbitalSystem orbitalSystem(hostMass, hostSpaceTrueRadius);
+	ScalingSpace & hostSpace = orbitalSystem.GetHostSpace();
+
+	for (int index = 1; index <= 3; ++index)
+		orbitalSystem.CreateScalingSpace(hostSpaceTrueRadius / powf(2.f, static_cast<float>(index)));
+
+	std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+	ReplayRecorder recorder(stream);
+	orbitalSystem.SetReplayRecorder(&recorder);
+
+	std::vector<Particle *> particles;
+	for (int index = 0; index < particleCount; ++index)
+	{
+		float const speedFactor = 0.45f + (0.02f * static_cast<float>(index));
+
+		particles.push_back(&orbitalSystem.CreateParticle(1.f, { 0.75f, 0.f, 0.f },
+			{ 0.f, speedFactor * hostSpace.CircularOrbitSpeed(0.75f), 0.f }, hostSpace));
+	}
+
+	Time::Microseconds const timeStep = particles.back()->GetOrbit().GetCurrentSection().m_elements.m_period.Get() / 16;
+
+	// The state of every particle relative to its host space's primary, and its host space.
+	struct RecordedState
+	{
+		Vector3		m_position;
+		Vector3		m_velocity;
+		uint64_t	m_spaceUuid;
+	};
+
+	auto const recordStates = [&]()
+	{
+		orbitalSystem.Synchronize();
+
+		std::vector<RecordedState> states;
+		for (Particle * pParticle : particles)
+		{
+			ScalingSpace & scalingSpace = *pParticle->GetHostSpace();
+
+			states.push_back(RecordedState{ pParticle->GetState().m_localPosition - scalingSpace.GetPrimaryPosition(),
+				pParticle->GetState().m_localVelocity - scalingSpace.GetPrimaryVelocity(), scalingSpace.m_uuid.Get() });
+		}
+
+		return states;
+	};
+
+	for (int step = 0; step < 12; ++step)
+		orbitalSystem.OnUpdate(timeStep);
+
+	Time::Microseconds const midTime = orbitalSystem.GetTime();
+	std::vector<RecordedState> const midStates = recordStates();
+
+	orbitalSystem.ApplyImpulse(*particles.front(), { 0.f, 0.f, 0.1f * hostSpace.CircularOrbitSpeed(0.75f) });
+
+	for (int step = 0; step < 12; ++step)
+		orbitalSystem.OnUpdate(timeStep);
+
+	Time::Microseconds const endTime = orbitalSystem.GetTime();
+	std::vector<RecordedState> const endStates = recordStates();
+
+	orbitalSystem.SetReplayRecorder(nullptr);
+
+	std::string const log = stream.str();
+
+	testHandler.Assert(particleCount < recorder.GetEventCount(), true, "Transitions are recorded");
+	testHandler.Assert(log.size() < 8 + (recorder.GetEventCount() * 40), true, "Events are delta-compressed");
+
+	// Playback reproduces the system at any recorded time.
+	auto const matchesStates = [&](ReplayPlayback const& playback, std::vector<RecordedState> const& states)
+	{
+		bool isMatching = (particleCount == playback.GetParticleCount());
+
+		for (size_t index = 0; isMatching && (index < states.size()); ++index)
+		{
+			Vector3 position, velocity;
+
+			isMatching = playback.ComputeKinetics(particles[index]->m_uuid, position, velocity) &&
+				(playback.FindParticle(particles[index]->m_uuid)->m_spaceUuid.Get() == states[index].m_spaceUuid) &&
+				((position - states[index].m_position).SqareMagnitude() < 1e-8f) &&
+				((velocity - states[index].m_velocity).SqareMagnitude() < 1e-8f);
+		}
+
+		return isMatching;
+	};
+
+	{
+		std::istringstream logStream(log, std::ios::in | std::ios::binary);
+		ReplayPlayback playback(logStream);
+
+		playback.AdvanceTo(midTime);
+		testHandler.Assert(matchesStates(playback, midStates), true, "Playback matches the system before the impulse");
+
+		playback.AdvanceTo(endTime);
+		testHandler.Assert(matchesStates(playback, endStates), true, "Playback matches the system after the impulse");
+	}
+
+	// A torn final record ends the log.
+	{
+		std::istringstream logStream(log.substr(0, log.size() - 1), std::ios::in | std::ios::binary);
+		ReplayReader reader(logStream);
+
+		uint64_t eventCount = 0;
+		for (ReplayEvent event; reader.Read(event);)
+			++eventCount;
+
+		testHandler.Assert(eventCount + 1, recorder.GetEventCount(), "Torn record is discarded");
+	}
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -1,17 +1,22 @@
 #include "ScaledSpaceBase.h"
 
 #include "ParticleBase.h"
+#include "OrbitalSystem2.h"
 
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
 ScaledSpaceBase::ScaledSpaceBase(ParticleBase * pHostParticle, float trueRadius) :
 	m_pHostParticle(pHostParticle),
-	m_pOuterSpace(nullptr),
-	m_pInnerSpace(nullptr),
+	m_spaceTree(pHostParticle->GetOrbitalSystem().GetScaledSpaceTree()),
+	m_treeIndex(ScaledSpaceTree::kInvalidIndex),
 	m_trueRadius(trueRadius),
 	m_radius(1.f),
-	m_gravityParameter(0.f)
+	m_gravityParameter(0.f),
+	m_updateTier(UpdateTier::EveryTick),
+	m_epoch(pHostParticle->GetOrbitalSystem().GetTime()),
+	m_perturbedParticleCount(0),
+	m_spatialIndexStoreGeneration(0)
 {
 	assert(nullptr != m_pHostParticle);
 	assert(0.f < m_trueRadius);
@@ -19,6 +24,15 @@ ScaledSpaceBase::ScaledSpaceBase(ParticleBase * pHostParticle, float trueRadius)
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
+ScaledSpaceBase::~ScaledSpaceBase()
+{
+	m_particles.clear(); // Stored particles remove themselves from the particle store, which is declared after the particle list.
+
+	m_spaceTree.Invalidate();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
 void ScaledSpaceBase::Initialize(float radius)
 {
 	m_radius = radius;
@@ -29,17 +43,60 @@ void ScaledSpaceBase::Initialize(float radius)
 
 void ScaledSpaceBase::SetRadius(float radius)
 {
-	API_ASSERT_THROW(nullptr != m_pOuterSpace, RESULT_CODE_INVALID_STATE, "Cannot set the relative radius of the host space");
+	ScaledSpaceBase const*const pOuterSpace = GetOuterSpace();
+
+	API_ASSERT_THROW(nullptr != pOuterSpace, RESULT_CODE_INVALID_STATE, "Cannot set the relative radius of the host space");
 
-	API_ASSERT_THROW(m_particles.empty() && (nullptr == m_pInnerSpace), RESULT_CODE_INVALID_STATE,
+	API_ASSERT_THROW(m_particles.empty() && (nullptr == GetInnerSpace()), RESULT_CODE_INVALID_STATE,
 		"Cannot resize a Scaled Space containing any smaller spaces or particles");
 
 	API_ASSERT_THROW((kMinimumScalingSpaceRadius <= radius) && (radius < kMaximumScalingSpaceRadius), RESULT_CODE_INVALID_PARAMETER,
 		Fmt::Format("Radius must be a value in the range [{}, {})", kMinimumScalingSpaceRadius, kMaximumScalingSpaceRadius));
 
-	m_trueRadius = m_pOuterSpace->m_trueRadius * radius;
+	m_trueRadius = pOuterSpace->m_trueRadius * radius;
+
+	m_spaceTree.Rebuild(); // The cumulative scale factors have changed.
 
 	Initialize(radius);
 }
 
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ScaledSpaceBase::EnableParticleStore()
+{
+	API_ASSERT_THROW(m_particles.empty(), RESULT_CODE_INVALID_STATE, "Cannot enable the particle store of a Scaled Space containing particles");
+
+	if (nullptr == m_pParticleStore)
+		m_pParticleStore = MakeUnique<ParticleStore>();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ScaledSpaceBase::EnableSpatialIndex(float cellSize)
+{
+	m_pSpatialIndex = MakeUnique<SpatialHashGrid<ParticleBase *>>(cellSize);
+
+	for (PoolPtr<ParticleBase> const& pParticle : m_particles)
+		m_pSpatialIndex->Insert(pParticle.get(), pParticle->GetPosition());
+
+	m_spatialIndexStoreGeneration = (nullptr == m_pParticleStore) ? 0 : m_pParticleStore->GetGeneration();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SpatialHashGrid<ParticleBase *> * ScaledSpaceBase::GetSpatialIndex()
+{
+	if ((nullptr != m_pSpatialIndex) && (nullptr != m_pParticleStore) && (m_pParticleStore->GetGeneration() != m_spatialIndexStoreGeneration))
+	{
+		// Stored particles are moved in bulk by the store, so the index is synchronized here rather than as each one moves. Only
+		// the particles which have changed cell are rehashed.
+		for (PoolPtr<ParticleBase> const& pParticle : m_particles)
+			m_pSpatialIndex->Update(pParticle.get(), pParticle->GetPosition());
+
+		m_spatialIndexStoreGeneration = m_pParticleStore->GetGeneration();
+	}
+
+	return m_pSpatialIndex.get();
+}
+
 } // namespace Neutron ------------------------------------------------------------------------------------------------------------
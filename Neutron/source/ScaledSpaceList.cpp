@@ -6,7 +6,7 @@
 namespace Neutron // --------------------------------------------------------------------------------------------------------------
 {
 
-bool ScaledSpaceListPredicate::operator()(UniquePtr<ScaledSpaceBase> const& lhs, UniquePtr<ScaledSpaceBase> const& rhs)
+bool ScaledSpaceListPredicate::operator()(PoolPtr<ScaledSpaceBase> const& lhs, PoolPtr<ScaledSpaceBase> const& rhs)
 {
 	return lhs->GetTrueRadius() > rhs->GetTrueRadius();
 }
@@ -14,32 +14,6 @@ bool ScaledSpaceListPredicate::operator()(UniquePtr<ScaledSpaceBase> const& lhs,
 // --------------------------------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------------------------------
 
-void ScaledSpaceList::InitializeInnerOuter(iterator newScaledSpaceIter)
-{
-	if (begin() != newScaledSpaceIter)
-	{
-		ScaledSpaceList::iterator outerScalingSpaceListIter = newScaledSpaceIter;
-		--outerScalingSpaceListIter;
-
-		(*newScaledSpaceIter)->m_pOuterSpace = outerScalingSpaceListIter->get();
-		(*outerScalingSpaceListIter)->m_pInnerSpace = newScaledSpaceIter->get();
-	}
-	else
-	{
-		(*newScaledSpaceIter)->m_pOuterSpace = (*newScaledSpaceIter)->m_pHostParticle->GetHostSpace(); // Note: equals nullptr if host particle is the system host.
-	}
-
-	ScaledSpaceList::iterator innerScalingSpaceListIter = newScaledSpaceIter;
-	++innerScalingSpaceListIter;
-	if (end() != innerScalingSpaceListIter)
-	{
-		(*newScaledSpaceIter)->m_pInnerSpace = innerScalingSpaceListIter->get();
-		(*innerScalingSpaceListIter)->m_pOuterSpace = newScaledSpaceIter->get();
-	}
-}
-
-// --------------------------------------------------------------------------------------------------------------------------------
-
 ScaledSpaceList::iterator ScaledSpaceList::FindSpaceOfInfluence()
 {
 	iterator spaceOfInfluenceIter = begin();
@@ -0,0 +1,310 @@
+#include "ScaledSpaceTree.h"
+
+#include "OrbitalSystem2.h"
+#include "ParticleBase.h"
+#include "ScaledSpaceBase.h"
+#include "TestHandler.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+ScaledSpaceTree::ScaledSpaceTree() :
+	m_pRootSpace(nullptr),
+	m_isValid(false)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ScaledSpaceTree::SetRoot(ScaledSpaceBase * pRootSpace)
+{
+	m_pRootSpace = pRootSpace;
+
+	Rebuild();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ScaledSpaceTree::Rebuild()
+{
+	assert(nullptr != m_pRootSpace);
+
+	m_nodes.clear();
+
+	ScaledSpaceList const& rootSpaces = m_pRootSpace->GetHostParticle()->GetAttachedSpaces();
+	assert(&rootSpaces.Front() == m_pRootSpace);
+
+	Append(rootSpaces.cbegin(), rootSpaces.cend(), kInvalidIndex, 0);
+
+	m_origins.resize(m_nodes.size());
+
+	m_isValid = true;
+
+	RefreshOrigins();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ScaledSpaceTree::RefreshOrigins()
+{
+	assert(m_isValid);
+
+	// A parent always precedes its children, so one forward scan sees every parent's origin before its children's.
+	for (size_t index = 0; index < m_nodes.size(); ++index)
+	{
+		Node const& node = m_nodes[index];
+		Origin & origin = m_origins[index];
+
+		if (kInvalidIndex == node.m_parentIndex)
+		{
+			origin = Origin{ Vector3d::Zero(), Vector3d::Zero() };
+			continue;
+		}
+
+		Node const& parentNode = m_nodes[node.m_parentIndex];
+		origin = m_origins[node.m_parentIndex];
+
+		// An inner space shares the origin of its outer space. Otherwise the parent is the host particle's space.
+		ParticleBase const& hostParticle = *node.m_pSpace->m_pHostParticle;
+		if (parentNode.m_pSpace->m_pHostParticle != &hostParticle)
+		{
+			double const parentScaleToRoot = parentNode.m_scaleToRoot;
+
+			origin.m_position += Vector3d(hostParticle.GetPosition()) * parentScaleToRoot;
+			origin.m_velocity += Vector3d(hostParticle.GetVelocity()) * parentScaleToRoot;
+		}
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceTree::Node const& ScaledSpaceTree::GetNode(ScaledSpaceBase const& space) const
+{
+	assert((space.m_treeIndex < m_nodes.size()) && (&space == m_nodes[space.m_treeIndex].m_pSpace));
+
+	return m_nodes[space.m_treeIndex];
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceBase * ScaledSpaceTree::GetOuterSpace(ScaledSpaceBase const& space) const
+{
+	uint32_t const parentIndex = GetNode(space).m_parentIndex;
+
+	return (kInvalidIndex == parentIndex) ? nullptr : m_nodes[parentIndex].m_pSpace;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceBase * ScaledSpaceTree::GetInnerSpace(ScaledSpaceBase const& space) const
+{
+	uint32_t const firstChildIndex = GetNode(space).m_firstChildIndex;
+
+	// The inner space, if any, is always the first child. Other children are attached to particles in the space.
+	if ((kInvalidIndex == firstChildIndex) || (m_nodes[firstChildIndex].m_pSpace->m_pHostParticle != space.m_pHostParticle))
+		return nullptr;
+
+	return m_nodes[firstChildIndex].m_pSpace;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ParticleBase * ScaledSpaceTree::GetPrimary(ScaledSpaceBase const& space) const
+{
+	return GetNode(space).m_pPrimary;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+float ScaledSpaceTree::GetScale(ScaledSpaceBase const& fromSpace, ScaledSpaceBase const& toSpace) const
+{
+	Node const& fromNode = GetNode(fromSpace);
+	Node const& toNode = GetNode(toSpace);
+
+	return fromNode.m_scaleToRoot * toNode.m_scaleFromRoot;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Vector3 ScaledSpaceTree::TransformPosition(Vector3 const& position, ScaledSpaceBase const& fromSpace, ScaledSpaceBase const& toSpace) const
+{
+	if (&fromSpace == &toSpace)
+		return position;
+
+	Node const& fromNode = GetNode(fromSpace);
+	Node const& toNode = GetNode(toSpace);
+
+	// Accumulate in double precision, since the origins of deep spaces are tiny relative to the root.
+	Vector3d const rootPosition = m_origins[fromSpace.m_treeIndex].m_position +
+		Vector3d(position) * static_cast<double>(fromNode.m_scaleToRoot);
+
+	return Vector3((rootPosition - m_origins[toSpace.m_treeIndex].m_position) * static_cast<double>(toNode.m_scaleFromRoot));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Vector3 ScaledSpaceTree::TransformVelocity(Vector3 const& velocity, ScaledSpaceBase const& fromSpace, ScaledSpaceBase const& toSpace) const
+{
+	if (&fromSpace == &toSpace)
+		return velocity;
+
+	Node const& fromNode = GetNode(fromSpace);
+	Node const& toNode = GetNode(toSpace);
+
+	Vector3d const rootVelocity = m_origins[fromSpace.m_treeIndex].m_velocity +
+		Vector3d(velocity) * static_cast<double>(fromNode.m_scaleToRoot);
+
+	return Vector3((rootVelocity - m_origins[toSpace.m_treeIndex].m_velocity) * static_cast<double>(toNode.m_scaleFromRoot));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t ScaledSpaceTree::Append(ScaledSpaceList::const_iterator spaceIter, ScaledSpaceList::const_iterator endIter,
+	uint32_t parentIndex, uint32_t depth)
+{
+	ScaledSpaceBase & space = **spaceIter;
+
+	uint32_t const index = static_cast<uint32_t>(m_nodes.size());
+
+	// An influencing space is centred on its primary. A non-influencing space has the primary of its outer space, which is either
+	// a larger non-influencing space on the same host, or the host particle's own host space.
+	ParticleBase * pPrimary = space.m_pHostParticle;
+	if (!space.IsInfluencing())
+	{
+		assert(kInvalidIndex != parentIndex); // The system host's spaces are all influencing.
+		pPrimary = m_nodes[parentIndex].m_pPrimary;
+	}
+
+	float const scaleToRoot = (kInvalidIndex == parentIndex) ? 1.f : (space.m_trueRadius / m_pRootSpace->m_trueRadius);
+	float const scaleFromRoot = (kInvalidIndex == parentIndex) ? 1.f : (m_pRootSpace->m_trueRadius / space.m_trueRadius);
+
+	m_nodes.push_back(Node{ &space, pPrimary, parentIndex, kInvalidIndex, kInvalidIndex, kInvalidIndex, depth, scaleToRoot,
+		scaleFromRoot });
+
+	space.m_treeIndex = index;
+
+	uint32_t previousChildIndex = kInvalidIndex;
+
+	auto appendChild = [&](ScaledSpaceList::const_iterator childIter, ScaledSpaceList::const_iterator childEndIter)
+	{
+		uint32_t const childIndex = Append(childIter, childEndIter, index, depth + 1);
+
+		if (kInvalidIndex == previousChildIndex)
+			m_nodes[index].m_firstChildIndex = childIndex;
+		else
+			m_nodes[previousChildIndex].m_nextSiblingIndex = childIndex;
+
+		previousChildIndex = childIndex;
+	};
+
+	ScaledSpaceList::const_iterator innerIter = spaceIter;
+	if (endIter != ++innerIter)
+		appendChild(innerIter, endIter);
+
+	for (ParticleBase * pHostParticle : space.m_hostParticles)
+	{
+		ScaledSpaceList const& attachedSpaces = pHostParticle->GetAttachedSpaces();
+		appendChild(attachedSpaces.cbegin(), attachedSpaces.cend());
+	}
+
+	m_nodes[index].m_subtreeEndIndex = static_cast<uint32_t>(m_nodes.size());
+
+	return index;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceTreeTestScript::ScaledSpaceTreeTestScript() :
+	ITestScript("ScaledSpaceTree")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ScaledSpaceTreeTestScript::~ScaledSpaceTreeTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ScaledSpaceTreeTestScript::RunImpl(TestHandler & testHandler)
+{
+	static constexpr float HOST_MASS = 1e30f;
+	static constexpr float HOST_SPACE_RADIUS = 8e12f;
+
+	OrbitalSystem2 orbitalSystem(HOST_MASS, HOST_SPACE_RADIUS);
+
+	ScaledSpaceBase & hostSpace = *orbitalSystem.GetHostSpace();
+	ScaledSpaceBase & innerHostSpace = *orbitalSystem.CreateScaledSpace(*orbitalSystem.GetHostParticle(), HOST_SPACE_RADIUS / 10.f);
+
+	ParticleBase & particle = *orbitalSystem.CreateParticle(hostSpace, 1e10f, Vector3(0.5f, 0.f, 0.f),
+		Vector3(0.f, hostSpace.CircularOrbitSpeed(0.5f), 0.f), false);
+
+	ScaledSpaceBase & particleSpace = *orbitalSystem.CreateScaledSpace(particle, HOST_SPACE_RADIUS * 0.05f);
+	ScaledSpaceBase & innerParticleSpace = *orbitalSystem.CreateScaledSpace(particle, HOST_SPACE_RADIUS * 0.005f);
+
+	ScaledSpaceTree & spaceTree = orbitalSystem.GetScaledSpaceTree();
+	std::span<ScaledSpaceTree::Node const> const nodes = spaceTree.GetNodes();
+
+	// Depth-first order: the inner space is the first child, then the spaces attached to particles in the space.
+	testHandler.Assert(nodes.size(), 4ull, "Node count");
+	testHandler.Assert(nodes[0].m_pSpace->m_uuid, hostSpace.m_uuid, "Root node");
+	testHandler.Assert(nodes[1].m_pSpace->m_uuid, innerHostSpace.m_uuid, "Inner space is the first child");
+	testHandler.Assert(nodes[2].m_pSpace->m_uuid, particleSpace.m_uuid, "Particle space follows the inner space's subtree");
+	testHandler.Assert(nodes[3].m_pSpace->m_uuid, innerParticleSpace.m_uuid, "Particle inner space");
+
+	testHandler.Assert(nodes[0].m_subtreeEndIndex, 4u, "Root subtree spans the tree");
+	testHandler.Assert(nodes[1].m_nextSiblingIndex, 2u, "Sibling link");
+	testHandler.Assert(nodes[3].m_parentIndex, 2u, "Parent link");
+	testHandler.Assert(nodes[3].m_depth, 2u, "Depth");
+	testHandler.Assert(nodes[3].m_scaleToRoot, innerParticleSpace.GetTrueRadius() / HOST_SPACE_RADIUS, "Cumulative scale to root");
+
+	testHandler.Assert(particleSpace.GetOuterSpace()->m_uuid, hostSpace.m_uuid, "Outer space from the tree");
+	testHandler.Assert(particleSpace.GetInnerSpace()->m_uuid, innerParticleSpace.m_uuid, "Inner space from the tree");
+	testHandler.Assert(reinterpret_cast<uintptr_t>(hostSpace.GetOuterSpace()), reinterpret_cast<uintptr_t>(nullptr), "Root has no outer space");
+	testHandler.Assert(innerParticleSpace.GetPrimary()->m_uuid, orbitalSystem.GetHostParticle()->m_uuid, "Primary from the tree");
+
+	// The host space's centre, seen from the particle's spaces, is at minus the particle's position, rescaled.
+	Vector3 const hostCentre = spaceTree.TransformPosition(Vector3::Zero(), hostSpace, particleSpace);
+	testHandler.Assert((hostCentre - Vector3(-10.f, 0.f, 0.f)).SqareMagnitude() < 1e-8f, true, "Position transformed into a particle space");
+
+	Vector3 const innerPosition(0.f, 0.5f, 0.f);
+	Vector3 const innerPositionInHostSpace = spaceTree.TransformPosition(innerPosition, innerParticleSpace, hostSpace);
+	testHandler.Assert((innerPositionInHostSpace - Vector3(0.5f, 0.0025f, 0.f)).SqareMagnitude() < 1e-12f, true,
+		"Position transformed out of a nested space");
+	testHandler.Assert((spaceTree.TransformPosition(innerPositionInHostSpace, hostSpace, innerParticleSpace) - innerPosition)
+		.SqareMagnitude() < 1e-8f, true, "Position transform round trip");
+
+	Vector3 const hostVelocity = spaceTree.TransformVelocity(Vector3::Zero(), hostSpace, particleSpace);
+	testHandler.Assert((hostVelocity + particle.GetVelocity() * 20.f).SqareMagnitude() < 1e-8f * hostVelocity.SqareMagnitude(), true,
+		"Velocity transformed into a particle space");
+	testHandler.Assert(fabsf(spaceTree.GetScale(innerParticleSpace, innerHostSpace) - 0.05f) < 1e-8f, true, "Scale between spaces");
+
+	// The origins are refreshed at the end of each tick, so transforms follow the particle as it moves.
+	orbitalSystem.OnUpdate(particle.GetElements()->m_period.Get() / 8);
+
+	Vector3 const movedHostCentre = static_cast<ScaledSpaceTree const&>(spaceTree).TransformPosition(Vector3::Zero(), hostSpace, particleSpace);
+	testHandler.Assert((movedHostCentre + particle.GetPosition() * 20.f).SqareMagnitude() < 1e-8f, true,
+		"Position transformed into the space of a moved particle");
+
+	// The tree is rebuilt as spaces are created, so queries, which never rebuild it, see the spaces of influence of a batch.
+	std::vector<OrbitalSystem2::ParticleDesc> descs;
+	for (float const distance : { 0.3f, 0.6f, 0.7f })
+		descs.push_back({ &hostSpace, 1e24f, Vector3(distance, 0.f, 0.f), Vector3(0.f, hostSpace.CircularOrbitSpeed(distance), 0.f), 0.5f < distance });
+
+	std::vector<ParticleBase *> particles;
+	orbitalSystem.CreateParticles(descs, particles);
+
+	ScaledSpaceTree const& constSpaceTree = spaceTree;
+	testHandler.Assert(constSpaceTree.GetNodes().size(), 6ull, "Node count after creating a batch with two spaces of influence");
+	testHandler.Assert(constSpaceTree.GetOuterSpace(*particles[2]->GetSpaceOfInfluence()) == &hostSpace, true,
+		"Space of influence created in a batch is in the tree");
+
+	// Destroying a particle removes its attached spaces from the tree.
+	orbitalSystem.DestroyParticle(&particle);
+
+	testHandler.Assert(spaceTree.GetNodes().size(), 4ull, "Node count after destroying the particle");
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -9,6 +9,8 @@ namespace Neutron // -----------------------------------------------------------
 ScalingSpace::ScalingSpace(Particle * pHost, float trueRadius) :
 	m_trueRadius(trueRadius),
 	m_radius(1.f),
+	m_scale(1.f),
+	m_scaleGeneration(0),
 	m_isInfluencing(true),
 	m_gravityParameter(0.f),
 	m_pPrimary(pHost),
@@ -30,55 +32,49 @@ void ScalingSpace::Initialize(float radius, bool isInfluencing)
 
 	m_gravityParameter = ComputeScaledGravityParameter(m_trueRadius, m_pPrimary->GetState().m_mass);
 
-	ComputePrimaryKinetics(this, m_primaryPosition, m_primaryVelocity);
+	ComputePrimaryKinetics(m_pHost->GetEpoch(), m_primaryPosition, m_primaryVelocity);
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
-void ScalingSpace::ComputePrimaryKinetics(ScalingSpace const* pScalingSpace, Vector3 & position, Vector3 & velocity)
+void ScalingSpace::ComputePrimaryKinetics(Time::Microseconds time, Vector3 & position, Vector3 & velocity) const
 {
-	assert(nullptr != pScalingSpace);
-	assert(0 < pScalingSpace->m_trueRadius);
-
-	position = 0.f;
-	velocity = 0.f;
-
-	float scaling = 1.f;
-
-	while ((nullptr != pScalingSpace) && !pScalingSpace->m_isInfluencing)
+	if (m_isInfluencing)
 	{
-		Particle * pHost = pScalingSpace->m_pHost;
-		assert(nullptr != pHost);
+		position = 0.f; // The primary hosts the space.
+		velocity = 0.f;
 
-		ScalingSpace const* pHostSpace = pHost->GetHostSpace();
-		assert(nullptr != pHostSpace); // nullptr would mean the host particle is the system host, but all scaling spaces on the system host should be influencing so this should never happen.
-		assert(0 < pHostSpace->m_trueRadius);
+		return;
+	}
 
-		scaling *= (pHostSpace->m_trueRadius / pScalingSpace->m_trueRadius);
+	ScalingSpace const* pHostSpace = m_pHost->GetHostSpace();
+	assert(nullptr != pHostSpace); // nullptr would mean the host particle is the system host, but all scaling spaces on the system host should be influencing so this should never happen.
+	assert(0 < m_trueRadius);
 
-		position -= pHost->GetState().m_localPosition * scaling;
-		velocity -= pHost->GetState().m_localVelocity * scaling;
+	float const scaling = -pHostSpace->m_trueRadius / m_trueRadius;
 
-		pScalingSpace = pHostSpace;
-	}
+	m_pHost->ComputeOrbitKinetics(time, position, velocity);
+
+	position *= scaling;
+	velocity *= scaling;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
 
 Particle * ScalingSpace::FindPrimary(ScalingSpace const* pScalingSpace)
 {
-	Particle * pHost;
+	// The primary hosts the nearest influencing space up the tree, at whose centre it lies.
 	do
 	{
-		pHost = pScalingSpace->m_pHost;
+		assert(nullptr != pScalingSpace->m_pHost);
 
-		assert(nullptr != pHost);
+		pScalingSpace = pScalingSpace->m_pHost->GetHostSpace();
 
-		pScalingSpace = pHost->GetHostSpace();
+		assert(nullptr != pScalingSpace); // All scaling spaces on the system host are influencing.
 	}
-	while ((nullptr != pScalingSpace) && !pScalingSpace->m_isInfluencing);
+	while (!pScalingSpace->m_isInfluencing);
 
-	return pHost;
+	return pScalingSpace->m_pHost;
 }
 
 // --------------------------------------------------------------------------------------------------------------------------------
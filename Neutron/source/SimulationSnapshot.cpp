@@ -0,0 +1,168 @@
+#include "SimulationSnapshot.h"
+
+#include "OrbitalSystem2.h"
+#include "TestHandler.h"
+
+#include <thread>
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+SnapshotBuffer::SnapshotBuffer() :
+	m_pPublished(nullptr)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SimulationSnapshot & SnapshotBuffer::BeginWrite()
+{
+	if (nullptr == m_pBack)
+	{
+		// The retired snapshot is no longer published, so no new reader can acquire it: once its count falls to our own
+		// reference it cannot rise again.
+		if ((nullptr != m_pRetired) && (1 == m_pRetired.use_count()))
+			m_pBack = std::move(m_pRetired);
+		else
+			m_pBack = MakeShared<SimulationSnapshot>();
+	}
+
+	return *m_pBack;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotBuffer::Publish()
+{
+	assert(nullptr != m_pBack); // BeginWrite must be called first.
+
+	m_pPublished.store(m_pBack, std::memory_order_release);
+
+	m_pRetired = std::move(m_pFront);
+	m_pFront = std::move(m_pBack);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SimulationSnapshotTestScript::SimulationSnapshotTestScript() :
+	ITestScript("SimulationSnapshot")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SimulationSnapshotTestScript::~SimulationSnapshotTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void SimulationSnapshotTestScript::RunImpl(TestHandler & testHandler)
+{
+	// Snapshots of an orbital system.
+	OrbitalSystem2 orbitalSystem(1e30f, 8e12f);
+	ScaledSpaceBase & hostSpace = *orbitalSystem.GetHostSpace();
+
+	testHandler.Assert(nullptr == orbitalSystem.AcquireSnapshot(), true, "No snapshot before the first publish");
+
+	Vector3 const position(0.5f, 0.f, 0.f);
+	Vector3 const velocity(0.f, hostSpace.CircularOrbitSpeed(0.5f), 0.f);
+
+	ParticleBase & particle = *orbitalSystem.CreateParticle(hostSpace, 1.f, position, velocity, false);
+	orbitalSystem.PublishSnapshot();
+
+	SnapshotBuffer::SnapshotPtr pFirst = orbitalSystem.AcquireSnapshot();
+
+	testHandler.Assert(pFirst->m_tick, 1ull, "First snapshot tick");
+	testHandler.Assert(pFirst->m_spaces.size(), 1ull, "First snapshot space count");
+	testHandler.Assert(pFirst->m_particles.size(), 1ull, "First snapshot particle count");
+	testHandler.Assert(pFirst->m_particles[0].m_uuid, particle.m_uuid, "Snapshot particle identity");
+	testHandler.Assert(pFirst->m_particles[0].m_position, position, "Snapshot particle position");
+	testHandler.Assert(pFirst->m_particles[0].m_elements.m_period.Get(),
+		particle.GetElements()->m_period.Get(), "Snapshot particle elements");
+
+	// Evaluated half a period after the snapshot, the circular orbiter is opposite its snapshot position.
+	Vector3 halfPeriodPosition, halfPeriodVelocity;
+	pFirst->ComputeKinetics(0, pFirst->m_particles[0].m_elements.m_period.Get() / 2, halfPeriodPosition, halfPeriodVelocity);
+
+	testHandler.Assert((halfPeriodPosition + position).SqareMagnitude() < 1e-8f, true, "Snapshot particle evaluated after the snapshot time");
+
+	// A held snapshot is unaffected by later ticks, and is not recycled while held.
+	orbitalSystem.CreateParticle(hostSpace, 1.f, position * -1.f, velocity * -1.f, false);
+	orbitalSystem.PublishSnapshot();
+	orbitalSystem.PublishSnapshot();
+
+	SnapshotBuffer::SnapshotPtr pThird = orbitalSystem.AcquireSnapshot();
+
+	testHandler.Assert(pFirst->m_particles.size(), 1ull, "Held snapshot is unchanged");
+	testHandler.Assert(pThird->m_tick, 3ull, "Third snapshot tick");
+	testHandler.Assert(pThird->m_particles.size(), 2ull, "Third snapshot particle count");
+	testHandler.Assert(pThird.get() != pFirst.get(), true, "Held snapshot is not recycled");
+
+	// Once released, retired buffers are recycled rather than reallocated.
+	SimulationSnapshot const*const pThirdBuffer = pThird.get();
+	pFirst.reset();
+	pThird.reset();
+
+	orbitalSystem.PublishSnapshot();
+	orbitalSystem.PublishSnapshot();
+
+	testHandler.Assert(orbitalSystem.AcquireSnapshot().get() == pThirdBuffer, true, "Released snapshot is recycled");
+
+	// Concurrent readers always see a whole tick.
+	constexpr uint64_t kTickCount = 2000;
+	constexpr size_t kParticleCount = 64;
+
+	SnapshotBuffer snapshotBuffer;
+	std::atomic<bool> isTorn = false;
+	std::atomic<bool> isDone = false;
+
+	auto read = [&]()
+	{
+		uint64_t lastTick = 0;
+
+		while (!isDone.load())
+		{
+			SnapshotBuffer::SnapshotPtr pSnapshot = snapshotBuffer.Acquire();
+
+			if (nullptr == pSnapshot)
+				continue;
+
+			bool isConsistent = (lastTick <= pSnapshot->m_tick) && (kParticleCount == pSnapshot->m_particles.size());
+
+			for (SimulationSnapshot::ParticleState const& state : pSnapshot->m_particles)
+				isConsistent = isConsistent && (static_cast<float>(pSnapshot->m_tick) == state.m_position.X());
+
+			if (!isConsistent)
+				isTorn = true;
+
+			lastTick = pSnapshot->m_tick;
+		}
+	};
+
+	std::thread reader1(read);
+	std::thread reader2(read);
+
+	for (uint64_t tick = 1; tick <= kTickCount; ++tick)
+	{
+		SimulationSnapshot & snapshot = snapshotBuffer.BeginWrite();
+
+		snapshot.m_tick = tick;
+		snapshot.m_particles.resize(kParticleCount);
+
+		for (SimulationSnapshot::ParticleState & state : snapshot.m_particles)
+			state.m_position = Vector3(static_cast<float>(tick), 0.f, 0.f);
+
+		snapshotBuffer.Publish();
+	}
+
+	isDone = true;
+	reader1.join();
+	reader2.join();
+
+	testHandler.Assert(isTorn.load(), false, "Concurrent readers see consistent snapshots");
+	testHandler.Assert(snapshotBuffer.Acquire()->m_tick, kTickCount, "Last published tick");
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,403 @@
+#include "SnapshotFile.h"
+
+#include "OrbitalSystem2.h"
+#include "TestHandler.h"
+#include "Exception.h"
+
+namespace // detail
+{
+
+using namespace Neutron;
+
+constexpr size_t kWriteChunkSize = 4096; // Records gathered from the snapshot per write.
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t AlignSection(uint64_t offset)
+{
+	return (offset + SnapshotFile::kSectionAlignment - 1) & ~static_cast<uint64_t>(SnapshotFile::kSectionAlignment - 1);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void WriteBytes(std::ofstream & stream, void const* pData, size_t size)
+{
+	stream.write(static_cast<char const*>(pData), static_cast<std::streamsize>(size));
+
+	API_ASSERT_THROW(stream.good(), RESULT_CODE_FAILURE, "Failed to write the snapshot file");
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <returns>
+/// A particle's position and velocity at the snapshot time: as recorded, or propagated from its space's epoch if the space lags
+/// in a lower update tier. The file has no epochs, so it holds every particle at the snapshot time.
+/// </returns>
+std::pair<Vector3, Vector3> ComputeKinetics(SimulationSnapshot const& snapshot, size_t particleIndex)
+{
+	SimulationSnapshot::ParticleState const& particle = snapshot.m_particles[particleIndex];
+
+	if (snapshot.m_spaces[particle.m_spaceIndex].m_epoch == snapshot.m_time)
+		return { particle.m_position, particle.m_velocity };
+
+	std::pair<Vector3, Vector3> kinetics;
+	snapshot.ComputeKinetics(particleIndex, snapshot.m_time, kinetics.first, kinetics.second);
+
+	return kinetics;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Pad the file to a section's offset, and write its records, gathered in chunks from the snapshot. </summary>
+/// <param name="position"> The current file position, advanced past the section. </param>
+/// <param name="getRecord"> Returns the record at a given index. </param>
+template<typename T, typename TGetRecord>
+void WriteSection(std::ofstream & stream, uint64_t & position, uint64_t offset, size_t count, TGetRecord const& getRecord)
+{
+	static constexpr std::byte kPadding[SnapshotFile::kSectionAlignment] = {};
+
+	assert((position <= offset) && ((offset - position) < SnapshotFile::kSectionAlignment));
+	WriteBytes(stream, kPadding, offset - position);
+
+	std::vector<T> chunk;
+	chunk.reserve(std::min(count, kWriteChunkSize));
+
+	for (size_t begin = 0; begin < count; begin += kWriteChunkSize)
+	{
+		size_t const end = std::min(count, begin + kWriteChunkSize);
+
+		chunk.clear();
+
+		for (size_t index = begin; index < end; ++index)
+			chunk.push_back(getRecord(index));
+
+		WriteBytes(stream, chunk.data(), chunk.size() * sizeof(T));
+	}
+
+	position = offset + (count * sizeof(T));
+}
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+void SnapshotFile::Write(StringView filePath, SimulationSnapshot const& snapshot)
+{
+	using Particle = SimulationSnapshot::ParticleState;
+
+	std::vector<Particle> const& particles = snapshot.m_particles;
+
+	Header header = ComputeLayout(static_cast<uint32_t>(snapshot.m_spaces.size()), particles.size());
+	header.m_tick = snapshot.m_tick;
+	header.m_time = snapshot.m_time.Get();
+	header.m_hostMass = snapshot.m_hostMass;
+
+	auto const offset = [&](Section section) { return header.m_sectionOffsets[static_cast<size_t>(section)]; };
+
+	std::filesystem::path const path(filePath);
+	std::filesystem::path const temporaryPath = std::filesystem::path(path).concat(".tmp");
+
+	{
+		std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+		API_ASSERT_THROW(stream.is_open(), RESULT_CODE_FAILURE, Fmt::Format("Failed to open {} for writing", temporaryPath.string()));
+
+		WriteBytes(stream, &header, sizeof(Header));
+		uint64_t position = sizeof(Header);
+
+		WriteSection<SpaceRecord>(stream, position, offset(Section::Spaces), snapshot.m_spaces.size(), [&](size_t index)
+		{
+			SimulationSnapshot::SpaceState const& space = snapshot.m_spaces[index];
+
+			uint32_t const flags = (space.m_isInfluencing ? kSpaceInfluencing : 0) | (space.m_hasParticleStore ? kSpaceParticleStore : 0);
+
+			return SpaceRecord{ space.m_uuid.Get(), space.m_hostParticleUuid.Get(), space.m_parentIndex, space.m_firstParticle,
+				space.m_particleCount, flags, space.m_trueRadius, space.m_scaleToRoot, space.m_spatialIndexCellSize,
+				space.m_primaryPosition, space.m_primaryVelocity, 0 };
+		});
+
+		WriteSection<uint64_t>(stream, position, offset(Section::ParticleUuids), particles.size(),
+			[&](size_t index) { return particles[index].m_uuid.Get(); });
+
+		WriteSection<uint8_t>(stream, position, offset(Section::ParticleFlags), particles.size(), [&](size_t index)
+		{
+			return static_cast<uint8_t>((particles[index].m_isInfluencing ? kParticleInfluencing : 0) |
+				(particles[index].m_hasOrbit ? kParticleHasOrbit : 0));
+		});
+
+		WriteSection<float>(stream, position, offset(Section::ParticleMasses), particles.size(),
+			[&](size_t index) { return particles[index].m_mass; });
+		WriteSection<Vector3>(stream, position, offset(Section::ParticlePositions), particles.size(),
+			[&](size_t index) { return ComputeKinetics(snapshot, index).first; });
+		WriteSection<Vector3>(stream, position, offset(Section::ParticleVelocities), particles.size(),
+			[&](size_t index) { return ComputeKinetics(snapshot, index).second; });
+		WriteSection<double>(stream, position, offset(Section::ParticleMeanAnomalies), particles.size(), [&](size_t index)
+		{
+			Particle const& particle = particles[index];
+			Time::Microseconds const epoch = snapshot.m_spaces[particle.m_spaceIndex].m_epoch;
+
+			return particle.m_hasOrbit ? particle.m_elements.PropagateMeanAnomaly(particle.m_meanAnomaly, snapshot.m_time - epoch) :
+				particle.m_meanAnomaly;
+		});
+		WriteSection<Orbit::Elements>(stream, position, offset(Section::ParticleElements), particles.size(),
+			[&](size_t index) { return particles[index].m_elements; });
+
+		assert(position == header.m_fileSize);
+
+		stream.close();
+		API_ASSERT_THROW(!stream.fail(), RESULT_CODE_FAILURE, Fmt::Format("Failed to write {}", temporaryPath.string()));
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryPath, path, errorCode);
+
+	API_ASSERT_THROW(!errorCode, RESULT_CODE_FAILURE, Fmt::Format("Failed to replace {}: {}", filePath, errorCode.message()));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SnapshotFile::SnapshotFile(StringView filePath) :
+	m_pHeader(nullptr)
+{
+	API_ASSERT_THROW(RESULT_CODE_SUCCESS == m_file.Open(filePath), RESULT_CODE_FAILURE, Fmt::Format("Failed to map {}", filePath));
+
+	std::span<std::byte const> const data = m_file.GetData();
+	API_ASSERT_THROW(sizeof(Header) <= data.size(), RESULT_CODE_UNRECOGNIZED, "Snapshot file is truncated");
+
+	m_pHeader = reinterpret_cast<Header const*>(data.data()); // Mappings are page aligned.
+	Header const& header = *m_pHeader;
+
+	API_ASSERT_THROW(kMagic == header.m_magic, RESULT_CODE_UNRECOGNIZED, "Not a snapshot file");
+	API_ASSERT_THROW(kVersion == header.m_version, RESULT_CODE_UNRECOGNIZED,
+		Fmt::Format("Snapshot file version {} is not supported", header.m_version));
+	API_ASSERT_THROW((sizeof(Header) == header.m_headerSize) && (sizeof(SpaceRecord) == header.m_spaceRecordSize) &&
+		(sizeof(Orbit::Elements) == header.m_elementsSize), RESULT_CODE_UNRECOGNIZED, "Snapshot file record layout does not match this build");
+	API_ASSERT_THROW((0 < header.m_spaceCount) && (header.m_particleCount <= data.size()), RESULT_CODE_UNRECOGNIZED,
+		"Snapshot file counts are invalid");
+
+	// The layout is a function of the counts alone, so sections laid out as expected, in a file of the expected size, are in bounds.
+	Header const layout = ComputeLayout(header.m_spaceCount, header.m_particleCount);
+
+	API_ASSERT_THROW(std::equal(std::begin(layout.m_sectionOffsets), std::end(layout.m_sectionOffsets), std::begin(header.m_sectionOffsets)) &&
+		(layout.m_fileSize == header.m_fileSize) && (header.m_fileSize == data.size()), RESULT_CODE_UNRECOGNIZED,
+		"Snapshot file sections do not match its counts");
+
+	// The particles of each space follow those of the space before it, and each space follows its outer space.
+	uint64_t particleCount = 0;
+	std::span<SpaceRecord const> const spaces = GetSpaces();
+
+	for (size_t index = 0; index < spaces.size(); ++index)
+	{
+		SpaceRecord const& space = spaces[index];
+
+		bool const isParentValid = (0 == index) ? (SimulationSnapshot::kInvalidIndex == space.m_parentIndex) : (space.m_parentIndex < index);
+
+		API_ASSERT_THROW(isParentValid && (particleCount == space.m_firstParticle), RESULT_CODE_UNRECOGNIZED,
+			Fmt::Format("Snapshot file space {} is invalid", index));
+
+		particleCount += space.m_particleCount;
+	}
+
+	API_ASSERT_THROW(particleCount == header.m_particleCount, RESULT_CODE_UNRECOGNIZED, "Snapshot file particle count is invalid");
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SnapshotFile::Header SnapshotFile::ComputeLayout(uint32_t spaceCount, uint64_t particleCount)
+{
+	static constexpr size_t kSectionRecordSizes[] =
+	{
+		sizeof(SpaceRecord),
+		sizeof(uint64_t),
+		sizeof(uint8_t),
+		sizeof(float),
+		sizeof(Vector3),
+		sizeof(Vector3),
+		sizeof(double),
+		sizeof(Orbit::Elements)
+	};
+
+	static_assert(std::size(kSectionRecordSizes) == static_cast<size_t>(Section::Count));
+
+	Header header = {};
+	header.m_magic = kMagic;
+	header.m_version = kVersion;
+	header.m_headerSize = sizeof(Header);
+	header.m_spaceRecordSize = sizeof(SpaceRecord);
+	header.m_elementsSize = sizeof(Orbit::Elements);
+	header.m_spaceCount = spaceCount;
+	header.m_particleCount = particleCount;
+
+	uint64_t offset = sizeof(Header);
+
+	for (size_t section = 0; section < static_cast<size_t>(Section::Count); ++section)
+	{
+		uint64_t const count = (static_cast<size_t>(Section::Spaces) == section) ? spaceCount : particleCount;
+
+		header.m_sectionOffsets[section] = AlignSection(offset);
+		offset = header.m_sectionOffsets[section] + (count * kSectionRecordSizes[section]);
+	}
+
+	header.m_fileSize = offset;
+
+	return header;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SnapshotFileTestScript::SnapshotFileTestScript() :
+	ITestScript("SnapshotFile")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SnapshotFileTestScript::~SnapshotFileTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void SnapshotFileTestScript::RunImpl(TestHandler & testHandler)
+{
+	static constexpr float HOST_MASS = 1e30f;
+	static constexpr float HOST_SPACE_RADIUS = 8e12f;
+
+	// A system with an inner host space holding a particle store, a particle with an attached space, an influencing particle and
+	// a spatial index.
+	OrbitalSystem2 orbitalSystem(HOST_MASS, HOST_SPACE_RADIUS);
+	ScaledSpaceBase & hostSpace = *orbitalSystem.GetHostSpace();
+	ScaledSpaceBase & innerHostSpace = *orbitalSystem.CreateScaledSpace(*orbitalSystem.GetHostParticle(), HOST_SPACE_RADIUS / 10.f);
+
+	hostSpace.EnableSpatialIndex(0.1f);
+	innerHostSpace.EnableParticleStore();
+
+	auto const circularVelocity = [](ScaledSpaceBase & space, float radius) { return Vector3(0.f, space.CircularOrbitSpeed(radius), 0.f); };
+
+	ParticleBase & particle = *orbitalSystem.CreateParticle(hostSpace, 1e10f, Vector3(0.5f, 0.f, 0.f),
+		circularVelocity(hostSpace, 0.5f), false);
+	ParticleBase & planet = *orbitalSystem.CreateParticle(hostSpace, 1e27f, Vector3(0.f, -0.7f, 0.f),
+		Vector3(hostSpace.CircularOrbitSpeed(0.7f), 0.f, 0.f), true);
+	ScaledSpaceBase & particleSpace = *orbitalSystem.CreateScaledSpace(particle, HOST_SPACE_RADIUS * 0.05f);
+
+	for (int index = 0; index < 5; ++index)
+	{
+		float const radius = 0.3f + (0.1f * static_cast<float>(index));
+
+		orbitalSystem.CreateParticle(innerHostSpace, 1.f, Vector3(radius, 0.f, 0.f), circularVelocity(innerHostSpace, radius), false);
+		orbitalSystem.CreateParticle(*planet.GetSpaceOfInfluence(), 1.f, Vector3(0.f, radius, 0.f),
+			Vector3(-planet.GetSpaceOfInfluence()->CircularOrbitSpeed(radius), 0.f, 0.f), false);
+	}
+
+	orbitalSystem.CreateParticle(particleSpace, 1.f, Vector3(0.2f, 0.f, 0.f), Vector3(0.f, 0.5f, 0.f), false);
+	orbitalSystem.OnUpdate(Time::Microseconds(12345));
+	orbitalSystem.PublishSnapshot();
+
+	SnapshotBuffer::SnapshotPtr const pSnapshot = orbitalSystem.AcquireSnapshot();
+
+	// Written and mapped, the particle arrays match the snapshot in place.
+	std::filesystem::path const path = std::filesystem::temp_directory_path() / "NeutronSnapshotFileTest.nsnp";
+	String const filePath(path.string());
+	SnapshotFile::Write(filePath, *pSnapshot);
+
+	{
+		SnapshotFile const file(filePath);
+
+		testHandler.Assert(file.GetTick(), pSnapshot->m_tick, "File tick");
+		testHandler.Assert(file.GetTime() == pSnapshot->m_time, true, "File time");
+		testHandler.Assert(file.GetHostMass(), HOST_MASS, "File host mass");
+		testHandler.Assert(file.GetSpaces().size(), pSnapshot->m_spaces.size(), "File space count");
+		testHandler.Assert(file.GetParticleUuids().size(), pSnapshot->m_particles.size(), "File particle count");
+		testHandler.Assert(reinterpret_cast<uintptr_t>(file.GetParticleElements().data()) % SnapshotFile::kSectionAlignment, 0ull,
+			"File sections are aligned");
+
+		bool isMatching = true;
+
+		for (size_t index = 0; index < pSnapshot->m_particles.size(); ++index)
+		{
+			SimulationSnapshot::ParticleState const& state = pSnapshot->m_particles[index];
+
+			isMatching = isMatching && (file.GetParticleUuids()[index] == state.m_uuid.Get()) &&
+				(file.GetParticlePositions()[index] == state.m_position) && (file.GetParticleVelocities()[index] == state.m_velocity) &&
+				(file.GetParticleMeanAnomalies()[index] == state.m_meanAnomaly) &&
+				(!state.m_hasOrbit || (file.GetParticleElements()[index].m_period == state.m_elements.m_period));
+		}
+
+		testHandler.Assert(isMatching, true, "File particle arrays match the snapshot");
+
+		// Restored, the system has the same spaces and particles, with the same identities and states.
+		UniquePtr<OrbitalSystem2> const pRestored = OrbitalSystem2::Restore(file);
+		pRestored->PublishSnapshot();
+
+		SnapshotBuffer::SnapshotPtr const pRestoredSnapshot = pRestored->AcquireSnapshot();
+
+		testHandler.Assert(pRestoredSnapshot->m_tick, pSnapshot->m_tick + 1, "Restored system continues the file's ticks");
+		testHandler.Assert(pRestoredSnapshot->m_time == pSnapshot->m_time, true, "Restored system continues from the file's time");
+		testHandler.Assert(pRestoredSnapshot->m_spaces.size(), pSnapshot->m_spaces.size(), "Restored space count");
+		testHandler.Assert(pRestoredSnapshot->m_particles.size(), pSnapshot->m_particles.size(), "Restored particle count");
+		testHandler.Assert(pRestored->GetHostParticle()->m_uuid, orbitalSystem.GetHostParticle()->m_uuid, "Restored host particle identity");
+		testHandler.Assert(pRestored->GetHostSpace()->GetSpatialIndex()->Size(), hostSpace.GetSpatialIndex()->Size(), "Restored spatial index");
+		testHandler.Assert(pRestored->GetHostSpace()->GetInnerSpace()->GetParticleStore()->Size(), 5ull, "Restored particle store");
+
+		std::unordered_map<uint64_t, SimulationSnapshot::ParticleState const*> restoredParticles;
+		std::unordered_map<uint64_t, SimulationSnapshot::SpaceState const*> restoredSpaces;
+
+		for (SimulationSnapshot::ParticleState const& state : pRestoredSnapshot->m_particles)
+			restoredParticles.emplace(state.m_uuid.Get(), &state);
+
+		for (SimulationSnapshot::SpaceState const& space : pRestoredSnapshot->m_spaces)
+			restoredSpaces.emplace(space.m_uuid.Get(), &space);
+
+		bool isSpaceRestored = true;
+
+		for (SimulationSnapshot::SpaceState const& space : pSnapshot->m_spaces)
+		{
+			auto const iterator = restoredSpaces.find(space.m_uuid.Get());
+
+			isSpaceRestored = isSpaceRestored && (restoredSpaces.end() != iterator) &&
+				(iterator->second->m_hostParticleUuid == space.m_hostParticleUuid) && (iterator->second->m_trueRadius == space.m_trueRadius) &&
+				(iterator->second->m_isInfluencing == space.m_isInfluencing) && (iterator->second->m_particleCount == space.m_particleCount);
+		}
+
+		testHandler.Assert(isSpaceRestored, true, "Restored spaces match");
+
+		bool isParticleRestored = true;
+
+		for (SimulationSnapshot::ParticleState const& state : pSnapshot->m_particles)
+		{
+			auto const iterator = restoredParticles.find(state.m_uuid.Get());
+
+			isParticleRestored = isParticleRestored && (restoredParticles.end() != iterator) &&
+				(pRestoredSnapshot->m_spaces[iterator->second->m_spaceIndex].m_uuid == pSnapshot->m_spaces[state.m_spaceIndex].m_uuid) &&
+				(iterator->second->m_position == state.m_position) && (iterator->second->m_velocity == state.m_velocity) &&
+				(iterator->second->m_isInfluencing == state.m_isInfluencing) &&
+				(iterator->second->m_elements.m_period == state.m_elements.m_period);
+		}
+
+		testHandler.Assert(isParticleRestored, true, "Restored particles match");
+	}
+
+	// Files which are not snapshots for this build are rejected.
+	{
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		stream << "Not a snapshot file, but long enough to hold a snapshot header. Not a snapshot file, but long enough to hold a header.";
+	}
+
+	bool isException;
+
+	try
+	{
+		SnapshotFile const file(filePath);
+		isException = false;
+	}
+	catch (ApiException const&)
+	{
+		isException = true;
+	}
+	testHandler.Assert(isException, true, "Invalid file causes exception");
+
+	std::filesystem::remove(path);
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
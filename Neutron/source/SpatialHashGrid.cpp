@@ -0,0 +1,127 @@
+#include "SpatialHashGrid.h"
+
+#include "OrbitalSystem2.h"
+#include "TestHandler.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+SpatialHashGridTestScript::SpatialHashGridTestScript() :
+	ITestScript("SpatialHashGrid")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+SpatialHashGridTestScript::~SpatialHashGridTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void SpatialHashGridTestScript::RunImpl(TestHandler & testHandler)
+{
+	constexpr int kItemCount = 500;
+	constexpr float kDistance = 0.08f;
+
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+
+	SpatialHashGrid<int> grid(kDistance);
+	std::vector<Vector3> positions;
+
+	for (int item = 0; item < kItemCount; ++item)
+	{
+		positions.emplace_back(distribution(generator), distribution(generator), distribution(generator));
+		grid.Insert(item, positions.back());
+	}
+
+	// Move every other item, some across cells, and remove a few.
+	for (int item = 0; item < kItemCount; item += 2)
+	{
+		positions[item] += Vector3(0.5f * kDistance, 0.f, -2.f * kDistance);
+		grid.Update(item, positions[item]);
+	}
+
+	for (int item = 0; item < kItemCount; item += 50)
+		grid.Remove(item);
+
+	testHandler.Assert(grid.Size(), static_cast<size_t>(kItemCount - kItemCount / 50), "Item count");
+
+	auto isLive = [](int item) { return 0 != (item % 50); };
+
+	// Range query against brute force.
+	Vector3 const centre(0.1f, -0.2f, 0.3f);
+
+	std::vector<int> found;
+	grid.QueryRange(centre, 3.f * kDistance, found);
+	std::sort(found.begin(), found.end());
+
+	std::vector<int> expected;
+	for (int item = 0; item < kItemCount; ++item)
+	{
+		if (isLive(item) && ((positions[item] - centre).SqareMagnitude() <= 9.f * kDistance * kDistance))
+			expected.push_back(item);
+	}
+
+	testHandler.Assert(found == expected, true, "Range query matches brute force");
+
+	// Nearest query against brute force.
+	std::vector<int> byDistance;
+	for (int item = 0; item < kItemCount; ++item)
+	{
+		if (isLive(item))
+			byDistance.push_back(item);
+	}
+
+	std::sort(byDistance.begin(), byDistance.end(), [&](int lhs, int rhs)
+		{ return (positions[lhs] - centre).SqareMagnitude() < (positions[rhs] - centre).SqareMagnitude(); });
+	byDistance.resize(10);
+
+	grid.QueryNearest(centre, 10, found);
+
+	testHandler.Assert(found == byDistance, true, "Nearest query matches brute force");
+
+	grid.QueryNearest(Vector3(50.f, 50.f, 50.f), 3, found);
+
+	testHandler.Assert(found.size(), 3ull, "Nearest query far outside the occupied cells");
+
+	// Pair query against brute force.
+	std::vector<SpatialHashGrid<int>::ItemPair> pairs;
+	grid.QueryPairs(kDistance, pairs);
+
+	size_t expectedPairCount = 0;
+	for (int item = 0; item < kItemCount; ++item)
+	{
+		for (int other = item + 1; other < kItemCount; ++other)
+		{
+			if (isLive(item) && isLive(other) && ((positions[item] - positions[other]).SqareMagnitude() <= kDistance * kDistance))
+				++expectedPairCount;
+		}
+	}
+
+	testHandler.Assert(pairs.size(), expectedPairCount, "Pair query matches brute force");
+
+	// The index of a scaled space follows its particles.
+	OrbitalSystem2 orbitalSystem(1e30f, 8e12f);
+	ScaledSpaceBase & hostSpace = *orbitalSystem.GetHostSpace();
+
+	hostSpace.EnableSpatialIndex(0.05f);
+
+	ParticleBase * pNear = orbitalSystem.CreateParticle(hostSpace, 1.f, Vector3(0.5f, 0.f, 0.f),
+		Vector3(0.f, hostSpace.CircularOrbitSpeed(0.5f), 0.f), false);
+	ParticleBase * pFar = orbitalSystem.CreateParticle(hostSpace, 1.f, Vector3(-0.5f, 0.f, 0.f),
+		Vector3(0.f, -hostSpace.CircularOrbitSpeed(0.5f), 0.f), false);
+
+	std::vector<ParticleBase *> foundParticles;
+	hostSpace.GetSpatialIndex()->QueryRange(Vector3(0.45f, 0.f, 0.f), 0.1f, foundParticles);
+
+	testHandler.Assert(foundParticles.size() == 1 && foundParticles[0] == pNear, true, "Space index range query");
+
+	orbitalSystem.DestroyParticle(pNear);
+
+	testHandler.Assert(hostSpace.GetSpatialIndex()->Size(), 1ull, "Space index after destroying a particle");
+	testHandler.Assert(hostSpace.GetSpatialIndex()->Contains(pFar), true, "Space index keeps the remaining particle");
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,235 @@
+#include "TaskPool.h"
+
+#include "TestHandler.h"
+
+namespace // detail
+{
+
+thread_local Neutron::TaskPool const*	s_pWorkerPool = nullptr;	// The pool which owns the calling thread, if it is a worker.
+thread_local size_t						s_workerQueueIndex = 0;		// The calling worker's queue index in its pool.
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+TaskPool::TaskPool(size_t threadCount) :
+	m_queuedCount(0),
+	m_isStopping(false)
+{
+	threadCount = std::max<size_t>(1, threadCount);
+
+	for (size_t i = 0; i <= threadCount; ++i)
+		m_queues.push_back(MakeUnique<TaskQueue>());
+
+	for (size_t i = 0; i < threadCount; ++i)
+		m_threads.emplace_back([this, i]() { WorkerMain(i); });
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_isStopping = true;
+	}
+
+	m_wakeCondition.notify_all();
+
+	for (std::thread & thread : m_threads)
+		thread.join();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void TaskPool::Submit(TaskGroup & taskGroup, Task task)
+{
+	taskGroup.m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	TaskQueue & taskQueue = *m_queues[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(taskQueue.m_mutex);
+		taskQueue.m_tasks.push_back(QueuedTask{ std::move(task), &taskGroup });
+	}
+
+	m_queuedCount.fetch_add(1, std::memory_order_release);
+
+	// Take the wake mutex so that a worker cannot miss the notification between checking the queued count and waiting.
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+	}
+
+	m_wakeCondition.notify_one();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void TaskPool::Wait(TaskGroup & taskGroup)
+{
+	size_t const queueIndex = GetQueueIndex();
+
+	while (0 != taskGroup.m_pendingCount.load(std::memory_order_acquire))
+	{
+		if (!TryExecute(queueIndex))
+			std::this_thread::yield();
+	}
+
+	if (taskGroup.m_pException)
+		std::rethrow_exception(std::exchange(taskGroup.m_pException, nullptr));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+size_t TaskPool::GetQueueIndex() const
+{
+	return (this == s_pWorkerPool) ? s_workerQueueIndex : m_threads.size();
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool TaskPool::TryAcquire(size_t queueIndex, QueuedTask & queuedTask)
+{
+	if (0 == m_queuedCount.load(std::memory_order_acquire))
+		return false;
+
+	// Own queue first, newest task.
+	{
+		TaskQueue & taskQueue = *m_queues[queueIndex];
+
+		std::lock_guard<std::mutex> lock(taskQueue.m_mutex);
+		if (!taskQueue.m_tasks.empty())
+		{
+			queuedTask = std::move(taskQueue.m_tasks.back());
+			taskQueue.m_tasks.pop_back();
+			m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+
+			return true;
+		}
+	}
+
+	// Steal the oldest task from the other queues, starting from the next queue to spread contention.
+	size_t const queueCount = m_queues.size();
+	for (size_t offset = 1; offset < queueCount; ++offset)
+	{
+		TaskQueue & taskQueue = *m_queues[(queueIndex + offset) % queueCount];
+
+		std::lock_guard<std::mutex> lock(taskQueue.m_mutex);
+		if (!taskQueue.m_tasks.empty())
+		{
+			queuedTask = std::move(taskQueue.m_tasks.front());
+			taskQueue.m_tasks.pop_front();
+			m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+bool TaskPool::TryExecute(size_t queueIndex)
+{
+	QueuedTask queuedTask;
+	if (!TryAcquire(queueIndex, queuedTask))
+		return false;
+
+	TaskGroup & taskGroup = *queuedTask.m_pTaskGroup;
+
+	try
+	{
+		queuedTask.m_task();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(taskGroup.m_exceptionMutex);
+		if (!taskGroup.m_pException)
+			taskGroup.m_pException = std::current_exception();
+	}
+
+	taskGroup.m_pendingCount.fetch_sub(1, std::memory_order_acq_rel);
+
+	return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void TaskPool::WorkerMain(size_t queueIndex)
+{
+	s_pWorkerPool = this;
+	s_workerQueueIndex = queueIndex;
+
+	for (;;)
+	{
+		if (TryExecute(queueIndex))
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+
+		m_wakeCondition.wait(lock, [this]() { return m_isStopping || (0 != m_queuedCount.load(std::memory_order_acquire)); });
+
+		if (m_isStopping)
+			return;
+	}
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+TaskPoolTestScript::TaskPoolTestScript() :
+	ITestScript("TaskPool")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+TaskPoolTestScript::~TaskPoolTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void TaskPoolTestScript::RunImpl(TestHandler & testHandler)
+{
+	TaskPool taskPool(4);
+
+	testHandler.Assert(taskPool.GetThreadCount(), 4ull, "Task pool thread count");
+
+	// Nested task groups: each task submits and waits on its own group from a worker thread.
+	std::vector<uint64_t> sums(16, 0);
+	taskPool.ParallelFor(sums.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t index = begin; index < end; ++index)
+		{
+			std::vector<uint64_t> values(1000);
+			taskPool.ParallelFor(values.size(), 64, [&](size_t valueBegin, size_t valueEnd)
+			{
+				for (size_t value = valueBegin; value < valueEnd; ++value)
+					values[value] = value * index;
+			});
+
+			sums[index] = std::accumulate(values.begin(), values.end(), uint64_t(0));
+		}
+	});
+
+	testHandler.Assert<uint64_t, size_t>([&](size_t index) { return sums[index]; }, TestHandler::FRangeIndex(),
+		[](size_t index) { return static_cast<uint64_t>(index * 999 * 1000 / 2); }, "Nested parallel for", { 0, 15 });
+
+	bool isRethrown = false;
+	try
+	{
+		TaskPool::TaskGroup taskGroup;
+		taskPool.Submit(taskGroup, []() { throw std::runtime_error("Task failure"); });
+		taskPool.Wait(taskGroup);
+	}
+	catch (std::runtime_error const&)
+	{
+		isRethrown = true;
+	}
+
+	testHandler.Assert(isRethrown, true, "Task exception is rethrown by Wait");
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,66 @@
+#include "Vector3Pack.h"
+
+#include "TestHandler.h"
+
+namespace Neutron // --------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Vector3PackTestScript::Vector3PackTestScript() :
+	ITestScript("Vector3Pack")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+Vector3PackTestScript::~Vector3PackTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void Vector3PackTestScript::RunImpl(TestHandler & testHandler)
+{
+	constexpr size_t kCount = 8;
+
+	Vector3 lhs[kCount], rhs[kCount];
+	for (size_t i = 0; i < kCount; ++i)
+	{
+		lhs[i] = Vector3(1.f + static_cast<float>(i), 0.5f * static_cast<float>(i), 1e-3f);
+		rhs[i] = Vector3(-0.25f * static_cast<float>(i), 1.f, 1e3f * static_cast<float>(i % 3));
+	}
+
+	// Every lane must match the scalar Vector3, whichever width is dispatched on this processor.
+	DispatchFloatPack([&]<size_t NWidth>()
+	{
+		using Vector3Pack = TVector3Pack<NWidth>;
+
+		testHandler.Assert<bool, size_t>([&](size_t index)
+		{
+			size_t const base = index - (index % NWidth);
+			size_t const lane = index % NWidth;
+
+			Vector3Pack const lhsPack = Vector3Pack::Load(&lhs[base]);
+			Vector3Pack const rhsPack = Vector3Pack::Load(&rhs[base]);
+
+			return (lhsPack.Dot(rhsPack)[lane] == lhs[index].Dot(rhs[index])) &&
+				(lhsPack.Cross(rhsPack).Get(lane) == lhs[index].Cross(rhs[index])) &&
+				(lhsPack.PreciseCross(rhsPack).Get(lane) == lhs[index].PreciseCross(rhs[index])) &&
+				(lhsPack.Normalized().Get(lane) == lhs[index].Normalized());
+
+		}, TestHandler::FRangeIndex(), [](size_t) { return true; }, Fmt::Format("Vector3Pack<{}> lanes equal Vector3", NWidth),
+			{ 0, kCount - 1 });
+	});
+
+	testHandler.Assert<bool, int>([](int)
+	{
+		TVector3Pack<1> const zero = TVector3Pack<1>::Zero();
+		return (0.f != zero.IsZero()[0]) && (zero.Normalized().Get(0) == Vector3::Zero());
+
+	}, 0, true, "Vector3Pack normalizing the zero vector leaves it unchanged");
+}
+
+} // namespace Neutron ------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,256 @@
+#ifndef NOVA_OBJECT_POOL_H
+#define NOVA_OBJECT_POOL_H
+
+#include "NebulaTypes.h"
+#include "HeapBlockList.h"
+#include "ITestScript.h"
+
+namespace Nova // -----------------------------------------------------------------------------------------------------------------
+{
+
+using namespace Nebula;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Type-erased interface through which pooled objects are returned to the pool which allocated them. </summary>
+class IObjectPool
+{
+public:
+	virtual ~IObjectPool() = default;
+
+	/// <summary> Return the storage of a destroyed object to the pool. </summary>
+	virtual void Free(void * pStorage) = 0;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary> Deleter for objects allocated from an object pool. Destroys the object and returns its storage to the pool. </summary>
+/// <typeparam name="T"> The pointer type, which may be a base of the pooled type if it has a virtual destructor. </typeparam>
+template<typename T>
+class PoolDeleter
+{
+	template<typename U>
+	friend class PoolDeleter;
+
+public:
+	PoolDeleter() = default;
+	explicit PoolDeleter(IObjectPool * pPool);
+
+	template<typename U> requires std::is_convertible_v<U *, T *>
+	PoolDeleter(PoolDeleter<U> const& rhs);
+
+	void operator()(T * pObject) const;
+
+private:
+	IObjectPool *	m_pPool = nullptr;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+using PoolPtr = std::unique_ptr<T, PoolDeleter<T>>;
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+/// <summary>
+/// Pool of fixed-size objects of type T. Objects are placed in chunks of slots held in a heap block list, so they never move,
+/// and freed slots are recycled through an intrusive free list. Allocation and release are O(1) except when a new chunk is
+/// added. Not thread safe. The pool must outlive every object allocated from it.
+/// </summary>
+template<typename T>
+class ObjectPool : public IObjectPool
+{
+	friend class ObjectPoolTestScript;
+
+public:
+	/// <param name="chunkCount"> The number of objects per chunk. </param>
+	explicit ObjectPool(size_t chunkCount = 64);
+	virtual ~ObjectPool() override;
+
+	ObjectPool(ObjectPool const&) = delete;
+	ObjectPool & operator=(ObjectPool const&) = delete;
+
+	/// <summary> Construct an object in a free slot. </summary>
+	template<typename... TArgs>
+	PoolPtr<T> Make(TArgs &&... args);
+
+	/// <returns> The number of live objects. </returns>
+	size_t Size() const;
+
+	/// <returns> The number of slots in all chunks. </returns>
+	size_t Capacity() const;
+
+	virtual void Free(void * pStorage) override;
+
+private:
+	union Slot
+	{
+		Slot *				m_pNextFree;
+		alignas(T) byte_t	m_storage[sizeof(T)];
+	};
+
+	/// <returns> Storage for one object, from the free list if possible, otherwise from the tail chunk. </returns>
+	void * Allocate();
+
+	HeapBlockList		m_chunks;				// The slot chunks. The tail is the chunk currently being filled.
+	size_t				m_chunkCount;			// The number of slots per chunk.
+	size_t				m_chunkUsedCount;		// The number of slots of the tail chunk which have been handed out.
+	size_t				m_capacity;				// The number of slots in all chunks.
+	size_t				m_size;					// The number of live objects.
+	Slot *				m_pFreeList;			// Head of the list of freed slots.
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline PoolDeleter<T>::PoolDeleter(IObjectPool * pPool) :
+	m_pPool(pPool)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+template<typename U> requires std::is_convertible_v<U *, T *>
+inline PoolDeleter<T>::PoolDeleter(PoolDeleter<U> const& rhs) :
+	m_pPool(rhs.m_pPool)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline void PoolDeleter<T>::operator()(T * pObject) const
+{
+	assert(nullptr != m_pPool);
+
+	// The most derived object, which is what the pool allocated, need not share the address of a base class subobject.
+	void * pStorage = nullptr;
+	if constexpr (std::is_polymorphic_v<T>)
+		pStorage = dynamic_cast<void *>(pObject);
+	else
+		pStorage = pObject;
+
+	pObject->~T();
+
+	m_pPool->Free(pStorage);
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline ObjectPool<T>::ObjectPool(size_t chunkCount) :
+	m_chunks(Footprint::Make<Slot>(chunkCount)),
+	m_chunkCount(chunkCount),
+	m_chunkUsedCount(0),
+	m_capacity(chunkCount),
+	m_size(0),
+	m_pFreeList(nullptr)
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline ObjectPool<T>::~ObjectPool()
+{
+	assert(0 == m_size); // Objects allocated from the pool must be destroyed before it.
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+template<typename... TArgs>
+inline PoolPtr<T> ObjectPool<T>::Make(TArgs &&... args)
+{
+	void * pStorage = Allocate();
+
+	T * pObject = nullptr;
+	try
+	{
+		pObject = new (pStorage) T(std::forward<TArgs>(args)...);
+	}
+	catch (...)
+	{
+		Free(pStorage);
+		throw;
+	}
+
+	return PoolPtr<T>(pObject, PoolDeleter<T>(this));
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline size_t ObjectPool<T>::Size() const
+{
+	return m_size;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline size_t ObjectPool<T>::Capacity() const
+{
+	return m_capacity;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline void ObjectPool<T>::Free(void * pStorage)
+{
+	assert(0 < m_size);
+
+	Slot * pSlot = static_cast<Slot *>(pStorage);
+	pSlot->m_pNextFree = m_pFreeList;
+	m_pFreeList = pSlot;
+
+	--m_size;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+template<typename T>
+inline void * ObjectPool<T>::Allocate()
+{
+	Slot * pSlot = m_pFreeList;
+
+	if (nullptr != pSlot)
+	{
+		m_pFreeList = pSlot->m_pNextFree;
+	}
+	else
+	{
+		if (m_chunkCount == m_chunkUsedCount)
+		{
+			m_chunks.Extend();
+			m_chunkUsedCount = 0;
+			m_capacity += m_chunkCount;
+		}
+
+		pSlot = m_chunks.GetTail()->template Get<Slot>(m_chunkUsedCount++);
+	}
+
+	++m_size;
+
+	return pSlot->m_storage;
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class ObjectPoolTestScript : public ITestScript
+{
+public:
+	ObjectPoolTestScript();
+	virtual ~ObjectPoolTestScript();
+
+protected:
+	virtual void RunImpl(TestHandler & testHandler) override;
+};
+
+} // namespace Nova ---------------------------------------------------------------------------------------------------------------
+
+#endif//NOVA_OBJECT_POOL_H
@@ -6,6 +6,7 @@
 #include "Footprint.h"
 #include "HeapBlock.h"
 #include "HeapBlockList.h"
+#include "ObjectPool.h"
 #include "PriorityQueue.h"
 #include "RedBlackTree.h"
 #include "SortedList.h"
@@ -20,6 +21,7 @@ void AddTests(Nebula::TestHandler & testHandler)
 	testHandler.Register(MakeShared<FootprintTestScript>(), "Nova");
 	testHandler.Register(MakeShared<HeapBlockTestScript>(), "Nova");
 	testHandler.Register(MakeShared<HeapBlockListTestScript>(), "Nova");
+	testHandler.Register(MakeShared<ObjectPoolTestScript>(), "Nova");
 	testHandler.Register(MakeShared<AnchoredListTestScript>(), "Nova");
 	testHandler.Register(MakeShared<PriorityQueueTestScript>(), "Nova");
 	testHandler.Register(MakeShared<SortedListTestScript>(), "Nova");
@@ -0,0 +1,79 @@
+#include "ObjectPool.h"
+
+#include "TestHandler.h"
+
+namespace // detail
+{
+
+class PooledBase
+{
+public:
+	PooledBase(int value) : m_value(value) {}
+	virtual ~PooledBase() = default;
+
+	int		m_value;
+};
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+class PooledDerived : public PooledBase
+{
+public:
+	PooledDerived(int value, int & destroyedCount) : PooledBase(value), m_destroyedCount(destroyedCount) {}
+	virtual ~PooledDerived() override { ++m_destroyedCount; }
+
+	int &	m_destroyedCount;
+};
+
+} // detail -----------------------------------------------------------------------------------------------------------------------
+
+namespace Nova // -----------------------------------------------------------------------------------------------------------------
+{
+
+ObjectPoolTestScript::ObjectPoolTestScript() :
+	ITestScript("ObjectPool")
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+ObjectPoolTestScript::~ObjectPoolTestScript()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------------------
+
+void ObjectPoolTestScript::RunImpl(TestHandler & testHandler)
+{
+	constexpr size_t kChunkCount = 4;
+
+	int destroyedCount = 0;
+	ObjectPool<PooledDerived> objectPool(kChunkCount);
+	std::vector<PoolPtr<PooledBase>> objects;
+
+	for (int i = 0; i < 10; ++i)
+		objects.push_back(objectPool.Make(i, destroyedCount));
+
+	testHandler.Assert(objectPool.Size(), 10ull, "Live object count");
+	testHandler.Assert(objectPool.Capacity(), 12ull, "Capacity grows by whole chunks");
+	testHandler.Assert<int, size_t>([&](size_t index) { return objects[index]->m_value; }, TestHandler::FRangeIndex(),
+		[](size_t index) { return static_cast<int>(index); }, "Objects do not move when the pool grows", { 0, 9 });
+
+	PooledBase * pReleased = objects[5].get();
+	objects[5].reset();
+
+	testHandler.Assert(destroyedCount, 1, "Release calls the derived destructor through the base pointer");
+	testHandler.Assert(objectPool.Size(), 9ull, "Live object count after release");
+
+	objects[5] = objectPool.Make(50, destroyedCount);
+
+	testHandler.Assert(objects[5].get() == pReleased, true, "Released slot is recycled");
+	testHandler.Assert(objectPool.Capacity(), 12ull, "Recycling does not grow the pool");
+
+	objects.clear();
+
+	testHandler.Assert(destroyedCount, 11, "All objects destroyed");
+	testHandler.Assert(objectPool.Size(), 0ull, "Live object count after clear");
+}
+
+} // namespace Nova ---------------------------------------------------------------------------------------------------------------